@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+#include "common.h"
+#include <core/bounds.h>
+
+#include <random>
+
+using namespace dakku;
+
+namespace {
+void BM_Bounds2iIterate(benchmark::State &state) {
+  const auto n = static_cast<int>(state.range(0));
+  Bounds2i b{Point2i{0, 0}, Point2i{n, n}};
+  for (auto _ : state) {
+    int sum = 0;
+    for (Point2i p : b) sum += p.x() ^ p.y();
+    benchmark::DoNotOptimize(sum);
+  }
+  set_items_processed(state, n * n);
+}
+BENCHMARK(BM_Bounds2iIterate)->Arg(16)->Arg(64);
+
+void BM_Bounds3fUnion(benchmark::State &state) {
+  std::mt19937 rng{0};
+  std::uniform_real_distribution<float> u(-1, 1);
+  std::vector<Point3f> p(1024);
+  for (auto &q : p) q = Point3f(u(rng), u(rng), u(rng));
+  for (auto _ : state) {
+    Bounds3f b;
+    for (const auto &q : p) b = b | q;
+    benchmark::DoNotOptimize(b);
+  }
+  set_items_processed(state, static_cast<int64_t>(p.size()));
+}
+BENCHMARK(BM_Bounds3fUnion);
+
+/// random boxes and rays for the slab tests
+struct SlabData {
+  SlabData() {
+    std::mt19937 rng{0};
+    std::uniform_real_distribution<float> u(-10, 10);
+    for (auto &b : boxes)
+      b = Bounds3f{Point3f(u(rng), u(rng), u(rng)),
+                   Point3f(u(rng), u(rng), u(rng))};
+    for (auto &r : rays)
+      r = Ray{Point3f(u(rng), u(rng), u(rng)),
+              Vector3f(u(rng), u(rng), u(rng))};
+  }
+
+  std::array<Bounds3f, 8> boxes;
+  std::array<Ray, 256> rays;
+};
+
+void BM_Bounds3fIntersect(benchmark::State &state) {
+  SlabData data;
+  for (auto _ : state) {
+    int hits = 0;
+    for (const Ray &ray : data.rays) {
+      Vector3f inv_dir(1 / ray.d.x(), 1 / ray.d.y(), 1 / ray.d.z());
+      int dir_is_neg[3] = {inv_dir.x() < 0, inv_dir.y() < 0, inv_dir.z() < 0};
+      for (const Bounds3f &b : data.boxes)
+        hits += b.intersect_p(ray, inv_dir, dir_is_neg);
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  set_items_processed(
+      state, static_cast<int64_t>(data.rays.size() * data.boxes.size()));
+}
+BENCHMARK(BM_Bounds3fIntersect);
+
+template <size_t W>
+void BM_Bounds3fPacketIntersect(benchmark::State &state) {
+  SlabData data;
+  std::array<Bounds3fPacket<W>, 8 / W> packets;
+  for (size_t i = 0; i < data.boxes.size(); ++i)
+    packets[i / W].set(i % W, data.boxes[i]);
+  for (auto _ : state) {
+    uint32_t hits = 0;
+    for (const Ray &ray : data.rays) {
+      Vector3f inv_dir(1 / ray.d.x(), 1 / ray.d.y(), 1 / ray.d.z());
+      int dir_is_neg[3] = {inv_dir.x() < 0, inv_dir.y() < 0, inv_dir.z() < 0};
+      for (const auto &packet : packets)
+        hits += packet.intersect_p(ray, inv_dir, dir_is_neg);
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  set_items_processed(
+      state, static_cast<int64_t>(data.rays.size() * data.boxes.size()));
+}
+BENCHMARK(BM_Bounds3fPacketIntersect<4>);
+BENCHMARK(BM_Bounds3fPacketIntersect<8>);
+}  // namespace
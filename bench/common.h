@@ -0,0 +1,22 @@
+#ifndef DAKKU_BENCH_COMMON_H_
+#define DAKKU_BENCH_COMMON_H_
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace dakku {
+
+/**
+ * @brief report `items` operations per iteration as items/s and ns/op
+ *
+ */
+inline void set_items_processed(benchmark::State &state, int64_t items) {
+  state.SetItemsProcessed(state.iterations() * items);
+  // the inverted rate is seconds per item, scaled to nanoseconds
+  state.counters["ns/op"] = benchmark::Counter(
+      static_cast<double>(items) * 1e-9,
+      benchmark::Counter::kIsIterationInvariantRate |
+          benchmark::Counter::kInvert);
+}
+}  // namespace dakku
+#endif
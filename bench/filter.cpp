@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include "common.h"
+#include <filters/triangle.h>
+
+#include <random>
+
+using namespace dakku;
+
+namespace {
+/// random points inside (and a bit outside) a filter of radius 2
+std::vector<Point2f> random_points(size_t n) {
+  std::mt19937 rng{0};
+  std::uniform_real_distribution<float> u(-2.5f, 2.5f);
+  std::vector<Point2f> ret(n);
+  for (auto &p : ret) p = Point2f(u(rng), u(rng));
+  return ret;
+}
+
+constexpr size_t N = 1024;
+
+void BM_FilterEvaluate(benchmark::State &state) {
+  const Filter *filter = create_triangle_filter(2, 2);
+  auto p = random_points(N);
+  for (auto _ : state) {
+    float sum = 0;
+    for (const auto &q : p) sum += filter->evaluate(q);
+    benchmark::DoNotOptimize(sum);
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_FilterEvaluate);
+
+void BM_FilterTableEvaluate(benchmark::State &state) {
+  const Filter *filter = create_triangle_filter(2, 2);
+  const FilterTable &table = filter->table();
+  auto p = random_points(N);
+  for (auto _ : state) {
+    float sum = 0;
+    for (const auto &q : p) sum += table.evaluate(q);
+    benchmark::DoNotOptimize(sum);
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_FilterTableEvaluate);
+
+void BM_FilterEvaluateBatch(benchmark::State &state) {
+  const Filter *filter = create_triangle_filter(2, 2);
+  auto p = random_points(N);
+  std::vector<float> out(N);
+  for (auto _ : state) {
+    filter->evaluate_batch(p, out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_FilterEvaluateBatch);
+}  // namespace
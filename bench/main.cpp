@@ -0,0 +1,24 @@
+#include <benchmark/benchmark.h>
+
+#include <string_view>
+#include <vector>
+
+int main(int argc, char **argv) {
+  // export json to `bench.json` unless `--benchmark_out` is given
+  std::vector<char *> args(argv, argv + argc);
+  char out[] = "--benchmark_out=bench.json";
+  char format[] = "--benchmark_out_format=json";
+  bool has_out = false;
+  for (std::string_view arg : args)
+    has_out |= arg.starts_with("--benchmark_out=");
+  if (!has_out) {
+    args.push_back(out);
+    args.push_back(format);
+  }
+  int n = static_cast<int>(args.size());
+  benchmark::Initialize(&n, args.data());
+  if (benchmark::ReportUnrecognizedArguments(n, args.data())) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include "common.h"
+#include <core/memory.h>
+
+using namespace dakku;
+
+namespace {
+/// a bsdf sized object
+struct Object {
+  std::array<float, 24> data{};
+};
+
+constexpr size_t N = 1024;
+
+void BM_MemoryArenaAlloc(benchmark::State &state) {
+  MemoryArena arena;
+  for (auto _ : state) {
+    for (size_t i = 0; i < N; ++i)
+      benchmark::DoNotOptimize(arena.allocObject<Object>());
+    arena.release();
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_MemoryArenaAlloc);
+
+void BM_ThreadLocalArenasAlloc(benchmark::State &state) {
+  static ThreadLocalArenas arenas;
+  for (auto _ : state) {
+    MemoryArena &arena = arenas.local();
+    for (size_t i = 0; i < N; ++i)
+      benchmark::DoNotOptimize(arena.allocObject<Object>());
+    arenas.reset();
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_ThreadLocalArenasAlloc)->ThreadRange(1, 8);
+
+void BM_NewDelete(benchmark::State &state) {
+  std::vector<Object *> objects(N);
+  for (auto _ : state) {
+    for (auto &o : objects) benchmark::DoNotOptimize(o = new Object);
+    for (auto *o : objects) delete o;
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_NewDelete);
+}  // namespace
@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include "common.h"
+#include <core/vector.h>
+
+#include <random>
+
+using namespace dakku;
+
+namespace {
+/// random vectors, so that nothing is constant folded
+template <typename V>
+std::vector<V> random_vectors(size_t n) {
+  std::mt19937 rng{0};
+  std::uniform_real_distribution<float> u(-1, 1);
+  std::vector<V> ret(n);
+  for (auto &v : ret)
+    for (size_t i = 0; i < v.size(); ++i) v[i] = u(rng);
+  return ret;
+}
+
+constexpr size_t N = 1024;
+
+void BM_VectorAdd(benchmark::State &state) {
+  auto a = random_vectors<Vector3f>(N), b = random_vectors<Vector3f>(N);
+  std::vector<Vector3f> c(N);
+  for (auto _ : state) {
+    for (size_t i = 0; i < N; ++i) c[i] = a[i] + b[i];
+    benchmark::DoNotOptimize(c.data());
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_VectorAdd);
+
+void BM_VectorFused(benchmark::State &state) {
+  auto a = random_vectors<Vector3f>(N), b = random_vectors<Vector3f>(N);
+  std::vector<Point3f> p = random_vectors<Point3f>(N);
+  for (auto _ : state) {
+    for (size_t i = 0; i < N; ++i) p[i] = p[i] + (a[i] - b[i]) * 0.5f;
+    benchmark::DoNotOptimize(p.data());
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_VectorFused);
+
+void BM_VectorDot(benchmark::State &state) {
+  auto a = random_vectors<Vector3f>(N), b = random_vectors<Vector3f>(N);
+  for (auto _ : state) {
+    float sum = 0;
+    for (size_t i = 0; i < N; ++i) sum += a[i].dot(b[i]);
+    benchmark::DoNotOptimize(sum);
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_VectorDot);
+
+void BM_VectorCross(benchmark::State &state) {
+  auto a = random_vectors<Vector3f>(N), b = random_vectors<Vector3f>(N);
+  std::vector<Vector3f> c(N);
+  for (auto _ : state) {
+    for (size_t i = 0; i < N; ++i) c[i] = a[i].cross(b[i]);
+    benchmark::DoNotOptimize(c.data());
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_VectorCross);
+
+void BM_VectorNormalize(benchmark::State &state) {
+  auto a = random_vectors<Vector3f>(N);
+  std::vector<Vector3f> c(N);
+  for (auto _ : state) {
+    for (size_t i = 0; i < N; ++i) c[i] = a[i] / a[i].norm();
+    benchmark::DoNotOptimize(c.data());
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_VectorNormalize);
+
+void BM_VectorMinMax(benchmark::State &state) {
+  auto a = random_vectors<Point3f>(N), b = random_vectors<Point3f>(N);
+  std::vector<Point3f> c(N);
+  for (auto _ : state) {
+    for (size_t i = 0; i < N; ++i) c[i] = max(min(a[i], b[i]), c[i]);
+    benchmark::DoNotOptimize(c.data());
+  }
+  set_items_processed(state, N);
+}
+BENCHMARK(BM_VectorMinMax);
+}  // namespace
@@ -0,0 +1,6 @@
+add_requires("benchmark")
+target("bench")
+  set_kind("binary")
+  add_files("*.cpp")
+  add_packages("benchmark")
+  add_deps("dakku.core", "dakku.filters")
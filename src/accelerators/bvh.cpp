@@ -0,0 +1,367 @@
+#include <accelerators/bvh.h>
+#include <core/memory.h>
+#include <core/profiler.h>
+#include <core/stats.h>
+#include <core/trace.h>
+
+#include <oneapi/tbb/parallel_invoke.h>
+#include <oneapi/tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace dakku {
+
+DAKKU_STAT_COUNTER("BVH/Rays traced", rays_traced);
+DAKKU_STAT_COUNTER("BVH/Shadow rays traced", shadow_rays_traced);
+DAKKU_STAT_COUNTER("BVH/Primitive tests", primitive_tests);
+DAKKU_STAT_DISTRIBUTION("BVH/Nodes visited per ray", nodes_visited);
+DAKKU_STAT_RATIO("BVH/Primitives per leaf node", leaf_primitives, leaf_nodes);
+
+namespace {
+/// the number of sah buckets
+constexpr int N_BUCKETS = 16;
+/// ranges with more primitives are processed in parallel
+constexpr size_t PARALLEL_THRESHOLD = 4096;
+/// from this depth on the nodes are split at the object median, so that the
+/// levels left for up to $2^{32}$ primitives fit in `BVH::MAX_DEPTH`
+constexpr size_t MAX_SAH_DEPTH = BVH::MAX_DEPTH - 32;
+
+/**
+ * @brief primitive info used during the build
+ *
+ */
+struct PrimitiveInfo {
+  Bounds3f bounds;
+  Point3f centroid;
+  uint32_t index;
+};
+
+/**
+ * @brief bounds of the primitives and of their centroids over a range
+ *
+ */
+struct RangeBounds {
+  void add(const PrimitiveInfo &info) {
+    bounds = bounds | info.bounds;
+    centroid_bounds = centroid_bounds | info.centroid;
+  }
+
+  void merge(const RangeBounds &rhs) {
+    bounds = bounds | rhs.bounds;
+    centroid_bounds = centroid_bounds | rhs.centroid_bounds;
+  }
+
+  Bounds3f bounds;
+  Bounds3f centroid_bounds;
+};
+
+/**
+ * @brief sah buckets along an axis
+ *
+ */
+struct Buckets {
+  void merge(const Buckets &rhs) {
+    for (int i = 0; i < N_BUCKETS; ++i) {
+      count[i] += rhs.count[i];
+      bounds[i] = bounds[i] | rhs.bounds[i];
+    }
+  }
+
+  std::array<uint32_t, N_BUCKETS> count{};
+  std::array<Bounds3f, N_BUCKETS> bounds;
+};
+
+/**
+ * @brief reduce `T` over `info`, in parallel for large ranges
+ *
+ */
+template <typename T, typename F>
+T reduce(std::span<const PrimitiveInfo> info, F &&add) {
+  auto body = [&](const oneapi::tbb::blocked_range<size_t> &r, T acc) {
+    for (size_t i = r.begin(); i != r.end(); ++i) add(acc, info[i]);
+    return acc;
+  };
+  if (info.size() < PARALLEL_THRESHOLD)
+    return body(oneapi::tbb::blocked_range<size_t>(0, info.size()), T{});
+  return oneapi::tbb::parallel_reduce(
+      oneapi::tbb::blocked_range<size_t>(0, info.size(), PARALLEL_THRESHOLD),
+      T{}, body, [](T a, const T &b) {
+        a.merge(b);
+        return a;
+      });
+}
+
+/**
+ * @brief build tree node
+ *
+ */
+struct BuildNode {
+  Bounds3f bounds;
+  std::array<BuildNode *, 2> children{};
+  uint32_t axis{0};
+  uint32_t first{0};
+  uint32_t count{0};
+};
+
+/**
+ * @brief recursive binned sah builder
+ *
+ */
+class Builder {
+ public:
+  Builder(std::span<PrimitiveInfo> info, int max_prims_in_node)
+      : info(info), max_prims_in_node(max_prims_in_node) {}
+
+  /**
+   * @brief build the subtree of `info[begin, end)` at `depth`
+   *
+   */
+  BuildNode *build(size_t begin, size_t end, size_t depth = 0) {
+    ++total_nodes;
+    auto *node = arenas.local().allocObject<BuildNode>();
+    const size_t n = end - begin;
+    auto range = info.subspan(begin, n);
+    auto rb = reduce<RangeBounds>(
+        range, [](RangeBounds &acc, const PrimitiveInfo &p) { acc.add(p); });
+    node->bounds = rb.bounds;
+    const auto make_leaf = [&] {
+      node->first = static_cast<uint32_t>(begin);
+      node->count = static_cast<uint32_t>(n);
+      return node;
+    };
+    if (n == 1) return make_leaf();
+
+    const Bounds3f &cb = rb.centroid_bounds;
+    const auto axis = static_cast<int>(cb.max_extent());
+    size_t mid = begin + n / 2;
+    if (cb.p_max[axis] == cb.p_min[axis]) {
+      // all centroids coincide, sah can't separate them
+      if (n <= static_cast<size_t>(max_prims_in_node)) return make_leaf();
+    } else if (depth >= MAX_SAH_DEPTH) {
+      // sah may peel off a few primitives per level, halve the rest instead
+      if (n <= static_cast<size_t>(max_prims_in_node)) return make_leaf();
+      std::nth_element(range.begin(), range.begin() + n / 2, range.end(),
+                       [axis](const PrimitiveInfo &a, const PrimitiveInfo &b) {
+                         return a.centroid[axis] < b.centroid[axis];
+                       });
+    } else {
+      const auto bucket_of = [&](const PrimitiveInfo &p) {
+        int b = static_cast<int>(N_BUCKETS * cb.offset(p.centroid)[axis]);
+        return std::min(b, N_BUCKETS - 1);
+      };
+      auto buckets = reduce<Buckets>(
+          range, [&](Buckets &acc, const PrimitiveInfo &p) {
+            int b = bucket_of(p);
+            ++acc.count[b];
+            acc.bounds[b] = acc.bounds[b] | p.bounds;
+          });
+      // cost of splitting after bucket i, sweeping from both sides
+      std::array<float, N_BUCKETS - 1> cost{};
+      Bounds3f b;
+      uint32_t count = 0;
+      for (int i = 0; i < N_BUCKETS - 1; ++i) {
+        b = b | buckets.bounds[i];
+        count += buckets.count[i];
+        cost[i] = count == 0 ? INF : count * b.surface_area();
+      }
+      b = Bounds3f{};
+      count = 0;
+      for (int i = N_BUCKETS - 1; i > 0; --i) {
+        b = b | buckets.bounds[i];
+        count += buckets.count[i];
+        cost[i - 1] += count == 0 ? INF : count * b.surface_area();
+      }
+      const auto min_bucket = static_cast<int>(
+          std::min_element(cost.begin(), cost.end()) - cost.begin());
+      // relative to a traversal step costing 1 and an intersection costing 1
+      const float min_cost = 1 + cost[min_bucket] / rb.bounds.surface_area();
+      if (n <= static_cast<size_t>(max_prims_in_node) &&
+          min_cost >= static_cast<float>(n))
+        return make_leaf();
+      mid = std::partition(range.begin(), range.end(),
+                           [&](const PrimitiveInfo &p) {
+                             return bucket_of(p) <= min_bucket;
+                           }) -
+            info.begin();
+    }
+
+    node->axis = static_cast<uint32_t>(axis);
+    if (n > PARALLEL_THRESHOLD) {
+      TraceScope trace("BVH build split");
+      oneapi::tbb::parallel_invoke(
+          [&] { node->children[0] = build(begin, mid, depth + 1); },
+          [&] { node->children[1] = build(mid, end, depth + 1); });
+    } else {
+      node->children[0] = build(begin, mid, depth + 1);
+      node->children[1] = build(mid, end, depth + 1);
+    }
+    return node;
+  }
+
+  /// the number of nodes built
+  std::atomic<uint32_t> total_nodes{0};
+
+ private:
+  /// primitive info, partitioned in place
+  std::span<PrimitiveInfo> info;
+  /// the maximum number of primitives in a leaf
+  int max_prims_in_node;
+  /// build nodes
+  ThreadLocalArenas arenas;
+};
+
+/**
+ * @brief traverse the nodes front to back, `visit(node)` is called for the
+ * leaves overlapping the ray and returns whether to stop
+ *
+ * @return the number of visited nodes
+ */
+template <typename F>
+DAKKU_INLINE size_t traverse(std::span<const BVHNode> nodes, const Ray &ray,
+                             F &&visit) {
+  if (nodes.empty()) return 0;
+  const Vector3f inv_dir(1 / ray.d.x(), 1 / ray.d.y(), 1 / ray.d.z());
+  const std::array<int, 3> dir_is_neg{inv_dir.x() < 0, inv_dir.y() < 0,
+                                      inv_dir.z() < 0};
+  // at most one entry per level, the build limits the depth
+  std::array<uint32_t, BVH::MAX_DEPTH> to_visit;
+  size_t to_visit_offset = 0;
+  uint32_t current = 0;
+  size_t visited = 0;
+  while (true) {
+    const BVHNode &node = nodes[current];
+    ++visited;
+    if (node.bound().intersect_p(ray, inv_dir, dir_is_neg.data())) {
+      if (node.n_primitives > 0) {
+        if (visit(node) || to_visit_offset == 0) return visited;
+        current = to_visit[--to_visit_offset];
+      } else if (dir_is_neg[node.axis]) {
+        // visit the nearer child first
+        to_visit[to_visit_offset++] = current + 1;
+        current = node.second_child_offset;
+      } else {
+        to_visit[to_visit_offset++] = node.second_child_offset;
+        current = current + 1;
+      }
+    } else {
+      if (to_visit_offset == 0) return visited;
+      current = to_visit[--to_visit_offset];
+    }
+  }
+}
+}  // namespace
+
+BVH::BVH(std::span<const Primitive *const> prims, int max_prims_in_node) {
+  ProfilePhase _(Prof::BVH_BUILD);
+  TraceScope trace("BVH build");
+  max_prims_in_node = std::clamp(max_prims_in_node, 1, MAX_PRIMS_IN_NODE);
+  if (prims.empty()) return;
+  std::vector<PrimitiveInfo> info(prims.size());
+  oneapi::tbb::parallel_for(size_t{0}, prims.size(), [&](size_t i) {
+    Bounds3f b = prims[i]->world_bound();
+    info[i] = {b, b.centroid(), static_cast<uint32_t>(i)};
+  });
+
+  Builder builder{info, max_prims_in_node};
+  BuildNode *root = builder.build(0, info.size());
+
+  primitives.resize(info.size());
+  prim_ids.resize(info.size());
+  for (size_t i = 0; i < info.size(); ++i) {
+    primitives[i] = prims[info[i].index];
+    prim_ids[i] = info[i].index;
+  }
+
+  // flatten depth first, the first child directly follows its parent
+  nodes.resize(builder.total_nodes);
+  uint32_t offset = 0;
+  auto flatten = [&](auto &&self, const BuildNode *node) -> uint32_t {
+    const uint32_t index = offset++;
+    BVHNode &linear = nodes[index];
+    for (int i = 0; i < 3; ++i) {
+      linear.bounds[0][i] = node->bounds.p_min[i];
+      linear.bounds[1][i] = node->bounds.p_max[i];
+    }
+    if (node->count > 0) {
+      linear.primitives_offset = node->first;
+      linear.n_primitives = static_cast<uint16_t>(node->count);
+      DAKKU_STAT_ADD(leaf_primitives, node->count);
+      DAKKU_STAT_INC(leaf_nodes);
+    } else {
+      linear.axis = static_cast<uint8_t>(node->axis);
+      linear.n_primitives = 0;
+      self(self, node->children[0]);
+      linear.second_child_offset = self(self, node->children[1]);
+    }
+    return index;
+  };
+  flatten(flatten, root);
+  DAKKU_CHECK(offset == nodes.size(), "bvh node count mismatch: {} != {}",
+              offset, nodes.size());
+}
+
+Bounds3f BVH::world_bound() const {
+  if (nodes.empty()) return {};
+  return nodes.front().bound();
+}
+
+std::optional<RayHit> BVH::intersect(const Ray &ray) const {
+  ProfilePhase _(Prof::TRAVERSAL);
+  std::optional<RayHit> hit;
+  [[maybe_unused]] const size_t visited =
+      traverse(nodes, ray, [&](const BVHNode &node) {
+        DAKKU_STAT_ADD(primitive_tests, node.n_primitives);
+        for (uint32_t i = node.primitives_offset;
+             i < node.primitives_offset + node.n_primitives; ++i) {
+          if (auto h = primitives[i]->intersect(ray)) {
+            hit = h;
+            hit->prim_id = prim_ids[i];
+          }
+        }
+        return false;
+      });
+  DAKKU_STAT_INC(rays_traced);
+  DAKKU_STAT_VALUE(nodes_visited, visited);
+  return hit;
+}
+
+bool BVH::occluded(const Ray &ray) const {
+  ProfilePhase _(Prof::SHADOW_TRAVERSAL);
+  bool ret = false;
+  [[maybe_unused]] const size_t visited =
+      traverse(nodes, ray, [&](const BVHNode &node) {
+        for (uint32_t i = node.primitives_offset;
+             i < node.primitives_offset + node.n_primitives; ++i) {
+          DAKKU_STAT_INC(primitive_tests);
+          if (primitives[i]->occluded(ray)) return ret = true;
+        }
+        return false;
+      });
+  DAKKU_STAT_INC(shadow_rays_traced);
+  DAKKU_STAT_VALUE(nodes_visited, visited);
+  return ret;
+}
+
+Accelerator *create_bvh_accelerator(
+    std::span<const Primitive *const> primitives, int max_prims_in_node) {
+  return GlobalMemoryArena::instance().allocObject<BVH>(primitives,
+                                                        max_prims_in_node);
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(BVH, [] {
+  DAKKU_INFO("register BVH");
+  auto &state = Lua::instance().get_state();
+  state.set_function(
+      "_create_bvh_accelerator",
+      sol::overload(
+          [](const sol::table &primitives) {
+            return create_bvh_accelerator(primitives_from_lua(primitives));
+          },
+          [](const sol::table &primitives, int max_prims_in_node) {
+            return create_bvh_accelerator(primitives_from_lua(primitives),
+                                          max_prims_in_node);
+          }));
+  return 0;
+});
+}  // namespace dakku
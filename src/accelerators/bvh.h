@@ -0,0 +1,122 @@
+#ifndef DAKKU_ACCELERATORS_BVH_H_
+#define DAKKU_ACCELERATORS_BVH_H_
+#include <accelerators/fwd.h>
+#include <core/accelerator.h>
+
+#include <oneapi/tbb/cache_aligned_allocator.h>
+
+#include <span>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief flattened bvh node (two nodes per cache line)
+ * an interior node is followed by its first child, the second child is at
+ * `second_child_offset`
+ *
+ */
+struct alignas(32) BVHNode {
+  /// `bounds[0]` is the minimum corner, `bounds[1]` the maximum corner
+  std::array<std::array<float, 3>, 2> bounds;
+  union {
+    /// leaf: offset of the first primitive
+    uint32_t primitives_offset;
+    /// interior: offset of the second child
+    uint32_t second_child_offset;
+  };
+  /// the number of primitives, $0$ for interior nodes
+  uint16_t n_primitives;
+  /// interior: split axis
+  uint8_t axis;
+  /// padding
+  uint8_t pad;
+
+  /**
+   * @brief get the node bounds
+   *
+   */
+  [[nodiscard]] Bounds3f bound() const {
+    return Bounds3f{Point3f{bounds[0][0], bounds[0][1], bounds[0][2]},
+                    Point3f{bounds[1][0], bounds[1][1], bounds[1][2]}};
+  }
+};
+static_assert(sizeof(BVHNode) == 32);
+
+/**
+ * @brief bounding volume hierarchy built with the binned surface area
+ * heuristic, the top levels are built in parallel tbb tasks
+ *
+ */
+class DAKKU_EXPORT_ACCELERATORS BVH : public Accelerator {
+ public:
+  using Accelerator::intersect;
+  using Accelerator::occluded;
+
+  /// the maximum number of primitives in a leaf
+  static constexpr int MAX_PRIMS_IN_NODE = 255;
+  /// the maximum depth of the tree (the size of the traversal stack)
+  static constexpr size_t MAX_DEPTH = 64;
+
+  /**
+   * @brief Construct a new BVH object
+   *
+   * @param primitives the primitives (not owned), `RayHit::prim_id` is the
+   * index in this list
+   * @param max_prims_in_node the maximum number of primitives in a leaf
+   */
+  explicit BVH(std::span<const Primitive *const> primitives,
+               int max_prims_in_node = 4);
+
+  /**
+   * @brief get the world space bounds of all primitives
+   *
+   */
+  [[nodiscard]] Bounds3f world_bound() const override;
+
+  /**
+   * @brief get the number of primitives
+   *
+   */
+  [[nodiscard]] size_t n_primitives() const override {
+    return primitives.size();
+  }
+
+  /**
+   * @brief find the closest hit in $(0, ray.tMax)$, on hit `ray.tMax` is
+   * shrunk to the hit
+   *
+   */
+  std::optional<RayHit> intersect(const Ray &ray) const override;
+
+  /**
+   * @brief check whether the ray hits anything in $(0, ray.tMax)$
+   *
+   */
+  [[nodiscard]] bool occluded(const Ray &ray) const override;
+
+  /**
+   * @brief get the flattened (depth first) nodes
+   *
+   */
+  [[nodiscard]] std::span<const BVHNode> get_nodes() const { return nodes; }
+
+ private:
+  /// primitives in leaf order
+  std::vector<const Primitive *> primitives;
+  /// original indices of `primitives`
+  std::vector<uint32_t> prim_ids;
+  /// cache line aligned nodes
+  std::vector<BVHNode, oneapi::tbb::cache_aligned_allocator<BVHNode>> nodes;
+};
+
+/**
+ * @brief Create a bvh accelerator object
+ *
+ */
+DAKKU_EXPORT_ACCELERATORS Accelerator *create_bvh_accelerator(
+    std::span<const Primitive *const> primitives, int max_prims_in_node = 4);
+
+DAKKU_DECLARE_LUA_OBJECT(BVH, DAKKU_EXPORT_ACCELERATORS);
+}  // namespace dakku
+#endif
@@ -0,0 +1,308 @@
+#include <accelerators/embree.h>
+#include <accelerators/bvh.h>
+#include <core/memory.h>
+
+namespace dakku {
+
+#ifdef DAKKU_ENABLE_EMBREE
+namespace {
+/**
+ * @brief embree packet types and entry points of width `N`
+ *
+ */
+template <size_t N>
+struct EmbreePacket;
+
+template <>
+struct EmbreePacket<4> {
+  using RayHitN = RTCRayHit4;
+  using RayN = RTCRay4;
+  static void intersect(const int *valid, RTCScene scene, RayHitN *rayhit) {
+    rtcIntersect4(valid, scene, rayhit);
+  }
+  static void occluded(const int *valid, RTCScene scene, RayN *ray) {
+    rtcOccluded4(valid, scene, ray);
+  }
+};
+
+template <>
+struct EmbreePacket<8> {
+  using RayHitN = RTCRayHit8;
+  using RayN = RTCRay8;
+  static void intersect(const int *valid, RTCScene scene, RayHitN *rayhit) {
+    rtcIntersect8(valid, scene, rayhit);
+  }
+  static void occluded(const int *valid, RTCScene scene, RayN *ray) {
+    rtcOccluded8(valid, scene, ray);
+  }
+};
+
+template <>
+struct EmbreePacket<16> {
+  using RayHitN = RTCRayHit16;
+  using RayN = RTCRay16;
+  static void intersect(const int *valid, RTCScene scene, RayHitN *rayhit) {
+    rtcIntersect16(valid, scene, rayhit);
+  }
+  static void occluded(const int *valid, RTCScene scene, RayN *ray) {
+    rtcOccluded16(valid, scene, ray);
+  }
+};
+
+/**
+ * @brief fill the embree rays of a packet (`RTCRay4/8/16`)
+ *
+ */
+template <size_t N, typename RayN>
+void fill_rays(const RayPacket<N> &rays, RayN &ray, std::array<int, N> &valid) {
+  for (size_t i = 0; i < N; ++i) {
+    valid[i] = rays.is_active(i) ? -1 : 0;
+    ray.org_x[i] = rays.o.x[i];
+    ray.org_y[i] = rays.o.y[i];
+    ray.org_z[i] = rays.o.z[i];
+    ray.dir_x[i] = rays.d.x[i];
+    ray.dir_y[i] = rays.d.y[i];
+    ray.dir_z[i] = rays.d.z[i];
+    ray.tnear[i] = 0;
+    ray.tfar[i] = rays.tMax[i];
+    ray.time[i] = 0;
+    ray.mask[i] = ~0u;
+    ray.id[i] = static_cast<unsigned>(i);
+    ray.flags[i] = 0;
+  }
+}
+
+/**
+ * @brief get the dakku ray of lane `i` of an embree ray packet
+ *
+ */
+Ray get_ray(RTCRayN *ray, unsigned n, unsigned i) {
+  return Ray{Point3f(RTCRayN_org_x(ray, n, i), RTCRayN_org_y(ray, n, i),
+                     RTCRayN_org_z(ray, n, i)),
+             Vector3f(RTCRayN_dir_x(ray, n, i), RTCRayN_dir_y(ray, n, i),
+                      RTCRayN_dir_z(ray, n, i)),
+             RTCRayN_tfar(ray, n, i)};
+}
+
+void bounds_func(const RTCBoundsFunctionArguments *args) {
+  const auto *self =
+      static_cast<const EmbreeAccelerator *>(args->geometryUserPtr);
+  Bounds3f b = self->get_primitive(args->primID)->world_bound();
+  RTCBounds *out = args->bounds_o;
+  out->lower_x = b.p_min.x();
+  out->lower_y = b.p_min.y();
+  out->lower_z = b.p_min.z();
+  out->upper_x = b.p_max.x();
+  out->upper_y = b.p_max.y();
+  out->upper_z = b.p_max.z();
+}
+
+void intersect_func(const RTCIntersectFunctionNArguments *args) {
+  const auto *self =
+      static_cast<const EmbreeAccelerator *>(args->geometryUserPtr);
+  const Primitive *primitive = self->get_primitive(args->primID);
+  const unsigned n = args->N;
+  RTCRayN *ray = RTCRayHitN_RayN(args->rayhit, n);
+  RTCHitN *hit = RTCRayHitN_HitN(args->rayhit, n);
+  for (unsigned i = 0; i < n; ++i) {
+    if (!args->valid[i]) continue;
+    auto h = primitive->intersect(get_ray(ray, n, i));
+    if (!h) continue;
+    RTCRayN_tfar(ray, n, i) = h->t;
+    RTCHitN_Ng_x(hit, n, i) = 0;
+    RTCHitN_Ng_y(hit, n, i) = 0;
+    RTCHitN_Ng_z(hit, n, i) = 0;
+    RTCHitN_u(hit, n, i) = h->uv.x();
+    RTCHitN_v(hit, n, i) = h->uv.y();
+    RTCHitN_primID(hit, n, i) = args->primID;
+    RTCHitN_geomID(hit, n, i) = args->geomID;
+    RTCHitN_instID(hit, n, i, 0) = args->context->instID[0];
+  }
+}
+
+void occluded_func(const RTCOccludedFunctionNArguments *args) {
+  const auto *self =
+      static_cast<const EmbreeAccelerator *>(args->geometryUserPtr);
+  const Primitive *primitive = self->get_primitive(args->primID);
+  const unsigned n = args->N;
+  for (unsigned i = 0; i < n; ++i) {
+    if (!args->valid[i]) continue;
+    // embree marks occluded rays with $tfar = -\infty$
+    if (primitive->occluded(get_ray(args->ray, n, i)))
+      RTCRayN_tfar(args->ray, n, i) = -INF;
+  }
+}
+
+/**
+ * @brief trace a packet with `rtcIntersect4/8/16`
+ *
+ */
+template <size_t N>
+uint32_t intersect_packet(RTCScene scene, const RayPacket<N> &rays,
+                          std::span<RayHit, N> hits) {
+  // embree requires the valid mask and the packet to be aligned to the
+  // packet size (16, 32 or 64 bytes)
+  alignas(4 * N) typename EmbreePacket<N>::RayHitN rayhit;
+  alignas(4 * N) std::array<int, N> valid;
+  fill_rays(rays, rayhit.ray, valid);
+  for (size_t i = 0; i < N; ++i) rayhit.hit.geomID[i] = RTC_INVALID_GEOMETRY_ID;
+  EmbreePacket<N>::intersect(valid.data(), scene, &rayhit);
+  uint32_t mask = 0;
+  for (size_t i = 0; i < N; ++i) {
+    if (!valid[i] || rayhit.hit.geomID[i] == RTC_INVALID_GEOMETRY_ID) continue;
+    hits[i] = RayHit{rayhit.ray.tfar[i],
+                     Point2f(rayhit.hit.u[i], rayhit.hit.v[i]),
+                     rayhit.hit.primID[i]};
+    rays.tMax[i] = rayhit.ray.tfar[i];
+    mask |= 1u << i;
+  }
+  return mask;
+}
+
+/**
+ * @brief trace a packet with `rtcOccluded4/8/16`
+ *
+ */
+template <size_t N>
+uint32_t occluded_packet(RTCScene scene, const RayPacket<N> &rays) {
+  alignas(4 * N) typename EmbreePacket<N>::RayN ray;
+  alignas(4 * N) std::array<int, N> valid;
+  fill_rays(rays, ray, valid);
+  EmbreePacket<N>::occluded(valid.data(), scene, &ray);
+  uint32_t mask = 0;
+  for (size_t i = 0; i < N; ++i)
+    if (valid[i] && ray.tfar[i] < 0) mask |= 1u << i;
+  return mask;
+}
+}  // namespace
+
+EmbreeAccelerator::EmbreeAccelerator(
+    std::span<const Primitive *const> primitives)
+    : primitives(primitives.begin(), primitives.end()),
+      device(rtcNewDevice(nullptr)) {
+  rtcSetDeviceErrorFunction(
+      device,
+      [](void *, RTCError code, const char *str) {
+        DAKKU_ERR("embree error {}: {}", static_cast<int>(code), str);
+      },
+      nullptr);
+  scene = rtcNewScene(device);
+  rtcSetSceneBuildQuality(scene, RTC_BUILD_QUALITY_HIGH);
+  if (!this->primitives.empty()) {
+    RTCGeometry geometry = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_USER);
+    rtcSetGeometryUserPrimitiveCount(
+        geometry, static_cast<unsigned>(this->primitives.size()));
+    rtcSetGeometryUserData(geometry, this);
+    rtcSetGeometryBoundsFunction(geometry, &bounds_func, nullptr);
+    rtcSetGeometryIntersectFunction(geometry, &intersect_func);
+    rtcSetGeometryOccludedFunction(geometry, &occluded_func);
+    rtcCommitGeometry(geometry);
+    rtcAttachGeometry(scene, geometry);
+    rtcReleaseGeometry(geometry);
+  }
+  rtcCommitScene(scene);
+}
+
+EmbreeAccelerator::~EmbreeAccelerator() {
+  rtcReleaseScene(scene);
+  rtcReleaseDevice(device);
+}
+
+Bounds3f EmbreeAccelerator::world_bound() const {
+  if (primitives.empty()) return {};
+  RTCBounds b;
+  rtcGetSceneBounds(scene, &b);
+  return Bounds3f{Point3f{b.lower_x, b.lower_y, b.lower_z},
+                  Point3f{b.upper_x, b.upper_y, b.upper_z}};
+}
+
+std::optional<RayHit> EmbreeAccelerator::intersect(const Ray &ray) const {
+  RTCRayHit rayhit;
+  rayhit.ray.org_x = ray.o.x();
+  rayhit.ray.org_y = ray.o.y();
+  rayhit.ray.org_z = ray.o.z();
+  rayhit.ray.dir_x = ray.d.x();
+  rayhit.ray.dir_y = ray.d.y();
+  rayhit.ray.dir_z = ray.d.z();
+  rayhit.ray.tnear = 0;
+  rayhit.ray.tfar = ray.tMax;
+  rayhit.ray.time = 0;
+  rayhit.ray.mask = ~0u;
+  rayhit.ray.id = 0;
+  rayhit.ray.flags = 0;
+  rayhit.hit.geomID = RTC_INVALID_GEOMETRY_ID;
+  rtcIntersect1(scene, &rayhit);
+  if (rayhit.hit.geomID == RTC_INVALID_GEOMETRY_ID) return {};
+  ray.tMax = rayhit.ray.tfar;
+  return RayHit{rayhit.ray.tfar, Point2f(rayhit.hit.u, rayhit.hit.v),
+                rayhit.hit.primID};
+}
+
+bool EmbreeAccelerator::occluded(const Ray &ray) const {
+  RTCRay r;
+  r.org_x = ray.o.x();
+  r.org_y = ray.o.y();
+  r.org_z = ray.o.z();
+  r.dir_x = ray.d.x();
+  r.dir_y = ray.d.y();
+  r.dir_z = ray.d.z();
+  r.tnear = 0;
+  r.tfar = ray.tMax;
+  r.time = 0;
+  r.mask = ~0u;
+  r.id = 0;
+  r.flags = 0;
+  rtcOccluded1(scene, &r);
+  return r.tfar < 0;
+}
+
+uint32_t EmbreeAccelerator::intersect(const RayPacket4 &rays,
+                                      std::span<RayHit, 4> hits) const {
+  return intersect_packet(scene, rays, hits);
+}
+
+uint32_t EmbreeAccelerator::intersect(const RayPacket8 &rays,
+                                      std::span<RayHit, 8> hits) const {
+  return intersect_packet(scene, rays, hits);
+}
+
+uint32_t EmbreeAccelerator::intersect(const RayPacket16 &rays,
+                                      std::span<RayHit, 16> hits) const {
+  return intersect_packet(scene, rays, hits);
+}
+
+uint32_t EmbreeAccelerator::occluded(const RayPacket4 &rays) const {
+  return occluded_packet(scene, rays);
+}
+
+uint32_t EmbreeAccelerator::occluded(const RayPacket8 &rays) const {
+  return occluded_packet(scene, rays);
+}
+
+uint32_t EmbreeAccelerator::occluded(const RayPacket16 &rays) const {
+  return occluded_packet(scene, rays);
+}
+#endif
+
+Accelerator *create_embree_accelerator(
+    std::span<const Primitive *const> primitives) {
+#ifdef DAKKU_ENABLE_EMBREE
+  return GlobalMemoryArena::instance().allocObject<EmbreeAccelerator>(
+      primitives);
+#else
+  DAKKU_WARN("dakku is built without embree, fall back to bvh");
+  return create_bvh_accelerator(primitives);
+#endif
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(EmbreeAccelerator, [] {
+  DAKKU_INFO("register EmbreeAccelerator");
+  auto &state = Lua::instance().get_state();
+  state.set_function("_create_embree_accelerator",
+                     [](const sol::table &primitives) {
+                       return create_embree_accelerator(
+                           primitives_from_lua(primitives));
+                     });
+  return 0;
+});
+}  // namespace dakku
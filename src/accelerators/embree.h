@@ -0,0 +1,78 @@
+#ifndef DAKKU_ACCELERATORS_EMBREE_H_
+#define DAKKU_ACCELERATORS_EMBREE_H_
+#include <accelerators/fwd.h>
+#include <core/accelerator.h>
+
+#ifdef DAKKU_ENABLE_EMBREE
+#include <embree4/rtcore.h>
+#endif
+
+namespace dakku {
+
+#ifdef DAKKU_ENABLE_EMBREE
+/**
+ * @brief embree backend (cpu), the primitives are embree user geometries
+ * and packets are traced with `rtcIntersect4/8/16`
+ *
+ */
+class DAKKU_EXPORT_ACCELERATORS EmbreeAccelerator : public Accelerator {
+ public:
+  using Accelerator::intersect;
+  using Accelerator::occluded;
+
+  /**
+   * @brief Construct a new Embree Accelerator object
+   *
+   * @param primitives the primitives (not owned), `RayHit::prim_id` is the
+   * index in this list
+   */
+  explicit EmbreeAccelerator(std::span<const Primitive *const> primitives);
+  ~EmbreeAccelerator() override;
+  EmbreeAccelerator(const EmbreeAccelerator &) = delete;
+  EmbreeAccelerator &operator=(const EmbreeAccelerator &) = delete;
+
+  [[nodiscard]] Bounds3f world_bound() const override;
+  [[nodiscard]] size_t n_primitives() const override {
+    return primitives.size();
+  }
+  std::optional<RayHit> intersect(const Ray &ray) const override;
+  [[nodiscard]] bool occluded(const Ray &ray) const override;
+  uint32_t intersect(const RayPacket4 &rays,
+                     std::span<RayHit, 4> hits) const override;
+  uint32_t intersect(const RayPacket8 &rays,
+                     std::span<RayHit, 8> hits) const override;
+  uint32_t intersect(const RayPacket16 &rays,
+                     std::span<RayHit, 16> hits) const override;
+  [[nodiscard]] uint32_t occluded(const RayPacket4 &rays) const override;
+  [[nodiscard]] uint32_t occluded(const RayPacket8 &rays) const override;
+  [[nodiscard]] uint32_t occluded(const RayPacket16 &rays) const override;
+
+  /**
+   * @brief get the primitive with index `i`
+   *
+   */
+  [[nodiscard]] const Primitive *get_primitive(size_t i) const {
+    return primitives[i];
+  }
+
+ private:
+  /// primitives
+  std::vector<const Primitive *> primitives;
+  /// embree device
+  RTCDevice device;
+  /// embree scene
+  RTCScene scene;
+};
+#endif
+
+/**
+ * @brief Create an embree accelerator object, if dakku is built without
+ * embree (xmake option `embree`) it warns and falls back to a bvh
+ *
+ */
+DAKKU_EXPORT_ACCELERATORS Accelerator *create_embree_accelerator(
+    std::span<const Primitive *const> primitives);
+
+DAKKU_DECLARE_LUA_OBJECT(EmbreeAccelerator, DAKKU_EXPORT_ACCELERATORS);
+}  // namespace dakku
+#endif
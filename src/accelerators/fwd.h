@@ -0,0 +1,12 @@
+#ifndef DAKKU_ACCELERATORS_FWD_H_
+#define DAKKU_ACCELERATORS_FWD_H_
+#include <core/primitive.h>
+
+namespace dakku {
+#if DAKKU_BUILD_MODULE != DAKKU_ACCELERATORS_MODULE
+#define DAKKU_EXPORT_ACCELERATORS DAKKU_IMPORT
+#else
+#define DAKKU_EXPORT_ACCELERATORS DAKKU_EXPORT
+#endif
+}  // namespace dakku
+#endif
@@ -0,0 +1,14 @@
+if has_config("embree") then
+  add_requires("embree")
+end
+
+target("dakku.accelerators")
+  set_kind("shared")
+  add_defines("DAKKU_BUILD_MODULE=DAKKU_ACCELERATORS_MODULE")
+  add_includedirs(os.projectdir() .. "/src", {public = true})
+  add_files("*.cpp")
+  add_deps("dakku.core")
+  if has_config("embree") then
+    add_packages("embree")
+    add_defines("DAKKU_ENABLE_EMBREE", {public = true})
+  end
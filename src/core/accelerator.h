@@ -0,0 +1,131 @@
+#ifndef DAKKU_CORE_ACCELERATOR_H_
+#define DAKKU_CORE_ACCELERATOR_H_
+#include <core/primitive.h>
+#include <core/ray_packet.h>
+
+namespace dakku {
+
+/**
+ * @brief ray intersection backend over a list of primitives
+ * packet queries only trace the active lanes, the default implementations
+ * trace the lanes one by one, backends with native packet traversal override
+ * them
+ *
+ */
+class DAKKU_EXPORT_CORE Accelerator {
+ public:
+  virtual ~Accelerator() = default;
+
+  /**
+   * @brief get the world space bounds of all primitives
+   *
+   */
+  [[nodiscard]] virtual Bounds3f world_bound() const = 0;
+
+  /**
+   * @brief get the number of primitives, `RayHit::prim_id` is below it
+   *
+   */
+  [[nodiscard]] virtual size_t n_primitives() const = 0;
+
+  /**
+   * @brief find the closest hit in $(0, ray.tMax)$, on hit `ray.tMax` is
+   * shrunk to the hit
+   *
+   */
+  virtual std::optional<RayHit> intersect(const Ray &ray) const = 0;
+
+  /**
+   * @brief check whether the ray hits anything in $(0, ray.tMax)$
+   *
+   */
+  [[nodiscard]] virtual bool occluded(const Ray &ray) const = 0;
+
+  /**
+   * @brief find the closest hits of the active lanes, `hits[i]` is the hit of
+   * lane `i`, the `tMax` of the lanes that hit are shrunk
+   *
+   * @return mask of the lanes that hit
+   */
+  virtual uint32_t intersect(const RayPacket4 &rays,
+                             std::span<RayHit, 4> hits) const {
+    return intersect_lanes(rays, hits);
+  }
+
+  /**
+   * @brief see `intersect(const RayPacket4 &, std::span<RayHit, 4>)`
+   *
+   */
+  virtual uint32_t intersect(const RayPacket8 &rays,
+                             std::span<RayHit, 8> hits) const {
+    return intersect_lanes(rays, hits);
+  }
+
+  /**
+   * @brief see `intersect(const RayPacket4 &, std::span<RayHit, 4>)`
+   *
+   */
+  virtual uint32_t intersect(const RayPacket16 &rays,
+                             std::span<RayHit, 16> hits) const {
+    return intersect_lanes(rays, hits);
+  }
+
+  /**
+   * @brief check which active lanes hit anything
+   *
+   * @return mask of the occluded lanes
+   */
+  [[nodiscard]] virtual uint32_t occluded(const RayPacket4 &rays) const {
+    return occluded_lanes(rays);
+  }
+
+  /**
+   * @brief see `occluded(const RayPacket4 &)`
+   *
+   */
+  [[nodiscard]] virtual uint32_t occluded(const RayPacket8 &rays) const {
+    return occluded_lanes(rays);
+  }
+
+  /**
+   * @brief see `occluded(const RayPacket4 &)`
+   *
+   */
+  [[nodiscard]] virtual uint32_t occluded(const RayPacket16 &rays) const {
+    return occluded_lanes(rays);
+  }
+
+ protected:
+  /**
+   * @brief trace the active lanes one by one
+   *
+   */
+  template <size_t N>
+  uint32_t intersect_lanes(const RayPacket<N> &rays,
+                           std::span<RayHit, N> hits) const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N; ++i) {
+      if (!rays.is_active(i)) continue;
+      if (auto hit = intersect(rays.get(i))) {
+        hits[i] = *hit;
+        rays.tMax[i] = hit->t;
+        mask |= 1u << i;
+      }
+    }
+    return mask;
+  }
+
+  /**
+   * @brief trace the active lanes one by one
+   *
+   */
+  template <size_t N>
+  [[nodiscard]] uint32_t occluded_lanes(const RayPacket<N> &rays) const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N; ++i)
+      if (rays.is_active(i) && occluded(rays.get(i))) mask |= 1u << i;
+    return mask;
+  }
+};
+}  // namespace dakku
+#endif
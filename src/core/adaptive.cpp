@@ -0,0 +1,76 @@
+#include <core/adaptive.h>
+
+namespace dakku {
+
+AdaptiveSettings AdaptiveSettings::from_lua(const sol::table &table) {
+  AdaptiveSettings ret;
+  ret.base_spp = table.get_or("base_spp", ret.base_spp);
+  ret.pass_spp = table.get_or("pass_spp", ret.pass_spp);
+  ret.max_spp = table.get_or("max_spp", ret.max_spp);
+  ret.threshold = table.get_or("threshold", ret.threshold);
+  ret.region_size = table.get_or("region_size", ret.region_size);
+  return ret;
+}
+
+AdaptiveScheduler::AdaptiveScheduler(const Film &film,
+                                     const TileScheduler &scheduler,
+                                     const AdaptiveSettings &settings)
+    : film(film), scheduler(scheduler), settings(settings) {
+  // every pass must make progress
+  this->settings.max_spp = std::max(this->settings.max_spp, 1u);
+  this->settings.base_spp =
+      std::clamp(this->settings.base_spp, 1u, this->settings.max_spp);
+  this->settings.pass_spp = std::max(this->settings.pass_spp, 1u);
+  const int size = std::max(this->settings.region_size, 1);
+  for (const Bounds2i &tile : scheduler) {
+    const Bounds2i b = tile & film.get_pixel_bounds();
+    for (int y = b.p_min.y(); y < b.p_max.y(); y += size)
+      for (int x = b.p_min.x(); x < b.p_max.x(); x += size)
+        regions.emplace_back(
+            Point2i{x, y}, Point2i{std::min(x + size, b.p_max.x()),
+                                   std::min(y + size, b.p_max.y())});
+  }
+  region_spp.resize(regions.size());
+}
+
+std::vector<size_t> AdaptiveScheduler::unconverged_regions() const {
+  std::vector<size_t> ret;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    if (region_spp[i] >= settings.max_spp) continue;
+    for (const Point2i &p : regions[i]) {
+      if (film.get_variance(p).relative_error() > settings.threshold) {
+        ret.push_back(i);
+        break;
+      }
+    }
+  }
+  return ret;
+}
+
+ConvergenceReport AdaptiveScheduler::report(uint32_t pass, size_t n_regions,
+                                            uint64_t samples) const {
+  ConvergenceReport ret{pass, n_regions, samples};
+  uint64_t spp_sum = 0;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    for (const Point2i &p : regions[i]) {
+      const float error = film.get_variance(p).relative_error();
+      ++ret.pixels;
+      ret.converged += error <= settings.threshold;
+      ret.max_error = std::max(ret.max_error, error);
+      spp_sum += region_spp[i];
+    }
+  }
+  ret.mean_spp = ret.pixels > 0 ? static_cast<float>(spp_sum) /
+                                      static_cast<float>(ret.pixels)
+                                : 0;
+  DAKKU_INFO(
+      "adaptive pass {}: {} regions, {} samples, {}/{} pixels converged "
+      "({:.1f}%), mean spp {:.1f}, max relative error {:.4f}",
+      pass, n_regions, samples, ret.converged, ret.pixels,
+      ret.pixels > 0 ? 100.0 * static_cast<double>(ret.converged) /
+                           static_cast<double>(ret.pixels)
+                     : 100.0,
+      ret.mean_spp, ret.max_error);
+  return ret;
+}
+}  // namespace dakku
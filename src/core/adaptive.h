@@ -0,0 +1,168 @@
+#ifndef DAKKU_CORE_ADAPTIVE_H_
+#define DAKKU_CORE_ADAPTIVE_H_
+#include <core/film.h>
+#include <core/tile.h>
+
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief adaptive sampling parameters, read from the lua scene (e.g.
+ * `scene.adaptive = { threshold = 0.02, base_spp = 16 }`, passed as
+ * `_create_simple_integrator(max_depth, tile_size, scene.adaptive)`)
+ *
+ */
+struct DAKKU_EXPORT_CORE AdaptiveSettings {
+  /// samples per pixel of the base pass
+  uint32_t base_spp{16};
+  /// samples per pixel a later pass adds to the unconverged regions
+  uint32_t pass_spp{16};
+  /// no pixel gets more samples than this
+  uint32_t max_spp{1024};
+  /// a pixel is converged once its relative error is at most this
+  float threshold{0.02f};
+  /// edge length of the regions that are revisited as a whole (1 revisits
+  /// single pixels)
+  int region_size{4};
+
+  /**
+   * @brief read the settings from a lua table, missing fields keep their
+   * defaults
+   *
+   */
+  static AdaptiveSettings from_lua(const sol::table &table);
+};
+
+/**
+ * @brief the state of the film after a pass
+ *
+ */
+struct ConvergenceReport {
+  /// pass index (0 is the base pass)
+  uint32_t pass{0};
+  /// the number of regions (tiles in the base pass) sampled by the pass
+  size_t regions{0};
+  /// the number of samples taken by the pass
+  uint64_t samples{0};
+  /// the number of film pixels
+  size_t pixels{0};
+  /// the number of pixels whose relative error is at most the threshold
+  size_t converged{0};
+  /// the largest relative error of a pixel
+  float max_error{0};
+  /// samples per pixel averaged over the film
+  float mean_spp{0};
+};
+
+/**
+ * @brief adaptive sampling over a `TileScheduler`: a base pass samples
+ * every tile, later passes revisit only the regions (`region_size` squares
+ * of the film, in tile order) with a pixel whose relative error (from the
+ * film's per pixel variance) is above the threshold, until every region is
+ * converged or reaches `max_spp`
+ *
+ */
+class DAKKU_EXPORT_CORE AdaptiveScheduler {
+ public:
+  /**
+   * @brief Construct a new Adaptive Scheduler object
+   *
+   * @param film the film the samples are added to
+   * @param scheduler tiles over the film's sample bounds
+   * @param settings adaptive sampling parameters
+   */
+  AdaptiveScheduler(const Film &film, const TileScheduler &scheduler,
+                    const AdaptiveSettings &settings);
+
+  /**
+   * @brief render all passes, `f(bounds, first_sample, n_samples)` takes
+   * samples `[first_sample, first_sample + n_samples)` of every pixel in
+   * `bounds` and merges them into the film, the calls of a pass run in
+   * parallel
+   *
+   * @return the report of every pass
+   */
+  template <typename F>
+  std::vector<ConvergenceReport> render(F &&f);
+
+  /**
+   * @brief get the regions whose pixels are not converged and that can
+   * take more samples (indices into `get_regions()`)
+   *
+   */
+  [[nodiscard]] std::vector<size_t> unconverged_regions() const;
+
+  /**
+   * @brief summarize the film after a pass and log it
+   *
+   */
+  ConvergenceReport report(uint32_t pass, size_t regions,
+                           uint64_t samples) const;
+
+  /**
+   * @brief get the regions a later pass can revisit
+   *
+   */
+  [[nodiscard]] const std::vector<Bounds2i> &get_regions() const {
+    return regions;
+  }
+
+  /**
+   * @brief get the samples per pixel taken in region `i`
+   *
+   */
+  [[nodiscard]] uint32_t get_region_spp(size_t i) const {
+    return region_spp[i];
+  }
+
+ private:
+  /// the film
+  const Film &film;
+  /// tiles of the base pass
+  const TileScheduler &scheduler;
+  /// settings
+  AdaptiveSettings settings;
+  /// film regions in tile order
+  std::vector<Bounds2i> regions;
+  /// samples per pixel taken in each region
+  std::vector<uint32_t> region_spp;
+};
+
+template <typename F>
+std::vector<ConvergenceReport> AdaptiveScheduler::render(F &&f) {
+  std::vector<ConvergenceReport> reports;
+  uint64_t samples = 0;
+  for (const Bounds2i &tile : scheduler)
+    samples += static_cast<uint64_t>(tile.area()) * settings.base_spp;
+  scheduler.parallel_for([&](const Bounds2i &tile) {
+    f(tile, uint32_t{0}, settings.base_spp);
+  });
+  std::fill(region_spp.begin(), region_spp.end(), settings.base_spp);
+  reports.push_back(report(0, scheduler.size(), samples));
+
+  for (uint32_t pass = 1;; ++pass) {
+    const std::vector<size_t> active = unconverged_regions();
+    if (active.empty()) break;
+    samples = 0;
+    for (size_t i : active)
+      samples += static_cast<uint64_t>(regions[i].area()) *
+                 std::min(settings.pass_spp, settings.max_spp - region_spp[i]);
+    oneapi::tbb::parallel_for(
+        oneapi::tbb::blocked_range<size_t>(0, active.size()),
+        [&](const oneapi::tbb::blocked_range<size_t> &r) {
+          for (size_t k = r.begin(); k != r.end(); ++k) {
+            const size_t i = active[k];
+            const uint32_t n =
+                std::min(settings.pass_spp, settings.max_spp - region_spp[i]);
+            TraceScope trace("Adaptive region", regions[i]);
+            f(regions[i], region_spp[i], n);
+            region_spp[i] += n;
+          }
+        });
+    reports.push_back(report(pass, active.size(), samples));
+  }
+  return reports;
+}
+}  // namespace dakku
+#endif
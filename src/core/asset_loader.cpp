@@ -0,0 +1,63 @@
+#include <core/asset_loader.h>
+#include <core/trace.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace dakku {
+
+AssetLoader &AssetLoader::instance() {
+  static AssetLoader _instance;
+  return _instance;
+}
+
+AssetLoader::~AssetLoader() { wait(); }
+
+void AssetLoader::schedule(std::function<void()> load) {
+  ++in_flight;
+  queue.push(std::move(load));
+  group.run([this] { run_one(); });
+}
+
+bool AssetLoader::run_one() {
+  std::function<void()> load;
+  if (!queue.try_pop(load)) return false;
+  // count the load as finished however it exits, otherwise `wait()` hangs
+  struct Finish {
+    std::atomic<size_t> &in_flight;
+    ~Finish() { --in_flight; }
+  } finish{in_flight};
+  TraceScope trace("Asset load");
+  load();
+  return true;
+}
+
+void AssetLoader::wait() {
+  while (run_one()) {
+  }
+  group.wait();
+}
+
+std::string read_file(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    DAKKU_ERR("cannot open {}", path);
+    return {};
+  }
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  return std::move(ss).str();
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(AssetLoader, [] {
+  DAKKU_INFO("register AssetLoader");
+  auto &lua = Lua::instance().get_state();
+  lua.new_usertype<FileAsset>("FileAsset", "ready", &FileAsset::ready, "get",
+                              &FileAsset::get);
+  lua.set_function("_load_file_async", [](const std::string &path) {
+    return AssetLoader::instance().submit([path] { return read_file(path); });
+  });
+  lua.set_function("_wait_assets", [] { AssetLoader::instance().wait(); });
+  return 0;
+});
+}  // namespace dakku
@@ -0,0 +1,150 @@
+#ifndef DAKKU_CORE_ASSET_LOADER_H_
+#define DAKKU_CORE_ASSET_LOADER_H_
+#include <core/logger.h>
+#include <core/lua.h>
+
+#include <oneapi/tbb.h>
+
+#include <functional>
+#include <future>
+
+namespace dakku {
+
+/**
+ * @brief loads assets (meshes, images, ...) as tbb tasks while the scene
+ * script keeps running, the script receives `AssetHandle`s and everything is
+ * joined by `wait()` before the scene is finalized
+ * load functions run on worker threads, so they must not touch the lua state
+ *
+ */
+class DAKKU_EXPORT_CORE AssetLoader {
+ public:
+  /**
+   * @brief get asset loader instance
+   *
+   */
+  static AssetLoader &instance();
+
+  /**
+   * @brief schedule `load` and return a handle to its result
+   *
+   * @tparam F `T()`
+   */
+  template <typename F>
+  auto submit(F &&load);
+
+  /**
+   * @brief run pending loads on the calling thread until `future` is ready,
+   * so waiting never depends on a free worker thread
+   *
+   */
+  template <typename T>
+  void wait(const std::shared_future<T> &future) {
+    while (future.wait_for(std::chrono::seconds(0)) !=
+           std::future_status::ready) {
+      if (!run_one()) future.wait();
+    }
+  }
+
+  /**
+   * @brief join all scheduled loads
+   *
+   */
+  void wait();
+
+  /**
+   * @brief the number of loads that have been scheduled but not finished
+   *
+   */
+  [[nodiscard]] size_t pending() const { return in_flight; }
+
+ private:
+  AssetLoader() = default;
+  ~AssetLoader();
+
+  /**
+   * @brief enqueue a load and spawn a task that runs one queued load
+   *
+   */
+  void schedule(std::function<void()> load);
+
+  /**
+   * @brief run one queued load on the calling thread
+   *
+   * @return whether a load was run
+   */
+  bool run_one();
+
+  /// queued loads, each one is run exactly once by a task or a waiter
+  oneapi::tbb::concurrent_queue<std::function<void()>> queue;
+  /// tasks that run the queued loads
+  oneapi::tbb::task_group group;
+  /// scheduled but unfinished loads
+  std::atomic<size_t> in_flight{0};
+};
+
+/**
+ * @brief handle to an asset that is being loaded
+ *
+ * @tparam T asset type
+ */
+template <typename T>
+class AssetHandle {
+ public:
+  AssetHandle() = default;
+  explicit AssetHandle(std::shared_future<T> future)
+      : future(std::move(future)) {}
+
+  /**
+   * @brief check whether the asset has been loaded
+   *
+   */
+  [[nodiscard]] bool ready() const {
+    return future.valid() && future.wait_for(std::chrono::seconds(0)) ==
+                                 std::future_status::ready;
+  }
+
+  /**
+   * @brief get the asset, blocks (helping with pending loads) until it is
+   * loaded, rethrows the exception of a failed load
+   *
+   */
+  const T &get() const {
+    DAKKU_CHECK(future.valid(), "empty asset handle");
+    AssetLoader::instance().wait(future);
+    return future.get();
+  }
+
+ private:
+  /// the result of the load
+  std::shared_future<T> future;
+};
+
+template <typename F>
+auto AssetLoader::submit(F &&load) {
+  using T = std::invoke_result_t<F>;
+  auto promise = std::make_shared<std::promise<T>>();
+  AssetHandle<T> handle{promise->get_future().share()};
+  schedule([promise, load = std::forward<F>(load)]() mutable {
+    // a failed load is rethrown by `AssetHandle::get`, it must not escape
+    // into the task group or leave the handle waiting forever
+    try {
+      promise->set_value(load());
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return handle;
+}
+
+/**
+ * @brief read a whole file (empty on failure)
+ *
+ */
+DAKKU_EXPORT_CORE std::string read_file(const std::string &path);
+
+/// handle to the bytes of a file
+using FileAsset = AssetHandle<std::string>;
+DAKKU_DECLARE_LUA_OBJECT(AssetLoader, DAKKU_EXPORT_CORE);
+}  // namespace dakku
+#endif
@@ -0,0 +1,46 @@
+#ifndef DAKKU_CORE_ATOMIC_FLOAT_H_
+#define DAKKU_CORE_ATOMIC_FLOAT_H_
+#include <core/fwd.h>
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace dakku {
+
+/**
+ * @brief float with an atomic (compare and swap) `add`, all accesses are
+ * relaxed, callers synchronize through task completion
+ *
+ */
+class AtomicFloat {
+ public:
+  explicit AtomicFloat(float v = 0) : bits(std::bit_cast<uint32_t>(v)) {}
+
+  operator float() const {
+    return std::bit_cast<float>(bits.load(std::memory_order_relaxed));
+  }
+
+  AtomicFloat &operator=(float v) {
+    bits.store(std::bit_cast<uint32_t>(v), std::memory_order_relaxed);
+    return *this;
+  }
+
+  /**
+   * @brief atomically add `v`
+   *
+   */
+  void add(float v) {
+    uint32_t old = bits.load(std::memory_order_relaxed);
+    while (!bits.compare_exchange_weak(
+        old, std::bit_cast<uint32_t>(std::bit_cast<float>(old) + v),
+        std::memory_order_relaxed)) {
+    }
+  }
+
+ private:
+  /// float bits
+  std::atomic<uint32_t> bits;
+};
+}  // namespace dakku
+#endif
@@ -1,6 +1,7 @@
 #ifndef DAKKU_CORE_BOUNDS_H_
 #define DAKKU_CORE_BOUNDS_H_
-#include <core/vector.h>
+#include <core/math_func.h>
+#include <core/ray_packet.h>
 
 #include <iterator>
 #include <utility>
@@ -252,6 +253,20 @@ class BoundsBase {
     return std::sqrt(distance_squared(p, b));
   }
 
+  /**
+   * @brief get `p_min` ($i = 0$) or `p_max` ($i = 1$)
+   *
+   */
+  const Point<T, S> &operator[](size_t i) const {
+    return i == 0 ? p_min : p_max;
+  }
+
+  /**
+   * @brief get `p_min` ($i = 0$) or `p_max` ($i = 1$)
+   *
+   */
+  Point<T, S> &operator[](size_t i) { return i == 0 ? p_min : p_max; }
+
   [[nodiscard]] std::string to_string() const {
     return "[" + p_min.to_string() + ", " + p_max.to_string() + "]";
   }
@@ -303,11 +318,164 @@ class Bounds3 : public BoundsBase<T, 3> {
   using BoundsBase<T, 3>::BoundsBase;
 
   Bounds3(const BoundsBase<T, 3> &base) : BoundsBase<T, 3>(base) {}
+
+  /**
+   * @brief get the surface area of the bounds
+   *
+   */
+  [[nodiscard]] T surface_area() const {
+    Vector<T, 3> d = this->diagonal();
+    return 2 * (d.x() * d.y() + d.x() * d.z() + d.y() * d.z());
+  }
+
+  /**
+   * @brief get the center of the bounds
+   *
+   */
+  [[nodiscard]] Point<T, 3> centroid() const {
+    return (this->p_min + this->p_max) * static_cast<T>(0.5);
+  }
+
+  /**
+   * @brief check whether the ray overlaps the bounds in $[0, ray.tMax]$, the
+   * far distances are enlarged by $2 \gamma_3$ so that rounding never misses a
+   * hit, nan slabs ($0 \cdot \infty$, the ray lies in a slab plane) are
+   * ignored
+   *
+   * @param [out] hit_t0 the entry distance (optional)
+   * @param [out] hit_t1 the exit distance (optional)
+   */
+  bool intersect_p(const Ray &ray, float *hit_t0 = nullptr,
+                   float *hit_t1 = nullptr) const {
+    float t0 = 0, t1 = ray.tMax;
+    for (size_t i = 0; i < 3; ++i) {
+      float inv_dir = 1 / ray.d[i];
+      // pick the planes by the direction (not by swapping the distances), so
+      // that empty bounds are never hit
+      const bool dir_is_neg = inv_dir < 0;
+      float t_near = ((*this)[dir_is_neg][i] - ray.o[i]) * inv_dir;
+      float t_far = ((*this)[!dir_is_neg][i] - ray.o[i]) * inv_dir;
+      t_far *= 1 + 2 * gamma(3);
+      // written so that nan distances keep the current interval
+      t0 = t_near > t0 ? t_near : t0;
+      t1 = t_far < t1 ? t_far : t1;
+      if (t0 > t1) return false;
+    }
+    if (hit_t0) *hit_t0 = t0;
+    if (hit_t1) *hit_t1 = t1;
+    return true;
+  }
+
+  /**
+   * @brief same test as `intersect_p(const Ray &, float *, float *)` with the
+   * precomputed reciprocal direction, used in bvh traversal
+   *
+   * @param inv_dir $1 / ray.d$
+   * @param dir_is_neg whether each component of `inv_dir` is negative
+   */
+  bool intersect_p(const Ray &ray, const Vector3f &inv_dir,
+                   const int dir_is_neg[3]) const {
+    float t0 = 0, t1 = ray.tMax;
+    for (size_t i = 0; i < 3; ++i) {
+      const float t_near = ((*this)[dir_is_neg[i]][i] - ray.o[i]) * inv_dir[i];
+      float t_far = ((*this)[1 - dir_is_neg[i]][i] - ray.o[i]) * inv_dir[i];
+      t_far *= 1 + 2 * gamma(3);
+      // no early exit, nan distances keep the current interval
+      t0 = t_near > t0 ? t_near : t0;
+      t1 = t_far < t1 ? t_far : t1;
+    }
+    return t0 <= t1;
+  }
 };
 
 /// 3d float bounds
 using Bounds3f = Bounds3<float>;
 
+/**
+ * @brief `N` 3d float bounds stored as structure of arrays, tested against a
+ * single ray at once (the inner loop of wide bvh traversal)
+ * unused lanes hold empty bounds ($[\infty, -\infty]$) that no ray hits
+ *
+ * @tparam N lane count (4 or 8)
+ */
+template <size_t N>
+requires(N == 4 || N == 8) struct Bounds3fPacket {
+  /**
+   * @brief set lane `i`
+   *
+   */
+  void set(size_t i, const Bounds3f &b) {
+    p_min.set(i, b.p_min);
+    p_max.set(i, b.p_max);
+  }
+
+  /**
+   * @brief get lane `i`
+   *
+   */
+  [[nodiscard]] Bounds3f get(size_t i) const {
+    Bounds3f ret;
+    ret.p_min = p_min.template get<Point3f>(i);
+    ret.p_max = p_max.template get<Point3f>(i);
+    return ret;
+  }
+
+  /**
+   * @brief test the ray against all lanes without branches, same semantics
+   * as `Bounds3f::intersect_p(const Ray &, float *, float *)`
+   *
+   * @param inv_dir $1 / ray.d$
+   * @param dir_is_neg whether each component of `inv_dir` is negative
+   * @param [out] t_near entry distances (optional, valid for the lanes hit)
+   * @return mask of the lanes hit (bit i for lane i)
+   */
+  uint32_t intersect_p(const Ray &ray, const Vector3f &inv_dir,
+                       const int dir_is_neg[3],
+                       std::array<float, N> *t_near = nullptr) const {
+    using Lanes = SimdFloatFor<N>;
+    constexpr size_t W = std::min(N, SIMD_WIDTH);
+    const Lanes far_scale = Lanes::set1(1 + 2 * gamma(3));
+    alignas(Float3Packet<N>::ALIGN) std::array<float, N> entry;
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N; i += W) {
+      Lanes t0 = Lanes::set1(0);
+      Lanes t1 = Lanes::set1(ray.tMax);
+      for (size_t a = 0; a < 3; ++a) {
+        const Float3Packet<N> &near = dir_is_neg[a] ? p_max : p_min;
+        const Float3Packet<N> &far = dir_is_neg[a] ? p_min : p_max;
+        const std::array<float, N> &near_a =
+            a == 0 ? near.x : (a == 1 ? near.y : near.z);
+        const std::array<float, N> &far_a =
+            a == 0 ? far.x : (a == 1 ? far.y : far.z);
+        const Lanes o = Lanes::set1(ray.o[a]);
+        const Lanes inv = Lanes::set1(inv_dir[a]);
+        // `max`/`min` return their second operand if either is nan, so nan
+        // slabs keep the current interval
+        t0 = max((Lanes::load(&near_a[i]) - o) * inv, t0);
+        t1 = min((Lanes::load(&far_a[i]) - o) * inv * far_scale, t1);
+      }
+      mask |= le_mask(t0, t1) << i;
+      t0.store(&entry[i]);
+    }
+    if (t_near) *t_near = entry;
+    return mask;
+  }
+
+  /// minimum corners
+  Float3Packet<N> p_min = filled(INF);
+  /// maximum corners
+  Float3Packet<N> p_max = filled(-INF);
+
+ private:
+  static Float3Packet<N> filled(float v) {
+    Float3Packet<N> ret;
+    ret.x.fill(v);
+    ret.y.fill(v);
+    ret.z.fill(v);
+    return ret;
+  }
+};
+
 /**
  * @brief 2d integer bounds iterator, iterate all pixels inside
  *
@@ -0,0 +1,51 @@
+#include <core/camera.h>
+#include <core/memory.h>
+
+namespace dakku {
+
+Camera::Camera(const Point3f &eye, const Point3f &target, const Vector3f &up,
+               float fov, const Point2i &resolution)
+    : eye(eye) {
+  Vector3f forward{target - eye};
+  forward /= forward.length();
+  Vector3f right{forward.cross(up)};
+  right /= right.length();
+  const Vector3f down{forward.cross(right)};
+  // a pixel is `scale` wide on the image plane
+  const float scale = 2 * std::tan(fov * PI / 360) /
+                      static_cast<float>(std::max(resolution.y(), 1));
+  dx = right * scale;
+  dy = down * scale;
+  corner = Vector3f{forward - dx * (0.5f * static_cast<float>(resolution.x())) -
+                    dy * (0.5f * static_cast<float>(resolution.y()))};
+}
+
+RayDifferential Camera::generate_ray_differential(
+    const Point2f &p_film) const {
+  const Vector3f d{corner + dx * p_film.x() + dy * p_film.y()};
+  RayDifferential ray{eye, d / d.length()};
+  const Vector3f d_x{d + dx}, d_y{d + dy};
+  ray.rx_origin = ray.ry_origin = eye;
+  ray.rx_direction = d_x / d_x.length();
+  ray.ry_direction = d_y / d_y.length();
+  ray.has_differentials = true;
+  return ray;
+}
+
+Camera *create_camera(const Point3f &eye, const Point3f &target,
+                      const Vector3f &up, float fov,
+                      const Point2i &resolution) {
+  return GlobalMemoryArena::instance().allocObject<Camera>(eye, target, up,
+                                                           fov, resolution);
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(Camera, [] {
+  DAKKU_INFO("register Camera");
+  auto &state = Lua::instance().get_state();
+  state.new_usertype<Camera>("Camera", sol::no_constructor,
+                             "generate_ray_differential",
+                             &Camera::generate_ray_differential);
+  state.set_function("_create_camera", &create_camera);
+  return 0;
+});
+}  // namespace dakku
@@ -0,0 +1,56 @@
+#ifndef DAKKU_CORE_CAMERA_H_
+#define DAKKU_CORE_CAMERA_H_
+#include <core/ray.h>
+
+namespace dakku {
+
+/**
+ * @brief pinhole camera, film position $(x, y)$ (in pixels, y pointing down)
+ * maps to a point on the image plane one unit in front of the eye
+ *
+ */
+class DAKKU_EXPORT_CORE Camera {
+ public:
+  /**
+   * @brief Construct a new Camera object
+   *
+   * @param eye camera position
+   * @param target the point the film centre looks at
+   * @param up up direction (need not be orthogonal to the view direction)
+   * @param fov vertical field of view in degrees
+   * @param resolution film resolution
+   */
+  Camera(const Point3f &eye, const Point3f &target, const Vector3f &up,
+         float fov, const Point2i &resolution);
+
+  /**
+   * @brief generate the ray through film position `p_film` with the
+   * differentials of the rays one pixel over in x and y (unit directions)
+   *
+   */
+  [[nodiscard]] RayDifferential generate_ray_differential(
+      const Point2f &p_film) const;
+
+ private:
+  /// camera position
+  Point3f eye;
+  /// direction to film position $(0, 0)$
+  Vector3f corner;
+  /// image plane step of one pixel in x
+  Vector3f dx;
+  /// image plane step of one pixel in y
+  Vector3f dy;
+};
+
+/**
+ * @brief Create a camera object
+ *
+ */
+DAKKU_EXPORT_CORE Camera *create_camera(const Point3f &eye,
+                                        const Point3f &target,
+                                        const Vector3f &up, float fov,
+                                        const Point2i &resolution);
+
+DAKKU_DECLARE_LUA_OBJECT(Camera, DAKKU_EXPORT_CORE);
+}  // namespace dakku
+#endif
@@ -28,6 +28,10 @@ static constexpr float PI_OVER_4 =
 /// shadow epsilon, used for shadow ray, offset ray origin
 static constexpr float SHADOW_EPS = 1e-5f;
 
+/// machine epsilon (half ulp of 1), used for bounding rounding errors
+static constexpr float MACHINE_EPSILON =
+    std::numeric_limits<float>::epsilon() * 0.5f;
+
 /// 1 - eps
 static constexpr float ONE_MINUS_EPSILON =
     1 - std::numeric_limits<float>::epsilon();
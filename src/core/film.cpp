@@ -0,0 +1,182 @@
+#include <core/film.h>
+#include <core/memory.h>
+#include <core/profiler.h>
+
+namespace dakku {
+
+namespace {
+/// rec. 709 luminance
+float luminance(const Vector3f &rgb) {
+  return 0.212671f * rgb.x() + 0.715160f * rgb.y() + 0.072169f * rgb.z();
+}
+}  // namespace
+
+FilmTile::FilmTile(const Bounds2i &pixel_bounds, const Filter &filter)
+    : pixel_bounds(pixel_bounds),
+      filter(filter),
+      pixels(static_cast<size_t>(std::max(0, pixel_bounds.area()))) {}
+
+void FilmTile::add_sample(const Point2f &p_film, const Vector3f &rgb,
+                          float sample_weight) {
+  ProfilePhase _(Prof::FILM_ADD_SAMPLE);
+  if (!std::isfinite(rgb.x()) || !std::isfinite(rgb.y()) ||
+      !std::isfinite(rgb.z())) {
+    DAKKU_WARN_EVERY_N(4096, "film: drop non-finite radiance at ({}, {})",
+                       p_film.x(), p_film.y());
+    return;
+  }
+  // the pixel containing the sample belongs to this tile if it's on the film
+  const Point2i p_sample{static_cast<int>(std::floor(p_film.x())),
+                         static_cast<int>(std::floor(p_film.y()))};
+  if (inside_exclusive(p_sample, pixel_bounds))
+    get_pixel(p_sample).variance.add(luminance(rgb));
+  // the pixels whose filter extent contains the sample (discrete coordinates)
+  const float dx = p_film.x() - 0.5f, dy = p_film.y() - 0.5f;
+  const int x0 = std::max(static_cast<int>(std::ceil(dx - filter.radius.x())),
+                          pixel_bounds.p_min.x());
+  const int y0 = std::max(static_cast<int>(std::ceil(dy - filter.radius.y())),
+                          pixel_bounds.p_min.y());
+  const int x1 =
+      std::min(static_cast<int>(std::floor(dx + filter.radius.x())) + 1,
+               pixel_bounds.p_max.x());
+  const int y1 =
+      std::min(static_cast<int>(std::floor(dy + filter.radius.y())) + 1,
+               pixel_bounds.p_max.y());
+  if (x0 >= x1 || y0 >= y1) return;
+  // evaluate the whole footprint through the filter table at once
+  offsets.clear();
+  for (int y = y0; y < y1; ++y)
+    for (int x = x0; x < x1; ++x)
+      offsets.emplace_back(static_cast<float>(x) - dx,
+                           static_cast<float>(y) - dy);
+  weights.resize(offsets.size());
+  filter.evaluate_batch(offsets, weights);
+  size_t k = 0;
+  for (int y = y0; y < y1; ++y) {
+    for (int x = x0; x < x1; ++x, ++k) {
+      const float w = weights[k] * sample_weight;
+      FilmTilePixel &pixel = get_pixel(Point2i{x, y});
+      for (int c = 0; c < 3; ++c) pixel.contrib_sum[c] += rgb[c] * w;
+      pixel.filter_weight_sum += w;
+    }
+  }
+}
+
+FilmTilePixel &FilmTile::get_pixel(const Point2i &p) {
+  DAKKU_CHECK(inside_exclusive(p, pixel_bounds), "pixel out of tile: ({}, {})",
+              p.x(), p.y());
+  const int width = pixel_bounds.p_max.x() - pixel_bounds.p_min.x();
+  return pixels[(p.y() - pixel_bounds.p_min.y()) * width +
+                (p.x() - pixel_bounds.p_min.x())];
+}
+
+const FilmTilePixel &FilmTile::get_pixel(const Point2i &p) const {
+  return const_cast<FilmTile *>(this)->get_pixel(p);
+}
+
+Film::Film(const Point2i &resolution, const Filter &filter)
+    : resolution(resolution),
+      pixel_bounds(Point2i{0, 0}, resolution),
+      filter(filter),
+      pixels(static_cast<size_t>(resolution.x()) * resolution.y()),
+      variances(pixels.size()) {}
+
+Bounds2i Film::get_sample_bounds() const {
+  return Bounds2i{
+      Point2i{static_cast<int>(std::floor(0.5f - filter.radius.x())),
+              static_cast<int>(std::floor(0.5f - filter.radius.y()))},
+      Point2i{static_cast<int>(
+                  std::ceil(resolution.x() - 0.5f + filter.radius.x())),
+              static_cast<int>(
+                  std::ceil(resolution.y() - 0.5f + filter.radius.y()))}};
+}
+
+FilmTile Film::get_film_tile(const Bounds2i &sample_bounds) const {
+  // the pixels reached by samples in `sample_bounds`
+  const Point2i p0{
+      static_cast<int>(std::ceil(static_cast<float>(sample_bounds.p_min.x()) -
+                                 0.5f - filter.radius.x())),
+      static_cast<int>(std::ceil(static_cast<float>(sample_bounds.p_min.y()) -
+                                 0.5f - filter.radius.y()))};
+  const Point2i p1{
+      static_cast<int>(std::floor(static_cast<float>(sample_bounds.p_max.x()) -
+                                  0.5f + filter.radius.x())) +
+          1,
+      static_cast<int>(std::floor(static_cast<float>(sample_bounds.p_max.y()) -
+                                  0.5f + filter.radius.y())) +
+          1};
+  Bounds2i bounds = Bounds2i{p0, p1} & pixel_bounds;
+  if (bounds.p_min.x() >= bounds.p_max.x() ||
+      bounds.p_min.y() >= bounds.p_max.y())
+    bounds = Bounds2i{pixel_bounds.p_min, pixel_bounds.p_min};
+  return FilmTile{bounds, filter};
+}
+
+void Film::merge_film_tile(const FilmTile &tile) {
+  ProfilePhase _(Prof::FILM_MERGE);
+  // neighbouring tiles overlap by the filter radius, the atomic adds only
+  // contend on those borders
+  const Bounds2i &bounds = tile.get_pixel_bounds();
+  for (int y = bounds.p_min.y(); y < bounds.p_max.y(); ++y) {
+    for (int x = bounds.p_min.x(); x < bounds.p_max.x(); ++x) {
+      const Point2i p{x, y};
+      const FilmTilePixel &src = tile.get_pixel(p);
+      Pixel &dst = get_pixel(p);
+      for (int c = 0; c < 3; ++c) dst.contrib_sum[c].add(src.contrib_sum[c]);
+      dst.filter_weight_sum.add(src.filter_weight_sum);
+      // only the owning tile has samples in the pixel
+      if (src.variance.n > 0)
+        variances[y * resolution.x() + x].merge(src.variance);
+    }
+  }
+}
+
+void Film::add_splat(const Point2f &p_film, const Vector3f &rgb) {
+  const Point2i p{static_cast<int>(std::floor(p_film.x())),
+                  static_cast<int>(std::floor(p_film.y()))};
+  // also rejects nan positions
+  if (!inside_exclusive(p, pixel_bounds)) return;
+  Pixel &pixel = get_pixel(p);
+  for (int c = 0; c < 3; ++c) pixel.splat[c].add(rgb[c]);
+}
+
+void Film::get_pixels(const Bounds2i &bounds, std::span<float> rgb,
+                      float splat_scale) const {
+  [[maybe_unused]] const Vector2i size = bounds.diagonal();
+  DAKKU_CHECK(rgb.size() == static_cast<size_t>(size.x()) * size.y() * 3,
+              "size mismatch: {} != {}", rgb.size(), size.x() * size.y() * 3);
+  float *out = rgb.data();
+  for (int y = bounds.p_min.y(); y < bounds.p_max.y(); ++y) {
+    for (int x = bounds.p_min.x(); x < bounds.p_max.x(); ++x, out += 3) {
+      const Pixel &pixel = get_pixel(Point2i{x, y});
+      const float weight = pixel.filter_weight_sum;
+      const float inv_weight = weight != 0 ? 1 / weight : 0;
+      for (int c = 0; c < 3; ++c)
+        out[c] = std::max(0.0f, pixel.contrib_sum[c] * inv_weight) +
+                 splat_scale * pixel.splat[c];
+    }
+  }
+}
+
+void Film::clear() {
+  for (Pixel &pixel : pixels) {
+    for (int c = 0; c < 3; ++c) {
+      pixel.contrib_sum[c] = 0;
+      pixel.splat[c] = 0;
+    }
+    pixel.filter_weight_sum = 0;
+  }
+  std::fill(variances.begin(), variances.end(), VarianceEstimator{});
+}
+
+Film *create_film(const Point2i &resolution, const Filter &filter) {
+  return GlobalMemoryArena::instance().allocObject<Film>(resolution, filter);
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(Film, [] {
+  DAKKU_INFO("register Film");
+  auto &state = Lua::instance().get_state();
+  state.set_function("_create_film", &create_film);
+  return 0;
+});
+}  // namespace dakku
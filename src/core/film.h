@@ -0,0 +1,267 @@
+#ifndef DAKKU_CORE_FILM_H_
+#define DAKKU_CORE_FILM_H_
+#include <core/atomic_float.h>
+#include <core/bounds.h>
+#include <core/filter.h>
+
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief online (welford) mean and variance of a pixel's sample luminance,
+ * estimators of disjoint sample sets merge exactly (chan et al.)
+ *
+ */
+struct VarianceEstimator {
+  /**
+   * @brief add a sample value
+   *
+   */
+  void add(float x) {
+    ++n;
+    const float delta = x - mean;
+    mean += delta / static_cast<float>(n);
+    m2 += delta * (x - mean);
+  }
+
+  /**
+   * @brief merge the samples of another estimator
+   *
+   */
+  void merge(const VarianceEstimator &rhs) {
+    if (rhs.n == 0) return;
+    const uint32_t total = n + rhs.n;
+    const float delta = rhs.mean - mean;
+    const float w = static_cast<float>(rhs.n) / static_cast<float>(total);
+    mean += delta * w;
+    m2 += rhs.m2 + delta * delta * static_cast<float>(n) * w;
+    n = total;
+  }
+
+  /**
+   * @brief the unbiased sample variance ($0$ with less than two samples)
+   *
+   */
+  [[nodiscard]] float variance() const {
+    return n > 1 ? m2 / static_cast<float>(n - 1) : 0;
+  }
+
+  /**
+   * @brief the standard error of the mean relative to the mean, infinite
+   * with less than two samples, `min_mean` keeps dark pixels from never
+   * converging
+   *
+   */
+  [[nodiscard]] float relative_error(float min_mean = 1e-3f) const {
+    if (n < 2) return INF;
+    return std::sqrt(variance() / static_cast<float>(n)) /
+           std::max(std::abs(mean), min_mean);
+  }
+
+  /// the number of samples
+  uint32_t n{0};
+  /// the mean
+  float mean{0};
+  /// the sum of squared differences from the mean
+  float m2{0};
+};
+
+/**
+ * @brief a pixel of a film tile
+ *
+ */
+struct FilmTilePixel {
+  /// filter weighted sum of the rgb contributions
+  std::array<float, 3> contrib_sum{};
+  /// sum of the filter weights
+  float filter_weight_sum{0};
+  /// luminance statistics of the samples inside the pixel
+  VarianceEstimator variance;
+};
+
+/**
+ * @brief private accumulation buffer of a tile, covers the pixels that the
+ * samples of the tile reach through the filter (the tile grown by the filter
+ * radius), owned by one thread, so adding samples needs no synchronization
+ *
+ */
+class DAKKU_EXPORT_CORE FilmTile {
+ public:
+  /**
+   * @brief Construct a new Film Tile object
+   *
+   * @param pixel_bounds the pixels covered by the tile
+   * @param filter the film's filter
+   */
+  FilmTile(const Bounds2i &pixel_bounds, const Filter &filter);
+
+  /**
+   * @brief add a filtered sample
+   *
+   * @param p_film sample position on the film (continuous coordinates)
+   * @param rgb sample radiance
+   * @param sample_weight sample weight
+   */
+  void add_sample(const Point2f &p_film, const Vector3f &rgb,
+                  float sample_weight = 1);
+
+  /**
+   * @brief get the pixel at `p` (film coordinates)
+   *
+   */
+  FilmTilePixel &get_pixel(const Point2i &p);
+
+  /**
+   * @brief get the pixel at `p` (film coordinates)
+   *
+   */
+  [[nodiscard]] const FilmTilePixel &get_pixel(const Point2i &p) const;
+
+  /**
+   * @brief get the pixels covered by the tile
+   *
+   */
+  [[nodiscard]] const Bounds2i &get_pixel_bounds() const {
+    return pixel_bounds;
+  }
+
+ private:
+  /// pixels covered by the tile
+  Bounds2i pixel_bounds;
+  /// the film's filter
+  const Filter &filter;
+  /// pixels (row major)
+  std::vector<FilmTilePixel> pixels;
+  /// scratch filter offsets of a sample footprint
+  std::vector<Point2f> offsets;
+  /// scratch filter weights of a sample footprint
+  std::vector<float> weights;
+};
+
+/**
+ * @brief film, samples are accumulated in private `FilmTile`s that are
+ * merged (lock free) when their tile completes, splats from light paths go
+ * to a separate atomic buffer
+ * the luminance variance of the samples inside each pixel is tracked for
+ * adaptive sampling, a pixel's samples all come from the one tile whose
+ * sample bounds contain it, so its estimator is merged without atomics
+ *
+ */
+class DAKKU_EXPORT_CORE Film {
+ public:
+  /**
+   * @brief Construct a new Film object
+   *
+   * @param resolution film resolution
+   * @param filter reconstruction filter
+   */
+  Film(const Point2i &resolution, const Filter &filter);
+
+  /**
+   * @brief get the bounds of the sample positions that contribute to the
+   * pixels (the pixel bounds grown by the filter radius)
+   *
+   */
+  [[nodiscard]] Bounds2i get_sample_bounds() const;
+
+  /**
+   * @brief get the film tile for the samples in `sample_bounds`
+   *
+   */
+  [[nodiscard]] FilmTile get_film_tile(const Bounds2i &sample_bounds) const;
+
+  /**
+   * @brief merge a completed tile into the image (thread safe)
+   *
+   */
+  void merge_film_tile(const FilmTile &tile);
+
+  /**
+   * @brief add a splat to the pixel containing `p_film` (thread safe)
+   *
+   */
+  void add_splat(const Point2f &p_film, const Vector3f &rgb);
+
+  /**
+   * @brief resolve the pixels of `bounds`: the filtered samples plus the
+   * splats scaled by `splat_scale`, row major rgb (the `ImageWriter` tile
+   * layout)
+   *
+   */
+  void get_pixels(const Bounds2i &bounds, std::span<float> rgb,
+                  float splat_scale = 1) const;
+
+  /**
+   * @brief get the sample statistics of the pixel at `p`
+   *
+   */
+  [[nodiscard]] const VarianceEstimator &get_variance(const Point2i &p) const {
+    return variances[p.y() * resolution.x() + p.x()];
+  }
+
+  /**
+   * @brief clear all pixels and splats (unsynchronized)
+   *
+   */
+  void clear();
+
+  /**
+   * @brief film resolution
+   *
+   */
+  [[nodiscard]] const Point2i &get_resolution() const { return resolution; }
+
+  /**
+   * @brief film bounds
+   *
+   */
+  [[nodiscard]] const Bounds2i &get_pixel_bounds() const {
+    return pixel_bounds;
+  }
+
+ private:
+  /**
+   * @brief a pixel of the image, one cache line holds two pixels
+   *
+   */
+  struct alignas(32) Pixel {
+    /// filter weighted sum of the rgb contributions
+    std::array<AtomicFloat, 3> contrib_sum;
+    /// sum of the filter weights
+    AtomicFloat filter_weight_sum;
+    /// unweighted sum of the splats
+    std::array<AtomicFloat, 3> splat;
+  };
+
+  /// get the pixel at `p`
+  Pixel &get_pixel(const Point2i &p) {
+    return pixels[p.y() * resolution.x() + p.x()];
+  }
+
+  /// get the pixel at `p`
+  [[nodiscard]] const Pixel &get_pixel(const Point2i &p) const {
+    return pixels[p.y() * resolution.x() + p.x()];
+  }
+
+  /// film resolution
+  Point2i resolution;
+  /// film bounds
+  Bounds2i pixel_bounds;
+  /// reconstruction filter
+  const Filter &filter;
+  /// pixels (row major)
+  std::vector<Pixel> pixels;
+  /// sample statistics of the pixels (row major)
+  std::vector<VarianceEstimator> variances;
+};
+
+/**
+ * @brief create a film
+ *
+ */
+DAKKU_EXPORT_CORE Film *create_film(const Point2i &resolution,
+                                    const Filter &filter);
+DAKKU_DECLARE_LUA_OBJECT(Film, DAKKU_EXPORT_CORE);
+}  // namespace dakku
+#endif
@@ -2,6 +2,83 @@
 
 namespace dakku {
 
+FilterTable::FilterTable(const Filter &filter)
+    : radius(filter.radius), inv_radius(filter.inv_radius) {
+  for (int y = 0, offset = 0; y < WIDTH; ++y) {
+    for (int x = 0; x < WIDTH; ++x, ++offset) {
+      Point2f p((static_cast<float>(x) + 0.5f) * radius.x() / WIDTH,
+                (static_cast<float>(y) + 0.5f) * radius.y() / WIDTH);
+      values[offset] = filter.evaluate(p);
+    }
+  }
+}
+
+float FilterTable::evaluate(const Point2f &p) const {
+  float ax = std::abs(p.x());
+  float ay = std::abs(p.y());
+  // also rejects nans
+  if (!(ax <= radius.x() && ay <= radius.y())) return 0;
+  int ix = std::min(static_cast<int>(ax * inv_radius.x() * WIDTH), WIDTH - 1);
+  int iy = std::min(static_cast<int>(ay * inv_radius.y() * WIDTH), WIDTH - 1);
+  return values[iy * WIDTH + ix];
+}
+
+void FilterTable::evaluate(std::span<const Point2f> p,
+                           std::span<float> out) const {
+  DAKKU_CHECK(p.size() == out.size(), "size mismatch: {} != {}", p.size(),
+              out.size());
+  size_t i = 0;
+#ifdef DAKKU_ENABLE_AVX2
+  static_assert(sizeof(Point2f) == 2 * sizeof(float), "Point2f is not packed");
+  const auto *src = reinterpret_cast<const float *>(p.data());
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 rx = _mm256_set1_ps(radius.x());
+  const __m256 ry = _mm256_set1_ps(radius.y());
+  const __m256 irx = _mm256_set1_ps(inv_radius.x());
+  const __m256 iry = _mm256_set1_ps(inv_radius.y());
+  const __m256 width = _mm256_set1_ps(static_cast<float>(WIDTH));
+  const __m256i last = _mm256_set1_epi32(WIDTH - 1);
+  for (; i + 8 <= p.size(); i += 8) {
+    // deinterleave 8 (x, y) pairs
+    __m256 a = _mm256_loadu_ps(src + 2 * i);      // x0 y0 x1 y1 | x2 y2 x3 y3
+    __m256 b = _mm256_loadu_ps(src + 2 * i + 8);  // x4 y4 x5 y5 | x6 y6 x7 y7
+    __m256 xs = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m256 ys = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    // lanes are now ordered 0 1 4 5 | 2 3 6 7, restore the order
+    const __m256i order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+    xs = _mm256_permutevar8x32_ps(xs, order);
+    ys = _mm256_permutevar8x32_ps(ys, order);
+    __m256 ax = _mm256_andnot_ps(sign, xs);
+    __m256 ay = _mm256_andnot_ps(sign, ys);
+    __m256 inside = _mm256_and_ps(_mm256_cmp_ps(ax, rx, _CMP_LE_OQ),
+                                  _mm256_cmp_ps(ay, ry, _CMP_LE_OQ));
+    __m256i ix = _mm256_min_epi32(
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_mul_ps(ax, irx), width)),
+        last);
+    __m256i iy = _mm256_min_epi32(
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_mul_ps(ay, iry), width)),
+        last);
+    __m256i index = _mm256_add_epi32(_mm256_slli_epi32(iy, 4), ix);
+    static_assert(WIDTH == 16, "index computation assumes WIDTH == 16");
+    // masked gather: lanes outside the extent (or nan) are never loaded
+    __m256 v = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), values.data(),
+                                        index, inside, sizeof(float));
+    _mm256_storeu_ps(out.data() + i, v);
+  }
+#endif
+  for (; i < p.size(); ++i) out[i] = evaluate(p[i]);
+}
+
 Filter::Filter(const Vector2f &radius)
     : radius(radius), inv_radius(1.0f / radius) {}
-}  // namespace dakku
\ No newline at end of file
+
+const FilterTable &Filter::table() const {
+  std::call_once(table_flag, [this] { _table.emplace(*this); });
+  return *_table;
+}
+
+void Filter::evaluate_batch(std::span<const Point2f> p,
+                            std::span<float> out) const {
+  table().evaluate(p, out);
+}
+}  // namespace dakku
@@ -2,8 +2,58 @@
 #define DAKKU_CORE_FILTER_H_
 #include <core/vector.h>
 
+#include <mutex>
+#include <optional>
+
 namespace dakku {
 
+class Filter;
+
+/**
+ * @brief precomputed filter values over the positive quadrant
+ * (filters are symmetric), entry $(x, y)$ holds the value at the center of the
+ * cell, the lookup is a nearest-cell fetch indexed through `inv_radius`
+ *
+ */
+class DAKKU_EXPORT_CORE FilterTable {
+ public:
+  /// table resolution in each dimension
+  static constexpr int WIDTH = 16;
+
+  /**
+   * @brief Construct a new Filter Table object by evaluating `filter`
+   *
+   * @param filter the given filter
+   */
+  explicit FilterTable(const Filter &filter);
+
+  /**
+   * @brief look up the filter value at `p` (relative to the center),
+   * return $0$ outside the filter's extent
+   *
+   * @param p the given 2D point
+   * @return float filter's value
+   */
+  [[nodiscard]] float evaluate(const Point2f &p) const;
+
+  /**
+   * @brief look up the filter values at `p` (relative to the center),
+   * `out[i]` is the value at `p[i]`, return $0$ outside the filter's extent
+   *
+   * @param p the given 2D points
+   * @param [out] out filter's values
+   */
+  void evaluate(std::span<const Point2f> p, std::span<float> out) const;
+
+ private:
+  /// filter radius
+  Vector2f radius;
+  /// filter radius inversion
+  Vector2f inv_radius;
+  /// table values (row major, $y \times WIDTH + x$)
+  std::array<float, WIDTH * WIDTH> values{};
+};
+
 class DAKKU_EXPORT_CORE Filter {
  public:
   /**
@@ -24,10 +74,31 @@ class DAKKU_EXPORT_CORE Filter {
    */
   [[nodiscard]] virtual float evaluate(const Point2f &p) const = 0;
 
+  /**
+   * @brief get the precomputed table of the filter (built on first use)
+   *
+   */
+  [[nodiscard]] const FilterTable &table() const;
+
+  /**
+   * @brief evaluate the filter at a batch of points through the table,
+   * `out[i]` is the value at `p[i]`, points outside the filter's extent get $0$
+   *
+   * @param p the given 2D points (relative to the center of the filter)
+   * @param [out] out filter's values
+   */
+  void evaluate_batch(std::span<const Point2f> p, std::span<float> out) const;
+
   /// filter radius
   const Vector2f radius;
   /// filter radius inversion
   const Vector2f inv_radius;
+
+ private:
+  /// guards the table construction
+  mutable std::once_flag table_flag;
+  /// lazily built table
+  mutable std::optional<FilterTable> _table;
 };
 }  // namespace dakku
-#endif
\ No newline at end of file
+#endif
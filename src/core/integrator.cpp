@@ -0,0 +1,169 @@
+#include <core/integrator.h>
+#include <core/memory.h>
+#include <core/stats.h>
+
+namespace dakku {
+
+DAKKU_STAT_COUNTER("Integrator/Camera rays", camera_rays_traced);
+DAKKU_STAT_COUNTER("Integrator/Extension rays", extension_rays_traced);
+DAKKU_STAT_COUNTER("Integrator/Shadow rays", shadow_rays_traced);
+
+namespace {
+/// start a ray at `p` offset along `n` (on the side of `d`) past self hits
+Ray spawn_ray(const Point3f &p, const Normal3f &n, const Vector3f &d) {
+  const float scale = std::max(
+      {1.0f, std::abs(p.x()), std::abs(p.y()), std::abs(p.z())});
+  const Vector3f offset{n.x(), n.y(), n.z()};
+  const float s = n.dot(d) < 0 ? -SHADOW_EPS * scale : SHADOW_EPS * scale;
+  return Ray{Point3f{p + offset * s}, d};
+}
+
+/// a scene assembled by a script, owns the list `primitives` points to
+struct LuaScene : Scene {
+  std::vector<const Primitive *> owned_primitives;
+};
+
+/// `table` is `{accelerator, primitives, materials, material_ids, light,
+/// background}`, `primitives` must be the list the accelerator was built
+/// from (the counts are checked, the hits index it unchecked) and material
+/// ids are 1-based like lua arrays
+Scene *lua_create_scene(const sol::table &table) {
+  auto *scene = GlobalMemoryArena::instance().allocObject<LuaScene>();
+  scene->accelerator = table.get<const Accelerator *>("accelerator");
+  if (!scene->accelerator) lua_error("scene has no accelerator");
+  const auto primitives = table.get<sol::optional<sol::table>>("primitives");
+  if (!primitives || primitives->size() == 0)
+    lua_error("scene has no primitives");
+  scene->owned_primitives = primitives_from_lua(*primitives);
+  if (scene->owned_primitives.size() != scene->accelerator->n_primitives())
+    lua_error("scene has {} primitives, its accelerator was built over {}",
+              scene->owned_primitives.size(),
+              scene->accelerator->n_primitives());
+  scene->primitives = scene->owned_primitives;
+  if (const auto materials =
+          table.get<sol::optional<sol::table>>("materials")) {
+    if (materials->size() == 0) lua_error("scene has an empty material list");
+    scene->materials.resize(materials->size());
+    for (size_t i = 0; i < scene->materials.size(); ++i)
+      scene->materials[i] =
+          Material::from_lua(materials->get<sol::table>(i + 1));
+  }
+  // the integrators index `materials` with these unchecked
+  if (const auto ids = table.get<sol::optional<sol::table>>("material_ids")) {
+    scene->material_ids.resize(ids->size());
+    for (size_t i = 0; i < scene->material_ids.size(); ++i) {
+      const auto id = ids->get<int64_t>(i + 1);
+      if (id < 1 || static_cast<size_t>(id) > scene->materials.size())
+        lua_error("material id {} out of range: {} not in [1, {}]", i + 1, id,
+                  scene->materials.size());
+      scene->material_ids[i] = static_cast<uint32_t>(id - 1);
+    }
+  }
+  if (const auto light = table.get<sol::optional<sol::table>>("light"))
+    scene->light = DirectionalLight::from_lua(*light);
+  scene->background = table.get_or("background", scene->background);
+  return scene;
+}
+}  // namespace
+
+Material Material::from_lua(const sol::table &table) {
+  Material ret;
+  const auto type = table.get_or("type", std::string{"diffuse"});
+  if (type == "mirror")
+    ret.type = MaterialType::MIRROR;
+  else if (type != "diffuse")
+    lua_error("unknown material type {}", type);
+  ret.albedo = table.get_or("albedo", ret.albedo);
+  ret.emission = table.get_or("emission", ret.emission);
+  return ret;
+}
+
+DirectionalLight DirectionalLight::from_lua(const sol::table &table) {
+  DirectionalLight ret;
+  const Vector3f direction = table.get_or("direction", ret.direction);
+  const float length = direction.length();
+  if (!(length > 0)) lua_error("light direction has zero length");
+  ret.direction = direction / length;
+  ret.radiance = table.get_or("radiance", ret.radiance);
+  return ret;
+}
+
+SurfaceHit surface_hit(const Scene &scene, const Ray &ray,
+                       const RayHit &hit) {
+  SurfaceHit ret;
+  ret.p = ray(hit.t);
+  ret.wo = Vector3f{-ray.d / ray.d.length()};
+  ret.n = scene.primitives[hit.prim_id]->normal(ret.p, hit);
+  if (ret.n.dot(ret.wo) < 0) ret.n = -ret.n;
+  return ret;
+}
+
+std::optional<ScatteredRay> sample_light(const Scene &scene,
+                                         const Material &material,
+                                         const SurfaceHit &hit) {
+  if (material.type != MaterialType::DIFFUSE) return {};
+  const DirectionalLight &light = scene.light;
+  const float cos_theta = hit.n.dot(light.direction);
+  if (cos_theta <= 0 || light.radiance.is_zero()) return {};
+  return ScatteredRay{
+      spawn_ray(hit.p, hit.n, light.direction),
+      Vector3f{material.albedo * light.radiance * (INV_PI * cos_theta)}};
+}
+
+std::optional<ScatteredRay> sample_material(const Material &material,
+                                            const SurfaceHit &hit,
+                                            const Point2f &u) {
+  if (material.albedo.is_zero()) return {};
+  const Normal3f &n = hit.n;
+  if (material.type == MaterialType::MIRROR) {
+    const Vector3f wi{Vector3f{n.x(), n.y(), n.z()} * (2 * n.dot(hit.wo)) -
+                      hit.wo};
+    return ScatteredRay{spawn_ray(hit.p, n, wi), material.albedo};
+  }
+  // cosine weighted hemisphere, the cosine and pdf cancel: the weight is the
+  // albedo
+  const float r = std::sqrt(u.x()), phi = 2 * PI * u.y();
+  const float x = r * std::cos(phi), y = r * std::sin(phi);
+  const float z = std::sqrt(std::max(0.0f, 1 - u.x()));
+  // orthonormal basis around n (duff et al. 2017)
+  const float sign = std::copysign(1.0f, n.z());
+  const float a = -1 / (sign + n.z()), b = n.x() * n.y() * a;
+  const Vector3f s{1 + sign * n.x() * n.x() * a, sign * b, -sign * n.x()};
+  const Vector3f t{b, sign + n.y() * n.y() * a, -n.y()};
+  const Vector3f wi{s * x + t * y + Vector3f{n.x(), n.y(), n.z()} * z};
+  return ScatteredRay{spawn_ray(hit.p, n, wi), material.albedo};
+}
+
+void Integrator::report(std::string_view name, const RenderStats &stats) {
+  DAKKU_STAT_ADD(camera_rays_traced, stats.camera_rays);
+  DAKKU_STAT_ADD(extension_rays_traced, stats.extension_rays);
+  DAKKU_STAT_ADD(shadow_rays_traced, stats.shadow_rays);
+  DAKKU_INFO("{}: {} rays ({} camera, {} extension, {} shadow) in {:.3f}s, "
+             "{:.2f} Mrays/s",
+             name, stats.rays(), stats.camera_rays, stats.extension_rays,
+             stats.shadow_rays, stats.seconds, stats.mrays_per_second());
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(Scene, [] {
+  DAKKU_INFO("register Scene");
+  auto &state = Lua::instance().get_state();
+  state.new_usertype<Scene>("Scene", sol::no_constructor, "background",
+                            sol::readonly(&Scene::background));
+  state.new_usertype<RenderStats>(
+      "RenderStats", sol::no_constructor, "camera_rays",
+      sol::readonly(&RenderStats::camera_rays), "extension_rays",
+      sol::readonly(&RenderStats::extension_rays), "shadow_rays",
+      sol::readonly(&RenderStats::shadow_rays), "seconds",
+      sol::readonly(&RenderStats::seconds), "rays", &RenderStats::rays,
+      "mrays_per_second", &RenderStats::mrays_per_second);
+  state.set_function("_create_scene", &lua_create_scene);
+  // renders into `film`, returns the `RenderStats`
+  state.set_function("_render",
+                     [](const Integrator &integrator, const Scene &scene,
+                        const Camera &camera, const Sampler &sampler,
+                        Film &film) {
+                       return integrator.render(scene, camera, sampler, film);
+                     });
+  return 0;
+});
+}  // namespace dakku
@@ -0,0 +1,225 @@
+#ifndef DAKKU_CORE_INTEGRATOR_H_
+#define DAKKU_CORE_INTEGRATOR_H_
+#include <core/accelerator.h>
+#include <core/camera.h>
+#include <core/film.h>
+#include <core/sampler.h>
+
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief the scattering model of a material
+ *
+ */
+enum class MaterialType : uint32_t {
+  /// lambertian reflection
+  DIFFUSE,
+  /// perfect specular reflection
+  MIRROR
+};
+
+/**
+ * @brief surface material, shared by all primitives with the same material id
+ *
+ */
+struct Material {
+  /// scattering model
+  MaterialType type{MaterialType::DIFFUSE};
+  /// reflectance
+  Vector3f albedo{0.5f, 0.5f, 0.5f};
+  /// emitted radiance
+  Vector3f emission{0, 0, 0};
+
+  /**
+   * @brief read a material from a lua table
+   * `{type = "diffuse" | "mirror", albedo = ..., emission = ...}`, missing
+   * fields keep their defaults
+   *
+   */
+  static Material from_lua(const sol::table &table);
+};
+
+/**
+ * @brief light infinitely far away in a single direction
+ *
+ */
+struct DirectionalLight {
+  /// unit direction towards the light
+  Vector3f direction{0, 1, 0};
+  /// radiance arriving from the light
+  Vector3f radiance{0, 0, 0};
+
+  /**
+   * @brief read a light from a lua table `{direction = ..., radiance = ...}`,
+   * the direction is normalized
+   *
+   */
+  static DirectionalLight from_lua(const sol::table &table);
+};
+
+/**
+ * @brief everything an integrator renders: the accelerator over the
+ * primitives, a material per primitive, one directional light and a constant
+ * background
+ *
+ */
+struct DAKKU_EXPORT_CORE Scene {
+  /// the accelerator, `RayHit::prim_id` indexes `primitives`
+  const Accelerator *accelerator{nullptr};
+  /// the primitives the accelerator was built from
+  std::span<const Primitive *const> primitives;
+  /// materials (at least one)
+  std::vector<Material> materials{Material{}};
+  /// material id of each primitive, primitives past the end use material 0
+  std::vector<uint32_t> material_ids;
+  /// the light
+  DirectionalLight light;
+  /// radiance of the rays that leave the scene
+  Vector3f background{0, 0, 0};
+
+  /**
+   * @brief get the material id of a primitive
+   *
+   */
+  [[nodiscard]] uint32_t material_id(uint32_t prim_id) const {
+    return prim_id < material_ids.size() ? material_ids[prim_id] : 0;
+  }
+};
+
+/**
+ * @brief the local geometry at a ray hit
+ *
+ */
+struct SurfaceHit {
+  /// hit point
+  Point3f p;
+  /// unit normal, flipped to the side of `wo`
+  Normal3f n;
+  /// unit direction back along the ray
+  Vector3f wo;
+};
+
+/**
+ * @brief a ray leaving a surface with the factor it applies to the path
+ * throughput (or the radiance it carries if unoccluded, for shadow rays)
+ *
+ */
+struct ScatteredRay {
+  /// the ray
+  Ray ray;
+  /// throughput factor or unoccluded radiance
+  Vector3f weight;
+};
+
+/**
+ * @brief get the local geometry of `hit` on `ray`
+ *
+ */
+DAKKU_EXPORT_CORE SurfaceHit surface_hit(const Scene &scene, const Ray &ray,
+                                         const RayHit &hit);
+
+/**
+ * @brief get the shadow ray towards the scene light and the radiance it
+ * reflects towards `wo` if unoccluded
+ *
+ * @return nothing if the material reflects no light from the light
+ */
+DAKKU_EXPORT_CORE std::optional<ScatteredRay> sample_light(
+    const Scene &scene, const Material &material, const SurfaceHit &hit);
+
+/**
+ * @brief sample the continuation of a path at a hit, the weight is
+ * $\frac {f \cos \theta} {pdf}$
+ *
+ * @param u uniform sample in $[0, 1)^2$
+ * @return nothing if the path ends
+ */
+DAKKU_EXPORT_CORE std::optional<ScatteredRay> sample_material(
+    const Material &material, const SurfaceHit &hit, const Point2f &u);
+
+/**
+ * @brief ray counts and time of a render
+ *
+ */
+struct RenderStats {
+  /// camera rays traced
+  uint64_t camera_rays{0};
+  /// continuation rays traced
+  uint64_t extension_rays{0};
+  /// shadow rays traced
+  uint64_t shadow_rays{0};
+  /// wall clock time in seconds
+  double seconds{0};
+
+  /**
+   * @brief get the number of rays traced
+   *
+   */
+  [[nodiscard]] uint64_t rays() const {
+    return camera_rays + extension_rays + shadow_rays;
+  }
+
+  /**
+   * @brief get the throughput in million rays per second
+   *
+   */
+  [[nodiscard]] double mrays_per_second() const {
+    return seconds > 0 ? static_cast<double>(rays()) * 1e-6 / seconds : 0;
+  }
+};
+
+/**
+ * @brief unidirectional path tracer with next event estimation towards the
+ * scene light
+ * all integrators share the sample dimensions (0, 1: film position,
+ * `bounce_dimension(depth)` and the next: continuation direction) and the
+ * shading functions above, so they render the same estimate and only differ
+ * in how the paths are scheduled
+ *
+ */
+class DAKKU_EXPORT_CORE Integrator {
+ public:
+  /**
+   * @brief Construct a new Integrator object
+   *
+   * @param max_depth the maximum number of bounces (0 renders emission only)
+   */
+  explicit Integrator(int max_depth) : max_depth(max_depth) {}
+  virtual ~Integrator() = default;
+
+  /**
+   * @brief render `sampler.samples_per_pixel` samples of every pixel of
+   * the film's sample bounds into the film
+   *
+   */
+  virtual RenderStats render(const Scene &scene, const Camera &camera,
+                             const Sampler &sampler, Film &film) const = 0;
+
+  /**
+   * @brief get the first sample dimension of the continuation direction at
+   * bounce `depth`
+   *
+   */
+  static constexpr uint32_t bounce_dimension(int depth) {
+    return 2 + 2 * static_cast<uint32_t>(depth);
+  }
+
+  /// the maximum number of bounces
+  const int max_depth;
+
+ protected:
+  /**
+   * @brief add the ray counts to the statistics and log the throughput
+   *
+   */
+  static void report(std::string_view name, const RenderStats &stats);
+};
+
+DAKKU_DECLARE_LUA_OBJECT(Scene, DAKKU_EXPORT_CORE);
+}  // namespace dakku
+#endif
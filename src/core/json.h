@@ -0,0 +1,23 @@
+#ifndef DAKKU_CORE_JSON_H_
+#define DAKKU_CORE_JSON_H_
+#include <core/fwd.h>
+
+#include <string>
+#include <string_view>
+
+namespace dakku {
+
+/**
+ * @brief quote `s` as a json string (used by the stats and trace dumps)
+ *
+ */
+inline std::string json_string(std::string_view s) {
+  std::string ret = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') ret += '\\';
+    ret += c;
+  }
+  return ret + '"';
+}
+}  // namespace dakku
+#endif
@@ -1,18 +1,152 @@
 #include <core/logger.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <spdlog/sinks/base_sink.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <vector>
+
 namespace dakku {
 
+namespace {
+/**
+ * @brief registry of the rate limited call sites
+ *
+ */
+struct LogSiteRegistry {
+  static LogSiteRegistry &instance() {
+    static LogSiteRegistry registry;
+    return registry;
+  }
+
+  /// guards `sites`
+  std::mutex mutex;
+  /// registered sites
+  std::vector<const LogSite *> sites;
+};
+}  // namespace
+
+/**
+ * @brief sink that counts the flushes the worker has processed, its logger
+ * only posts flushes, and the worker handles the queue in order, so once a
+ * flush is reached every message posted before it has been written
+ *
+ */
+class Logger::FlushBarrier final : public spdlog::sinks::base_sink<std::mutex> {
+ public:
+  /**
+   * @brief post a flush through `logger` and wait until the worker reaches it
+   *
+   */
+  void wait(spdlog::async_logger &logger) {
+    std::unique_lock lock(barrier_mutex);
+    const uint64_t target = ++requested;
+    // a full queue may drop the flush (overrun), post it again then
+    while (reached < target) {
+      lock.unlock();
+      logger.flush();
+      lock.lock();
+      cv.wait_for(lock, std::chrono::milliseconds(50),
+                  [&] { return reached >= target; });
+    }
+  }
+
+ protected:
+  void sink_it_(const spdlog::details::log_msg &) override {}
+
+  void flush_() override {
+    {
+      std::lock_guard lock(barrier_mutex);
+      ++reached;
+    }
+    cv.notify_all();
+  }
+
+ private:
+  /// guards the counters
+  std::mutex barrier_mutex;
+  /// signals `reached`
+  std::condition_variable cv;
+  /// the number of barriers waited for
+  uint64_t requested{0};
+  /// the number of flushes processed by the worker
+  uint64_t reached{0};
+};
+
 Logger::Logger(std::shared_ptr<spdlog::logger> logger)
-    : _logger(std::move(logger)) {
+    : _logger(std::move(logger)), current(_logger.get()) {
 #ifdef DAKKU_BUILD_DEBUG
   _logger->set_level(spdlog::level::debug);
 #endif
 }
 
-const Logger &Logger::get() {
+Logger &Logger::instance() {
   static Logger logger{spdlog::stdout_color_mt("dakku")};
   return logger;
 }
-}  // namespace dakku
\ No newline at end of file
+
+const Logger &Logger::get() { return instance(); }
+
+void Logger::set_async(bool async, size_t queue_size) {
+  Logger &logger = instance();
+  std::lock_guard lock(logger.mutex);
+  if (async) {
+    if (!logger.async_logger) {
+      logger.pool = std::make_shared<spdlog::details::thread_pool>(
+          std::max<size_t>(queue_size, 1), 1);
+      logger.async_logger = std::make_shared<spdlog::async_logger>(
+          logger._logger->name(), logger._logger->sinks().begin(),
+          logger._logger->sinks().end(), logger.pool,
+          spdlog::async_overflow_policy::overrun_oldest);
+      logger.async_logger->set_level(logger._logger->level());
+      logger.async_logger->flush_on(spdlog::level::err);
+      logger.barrier = std::make_shared<FlushBarrier>();
+      logger.barrier_logger = std::make_shared<spdlog::async_logger>(
+          logger._logger->name(), logger.barrier, logger.pool,
+          spdlog::async_overflow_policy::overrun_oldest);
+    }
+    logger.current.store(logger.async_logger.get(), std::memory_order_release);
+  } else {
+    logger.current.store(logger._logger.get(), std::memory_order_release);
+    if (logger.async_logger) {
+      // the queue may be empty while the worker still writes the last
+      // message, wait until it reaches a flush posted behind them instead
+      logger.async_logger->flush();
+      logger.barrier->wait(*logger.barrier_logger);
+    }
+  }
+}
+
+size_t Logger::dropped() {
+  const Logger &logger = get();
+  return logger.pool ? logger.pool->overrun_counter() : 0;
+}
+
+void Logger::report_suppressed() {
+  if (size_t n = dropped(); n > 0)
+    DAKKU_WARN("dropped {} messages from the full async queue", n);
+  auto &registry = LogSiteRegistry::instance();
+  std::lock_guard lock(registry.mutex);
+  for (const LogSite *site : registry.sites) {
+    if (uint64_t n = site->suppressed(); n > 0)
+      DAKKU_INFO("suppressed {} messages from {}:{}", n, site->file,
+                 site->line);
+  }
+}
+
+LogSite::LogSite(const char *file, int line) : file(file), line(line) {
+  auto &registry = LogSiteRegistry::instance();
+  std::lock_guard lock(registry.mutex);
+  registry.sites.push_back(this);
+}
+
+LogSite::~LogSite() {
+  auto &registry = LogSiteRegistry::instance();
+  std::lock_guard lock(registry.mutex);
+  std::erase(registry.sites, this);
+}
+}  // namespace dakku
@@ -2,8 +2,11 @@
 #define DAKKU_CORE_LOGGER_H_
 #include <core/fwd.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 
+#include <spdlog/async_logger.h>
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/ostr.h>
 
@@ -14,6 +17,9 @@ namespace dakku {
  */
 class DAKKU_EXPORT_CORE Logger {
  public:
+  /// default capacity (in messages) of the asynchronous queue
+  static constexpr size_t DEFAULT_QUEUE_SIZE = 8192;
+
   /**
    * @brief get logger instance
    *
@@ -26,9 +32,39 @@ class DAKKU_EXPORT_CORE Logger {
    *
    * @return the corresponding spdlog::logger
    */
-  [[nodiscard]] spdlog::logger *handle() const { return _logger.get(); }
+  [[nodiscard]] spdlog::logger *handle() const {
+    return current.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief switch between synchronous and asynchronous logging, the
+   * asynchronous logger formats on the calling thread and hands the message
+   * to a spdlog worker thread, a full queue drops the oldest messages instead
+   * of blocking, switching back waits until the worker has written every
+   * message queued before the switch
+   *
+   * @param async whether to log asynchronously
+   * @param queue_size queue capacity, only used by the first switch
+   */
+  static void set_async(bool async, size_t queue_size = DEFAULT_QUEUE_SIZE);
+
+  /**
+   * @brief get the number of messages dropped by the full asynchronous queue
+   *
+   */
+  static size_t dropped();
+
+  /**
+   * @brief log the number of messages that the rate limited call sites
+   * (`DAKKU_WARN_ONCE`, `DAKKU_WARN_EVERY_N`) have suppressed and the
+   * number of messages dropped by the full asynchronous queue
+   *
+   */
+  static void report_suppressed();
 
  private:
+  class FlushBarrier;
+
   /**
    * @brief Construct a new Logger object with spdlog::logger
    *
@@ -36,8 +72,88 @@ class DAKKU_EXPORT_CORE Logger {
    */
   explicit Logger(std::shared_ptr<spdlog::logger> _logger);
 
+  /**
+   * @brief get the mutable logger instance
+   *
+   */
+  static Logger &instance();
+
   /// spdlog logger
   std::shared_ptr<spdlog::logger> _logger;
+  /// worker thread of the asynchronous logger
+  std::shared_ptr<spdlog::details::thread_pool> pool;
+  /// asynchronous logger over the same sinks (kept alive once created, as
+  /// other threads may still hold its handle)
+  std::shared_ptr<spdlog::async_logger> async_logger;
+  /// sink of a private asynchronous logger on the same queue, its flushes
+  /// tell when the worker has reached them
+  std::shared_ptr<FlushBarrier> barrier;
+  /// the asynchronous logger that posts the barrier flushes
+  std::shared_ptr<spdlog::async_logger> barrier_logger;
+  /// the logger in use
+  std::atomic<spdlog::logger *> current;
+  /// guards the switching
+  std::mutex mutex;
+};
+
+/**
+ * @brief a rate limited logging call site, one relaxed atomic increment per
+ * call, suppressed messages are neither formatted nor sent to the sinks
+ *
+ */
+class DAKKU_EXPORT_CORE LogSite {
+ public:
+  /**
+   * @brief Construct a new Log Site object (registered for the summary)
+   *
+   */
+  LogSite(const char *file, int line);
+  ~LogSite();
+  LogSite(const LogSite &) = delete;
+  LogSite &operator=(const LogSite &) = delete;
+
+  /**
+   * @brief count a hit, return whether it is the `n`-th one since the last
+   * logged hit (the first hit is always logged)
+   *
+   */
+  bool every(uint64_t n) {
+    return logged(hits.fetch_add(1, std::memory_order_relaxed) % n == 0);
+  }
+
+  /**
+   * @brief count a hit, return whether it is the first one
+   *
+   */
+  bool once() {
+    return logged(hits.fetch_add(1, std::memory_order_relaxed) == 0);
+  }
+
+  /**
+   * @brief the number of suppressed hits
+   *
+   */
+  [[nodiscard]] uint64_t suppressed() const {
+    return hits.load(std::memory_order_relaxed) -
+           fired.load(std::memory_order_relaxed);
+  }
+
+  /// source file
+  const char *file;
+  /// source line
+  int line;
+
+ private:
+  /// count a logged hit
+  bool logged(bool log) {
+    if (log) fired.fetch_add(1, std::memory_order_relaxed);
+    return log;
+  }
+
+  /// the number of hits
+  std::atomic<uint64_t> hits{0};
+  /// the number of logged hits
+  std::atomic<uint64_t> fired{0};
 };
 
 /// log error message
@@ -49,6 +165,18 @@ class DAKKU_EXPORT_CORE Logger {
 /// log warning message
 #define DAKKU_WARN(...) \
   SPDLOG_LOGGER_CALL(Logger::get().handle(), spdlog::level::warn, __VA_ARGS__)
+/// log warning message only the first time this call site is reached
+#define DAKKU_WARN_ONCE(...)                                     \
+  do {                                                           \
+    static ::dakku::LogSite _dakku_log_site{__FILE__, __LINE__}; \
+    if (_dakku_log_site.once()) DAKKU_WARN(__VA_ARGS__);         \
+  } while (0)
+/// log warning message every `n` times this call site is reached
+#define DAKKU_WARN_EVERY_N(n, ...)                               \
+  do {                                                           \
+    static ::dakku::LogSite _dakku_log_site{__FILE__, __LINE__}; \
+    if (_dakku_log_site.every(n)) DAKKU_WARN(__VA_ARGS__);       \
+  } while (0)
 #ifdef DAKKU_BUILD_DEBUG
 /// log debug message
 #define DAKKU_DEBUG(...) \
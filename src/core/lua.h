@@ -6,6 +6,7 @@
 #define SOL_ALL_SAFETIES_ON 1
 #endif
 #include <sol/sol.hpp>
+#include <spdlog/fmt/fmt.h>
 
 namespace dakku {
 
@@ -33,6 +34,17 @@ class DAKKU_EXPORT_CORE Lua {
   sol::state state;
 };
 
+/**
+ * @brief reject bad input of a bound function with a lua error (checked in
+ * every build mode, unlike `DAKKU_CHECK`)
+ *
+ */
+template <typename... Args>
+[[noreturn]] void lua_error(fmt::format_string<Args...> format,
+                            Args &&...args) {
+  throw sol::error(fmt::format(format, std::forward<Args>(args)...));
+}
+
 #define DAKKU_DECLARE_LUA_OBJECT(name, export) \
   struct export _##name##_lua_bind_wrapper {   \
     static int _##name##_bind_lua;             \
@@ -1,8 +1,10 @@
 #ifndef DAKKU_CORE_MATH_FUNC_H_
 #define DAKKU_CORE_MATH_FUNC_H_
-#include <core/fwd.h>
+#include <core/constants.h>
 
+#include <bit>
 #include <cmath>
+#include <cstdint>
 
 namespace dakku {
 
@@ -26,5 +28,117 @@ requires std::is_floating_point_v<T> DAKKU_INLINE bool isnan(T x) {
  */
 template <typename T>
 requires std::is_integral_v<T> DAKKU_INLINE bool isnan(T) { return false; }
+
+/**
+ * @brief conservative bound $\gamma_n$ of the relative error of $n$ floating
+ * point operations
+ *
+ * @param n the number of operations
+ */
+constexpr float gamma(int n) {
+  return (static_cast<float>(n) * MACHINE_EPSILON) /
+         (1 - static_cast<float>(n) * MACHINE_EPSILON);
+}
+
+/**
+ * @brief convert a float to an ieee half float (round to nearest even)
+ *
+ * @return the half float bits
+ */
+inline uint16_t float_to_half(float f) {
+  const uint32_t bits = std::bit_cast<uint32_t>(f);
+  const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+  const uint32_t abs = bits & 0x7fffffffu;
+  // inf, nan (quiet) and values that round past the largest half (65504)
+  if (abs > 0x7f800000u) return sign | 0x7e00u;
+  if (abs >= 0x477ff000u) return sign | 0x7c00u;
+  uint32_t h, rem, half;
+  if (abs < 0x38800000u) {
+    // subnormal half: units of $2^{-24}$
+    if (abs < 0x33000000u) return sign;
+    const uint32_t shift = 126 - (abs >> 23);
+    const uint32_t m = (abs & 0x7fffffu) | 0x800000u;
+    h = m >> shift;
+    rem = m & ((1u << shift) - 1);
+    half = 1u << (shift - 1);
+  } else {
+    // rebias the exponent from 127 to 15, a mantissa carry bumps it
+    h = (abs - 0x38000000u) >> 13;
+    rem = abs & 0x1fffu;
+    half = 0x1000u;
+  }
+  if (rem > half || (rem == half && (h & 1))) ++h;
+  return static_cast<uint16_t>(sign | h);
+}
+
+/**
+ * @brief convert an ieee half float to a float (exact)
+ *
+ * @param h the half float bits
+ */
+inline float half_to_float(uint16_t h) {
+  const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+  uint32_t exp = (h >> 10) & 0x1fu, mant = h & 0x3ffu;
+  if (exp == 0x1f) return std::bit_cast<float>(sign | 0x7f800000u | mant << 13);
+  if (exp != 0)
+    return std::bit_cast<float>(sign | (exp + 112) << 23 | mant << 13);
+  if (mant == 0) return std::bit_cast<float>(sign);
+  // subnormal half, normalize the mantissa
+  exp = 113;
+  while (!(mant & 0x400u)) {
+    mant <<= 1;
+    --exp;
+  }
+  return std::bit_cast<float>(sign | exp << 23 | (mant & 0x3ffu) << 13);
+}
+
+/**
+ * @brief reverse the bits of a 32 bit integer
+ *
+ */
+constexpr uint32_t reverse_bits_32(uint32_t v) {
+  v = (v << 16) | (v >> 16);
+  v = ((v & 0x00ff00ffu) << 8) | ((v & 0xff00ff00u) >> 8);
+  v = ((v & 0x0f0f0f0fu) << 4) | ((v & 0xf0f0f0f0u) >> 4);
+  v = ((v & 0x33333333u) << 2) | ((v & 0xccccccccu) >> 2);
+  v = ((v & 0x55555555u) << 1) | ((v & 0xaaaaaaaau) >> 1);
+  return v;
+}
+
+/**
+ * @brief mix the bits of a 64 bit integer (a finalizer of good avalanche),
+ * used to hash sampler coordinates into seeds
+ *
+ */
+constexpr uint64_t mix_bits(uint64_t v) {
+  v ^= v >> 31;
+  v *= 0x7fb5d329728ea185ull;
+  v ^= v >> 27;
+  v *= 0x81dadef4bc2dd44dull;
+  v ^= v >> 33;
+  return v;
+}
+
+/**
+ * @brief spread the low 10 bits of `x` to every third bit
+ *
+ */
+constexpr uint32_t left_shift_3(uint32_t x) {
+  x &= 0x3ffu;
+  x = (x | (x << 16)) & 0x030000ffu;
+  x = (x | (x << 8)) & 0x0300f00fu;
+  x = (x | (x << 4)) & 0x030c30c3u;
+  x = (x | (x << 2)) & 0x09249249u;
+  return x;
+}
+
+/**
+ * @brief interleave the low 10 bits of `x`, `y` and `z` (x in the lowest
+ * bit)
+ *
+ */
+constexpr uint32_t encode_morton_3(uint32_t x, uint32_t y, uint32_t z) {
+  return (left_shift_3(z) << 2) | (left_shift_3(y) << 1) | left_shift_3(x);
+}
 }  // namespace dakku
 #endif
\ No newline at end of file
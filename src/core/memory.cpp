@@ -1,7 +1,41 @@
 #include <core/memory.h>
+#include <core/stats.h>
 
 namespace dakku {
 
+DAKKU_STAT_COUNTER("Memory/Thread arena bytes", arena_bytes);
+
+ThreadLocalArenas::LocalArena::LocalArena(size_t block_size)
+    : block(scalable_aligned_malloc(block_size, 64)),
+      monotonic(block, block_size, oneapi::tbb::scalable_memory_resource()) {
+  DAKKU_STAT_ADD(arena_bytes, block_size);
+}
+
+ThreadLocalArenas::LocalArena::~LocalArena() {
+  arena.release();
+  monotonic.release();
+  scalable_aligned_free(block);
+}
+
+void ThreadLocalArenas::LocalArena::reset() {
+  // the pool returns its chunks to the monotonic resource (a no-op), then
+  // the monotonic resource rewinds to the start of the initial block
+  arena.release();
+  monotonic.release();
+}
+
+ThreadLocalArenas::ThreadLocalArenas(size_t block_size) : arenas(block_size) {}
+
+MemoryArena &ThreadLocalArenas::local() { return arenas.local().arena; }
+
+void ThreadLocalArenas::reset() { arenas.local().reset(); }
+
+void ThreadLocalArenas::reset_all() {
+  for (auto &arena : arenas) arena.reset();
+}
+
+size_t ThreadLocalArenas::size() const { return arenas.size(); }
+
 MemoryArena &GlobalMemoryArena::instance() {
   static GlobalMemoryArena _instance;
   return _instance.arena;
@@ -11,7 +11,9 @@
 #if __has_include(<alloca.h>)
 #include <alloca.h>
 #endif
+#include <memory>
 #include <memory_resource>
+#include <span>
 
 namespace dakku {
 
@@ -47,6 +49,22 @@ class DAKKU_EXPORT_CORE MemoryArena {
         std::forward<Args>(args)...);
   }
 
+  /**
+   * @brief allocate `n` contiguous objects from the arena in one block
+   *
+   * @tparam T object type
+   * @tparam F callable returning the object at an index
+   * @param n object count
+   * @param make constructs object `i` from `make(i)`
+   * @return std::span<T> the objects
+   */
+  template <typename T, typename F>
+  std::span<T> allocArray(size_t n, F &&make) {
+    T *ret = std::pmr::polymorphic_allocator<T>{&resource}.allocate(n);
+    for (size_t i = 0; i < n; ++i) std::construct_at(ret + i, make(i));
+    return {ret, n};
+  }
+
   /**
    * @brief release the memory arena
    *
@@ -61,6 +79,76 @@ class DAKKU_EXPORT_CORE MemoryArena {
   std::pmr::unsynchronized_pool_resource resource{&upStream};
 };
 
+/**
+ * @brief per-thread memory arenas for parallel workers
+ * every thread gets its own `MemoryArena` over a private initial block, so
+ * allocations never contend, `reset()` rewinds the calling thread's arena
+ * and only touches the upstream allocator when the block has overflowed
+ *
+ */
+class DAKKU_EXPORT_CORE ThreadLocalArenas {
+ public:
+  /// default size of the initial block of each thread arena
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+  /**
+   * @brief Construct a new Thread Local Arenas object
+   *
+   * @param block_size size of the initial block of each thread arena
+   */
+  explicit ThreadLocalArenas(size_t block_size = DEFAULT_BLOCK_SIZE);
+
+  /**
+   * @brief get the calling thread's arena (created on first use)
+   *
+   */
+  MemoryArena &local();
+
+  /**
+   * @brief release all objects allocated from the calling thread's arena,
+   * call it at tile or sample boundaries
+   *
+   */
+  void reset();
+
+  /**
+   * @brief reset the arenas of all threads (unsynchronized, call it only
+   * when no worker uses the arenas)
+   *
+   */
+  void reset_all();
+
+  /**
+   * @brief the number of thread arenas created so far
+   *
+   */
+  [[nodiscard]] size_t size() const;
+
+ private:
+  /**
+   * @brief a thread's arena: a pool over a rewindable monotonic block
+   *
+   */
+  struct LocalArena {
+    explicit LocalArena(size_t block_size);
+    ~LocalArena();
+    LocalArena(const LocalArena &) = delete;
+    LocalArena &operator=(const LocalArena &) = delete;
+
+    void reset();
+
+    /// initial block
+    void *block;
+    /// monotonic resource over the block
+    std::pmr::monotonic_buffer_resource monotonic;
+    /// the arena
+    MemoryArena arena{&monotonic};
+  };
+
+  /// arenas of all threads
+  oneapi::tbb::enumerable_thread_specific<LocalArena> arenas;
+};
+
 /**
  * @brief global memory arena
  *
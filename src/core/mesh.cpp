@@ -0,0 +1,228 @@
+#include <core/memory.h>
+#include <core/mesh.h>
+
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
+
+namespace dakku {
+
+namespace {
+/// $\pm 1$ by the sign bit, so that zeros stay on the positive side
+float sign_not_zero(float x) { return std::signbit(x) ? -1.0f : 1.0f; }
+
+/// $[-1, 1]$ to a 16-bit snorm
+uint32_t to_snorm16(float x) {
+  return static_cast<uint16_t>(
+      static_cast<int16_t>(std::lround(std::clamp(x, -1.0f, 1.0f) * 32767)));
+}
+
+/// 16-bit snorm to $[-1, 1]$
+float from_snorm16(uint32_t x) {
+  return std::max(static_cast<float>(static_cast<int16_t>(x)) / 32767, -1.0f);
+}
+
+/// column `j` of the linear part of a row major $3 \times 4$ matrix
+Vector3f column(std::span<const float, 12> m, size_t j) {
+  return Vector3f{m[j], m[4 + j], m[8 + j]};
+}
+
+/// `TriangleMesh::transform` with a lua array of 12 numbers
+void lua_transform(TriangleMesh &mesh, const sol::table &m) {
+  std::array<float, 12> matrix{};
+  if (m.size() != matrix.size())
+    lua_error("expect {} matrix entries, got {}", matrix.size(), m.size());
+  for (size_t i = 0; i < matrix.size(); ++i) matrix[i] = m[i + 1];
+  mesh.transform(matrix);
+}
+}  // namespace
+
+uint32_t encode_octahedral(const Normal3f &n) {
+  const float l1 = std::abs(n.x()) + std::abs(n.y()) + std::abs(n.z());
+  if (l1 == 0) return 0;
+  float u = n.x() / l1, v = n.y() / l1;
+  if (n.z() < 0) {
+    // fold the lower hemisphere over the diagonals
+    const float fu = (1 - std::abs(v)) * sign_not_zero(u);
+    const float fv = (1 - std::abs(u)) * sign_not_zero(v);
+    u = fu;
+    v = fv;
+  }
+  return to_snorm16(u) | to_snorm16(v) << 16;
+}
+
+Normal3f decode_octahedral(uint32_t bits) {
+  float x = from_snorm16(bits & 0xffffu), y = from_snorm16(bits >> 16);
+  const float z = 1 - std::abs(x) - std::abs(y);
+  if (z < 0) {
+    const float ux = (1 - std::abs(y)) * sign_not_zero(x);
+    const float uy = (1 - std::abs(x)) * sign_not_zero(y);
+    x = ux;
+    y = uy;
+  }
+  const Normal3f n{x, y, z};
+  return n / n.length();
+}
+
+TriangleMesh::TriangleMesh(size_t n_vertices, size_t n_triangles,
+                           bool has_normals, bool has_uvs) {
+  resize(n_vertices, n_triangles, has_normals, has_uvs);
+}
+
+TriangleMesh::TriangleMesh(Point3fArray positions,
+                           std::vector<uint32_t> indices)
+    : positions(std::move(positions)), indices(std::move(indices)) {
+  DAKKU_CHECK(this->indices.size() % 3 == 0,
+              "index count {} is not a multiple of 3", this->indices.size());
+}
+
+void TriangleMesh::resize(size_t n_vertices, size_t n_triangles,
+                          bool has_normals, bool has_uvs) {
+  positions.resize(n_vertices);
+  indices.resize(3 * n_triangles);
+  normals.resize(has_normals ? n_vertices : 0);
+  uvs.resize(has_uvs ? 2 * n_vertices : 0);
+}
+
+Bounds3f TriangleMesh::triangle_bound(size_t t) const {
+  const auto [v0, v1, v2] = triangle(t);
+  return Bounds3f{position(v0), position(v1)} | position(v2);
+}
+
+Bounds3f TriangleMesh::world_bound() const {
+  return oneapi::tbb::parallel_reduce(
+      oneapi::tbb::blocked_range<size_t>(0, n_triangles(), 4096), Bounds3f{},
+      [this](const oneapi::tbb::blocked_range<size_t> &r, Bounds3f b) {
+        for (size_t t = r.begin(); t != r.end(); ++t)
+          b = b | triangle_bound(t);
+        return b;
+      },
+      [](const Bounds3f &a, const Bounds3f &b) -> Bounds3f { return a | b; });
+}
+
+void TriangleMesh::transform(std::span<const float, 12> m) {
+  positions.transform(m);
+  if (normals.empty()) return;
+  // the cofactor matrix is the inverse transpose scaled by the determinant
+  const Vector3f a0 = column(m, 0), a1 = column(m, 1), a2 = column(m, 2);
+  const Vector3f c0 = a1.cross(a2), c1 = a2.cross(a0), c2 = a0.cross(a1);
+  const float s = a0.dot(c0) < 0 ? -1.0f : 1.0f;
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<size_t>(0, normals.size(), 4096),
+      [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          const Normal3f n = decode_octahedral(normals[i]);
+          const Vector3f t = (c0 * n.x() + c1 * n.y() + c2 * n.z()) * s;
+          normals[i] = encode_octahedral(Normal3f{t.x(), t.y(), t.z()});
+        }
+      });
+}
+
+bool TriangleMesh::is_valid() const {
+  return std::all_of(indices.begin(), indices.end(),
+                     [n = n_vertices()](uint32_t i) { return i < n; });
+}
+
+size_t TriangleMesh::memory_bytes() const {
+  return positions.data().size_bytes() + indices.size() * sizeof(uint32_t) +
+         normals.size() * sizeof(uint32_t) + uvs.size() * sizeof(uint16_t);
+}
+
+std::optional<std::array<float, 3>> TriangleMesh::hit(size_t t,
+                                                      const Ray &ray) const {
+  // moller-trumbore
+  const auto [i0, i1, i2] = triangle(t);
+  const Point3f p0 = position(i0);
+  const Vector3f e1 = position(i1) - p0, e2 = position(i2) - p0;
+  const Vector3f p = ray.d.cross(e2);
+  const float det = e1.dot(p);
+  if (det == 0 || std::isnan(det)) return {};
+  const float inv_det = 1 / det;
+  const Vector3f s = ray.o - p0;
+  const float b1 = s.dot(p) * inv_det;
+  if (b1 < 0 || b1 > 1) return {};
+  const Vector3f q = s.cross(e1);
+  const float b2 = ray.d.dot(q) * inv_det;
+  if (b2 < 0 || b1 + b2 > 1) return {};
+  const float t_hit = e2.dot(q) * inv_det;
+  if (!(t_hit > 0 && t_hit < ray.tMax)) return {};
+  return std::array{t_hit, b1, b2};
+}
+
+std::optional<RayHit> TriangleMesh::intersect(size_t t, const Ray &ray) const {
+  auto h = hit(t, ray);
+  if (!h) return {};
+  const auto [t_hit, b1, b2] = *h;
+  ray.tMax = t_hit;
+  return RayHit{t_hit, Point2f{b1, b2}};
+}
+
+bool TriangleMesh::occluded(size_t t, const Ray &ray) const {
+  return hit(t, ray).has_value();
+}
+
+Normal3f TriangleMesh::surface_normal(size_t t, const Point2f &b) const {
+  const auto [i0, i1, i2] = triangle(t);
+  if (has_normals()) {
+    const Normal3f n = normal(i0) * (1 - b.x() - b.y()) + normal(i1) * b.x() +
+                       normal(i2) * b.y();
+    const float length = n.length();
+    if (length > 0) return n / length;
+  }
+  const Point3f p0 = position(i0);
+  const Vector3f n = (position(i1) - p0).cross(position(i2) - p0);
+  const float length = n.length();
+  // degenerate triangles have no geometric normal, any unit vector will do
+  if (!(length > 0)) return Normal3f{0, 0, 1};
+  return Normal3f{n.x(), n.y(), n.z()} / length;
+}
+
+std::vector<const Primitive *> create_triangles(const TriangleMesh &mesh) {
+  // one block for the whole mesh instead of an allocation per triangle
+  const std::span<Triangle> triangles =
+      GlobalMemoryArena::instance().allocArray<Triangle>(
+          mesh.n_triangles(), [&](size_t t) {
+            return Triangle{&mesh, static_cast<uint32_t>(t)};
+          });
+  std::vector<const Primitive *> ret(triangles.size());
+  for (size_t t = 0; t < ret.size(); ++t) ret[t] = &triangles[t];
+  return ret;
+}
+
+TriangleMesh *create_triangle_mesh(Point3fArray positions,
+                                   std::vector<uint32_t> indices) {
+  return GlobalMemoryArena::instance().allocObject<TriangleMesh>(
+      std::move(positions), std::move(indices));
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(TriangleMesh, [] {
+  DAKKU_INFO("register TriangleMesh");
+  auto &state = Lua::instance().get_state();
+  state.new_usertype<TriangleMesh>(
+      "TriangleMesh", sol::no_constructor, "n_vertices",
+      &TriangleMesh::n_vertices, "n_triangles", &TriangleMesh::n_triangles,
+      "bounds", &TriangleMesh::world_bound, "transform", &lua_transform,
+      "memory_bytes", &TriangleMesh::memory_bytes);
+  // lua indices are 1-based, they are checked here since traversal trusts
+  // them
+  state.set_function(
+      "_create_triangle_mesh",
+      [](const Point3fArray &positions, const sol::table &table) {
+        if (table.size() % 3 != 0)
+          lua_error("index count {} is not a multiple of 3", table.size());
+        std::vector<uint32_t> indices(table.size());
+        for (size_t i = 0; i < indices.size(); ++i) {
+          const auto index = table.get<int64_t>(i + 1);
+          if (index < 1 || static_cast<size_t>(index) > positions.size())
+            lua_error("index {} out of range: {} not in [1, {}]", i + 1, index,
+                      positions.size());
+          indices[i] = static_cast<uint32_t>(index - 1);
+        }
+        return create_triangle_mesh(positions, std::move(indices));
+      });
+  state.set_function("_create_triangles", [](const TriangleMesh &mesh) {
+    return sol::as_table(create_triangles(mesh));
+  });
+  return 0;
+});
+}  // namespace dakku
@@ -0,0 +1,218 @@
+#ifndef DAKKU_CORE_MESH_H_
+#define DAKKU_CORE_MESH_H_
+#include <core/primitive.h>
+#include <core/vector_array.h>
+
+#include <span>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief encode a unit normal to 32 bits, the normal is projected to the
+ * octahedron, unfolded to $[-1, 1]^2$ and stored as two 16-bit snorms
+ *
+ */
+DAKKU_EXPORT_CORE uint32_t encode_octahedral(const Normal3f &n);
+
+/**
+ * @brief decode a normal packed by `encode_octahedral` (normalized)
+ *
+ */
+DAKKU_EXPORT_CORE Normal3f decode_octahedral(uint32_t bits);
+
+/**
+ * @brief indexed triangle mesh stored as structure of arrays: packed
+ * positions, 32-bit indices, octahedral normals (32 bits per vertex) and half
+ * float uvs (32 bits per vertex), normals and uvs are optional
+ * the vertices are expected in world space (see `transform`), so that
+ * intersections need no per hit transforms
+ *
+ */
+class DAKKU_EXPORT_CORE TriangleMesh {
+ public:
+  TriangleMesh() = default;
+
+  /**
+   * @brief Construct a new Triangle Mesh object with zero filled arrays
+   *
+   */
+  TriangleMesh(size_t n_vertices, size_t n_triangles, bool has_normals = false,
+               bool has_uvs = false);
+
+  /**
+   * @brief Construct a new Triangle Mesh object from positions and a
+   * triangle list (three indices per triangle)
+   *
+   */
+  TriangleMesh(Point3fArray positions, std::vector<uint32_t> indices);
+
+  /**
+   * @brief resize the arrays (the vertices and triangles are kept)
+   *
+   */
+  void resize(size_t n_vertices, size_t n_triangles, bool has_normals,
+              bool has_uvs);
+
+  [[nodiscard]] size_t n_vertices() const { return positions.size(); }
+  [[nodiscard]] size_t n_triangles() const { return indices.size() / 3; }
+  [[nodiscard]] bool has_normals() const { return !normals.empty(); }
+  [[nodiscard]] bool has_uvs() const { return !uvs.empty(); }
+
+  [[nodiscard]] Point3f position(size_t i) const { return positions.get(i); }
+  void set_position(size_t i, const Point3f &p) { positions.set(i, p); }
+
+  [[nodiscard]] Normal3f normal(size_t i) const {
+    return decode_octahedral(normals[i]);
+  }
+  void set_normal(size_t i, const Normal3f &n) {
+    normals[i] = encode_octahedral(n);
+  }
+
+  [[nodiscard]] Point2f uv(size_t i) const {
+    return Point2f{half_to_float(uvs[2 * i]), half_to_float(uvs[2 * i + 1])};
+  }
+  void set_uv(size_t i, const Point2f &uv) {
+    uvs[2 * i] = float_to_half(uv.x());
+    uvs[2 * i + 1] = float_to_half(uv.y());
+  }
+
+  /**
+   * @brief get the vertex indices of triangle `t`
+   *
+   */
+  [[nodiscard]] std::array<uint32_t, 3> triangle(size_t t) const {
+    return {indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]};
+  }
+  void set_triangle(size_t t, uint32_t v0, uint32_t v1, uint32_t v2) {
+    indices[3 * t] = v0;
+    indices[3 * t + 1] = v1;
+    indices[3 * t + 2] = v2;
+  }
+
+  /// raw positions (x0, y0, z0, x1, ...), for bulk loading
+  [[nodiscard]] std::span<float> position_data() { return positions.data(); }
+  /// raw indices (three per triangle), for bulk loading
+  [[nodiscard]] std::span<uint32_t> index_data() { return indices; }
+  /// raw octahedral normals, for bulk loading
+  [[nodiscard]] std::span<uint32_t> normal_data() { return normals; }
+  /// raw half float uvs (u0, v0, u1, ...), for bulk loading
+  [[nodiscard]] std::span<uint16_t> uv_data() { return uvs; }
+
+  /**
+   * @brief get the bounds of triangle `t`
+   *
+   */
+  [[nodiscard]] Bounds3f triangle_bound(size_t t) const;
+
+  /**
+   * @brief get the bounds of all triangles, computed in parallel
+   *
+   */
+  [[nodiscard]] Bounds3f world_bound() const;
+
+  /**
+   * @brief bake an affine transform (row major $3 \times 4$ matrix) into the
+   * vertices, normals are transformed by the inverse transpose
+   *
+   */
+  void transform(std::span<const float, 12> m);
+
+  /**
+   * @brief check that all indices refer to vertices
+   *
+   */
+  [[nodiscard]] bool is_valid() const;
+
+  /**
+   * @brief the number of bytes held by the arrays
+   *
+   */
+  [[nodiscard]] size_t memory_bytes() const;
+
+  /**
+   * @brief intersect the ray with triangle `t` (watertight is not
+   * guaranteed), on hit `ray.tMax` is shrunk to the hit
+   *
+   * @return the hit, `uv` holds the barycentrics of vertices 1 and 2
+   */
+  std::optional<RayHit> intersect(size_t t, const Ray &ray) const;
+
+  /**
+   * @brief check whether the ray hits triangle `t` in $(0, ray.tMax)$
+   *
+   */
+  [[nodiscard]] bool occluded(size_t t, const Ray &ray) const;
+
+  /**
+   * @brief get the unit normal of triangle `t` at barycentrics `b` (of
+   * vertices 1 and 2), interpolated from the vertex normals if there are any
+   *
+   */
+  [[nodiscard]] Normal3f surface_normal(size_t t, const Point2f &b) const;
+
+ private:
+  /// the hit distance and barycentrics of triangle `t`
+  [[nodiscard]] std::optional<std::array<float, 3>> hit(size_t t,
+                                                        const Ray &ray) const;
+
+  /// vertex positions
+  Point3fArray positions;
+  /// vertex indices, three per triangle
+  std::vector<uint32_t> indices;
+  /// octahedral vertex normals (empty if none)
+  std::vector<uint32_t> normals;
+  /// half float vertex uvs (empty if none)
+  std::vector<uint16_t> uvs;
+};
+
+/**
+ * @brief a triangle of a mesh, the primitive the accelerators are built over
+ *
+ */
+class DAKKU_EXPORT_CORE Triangle : public Primitive {
+ public:
+  Triangle(const TriangleMesh *mesh, uint32_t index)
+      : mesh(mesh), index(index) {}
+
+  [[nodiscard]] Bounds3f world_bound() const override {
+    return mesh->triangle_bound(index);
+  }
+
+  std::optional<RayHit> intersect(const Ray &ray) const override {
+    return mesh->intersect(index, ray);
+  }
+
+  [[nodiscard]] bool occluded(const Ray &ray) const override {
+    return mesh->occluded(index, ray);
+  }
+
+  [[nodiscard]] Normal3f normal(const Point3f &,
+                                const RayHit &hit) const override {
+    return mesh->surface_normal(index, hit.uv);
+  }
+
+  /// the mesh
+  const TriangleMesh *mesh;
+  /// triangle index in the mesh
+  uint32_t index;
+};
+
+/**
+ * @brief create the triangle primitives of a mesh (the mesh must outlive
+ * them), the triangles are stored in one contiguous arena block
+ *
+ */
+DAKKU_EXPORT_CORE std::vector<const Primitive *> create_triangles(
+    const TriangleMesh &mesh);
+
+/**
+ * @brief create a triangle mesh from positions and a triangle list
+ *
+ */
+DAKKU_EXPORT_CORE TriangleMesh *create_triangle_mesh(
+    Point3fArray positions, std::vector<uint32_t> indices);
+
+DAKKU_DECLARE_LUA_OBJECT(TriangleMesh, DAKKU_EXPORT_CORE);
+}  // namespace dakku
+#endif
@@ -0,0 +1,854 @@
+#include <core/mesh_loader.h>
+#include <core/stats.h>
+
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <sstream>
+
+#if defined(_WIN32) || defined(WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dakku {
+
+DAKKU_STAT_COUNTER("Mesh/Triangles loaded", triangles_loaded);
+DAKKU_STAT_COUNTER("Mesh/Bytes parsed", bytes_parsed);
+
+MappedFile::MappedFile(const std::string &path) {
+#if defined(_WIN32) || defined(WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+      // the view keeps the mapping alive after its handle is closed
+      HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping) {
+        data = static_cast<const char *>(
+            MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+      }
+      size = static_cast<size_t>(file_size.QuadPart);
+    }
+    CloseHandle(file);
+  }
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat st {};
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                     MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        data = static_cast<const char *>(p);
+        // the text parsers read through the file front to back
+        madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+      }
+      size = static_cast<size_t>(st.st_size);
+    }
+    close(fd);
+  }
+#endif
+  if (data) {
+    mapped = good = true;
+    return;
+  }
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return;
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  buffer = std::move(ss).str();
+  data = buffer.data();
+  size = buffer.size();
+  good = true;
+}
+
+MappedFile::~MappedFile() {
+  if (!mapped) return;
+#if defined(_WIN32) || defined(WIN32)
+  UnmapViewOfFile(data);
+#else
+  munmap(const_cast<char *>(data), size);
+#endif
+}
+
+namespace {
+/// split `data` into chunks of about `chunk_size` bytes that end after a
+/// line break (or at the end of `data`)
+std::vector<std::string_view> split_lines(std::string_view data,
+                                          size_t chunk_size) {
+  std::vector<std::string_view> chunks;
+  chunk_size = std::max<size_t>(chunk_size, 1);
+  size_t begin = 0;
+  while (begin < data.size()) {
+    size_t end = data.size();
+    if (data.size() - begin > chunk_size) {
+      const size_t eol = data.find('\n', begin + chunk_size - 1);
+      if (eol != std::string_view::npos) end = eol + 1;
+    }
+    chunks.push_back(data.substr(begin, end - begin));
+    begin = end;
+  }
+  return chunks;
+}
+
+/// call `f(line)` for every line of `chunk`, the line break (and a trailing
+/// `\r`) is removed
+template <typename F>
+void for_each_line(std::string_view chunk, F &&f) {
+  while (!chunk.empty()) {
+    const size_t eol = chunk.find('\n');
+    std::string_view line = chunk.substr(0, eol);
+    chunk.remove_prefix(eol == std::string_view::npos ? chunk.size()
+                                                      : eol + 1);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    f(line);
+  }
+}
+
+/// check whether the line holds anything but whitespace
+bool is_blank(std::string_view line) {
+  return line.find_first_not_of(" \t") == std::string_view::npos;
+}
+
+/// whitespace separated tokens of a line
+class Tokens {
+ public:
+  explicit Tokens(std::string_view line) : line(line) {}
+
+  /// the next token (empty at the end of the line)
+  std::string_view next() {
+    skip();
+    const size_t n = std::min(line.find_first_of(" \t"), line.size());
+    std::string_view ret = line.substr(0, n);
+    line.remove_prefix(n);
+    return ret;
+  }
+
+  /// parse the next token as a number
+  template <typename T>
+  bool get(T &v) {
+    skip();
+    if (!line.empty() && line.front() == '+') line.remove_prefix(1);
+    auto [next, ec] =
+        std::from_chars(line.data(), line.data() + line.size(), v);
+    line.remove_prefix(next - line.data());
+    return ec == std::errc{};
+  }
+
+ private:
+  void skip() {
+    line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+  }
+
+  std::string_view line;
+};
+
+/// exclusive prefix sums, `counts` is replaced by the offsets and the total
+/// is returned
+size_t exclusive_scan(std::vector<size_t> &counts) {
+  size_t sum = 0;
+  for (size_t &c : counts) sum += std::exchange(c, sum);
+  return sum;
+}
+
+/// ply scalar types
+enum class PlyType : uint8_t {
+  INT8,
+  UINT8,
+  INT16,
+  UINT16,
+  INT32,
+  UINT32,
+  FLOAT32,
+  FLOAT64,
+  INVALID
+};
+
+PlyType parse_ply_type(std::string_view name) {
+  static constexpr std::pair<std::string_view, PlyType> types[] = {
+      {"char", PlyType::INT8},      {"int8", PlyType::INT8},
+      {"uchar", PlyType::UINT8},    {"uint8", PlyType::UINT8},
+      {"short", PlyType::INT16},    {"int16", PlyType::INT16},
+      {"ushort", PlyType::UINT16},  {"uint16", PlyType::UINT16},
+      {"int", PlyType::INT32},      {"int32", PlyType::INT32},
+      {"uint", PlyType::UINT32},    {"uint32", PlyType::UINT32},
+      {"float", PlyType::FLOAT32},  {"float32", PlyType::FLOAT32},
+      {"double", PlyType::FLOAT64}, {"float64", PlyType::FLOAT64}};
+  for (const auto &[n, t] : types)
+    if (n == name) return t;
+  return PlyType::INVALID;
+}
+
+size_t ply_type_size(PlyType type) {
+  switch (type) {
+    case PlyType::INT8:
+    case PlyType::UINT8:
+      return 1;
+    case PlyType::INT16:
+    case PlyType::UINT16:
+      return 2;
+    case PlyType::INT32:
+    case PlyType::UINT32:
+    case PlyType::FLOAT32:
+      return 4;
+    case PlyType::FLOAT64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/// read a binary ply value, `swap` if the file endianness is not native
+double read_ply_value(const char *p, PlyType type, bool swap) {
+  char bytes[8];
+  const size_t n = ply_type_size(type);
+  std::memcpy(bytes, p, n);
+  if (swap) std::reverse(bytes, bytes + n);
+  auto as = [&bytes]<typename T>(T v) {
+    std::memcpy(&v, bytes, sizeof(T));
+    return static_cast<double>(v);
+  };
+  switch (type) {
+    case PlyType::INT8:
+      return as(int8_t{});
+    case PlyType::UINT8:
+      return as(uint8_t{});
+    case PlyType::INT16:
+      return as(int16_t{});
+    case PlyType::UINT16:
+      return as(uint16_t{});
+    case PlyType::INT32:
+      return as(int32_t{});
+    case PlyType::UINT32:
+      return as(uint32_t{});
+    case PlyType::FLOAT32:
+      return as(float{});
+    default:
+      return as(double{});
+  }
+}
+
+/// read a binary ply list count or vertex index, nothing unless it is in
+/// $[0, limit)$: casting negative, nan or huge values is undefined
+std::optional<size_t> read_ply_index(const char *p, PlyType type, bool swap,
+                                     size_t limit) {
+  const double v = read_ply_value(p, type, swap);
+  if (!(v >= 0 && v < static_cast<double>(limit))) return {};
+  return static_cast<size_t>(v);
+}
+
+struct PlyProperty {
+  std::string name;
+  /// value type (element type of lists)
+  PlyType type;
+  /// count type of lists, `INVALID` for scalars
+  PlyType count_type{PlyType::INVALID};
+
+  [[nodiscard]] bool is_list() const {
+    return count_type != PlyType::INVALID;
+  }
+};
+
+struct PlyElement {
+  std::string name;
+  size_t count{0};
+  std::vector<PlyProperty> properties;
+
+  /// index of property `name` (-1 if absent)
+  [[nodiscard]] int find(std::initializer_list<std::string_view> names) const {
+    for (size_t i = 0; i < properties.size(); ++i)
+      for (auto name : names)
+        if (properties[i].name == name) return static_cast<int>(i);
+    return -1;
+  }
+
+  /// bytes per binary record, 0 if the records have lists
+  [[nodiscard]] size_t stride() const {
+    size_t ret = 0;
+    for (const auto &p : properties) {
+      if (p.is_list()) return 0;
+      ret += ply_type_size(p.type);
+    }
+    return ret;
+  }
+};
+
+enum class PlyFormat { ASCII, BINARY_LITTLE_ENDIAN, BINARY_BIG_ENDIAN };
+
+struct PlyHeader {
+  PlyFormat format{PlyFormat::ASCII};
+  std::vector<PlyElement> elements;
+  /// the data after `end_header`
+  std::string_view body;
+};
+
+std::optional<PlyHeader> parse_ply_header(std::string_view data) {
+  PlyHeader header;
+  bool has_format = false;
+  size_t line_no = 0;
+  while (!data.empty()) {
+    const size_t eol = data.find('\n');
+    if (eol == std::string_view::npos) break;
+    std::string_view line = data.substr(0, eol);
+    data.remove_prefix(eol + 1);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    Tokens tokens{line};
+    const std::string_view keyword = tokens.next();
+    if (line_no++ == 0) {
+      if (keyword != "ply") break;
+    } else if (keyword == "format") {
+      const std::string_view format = tokens.next();
+      if (format == "ascii") {
+        header.format = PlyFormat::ASCII;
+      } else if (format == "binary_little_endian") {
+        header.format = PlyFormat::BINARY_LITTLE_ENDIAN;
+      } else if (format == "binary_big_endian") {
+        header.format = PlyFormat::BINARY_BIG_ENDIAN;
+      } else {
+        DAKKU_ERR("ply: unknown format {}", format);
+        return {};
+      }
+      has_format = true;
+    } else if (keyword == "element") {
+      PlyElement &element = header.elements.emplace_back();
+      element.name = tokens.next();
+      if (!tokens.get(element.count)) {
+        DAKKU_ERR("ply: invalid element line \"{}\"", line);
+        return {};
+      }
+    } else if (keyword == "property") {
+      if (header.elements.empty()) {
+        DAKKU_ERR("ply: property before any element");
+        return {};
+      }
+      PlyProperty property;
+      std::string_view type = tokens.next();
+      if (type == "list") {
+        property.count_type = parse_ply_type(tokens.next());
+        if (property.count_type == PlyType::INVALID) {
+          DAKKU_ERR("ply: invalid property line \"{}\"", line);
+          return {};
+        }
+        type = tokens.next();
+      }
+      property.type = parse_ply_type(type);
+      property.name = tokens.next();
+      if (property.type == PlyType::INVALID || property.name.empty()) {
+        DAKKU_ERR("ply: invalid property line \"{}\"", line);
+        return {};
+      }
+      header.elements.back().properties.push_back(std::move(property));
+    } else if (keyword == "end_header") {
+      if (!has_format) break;
+      header.body = data;
+      return header;
+    }
+    // comments, obj_info and unknown keywords are skipped
+  }
+  DAKKU_ERR("ply: invalid header");
+  return {};
+}
+
+/// where the attributes of a ply vertex are, as property indices
+struct PlyVertexLayout {
+  std::array<int, 3> position;
+  std::array<int, 3> normal;
+  std::array<int, 2> uv;
+
+  explicit PlyVertexLayout(const PlyElement &e)
+      : position{e.find({"x"}), e.find({"y"}), e.find({"z"})},
+        normal{e.find({"nx"}), e.find({"ny"}), e.find({"nz"})},
+        uv{e.find({"u", "s", "texture_u", "texture_s"}),
+           e.find({"v", "t", "texture_v", "texture_t"})} {}
+
+  [[nodiscard]] bool has_position() const {
+    return std::ranges::none_of(position, [](int i) { return i < 0; });
+  }
+  [[nodiscard]] bool has_normal() const {
+    return std::ranges::none_of(normal, [](int i) { return i < 0; });
+  }
+  [[nodiscard]] bool has_uv() const {
+    return std::ranges::none_of(uv, [](int i) { return i < 0; });
+  }
+
+  /// store vertex `i` from its property values
+  void store(TriangleMesh &mesh, size_t i, const double *values) const {
+    auto get = [values](int j) { return static_cast<float>(values[j]); };
+    mesh.set_position(i, Point3f{get(position[0]), get(position[1]),
+                                 get(position[2])});
+    if (mesh.has_normals())
+      mesh.set_normal(i, Normal3f{get(normal[0]), get(normal[1]),
+                                  get(normal[2])});
+    if (mesh.has_uvs()) mesh.set_uv(i, Point2f{get(uv[0]), get(uv[1])});
+  }
+};
+
+/// index of the vertex index list of a face element (-1 if absent)
+int find_face_indices(const PlyElement &face) {
+  const int ret = face.find({"vertex_indices", "vertex_index"});
+  return ret >= 0 && face.properties[ret].is_list() ? ret : -1;
+}
+
+/// write the fan triangulation of a polygon to `out`
+template <typename F>
+uint32_t *triangulate(uint32_t n, F &&index, uint32_t *out) {
+  const uint32_t i0 = index(0);
+  for (uint32_t k = 1; k + 1 < n; ++k) {
+    *out++ = i0;
+    *out++ = index(k);
+    *out++ = index(k + 1);
+  }
+  return out;
+}
+
+bool parse_ply_binary(const PlyHeader &header, TriangleMesh &mesh) {
+  const bool swap = (header.format == PlyFormat::BINARY_BIG_ENDIAN) !=
+                    (std::endian::native == std::endian::big);
+  const char *p = header.body.data();
+  const char *const end = p + header.body.size();
+  const size_t n_vertices = mesh.n_vertices();
+  auto truncated = [] {
+    DAKKU_ERR("ply: unexpected end of file");
+    return false;
+  };
+  auto out_of_range = [] {
+    DAKKU_ERR("ply: vertex index out of range");
+    return false;
+  };
+  // the value count of property `prop` at `p`, advances `p` past the count,
+  // nothing if the values don't fit in the rest of the file
+  auto read_count = [&](const PlyProperty &prop) -> std::optional<size_t> {
+    if (!prop.is_list()) return 1;
+    const size_t count_size = ply_type_size(prop.count_type);
+    if (static_cast<size_t>(end - p) < count_size) return {};
+    const size_t room = static_cast<size_t>(end - p) - count_size;
+    auto n = read_ply_index(p, prop.count_type, swap,
+                            room / ply_type_size(prop.type) + 1);
+    p += count_size;
+    return n;
+  };
+  // skip the records of an element with list properties one by one
+  auto skip_records = [&](const PlyElement &e) {
+    for (size_t r = 0; r < e.count; ++r) {
+      for (const auto &prop : e.properties) {
+        const auto n = read_count(prop);
+        if (!n) return false;
+        p += *n * ply_type_size(prop.type);
+      }
+    }
+    return true;
+  };
+
+  for (const PlyElement &e : header.elements) {
+    const size_t stride = e.stride();
+    if (e.name == "vertex") {
+      if (stride == 0) {
+        DAKKU_ERR("ply: unsupported list property in the vertex element");
+        return false;
+      }
+      if (static_cast<size_t>(end - p) / stride < e.count) return truncated();
+      const PlyVertexLayout layout{e};
+      const bool packed = !swap && e.properties.size() == 3 &&
+                          layout.position == std::array{0, 1, 2} &&
+                          std::ranges::all_of(e.properties, [](auto &prop) {
+                            return prop.type == PlyType::FLOAT32;
+                          });
+      if (packed) {
+        // the records are laid out exactly like the position array
+        std::memcpy(mesh.position_data().data(), p, e.count * stride);
+      } else {
+        std::vector<size_t> offsets(e.properties.size());
+        for (size_t j = 1; j < offsets.size(); ++j)
+          offsets[j] =
+              offsets[j - 1] + ply_type_size(e.properties[j - 1].type);
+        const char *records = p;
+        oneapi::tbb::parallel_for(
+            oneapi::tbb::blocked_range<size_t>(0, e.count, 4096),
+            [&](const oneapi::tbb::blocked_range<size_t> &r) {
+              std::vector<double> values(e.properties.size());
+              for (size_t i = r.begin(); i != r.end(); ++i) {
+                const char *record = records + i * stride;
+                for (size_t j = 0; j < values.size(); ++j)
+                  values[j] = read_ply_value(record + offsets[j],
+                                             e.properties[j].type, swap);
+                layout.store(mesh, i, values.data());
+              }
+            });
+      }
+      p += e.count * stride;
+    } else if (e.name == "face") {
+      const int list = find_face_indices(e);
+      if (list < 0) {
+        DAKKU_ERR("ply: faces without vertex indices");
+        return false;
+      }
+      const PlyProperty &indices = e.properties[list];
+      const size_t count_size = ply_type_size(indices.count_type);
+      const size_t index_size = ply_type_size(indices.type);
+      const size_t tri_stride = count_size + 3 * index_size;
+      // most meshes are triangles only: then the faces have a fixed stride
+      // and can be decoded in parallel
+      const bool fixed =
+          e.properties.size() == 1 &&
+          static_cast<size_t>(end - p) / tri_stride >= e.count &&
+          oneapi::tbb::parallel_reduce(
+              oneapi::tbb::blocked_range<size_t>(0, e.count, 1 << 16), true,
+              [&](const oneapi::tbb::blocked_range<size_t> &r, bool ok) {
+                for (size_t f = r.begin(); ok && f != r.end(); ++f)
+                  ok = read_ply_value(p + f * tri_stride, indices.count_type,
+                                      swap) == 3;
+                return ok;
+              },
+              std::logical_and<>{});
+      if (fixed) {
+        mesh.resize(mesh.n_vertices(), e.count, mesh.has_normals(),
+                    mesh.has_uvs());
+        const auto out = mesh.index_data();
+        const char *faces = p;
+        std::atomic<bool> ok{true};
+        oneapi::tbb::parallel_for(
+            oneapi::tbb::blocked_range<size_t>(0, e.count, 4096),
+            [&](const oneapi::tbb::blocked_range<size_t> &r) {
+              for (size_t f = r.begin(); f != r.end(); ++f) {
+                const char *face = faces + f * tri_stride + count_size;
+                for (size_t k = 0; k < 3; ++k) {
+                  const auto i = read_ply_index(face + k * index_size,
+                                                indices.type, swap, n_vertices);
+                  if (!i) ok = false;
+                  out[3 * f + k] = static_cast<uint32_t>(i.value_or(0));
+                }
+              }
+            });
+        if (!ok) return out_of_range();
+        p += e.count * tri_stride;
+        continue;
+      }
+      // polygons: triangulate sequentially
+      std::vector<uint32_t> triangles, polygon;
+      triangles.reserve(3 * e.count);
+      for (size_t f = 0; f < e.count; ++f) {
+        for (size_t j = 0; j < e.properties.size(); ++j) {
+          const PlyProperty &prop = e.properties[j];
+          const auto n = read_count(prop);
+          if (!n) return truncated();
+          const size_t size = ply_type_size(prop.type);
+          if (static_cast<int>(j) == list && *n >= 3) {
+            polygon.resize(*n);
+            for (size_t k = 0; k < *n; ++k) {
+              const auto i =
+                  read_ply_index(p + k * size, prop.type, swap, n_vertices);
+              if (!i) return out_of_range();
+              polygon[k] = static_cast<uint32_t>(*i);
+            }
+            const size_t offset = triangles.size();
+            triangles.resize(offset + 3 * (*n - 2));
+            triangulate(
+                static_cast<uint32_t>(*n),
+                [&](uint32_t k) { return polygon[k]; },
+                triangles.data() + offset);
+          }
+          p += *n * size;
+        }
+      }
+      mesh.resize(mesh.n_vertices(), triangles.size() / 3, mesh.has_normals(),
+                  mesh.has_uvs());
+      std::ranges::copy(triangles, mesh.index_data().begin());
+    } else if (stride != 0) {
+      if (static_cast<size_t>(end - p) / stride < e.count) return truncated();
+      p += e.count * stride;
+    } else if (!skip_records(e)) {
+      return truncated();
+    }
+  }
+  return true;
+}
+
+bool parse_ply_ascii(const PlyHeader &header, TriangleMesh &mesh,
+                     size_t chunk_size) {
+  const auto chunks = split_lines(header.body, chunk_size);
+  const size_t n_chunks = chunks.size();
+  // records of every element, in order
+  std::vector<size_t> element_begin(header.elements.size() + 1);
+  for (size_t k = 0; k < header.elements.size(); ++k)
+    element_begin[k + 1] = element_begin[k] + header.elements[k].count;
+  size_t vertex_element = header.elements.size();
+  size_t face_element = header.elements.size();
+  for (size_t k = 0; k < header.elements.size(); ++k) {
+    if (header.elements[k].name == "vertex") vertex_element = k;
+    if (header.elements[k].name == "face") face_element = k;
+  }
+  const bool has_faces = face_element < header.elements.size();
+  const int list = has_faces ? find_face_indices(header.elements[face_element])
+                             : -1;
+  std::optional<PlyVertexLayout> vertex_layout;
+  if (vertex_element < header.elements.size())
+    vertex_layout.emplace(header.elements[vertex_element]);
+  if (has_faces && list < 0) {
+    DAKKU_ERR("ply: faces without vertex indices");
+    return false;
+  }
+
+  // the element of record `record`
+  auto locate = [&](size_t record) {
+    const auto it = std::upper_bound(element_begin.begin() + 1,
+                                     element_begin.end(), record);
+    return static_cast<size_t>(it - element_begin.begin() - 1);
+  };
+  // the vertex count of a face line (0 if invalid)
+  auto polygon_size = [&](std::string_view line) {
+    Tokens tokens{line};
+    const PlyElement &face = header.elements[face_element];
+    for (int j = 0; j < static_cast<int>(face.properties.size()); ++j) {
+      size_t n = 1;
+      if (face.properties[j].is_list() && !tokens.get(n)) return size_t{0};
+      if (j == list) return n;
+      for (size_t k = 0; k < n; ++k) static_cast<void>(tokens.next());
+    }
+    return size_t{0};
+  };
+
+  // first pass: records per chunk, blank lines don't count
+  std::vector<size_t> record_offsets(n_chunks);
+  oneapi::tbb::parallel_for(size_t{0}, n_chunks, [&](size_t c) {
+    for_each_line(chunks[c], [&](std::string_view line) {
+      record_offsets[c] += !is_blank(line);
+    });
+  });
+  if (exclusive_scan(record_offsets) < element_begin.back()) {
+    DAKKU_ERR("ply: expect {} records", element_begin.back());
+    return false;
+  }
+
+  // second pass: triangles per chunk
+  std::vector<size_t> triangle_offsets(n_chunks);
+  if (has_faces) {
+    oneapi::tbb::parallel_for(size_t{0}, n_chunks, [&](size_t c) {
+      size_t record = record_offsets[c];
+      if (record >= element_begin[face_element + 1]) return;
+      for_each_line(chunks[c], [&](std::string_view line) {
+        if (is_blank(line)) return;
+        if (locate(record++) == face_element)
+          triangle_offsets[c] += std::max<size_t>(polygon_size(line), 2) - 2;
+      });
+    });
+  }
+  mesh.resize(mesh.n_vertices(), exclusive_scan(triangle_offsets),
+              mesh.has_normals(), mesh.has_uvs());
+
+  // third pass: vertices and indices
+  std::atomic<bool> ok{true};
+  const auto out = mesh.index_data();
+  oneapi::tbb::parallel_for(size_t{0}, n_chunks, [&](size_t c) {
+    size_t record = record_offsets[c];
+    uint32_t *tri = out.data() + 3 * triangle_offsets[c];
+    std::vector<double> values;
+    std::vector<uint32_t> polygon;
+    for_each_line(chunks[c], [&](std::string_view line) {
+      if (is_blank(line)) return;
+      const size_t r = record++;
+      const size_t k = locate(r);
+      if (k == vertex_element) {
+        const PlyElement &e = header.elements[k];
+        values.resize(e.properties.size());
+        Tokens tokens{line};
+        for (double &v : values)
+          if (!tokens.get(v)) {
+            DAKKU_ERR("ply: invalid vertex line \"{}\"", line);
+            ok = false;
+            return;
+          }
+        vertex_layout->store(mesh, r - element_begin[k], values.data());
+      } else if (k == face_element) {
+        const PlyElement &e = header.elements[k];
+        Tokens tokens{line};
+        for (int j = 0; j < static_cast<int>(e.properties.size()); ++j) {
+          size_t n = 1;
+          if (e.properties[j].is_list()) static_cast<void>(tokens.get(n));
+          if (j != list) {
+            for (size_t m = 0; m < n; ++m) static_cast<void>(tokens.next());
+            continue;
+          }
+          polygon.resize(n);
+          for (uint32_t &i : polygon)
+            if (!tokens.get(i)) {
+              DAKKU_ERR("ply: invalid face line \"{}\"", line);
+              ok = false;
+              return;
+            }
+          if (n >= 3)
+            tri = triangulate(
+                static_cast<uint32_t>(n),
+                [&](uint32_t m) { return polygon[m]; }, tri);
+        }
+      }
+    });
+  });
+  return ok;
+}
+
+/// parse an obj face index (`v`, `v/vt`, `v//vn` or `v/vt/vn`), negative
+/// indices are relative to `n_vertices`, the vertices before the face
+bool parse_obj_index(std::string_view token, size_t n_vertices,
+                     uint32_t &index) {
+  int64_t i;
+  auto [next, ec] =
+      std::from_chars(token.data(), token.data() + token.size(), i);
+  if (ec != std::errc{} || i == 0) return false;
+  index = static_cast<uint32_t>(
+      i > 0 ? i - 1 : static_cast<int64_t>(n_vertices) + i);
+  return true;
+}
+}  // namespace
+
+bool parse_ply(std::string_view data, TriangleMesh &mesh, size_t chunk_size) {
+  auto header = parse_ply_header(data);
+  if (!header) return false;
+  const auto vertex = std::ranges::find(header->elements, "vertex",
+                                        &PlyElement::name);
+  if (vertex == header->elements.end()) {
+    DAKKU_ERR("ply: no vertex element");
+    return false;
+  }
+  const PlyVertexLayout layout{*vertex};
+  if (!layout.has_position()) {
+    DAKKU_ERR("ply: vertices without positions");
+    return false;
+  }
+  mesh.resize(vertex->count, 0, layout.has_normal(), layout.has_uv());
+  const bool ok = header->format == PlyFormat::ASCII
+                      ? parse_ply_ascii(*header, mesh, chunk_size)
+                      : parse_ply_binary(*header, mesh);
+  if (!ok) return false;
+  if (!mesh.is_valid()) {
+    DAKKU_ERR("ply: vertex index out of range");
+    return false;
+  }
+  DAKKU_STAT_ADD(bytes_parsed, data.size());
+  DAKKU_STAT_ADD(triangles_loaded, mesh.n_triangles());
+  return true;
+}
+
+bool parse_obj(std::string_view data, TriangleMesh &mesh, size_t chunk_size) {
+  const auto chunks = split_lines(data, chunk_size);
+  const size_t n_chunks = chunks.size();
+  // first pass: vertices and triangles per chunk
+  std::vector<size_t> vertex_offsets(n_chunks), triangle_offsets(n_chunks);
+  oneapi::tbb::parallel_for(size_t{0}, n_chunks, [&](size_t c) {
+    for_each_line(chunks[c], [&](std::string_view line) {
+      Tokens tokens{line};
+      const std::string_view keyword = tokens.next();
+      if (keyword == "v") {
+        ++vertex_offsets[c];
+      } else if (keyword == "f") {
+        size_t n = 0;
+        while (!tokens.next().empty()) ++n;
+        triangle_offsets[c] += std::max<size_t>(n, 2) - 2;
+      }
+    });
+  });
+  const size_t n_vertices = exclusive_scan(vertex_offsets);
+  const size_t n_triangles = exclusive_scan(triangle_offsets);
+  mesh.resize(n_vertices, n_triangles, false, false);
+
+  // second pass: each chunk writes from its prefix sums
+  std::atomic<bool> ok{true};
+  const auto out = mesh.index_data();
+  oneapi::tbb::parallel_for(size_t{0}, n_chunks, [&](size_t c) {
+    size_t vertex = vertex_offsets[c];
+    uint32_t *tri = out.data() + 3 * triangle_offsets[c];
+    std::vector<uint32_t> polygon;
+    for_each_line(chunks[c], [&](std::string_view line) {
+      Tokens tokens{line};
+      const std::string_view keyword = tokens.next();
+      if (keyword == "v") {
+        Point3f p;
+        for (size_t j = 0; j < 3; ++j)
+          if (!tokens.get(p[j])) {
+            DAKKU_ERR("obj: invalid vertex line \"{}\"", line);
+            ok = false;
+          }
+        mesh.set_position(vertex++, p);
+      } else if (keyword == "f") {
+        polygon.clear();
+        for (auto token = tokens.next(); !token.empty(); token = tokens.next())
+          if (!parse_obj_index(token, vertex, polygon.emplace_back())) {
+            DAKKU_ERR("obj: invalid face line \"{}\"", line);
+            ok = false;
+          }
+        if (polygon.size() >= 3)
+          tri = triangulate(
+              static_cast<uint32_t>(polygon.size()),
+              [&](uint32_t k) { return polygon[k]; }, tri);
+      }
+    });
+  });
+  if (!ok) return false;
+  if (!mesh.is_valid()) {
+    DAKKU_ERR("obj: vertex index out of range");
+    return false;
+  }
+  DAKKU_STAT_ADD(bytes_parsed, data.size());
+  DAKKU_STAT_ADD(triangles_loaded, mesh.n_triangles());
+  return true;
+}
+
+std::shared_ptr<TriangleMesh> load_mesh(const std::string &path) {
+  MappedFile file{path};
+  if (!file.is_good()) {
+    DAKKU_ERR("cannot open {}", path);
+    return nullptr;
+  }
+  auto ext = std::filesystem::path(path).extension().string();
+  std::ranges::transform(ext, ext.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  auto mesh = std::make_shared<TriangleMesh>();
+  bool ok;
+  if (ext == ".ply") {
+    ok = parse_ply(file.view(), *mesh);
+  } else if (ext == ".obj") {
+    ok = parse_obj(file.view(), *mesh);
+  } else {
+    DAKKU_ERR("unsupported mesh format {}", path);
+    return nullptr;
+  }
+  if (!ok) {
+    DAKKU_ERR("cannot load mesh {}", path);
+    return nullptr;
+  }
+  DAKKU_INFO("load mesh {}: {} vertices, {} triangles", path,
+             mesh->n_vertices(), mesh->n_triangles());
+  return mesh;
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(MeshLoader, [] {
+  DAKKU_INFO("register MeshLoader");
+  auto &lua = Lua::instance().get_state();
+  lua.new_usertype<MeshAsset>("MeshAsset", "ready", &MeshAsset::ready, "get",
+                              &MeshAsset::get);
+  lua.set_function("_load_mesh", &load_mesh);
+  lua.set_function("_load_mesh_async", [](const std::string &path) {
+    return AssetLoader::instance().submit([path] { return load_mesh(path); });
+  });
+  return 0;
+});
+}  // namespace dakku
@@ -0,0 +1,89 @@
+#ifndef DAKKU_CORE_MESH_LOADER_H_
+#define DAKKU_CORE_MESH_LOADER_H_
+#include <core/asset_loader.h>
+#include <core/mesh.h>
+
+#include <memory>
+#include <string_view>
+
+namespace dakku {
+
+/**
+ * @brief a read only view of a whole file, memory mapped where supported
+ * (falls back to reading the file into memory)
+ *
+ */
+class DAKKU_EXPORT_CORE MappedFile {
+ public:
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /**
+   * @brief check whether the file could be opened
+   *
+   */
+  [[nodiscard]] bool is_good() const { return good; }
+
+  /**
+   * @brief get the bytes of the file
+   *
+   */
+  [[nodiscard]] std::string_view view() const { return {data, size}; }
+
+ private:
+  /// first byte
+  const char *data{nullptr};
+  /// the number of bytes
+  size_t size{0};
+  /// whether `data` is a mapping (otherwise it points to `buffer`)
+  bool mapped{false};
+  /// whether the file could be opened
+  bool good{false};
+  /// file contents when mapping is not available
+  std::string buffer;
+};
+
+/// default size of the chunks that text meshes are parsed in
+inline constexpr size_t MESH_CHUNK_SIZE = 1 << 22;
+
+/**
+ * @brief parse a PLY mesh (ascii, binary little or big endian), vertex
+ * positions, normals (`nx`, `ny`, `nz`) and uvs (`u`/`s`/`texture_u`, ...)
+ * are read, polygons are triangulated as fans
+ * binary vertices are decoded in parallel, ascii bodies are parsed in
+ * parallel chunks of about `chunk_size` bytes split at line boundaries
+ *
+ * @return whether the mesh is parsed
+ */
+DAKKU_EXPORT_CORE bool parse_ply(std::string_view data, TriangleMesh &mesh,
+                                 size_t chunk_size = MESH_CHUNK_SIZE);
+
+/**
+ * @brief parse a Wavefront OBJ mesh, only vertex positions (`v`) and faces
+ * (`f`, position indices, negative ones are relative) are read, polygons are
+ * triangulated as fans
+ * the file is parsed in parallel chunks of about `chunk_size` bytes split at
+ * line boundaries, a counting pass places each chunk with prefix sums over
+ * the vertex and triangle counts
+ *
+ * @return whether the mesh is parsed
+ */
+DAKKU_EXPORT_CORE bool parse_obj(std::string_view data, TriangleMesh &mesh,
+                                 size_t chunk_size = MESH_CHUNK_SIZE);
+
+/**
+ * @brief load a `.ply` or `.obj` mesh through a memory mapping, safe to call
+ * from the asset loader's worker threads
+ *
+ * @return the mesh (nullptr on failure)
+ */
+DAKKU_EXPORT_CORE std::shared_ptr<TriangleMesh> load_mesh(
+    const std::string &path);
+
+/// handle to a mesh loaded in the background
+using MeshAsset = AssetHandle<std::shared_ptr<TriangleMesh>>;
+DAKKU_DECLARE_LUA_OBJECT(MeshLoader, DAKKU_EXPORT_CORE);
+}  // namespace dakku
+#endif
@@ -0,0 +1,74 @@
+#ifndef DAKKU_CORE_PRIMITIVE_H_
+#define DAKKU_CORE_PRIMITIVE_H_
+#include <core/bounds.h>
+#include <core/ray.h>
+
+#include <optional>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief the closest hit of a ray
+ *
+ */
+struct RayHit {
+  /// ray parameter of the hit
+  float t{INF};
+  /// parametric coordinates on the primitive
+  Point2f uv;
+  /// index of the primitive (in the list the accelerator was built from)
+  uint32_t prim_id{0};
+};
+
+/**
+ * @brief something rays can hit, the unit the accelerators are built over
+ *
+ */
+class DAKKU_EXPORT_CORE Primitive {
+ public:
+  virtual ~Primitive() = default;
+
+  /**
+   * @brief get the world space bounds of the primitive
+   *
+   */
+  [[nodiscard]] virtual Bounds3f world_bound() const = 0;
+
+  /**
+   * @brief intersect the ray with the primitive, only hits in
+   * $(0, ray.tMax)$ count, on hit `ray.tMax` is shrunk to the hit
+   *
+   * @return the hit (`prim_id` is filled by the accelerator)
+   */
+  virtual std::optional<RayHit> intersect(const Ray &ray) const = 0;
+
+  /**
+   * @brief check whether the ray hits the primitive in $(0, ray.tMax)$
+   *
+   */
+  [[nodiscard]] virtual bool occluded(const Ray &ray) const = 0;
+
+  /**
+   * @brief get the unit surface normal at a hit of the primitive
+   *
+   * @param p the hit point
+   * @param hit the hit returned by `intersect`
+   */
+  [[nodiscard]] virtual Normal3f normal(const Point3f &p,
+                                        const RayHit &hit) const = 0;
+};
+
+/**
+ * @brief get the primitives of a lua array
+ *
+ */
+inline std::vector<const Primitive *> primitives_from_lua(
+    const sol::table &table) {
+  std::vector<const Primitive *> ret(table.size());
+  for (size_t i = 0; i < ret.size(); ++i)
+    ret[i] = table.get<const Primitive *>(i + 1);
+  return ret;
+}
+}  // namespace dakku
+#endif
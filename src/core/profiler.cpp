@@ -0,0 +1,128 @@
+#include <core/profiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/time.h>
+/// `setitimer`/`SIGPROF` sampling is available
+#define DAKKU_ENABLE_PROFILER
+#endif
+
+namespace dakku {
+
+namespace {
+/// samples per phase combination, written by the signal handler
+std::array<std::atomic<uint64_t>, Profiler::N_STATES> profile_samples{};
+
+/// the names of the phases of `state` joined by `separator`, in nesting order
+std::string state_name(uint32_t state, std::string_view separator) {
+  std::string ret;
+  for (size_t i = 0; i < PROF_NAMES.size(); ++i) {
+    if (!(state & (1u << i))) continue;
+    if (!ret.empty()) ret += separator;
+    ret += PROF_NAMES[i];
+  }
+  return ret.empty() ? "Untracked" : ret;
+}
+
+#ifdef DAKKU_ENABLE_PROFILER
+/// `SIGPROF` handler, only touches static tls and lock free atomics
+void sample_handler(int) {
+  profile_samples[profiler_state & (Profiler::N_STATES - 1)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+#endif
+}  // namespace
+
+Profiler &Profiler::instance() {
+  static Profiler _instance;
+  return _instance;
+}
+
+void Profiler::start(int frequency) {
+  if (running) return;
+#ifdef DAKKU_ENABLE_PROFILER
+  struct sigaction sa {};
+  sa.sa_handler = sample_handler;
+  sa.sa_flags = SA_RESTART;
+  sigfillset(&sa.sa_mask);
+  if (sigaction(SIGPROF, &sa, nullptr) != 0) {
+    DAKKU_ERR("cannot install the SIGPROF handler");
+    return;
+  }
+  itimerval timer{};
+  timer.it_interval.tv_usec = 1000000 / std::clamp(frequency, 1, 1000000);
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    DAKKU_ERR("cannot start the profiling timer");
+    return;
+  }
+  running = true;
+#else
+  static_cast<void>(frequency);
+  DAKKU_WARN("the sampling profiler is not supported on this platform");
+#endif
+}
+
+void Profiler::stop() {
+  if (!running) return;
+#ifdef DAKKU_ENABLE_PROFILER
+  itimerval timer{};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  signal(SIGPROF, SIG_IGN);
+#endif
+  running = false;
+}
+
+void Profiler::report() const {
+  std::vector<std::pair<uint64_t, uint32_t>> states;
+  uint64_t total = 0;
+  std::array<uint64_t, PROF_NAMES.size()> inclusive{};
+  for (uint32_t s = 0; s < N_STATES; ++s) {
+    const uint64_t n = samples(s);
+    if (n == 0) continue;
+    states.emplace_back(n, s);
+    total += n;
+    for (size_t i = 0; i < inclusive.size(); ++i)
+      if (s & (1u << i)) inclusive[i] += n;
+  }
+  if (total == 0) return;
+  std::ranges::sort(states, std::greater{});
+  auto percent = [total](uint64_t n) { return 100.0 * n / total; };
+  DAKKU_INFO("profile ({} samples):", total);
+  DAKKU_INFO("  inclusive");
+  for (size_t i = 0; i < inclusive.size(); ++i)
+    if (inclusive[i] > 0)
+      DAKKU_INFO("    {:<54} {:6.2f}% ({})", PROF_NAMES[i],
+                 percent(inclusive[i]), inclusive[i]);
+  DAKKU_INFO("  exclusive");
+  for (const auto &[n, s] : states)
+    DAKKU_INFO("    {:<54} {:6.2f}% ({})", state_name(s, " / "), percent(n),
+               n);
+}
+
+bool Profiler::write_collapsed(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out) {
+    DAKKU_ERR("cannot create {}", path);
+    return false;
+  }
+  for (uint32_t s = 0; s < N_STATES; ++s)
+    if (const uint64_t n = samples(s); n > 0)
+      out << "dakku;" << state_name(s, ";") << ' ' << n << '\n';
+  return static_cast<bool>(out);
+}
+
+uint64_t Profiler::samples(uint32_t state) const {
+  return profile_samples[state & (N_STATES - 1)].load(
+      std::memory_order_relaxed);
+}
+
+void Profiler::clear() {
+  for (auto &n : profile_samples) n.store(0, std::memory_order_relaxed);
+}
+}  // namespace dakku
@@ -0,0 +1,144 @@
+#ifndef DAKKU_CORE_PROFILER_H_
+#define DAKKU_CORE_PROFILER_H_
+#include <core/logger.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace dakku {
+
+/**
+ * @brief profiled render phases, the nesting order of the phases is the
+ * order of the collapsed stacks
+ *
+ */
+enum class Prof : uint32_t {
+  SCENE_LOAD,
+  BVH_BUILD,
+  INTEGRATOR,
+  CAMERA_RAY,
+  TRAVERSAL,
+  SHADOW_TRAVERSAL,
+  SHADING,
+  FILM_ADD_SAMPLE,
+  FILM_MERGE,
+  IMAGE_WRITE,
+  COUNT
+};
+
+/// names of the profiled phases
+inline constexpr std::array<const char *, static_cast<size_t>(Prof::COUNT)>
+    PROF_NAMES{
+        "Scene loading",
+        "BVH construction",
+        "Integrator",
+        "Camera ray generation",
+        "BVH traversal",
+        "BVH shadow traversal",
+        "Shading",
+        "Film add sample",
+        "Film tile merge",
+        "Image writing",
+    };
+
+#if defined(__GNUC__)
+/// static tls model, so that the signal handler never allocates tls
+#define DAKKU_PROFILER_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define DAKKU_PROFILER_TLS
+#endif
+
+/// active phases of the calling thread (bit i for phase i)
+inline thread_local DAKKU_PROFILER_TLS uint32_t profiler_state = 0;
+
+/**
+ * @brief marks a phase as active for its scope, costs a couple of tls
+ * accesses, so it can stay in release builds
+ *
+ */
+class ProfilePhase {
+ public:
+  explicit ProfilePhase(Prof p) : mask(1u << static_cast<uint32_t>(p)) {
+    reset = (profiler_state & mask) == 0;
+    profiler_state |= mask;
+  }
+  ~ProfilePhase() {
+    if (reset) profiler_state &= ~mask;
+  }
+  ProfilePhase(const ProfilePhase &) = delete;
+  ProfilePhase &operator=(const ProfilePhase &) = delete;
+
+ private:
+  /// the phase bit
+  uint32_t mask;
+  /// whether the phase was inactive before (nested phases keep it set)
+  bool reset;
+};
+
+/**
+ * @brief sampling profiler, a `SIGPROF` timer (cpu time of the process)
+ * records the active phases of the interrupted thread, only available on
+ * posix systems
+ *
+ */
+class DAKKU_EXPORT_CORE Profiler {
+ public:
+  /// number of distinct phase combinations
+  static constexpr size_t N_STATES = size_t{1}
+                                     << static_cast<size_t>(Prof::COUNT);
+
+  /**
+   * @brief get profiler instance
+   *
+   */
+  static Profiler &instance();
+
+  /**
+   * @brief start sampling
+   *
+   * @param frequency samples per second of cpu time
+   */
+  void start(int frequency = 100);
+
+  /**
+   * @brief stop sampling
+   *
+   */
+  void stop();
+
+  /**
+   * @brief log the breakdown of the samples by phase combination
+   *
+   */
+  void report() const;
+
+  /**
+   * @brief write the samples as collapsed stacks (`a;b;c count` lines) for
+   * flamegraph tools
+   *
+   * @return whether the file has been written
+   */
+  [[nodiscard]] bool write_collapsed(const std::string &path) const;
+
+  /**
+   * @brief the number of samples taken while exactly the phases of `state`
+   * were active
+   *
+   */
+  [[nodiscard]] uint64_t samples(uint32_t state) const;
+
+  /**
+   * @brief drop all samples
+   *
+   */
+  void clear();
+
+ private:
+  Profiler() = default;
+
+  /// whether the timer is running
+  bool running{false};
+};
+}  // namespace dakku
+#endif
@@ -0,0 +1,361 @@
+#ifndef DAKKU_CORE_RAY_PACKET_H_
+#define DAKKU_CORE_RAY_PACKET_H_
+#include <core/ray.h>
+#include <core/simd.h>
+
+#include <span>
+
+namespace dakku {
+
+/**
+ * @brief SoA bundle of `N` 3d float vectors (or points)
+ *
+ * @tparam N lane count
+ */
+template <size_t N>
+struct Float3Packet {
+  /// lane alignment, so that full simd loads are aligned
+  static constexpr size_t ALIGN = std::min<size_t>(N, 16) * sizeof(float);
+
+  /**
+   * @brief get lane `i` as a `V` (`Point3f`, `Vector3f`, ...)
+   *
+   */
+  template <typename V>
+  V get(size_t i) const {
+    return V(x[i], y[i], z[i]);
+  }
+
+  /**
+   * @brief set lane `i`
+   *
+   */
+  template <typename V>
+  void set(size_t i, const V &v) {
+    x[i] = v.x();
+    y[i] = v.y();
+    z[i] = v.z();
+  }
+
+  /// x components
+  alignas(ALIGN) std::array<float, N> x{};
+  /// y components
+  alignas(ALIGN) std::array<float, N> y{};
+  /// z components
+  alignas(ALIGN) std::array<float, N> z{};
+};
+
+/**
+ * @brief a packet of `N` rays stored as structure of arrays
+ * lanes are processed with the widest simd type that fits `N`
+ *
+ * @tparam N lane count (4, 8 or 16)
+ */
+template <size_t N>
+requires(N == 4 || N == 8 || N == 16) class RayPacket {
+ public:
+  /// lane count
+  static constexpr size_t SIZE = N;
+  /// mask of all lanes
+  static constexpr uint32_t ALL = (1u << N) - 1;
+
+  /**
+   * @brief get the points on the rays at $t$ (same $t$ for all lanes)
+   *
+   */
+  Float3Packet<N> operator()(float t) const {
+    std::array<float, N> ts;
+    ts.fill(t);
+    return (*this)(ts);
+  }
+
+  /**
+   * @brief get the points on the rays at $t_i$
+   *
+   */
+  Float3Packet<N> operator()(const std::array<float, N> &t) const {
+    Float3Packet<N> ret;
+    alignas(Float3Packet<N>::ALIGN) std::array<float, N> ts = t;
+    for (size_t i = 0; i < N; i += W) {
+      Lanes tt = Lanes::load(&ts[i]);
+      (Lanes::load(&o.x[i]) + Lanes::load(&d.x[i]) * tt).store(&ret.x[i]);
+      (Lanes::load(&o.y[i]) + Lanes::load(&d.y[i]) * tt).store(&ret.y[i]);
+      (Lanes::load(&o.z[i]) + Lanes::load(&d.z[i]) * tt).store(&ret.z[i]);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief mask of the active lanes that have nans
+   *
+   */
+  [[nodiscard]] uint32_t nan_lanes() const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N; i += W) {
+      uint32_t m = nan_mask(Lanes::load(&o.x[i])) |
+                   nan_mask(Lanes::load(&o.y[i])) |
+                   nan_mask(Lanes::load(&o.z[i])) |
+                   nan_mask(Lanes::load(&d.x[i])) |
+                   nan_mask(Lanes::load(&d.y[i])) |
+                   nan_mask(Lanes::load(&d.z[i])) |
+                   nan_mask(Lanes::load(&tMax[i]));
+      mask |= m << i;
+    }
+    return mask & active;
+  }
+
+  /**
+   * @brief check whether any active ray has nans
+   *
+   */
+  [[nodiscard]] bool has_nans() const { return nan_lanes() != 0; }
+
+  /**
+   * @brief check whether lane `i` is active
+   *
+   */
+  [[nodiscard]] bool is_active(size_t i) const { return (active >> i) & 1; }
+
+  /**
+   * @brief set lane `i` to `ray` (the activity is not changed)
+   *
+   */
+  void set(size_t i, const Ray &ray) {
+    DAKKU_CHECK(i < N, "lane out of range: {} >= {}", i, N);
+    o.set(i, ray.o);
+    d.set(i, ray.d);
+    tMax[i] = ray.tMax;
+  }
+
+  /**
+   * @brief get the ray of lane `i`
+   *
+   */
+  [[nodiscard]] Ray get(size_t i) const {
+    DAKKU_CHECK(i < N, "lane out of range: {} >= {}", i, N);
+    return Ray{o.template get<Point3f>(i), d.template get<Vector3f>(i),
+               tMax[i]};
+  }
+
+  /**
+   * @brief load `rays` into the first `rays.size()` lanes and make exactly
+   * those lanes active
+   *
+   */
+  void gather(std::span<const Ray> rays) {
+    DAKKU_CHECK(rays.size() <= N, "too many rays: {} > {}", rays.size(), N);
+    for (size_t i = 0; i < rays.size(); ++i) set(i, rays[i]);
+    active = lane_mask(rays.size());
+  }
+
+  /**
+   * @brief load `rays[indices[i]]` into lane `i` and make exactly those lanes
+   * active
+   *
+   */
+  void gather(std::span<const Ray> rays, std::span<const uint32_t> indices) {
+    DAKKU_CHECK(indices.size() <= N, "too many rays: {} > {}", indices.size(),
+                N);
+    for (size_t i = 0; i < indices.size(); ++i) set(i, rays[indices[i]]);
+    active = lane_mask(indices.size());
+  }
+
+  /**
+   * @brief store the active lanes back to `rays` (lane `i` to `rays[i]`)
+   *
+   */
+  void scatter(std::span<Ray> rays) const {
+    for (size_t i = 0; i < rays.size() && i < N; ++i)
+      if (is_active(i)) rays[i] = get(i);
+  }
+
+  /**
+   * @brief store the active lanes back to `rays` (lane `i` to
+   * `rays[indices[i]]`)
+   *
+   */
+  void scatter(std::span<Ray> rays, std::span<const uint32_t> indices) const {
+    for (size_t i = 0; i < indices.size() && i < N; ++i)
+      if (is_active(i)) rays[indices[i]] = get(i);
+  }
+
+  /// ray origins
+  Float3Packet<N> o;
+  /// ray directions (note: they may not be normalized)
+  Float3Packet<N> d;
+  /// ray max times
+  alignas(Float3Packet<N>::ALIGN) mutable std::array<float, N> tMax{};
+  /// active lanes (bit i for lane i)
+  uint32_t active{0};
+
+ protected:
+  /// simd lanes used for the kernels
+  using Lanes = SimdFloatFor<N>;
+  /// simd width
+  static constexpr size_t W = std::min(N, SIMD_WIDTH);
+
+  /// mask of the first `n` lanes
+  static uint32_t lane_mask(size_t n) {
+    return n >= N ? ALL : (1u << n) - 1;
+  }
+};
+
+/**
+ * @brief a packet of `N` differential rays stored as structure of arrays
+ *
+ * @tparam N lane count (4, 8 or 16)
+ */
+template <size_t N>
+class RayDifferentialPacket : public RayPacket<N> {
+  using Lanes = typename RayPacket<N>::Lanes;
+  static constexpr size_t W = RayPacket<N>::W;
+
+ public:
+  /**
+   * @brief mask of the active lanes that have nans
+   *
+   */
+  [[nodiscard]] uint32_t nan_lanes() const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N; i += W) {
+      uint32_t m = 0;
+      for (const Float3Packet<N> *p :
+           {&rx_origin, &ry_origin, &rx_direction, &ry_direction})
+        m |= nan_mask(Lanes::load(&p->x[i])) |
+             nan_mask(Lanes::load(&p->y[i])) |
+             nan_mask(Lanes::load(&p->z[i]));
+      mask |= m << i;
+    }
+    return RayPacket<N>::nan_lanes() |
+           (mask & this->active & has_differentials);
+  }
+
+  /**
+   * @brief check whether any active ray differential has nans
+   *
+   */
+  [[nodiscard]] bool has_nans() const { return nan_lanes() != 0; }
+
+  /**
+   * @brief scale the differentials of all lanes, see
+   * `RayDifferential::scale_differentials`
+   *
+   * @param s scale
+   */
+  void scale_differentials(float s) {
+    const Lanes ss = Lanes::set1(s);
+    for (size_t i = 0; i < N; i += W) {
+      scale(rx_origin, this->o, ss, i);
+      scale(ry_origin, this->o, ss, i);
+      scale(rx_direction, this->d, ss, i);
+      scale(ry_direction, this->d, ss, i);
+    }
+  }
+
+  /**
+   * @brief set lane `i` to `ray` (the activity is not changed)
+   *
+   */
+  void set(size_t i, const RayDifferential &ray) {
+    RayPacket<N>::set(i, ray);
+    rx_origin.set(i, ray.rx_origin);
+    ry_origin.set(i, ray.ry_origin);
+    rx_direction.set(i, ray.rx_direction);
+    ry_direction.set(i, ray.ry_direction);
+    if (ray.has_differentials) {
+      has_differentials |= 1u << i;
+    } else {
+      has_differentials &= ~(1u << i);
+    }
+  }
+
+  /**
+   * @brief get the ray differential of lane `i`
+   *
+   */
+  [[nodiscard]] RayDifferential get(size_t i) const {
+    RayDifferential ret{this->o.template get<Point3f>(i),
+                        this->d.template get<Vector3f>(i), this->tMax[i]};
+    ret.has_differentials = (has_differentials >> i) & 1;
+    ret.rx_origin = rx_origin.template get<Point3f>(i);
+    ret.ry_origin = ry_origin.template get<Point3f>(i);
+    ret.rx_direction = rx_direction.template get<Vector3f>(i);
+    ret.ry_direction = ry_direction.template get<Vector3f>(i);
+    return ret;
+  }
+
+  /**
+   * @brief load `rays` into the first `rays.size()` lanes and make exactly
+   * those lanes active
+   *
+   */
+  void gather(std::span<const RayDifferential> rays) {
+    DAKKU_CHECK(rays.size() <= N, "too many rays: {} > {}", rays.size(), N);
+    for (size_t i = 0; i < rays.size(); ++i) set(i, rays[i]);
+    this->active = this->lane_mask(rays.size());
+  }
+
+  /**
+   * @brief load `rays[indices[i]]` into lane `i` and make exactly those lanes
+   * active
+   *
+   */
+  void gather(std::span<const RayDifferential> rays,
+              std::span<const uint32_t> indices) {
+    DAKKU_CHECK(indices.size() <= N, "too many rays: {} > {}", indices.size(),
+                N);
+    for (size_t i = 0; i < indices.size(); ++i) set(i, rays[indices[i]]);
+    this->active = this->lane_mask(indices.size());
+  }
+
+  /**
+   * @brief store the active lanes back to `rays` (lane `i` to `rays[i]`)
+   *
+   */
+  void scatter(std::span<RayDifferential> rays) const {
+    for (size_t i = 0; i < rays.size() && i < N; ++i)
+      if (this->is_active(i)) rays[i] = get(i);
+  }
+
+  /**
+   * @brief store the active lanes back to `rays` (lane `i` to
+   * `rays[indices[i]]`)
+   *
+   */
+  void scatter(std::span<RayDifferential> rays,
+               std::span<const uint32_t> indices) const {
+    for (size_t i = 0; i < indices.size() && i < N; ++i)
+      if (this->is_active(i)) rays[indices[i]] = get(i);
+  }
+
+  /// lanes that have differentials (bit i for lane i)
+  uint32_t has_differentials{0};
+  /// x sub ray origins (x + 1, y)
+  Float3Packet<N> rx_origin;
+  /// y sub ray origins (x, y + 1)
+  Float3Packet<N> ry_origin;
+  /// x sub ray directions
+  Float3Packet<N> rx_direction;
+  /// y sub ray directions
+  Float3Packet<N> ry_direction;
+
+ private:
+  /// $p = base + (p - base) s$ for lanes $[i, i + W)$
+  static void scale(Float3Packet<N> &p, const Float3Packet<N> &base,
+                    const Lanes &s, size_t i) {
+    for (auto [pc, bc] : {std::pair{&p.x, &base.x}, std::pair{&p.y, &base.y},
+                          std::pair{&p.z, &base.z}}) {
+      Lanes b = Lanes::load(&(*bc)[i]);
+      (b + (Lanes::load(&(*pc)[i]) - b) * s).store(&(*pc)[i]);
+    }
+  }
+};
+
+/// 4-wide ray packet
+using RayPacket4 = RayPacket<4>;
+/// 8-wide ray packet
+using RayPacket8 = RayPacket<8>;
+/// 16-wide ray packet
+using RayPacket16 = RayPacket<16>;
+}  // namespace dakku
+#endif
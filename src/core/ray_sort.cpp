@@ -0,0 +1,123 @@
+#include <core/ray_sort.h>
+#include <core/math_func.h>
+
+#include <oneapi/tbb/parallel_for.h>
+
+#include <vector>
+
+namespace dakku {
+
+namespace {
+/// keys per task of a radix sort pass
+constexpr size_t RADIX_CHUNK_SIZE = 16384;
+/// bits per radix sort pass
+constexpr int RADIX_BITS = 8;
+/// buckets per radix sort pass
+constexpr size_t RADIX_BUCKETS = size_t{1} << RADIX_BITS;
+
+/// quantize $v \in [0, 1]$ to `RAY_SORT_MORTON_BITS` bits (nan to 0)
+uint32_t quantize(float v) {
+  constexpr auto scale = static_cast<float>(1u << RAY_SORT_MORTON_BITS);
+  if (!(v > 0)) return 0;
+  return std::min(static_cast<uint32_t>(std::min(v, 1.0f) * scale),
+                  (1u << RAY_SORT_MORTON_BITS) - 1);
+}
+}  // namespace
+
+uint32_t ray_sort_key(const Point3f &o, const Vector3f &d,
+                      const Bounds3f &bounds) {
+  const uint32_t octant = static_cast<uint32_t>(d.x() < 0) |
+                          (static_cast<uint32_t>(d.y() < 0) << 1) |
+                          (static_cast<uint32_t>(d.z() < 0) << 2);
+  const Vector3f p = bounds.offset(o);
+  return (octant << (3 * RAY_SORT_MORTON_BITS)) |
+         encode_morton_3(quantize(p.x()), quantize(p.y()), quantize(p.z()));
+}
+
+void RadixSortScratch::reserve(size_t n) {
+  const size_t n_chunks = (n + RADIX_CHUNK_SIZE - 1) / RADIX_CHUNK_SIZE;
+  if (keys.size() < n) keys.resize(n);
+  if (values.size() < n) values.resize(n);
+  if (offsets.size() < n_chunks * RADIX_BUCKETS)
+    offsets.resize(n_chunks * RADIX_BUCKETS);
+}
+
+void radix_sort(std::span<uint32_t> keys, std::span<uint32_t> values,
+                RadixSortScratch &scratch, int key_bits) {
+  DAKKU_CHECK(keys.size() == values.size(), "size mismatch: {} != {}",
+              keys.size(), values.size());
+  const size_t n = keys.size();
+  const size_t n_chunks = (n + RADIX_CHUNK_SIZE - 1) / RADIX_CHUNK_SIZE;
+  scratch.reserve(n);
+  std::span<uint32_t> src_keys = keys, src_values = values;
+  std::span<uint32_t> dst_keys = std::span(scratch.keys).first(n);
+  std::span<uint32_t> dst_values = std::span(scratch.values).first(n);
+  const auto offsets =
+      std::span(scratch.offsets).first(n_chunks * RADIX_BUCKETS);
+  const auto chunks = oneapi::tbb::blocked_range<size_t>(0, n_chunks);
+  for (int shift = 0; shift < key_bits; shift += RADIX_BITS) {
+    // chunk histograms, an exclusive prefix sum in bucket-major order (keeps
+    // the sort stable), then a scatter per chunk
+    std::fill(offsets.begin(), offsets.end(), 0);
+    oneapi::tbb::parallel_for(
+        chunks, [&](const oneapi::tbb::blocked_range<size_t> &r) {
+          for (size_t c = r.begin(); c != r.end(); ++c) {
+            size_t *count = &offsets[c * RADIX_BUCKETS];
+            const size_t end = std::min(n, (c + 1) * RADIX_CHUNK_SIZE);
+            for (size_t i = c * RADIX_CHUNK_SIZE; i < end; ++i)
+              ++count[(src_keys[i] >> shift) & (RADIX_BUCKETS - 1)];
+          }
+        });
+    size_t sum = 0;
+    for (size_t b = 0; b < RADIX_BUCKETS; ++b) {
+      for (size_t c = 0; c < n_chunks; ++c) {
+        const size_t count = offsets[c * RADIX_BUCKETS + b];
+        offsets[c * RADIX_BUCKETS + b] = sum;
+        sum += count;
+      }
+    }
+    oneapi::tbb::parallel_for(
+        chunks, [&](const oneapi::tbb::blocked_range<size_t> &r) {
+          for (size_t c = r.begin(); c != r.end(); ++c) {
+            size_t *offset = &offsets[c * RADIX_BUCKETS];
+            const size_t end = std::min(n, (c + 1) * RADIX_CHUNK_SIZE);
+            for (size_t i = c * RADIX_CHUNK_SIZE; i < end; ++i) {
+              const size_t j =
+                  offset[(src_keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+              dst_keys[j] = src_keys[i];
+              dst_values[j] = src_values[i];
+            }
+          }
+        });
+    std::swap(src_keys, dst_keys);
+    std::swap(src_values, dst_values);
+  }
+  // an odd number of passes leaves the result in the buffers
+  if (src_keys.data() != keys.data()) {
+    std::copy(src_keys.begin(), src_keys.end(), keys.begin());
+    std::copy(src_values.begin(), src_values.end(), values.begin());
+  }
+}
+
+void radix_sort(std::span<uint32_t> keys, std::span<uint32_t> values,
+                int key_bits) {
+  RadixSortScratch scratch;
+  radix_sort(keys, values, scratch, key_bits);
+}
+
+void sort_rays(std::span<const Ray> rays, const Bounds3f &bounds,
+               std::span<uint32_t> order) {
+  DAKKU_CHECK(rays.size() == order.size(), "size mismatch: {} != {}",
+              rays.size(), order.size());
+  std::vector<uint32_t> keys(rays.size());
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<size_t>(0, rays.size(), 4096),
+      [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          keys[i] = ray_sort_key(rays[i].o, rays[i].d, bounds);
+          order[i] = static_cast<uint32_t>(i);
+        }
+      });
+  radix_sort(keys, order, RAY_SORT_KEY_BITS);
+}
+}  // namespace dakku
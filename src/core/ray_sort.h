@@ -0,0 +1,72 @@
+#ifndef DAKKU_CORE_RAY_SORT_H_
+#define DAKKU_CORE_RAY_SORT_H_
+#include <core/bounds.h>
+#include <core/ray.h>
+
+#include <span>
+#include <vector>
+
+namespace dakku {
+
+/// bits per axis of the origin morton code in `ray_sort_key`
+static constexpr int RAY_SORT_MORTON_BITS = 7;
+/// the number of low bits used by `ray_sort_key`
+static constexpr int RAY_SORT_KEY_BITS = 3 + 3 * RAY_SORT_MORTON_BITS;
+
+/**
+ * @brief get the sort key of a ray: the direction octant in the top 3 bits,
+ * then a coarse morton code of the origin normalized to `bounds` (usually
+ * the scene bounds), so that sorted rays with equal keys start close
+ * together and head the same way, and traverse the same nodes
+ *
+ */
+DAKKU_EXPORT_CORE uint32_t ray_sort_key(const Point3f &o, const Vector3f &d,
+                                        const Bounds3f &bounds);
+
+/**
+ * @brief scratch memory of `radix_sort`, keep one across sorts so that
+ * sorting up to the reserved number of keys allocates nothing
+ *
+ */
+struct DAKKU_EXPORT_CORE RadixSortScratch {
+  RadixSortScratch() = default;
+  explicit RadixSortScratch(size_t n) { reserve(n); }
+
+  /// grow the buffers to sort `n` keys
+  void reserve(size_t n);
+
+  /// ping-pong buffers of the keys and values
+  std::vector<uint32_t> keys, values;
+  /// bucket offsets of every chunk
+  std::vector<size_t> offsets;
+};
+
+/**
+ * @brief stable parallel lsd radix sort (8 bits per pass) of `keys` by their
+ * low `key_bits` bits, `values` are permuted along
+ *
+ */
+DAKKU_EXPORT_CORE void radix_sort(std::span<uint32_t> keys,
+                                  std::span<uint32_t> values,
+                                  RadixSortScratch &scratch,
+                                  int key_bits = 32);
+
+/**
+ * @brief `radix_sort` with temporary scratch memory
+ *
+ */
+DAKKU_EXPORT_CORE void radix_sort(std::span<uint32_t> keys,
+                                  std::span<uint32_t> values,
+                                  int key_bits = 32);
+
+/**
+ * @brief get the order that groups `rays` by `ray_sort_key`, `order[k]` is
+ * the index of the `k`-th ray, trace in this order and scatter the results
+ * back to `order[k]`
+ *
+ */
+DAKKU_EXPORT_CORE void sort_rays(std::span<const Ray> rays,
+                                 const Bounds3f &bounds,
+                                 std::span<uint32_t> order);
+}  // namespace dakku
+#endif
@@ -0,0 +1,10 @@
+#include <core/sampler.h>
+
+namespace dakku {
+
+void Sampler::sample_batch(const Point2i &pixel, uint32_t index,
+                           uint32_t first_dim, std::span<float> out) const {
+  for (size_t k = 0; k < out.size(); ++k)
+    out[k] = sample(pixel, index, first_dim + static_cast<uint32_t>(k));
+}
+}  // namespace dakku
@@ -0,0 +1,56 @@
+#ifndef DAKKU_CORE_SAMPLER_H_
+#define DAKKU_CORE_SAMPLER_H_
+#include <core/vector.h>
+
+#include <span>
+
+namespace dakku {
+
+/**
+ * @brief sample generator, stateless: a sample value is addressed by the
+ * pixel, the sample index in the pixel and the dimension, so any worker can
+ * render any tile (or revisit a pixel) and get the same samples
+ *
+ */
+class DAKKU_EXPORT_CORE Sampler {
+ public:
+  /**
+   * @brief Construct a new Sampler object
+   *
+   * @param samples_per_pixel the number of samples taken in each pixel
+   */
+  explicit Sampler(uint32_t samples_per_pixel)
+      : samples_per_pixel(samples_per_pixel) {}
+  virtual ~Sampler() = default;
+
+  /**
+   * @brief get dimension `dim` of sample `index` of `pixel`
+   *
+   * @return the value in $[0, 1)$
+   */
+  [[nodiscard]] virtual float sample(const Point2i &pixel, uint32_t index,
+                                     uint32_t dim) const = 0;
+
+  /**
+   * @brief get dimensions `dim` and `dim + 1` of sample `index` of `pixel`
+   *
+   */
+  [[nodiscard]] Point2f sample_2d(const Point2i &pixel, uint32_t index,
+                                  uint32_t dim) const {
+    return Point2f{sample(pixel, index, dim), sample(pixel, index, dim + 1)};
+  }
+
+  /**
+   * @brief get consecutive dimensions of a sample,
+   * `out[k] = sample(pixel, index, first_dim + k)`, samplers vectorize it
+   * over the dimensions (8 or 16 at once)
+   *
+   */
+  virtual void sample_batch(const Point2i &pixel, uint32_t index,
+                            uint32_t first_dim, std::span<float> out) const;
+
+  /// the number of samples taken in each pixel
+  const uint32_t samples_per_pixel;
+};
+}  // namespace dakku
+#endif
@@ -0,0 +1,618 @@
+#include <core/scene_cache.h>
+#include <core/bounds.h>
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+
+#if defined(_WIN32) || defined(WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dakku {
+
+namespace {
+/// file magic
+constexpr char MAGIC[8] = {'D', 'A', 'K', 'K', 'U', 'S', 'C', '\0'};
+/// section alignment
+constexpr size_t ALIGNMENT = 64;
+/// name of the section holding the input files
+constexpr std::string_view INPUTS_SECTION = "__inputs";
+/// the maximum nesting depth of cached lua tables
+constexpr int MAX_LUA_DEPTH = 64;
+
+/**
+ * @brief file header
+ *
+ */
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t n_sections;
+  /// hash of the script
+  uint64_t key;
+  uint64_t reserved[5];
+};
+static_assert(sizeof(Header) == ALIGNMENT);
+
+/**
+ * @brief section kinds
+ *
+ */
+enum SectionKind : uint32_t { SECTION_RAW, SECTION_LUA };
+
+/**
+ * @brief section table entry
+ *
+ */
+struct SectionEntry {
+  char name[40];
+  uint32_t kind;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t size;
+};
+static_assert(sizeof(SectionEntry) == ALIGNMENT);
+
+size_t align_up(size_t x) { return (x + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+/**
+ * @brief cache key of a script
+ *
+ */
+std::optional<uint64_t> script_key(const std::string &script) {
+  auto h = hash_file(script);
+  if (!h) return {};
+  const uint32_t version = SceneCache::VERSION;
+  return hash_bytes(std::as_bytes(std::span{&version, 1}), *h);
+}
+
+/**
+ * @brief byte stream writer
+ *
+ */
+class ByteWriter {
+ public:
+  template <typename T>
+  requires std::is_trivially_copyable_v<T>
+  void put(const T &v) {
+    const auto *p = reinterpret_cast<const std::byte *>(&v);
+    bytes.insert(bytes.end(), p, p + sizeof(T));
+  }
+
+  void put(std::string_view s) {
+    put(static_cast<uint32_t>(s.size()));
+    const auto *p = reinterpret_cast<const std::byte *>(s.data());
+    bytes.insert(bytes.end(), p, p + s.size());
+  }
+
+  std::vector<std::byte> bytes;
+};
+
+/**
+ * @brief byte stream reader
+ *
+ */
+class ByteReader {
+ public:
+  explicit ByteReader(std::span<const std::byte> bytes) : bytes(bytes) {}
+
+  template <typename T>
+  requires std::is_trivially_copyable_v<T> T get() {
+    T v{};
+    if (pos + sizeof(T) > bytes.size()) {
+      ok = false;
+      return v;
+    }
+    std::memcpy(&v, bytes.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return v;
+  }
+
+  std::string_view get_string() {
+    auto n = get<uint32_t>();
+    if (!ok || pos + n > bytes.size()) {
+      ok = false;
+      return {};
+    }
+    std::string_view ret{reinterpret_cast<const char *>(bytes.data() + pos),
+                         n};
+    pos += n;
+    return ret;
+  }
+
+  [[nodiscard]] bool done() const { return pos == bytes.size(); }
+
+  bool ok{true};
+
+ private:
+  std::span<const std::byte> bytes;
+  size_t pos{0};
+};
+
+/**
+ * @brief lua value tags, usertypes follow `LUA_TAG_USERTYPE` in the order of
+ * `LuaUsertypes`
+ *
+ */
+enum LuaTag : uint8_t {
+  LUA_TAG_NIL,
+  LUA_TAG_FALSE,
+  LUA_TAG_TRUE,
+  LUA_TAG_INTEGER,
+  LUA_TAG_NUMBER,
+  LUA_TAG_STRING,
+  LUA_TAG_TABLE,
+  LUA_TAG_USERTYPE
+};
+
+/// cached usertypes (append only, otherwise bump `SceneCache::VERSION`)
+using LuaUsertypes =
+    std::tuple<Vector2i, Vector2f, Vector3i, Vector3f, Vector4f, Point2i,
+               Point2f, Point3i, Point3f, Normal3f, Bounds2i, Bounds2f,
+               Bounds3f>;
+
+template <typename T>
+void put_usertype(ByteWriter &w, const T &v) {
+  if constexpr (requires { T::SIZE; }) {
+    for (size_t i = 0; i < T::SIZE; ++i) w.put(v[i]);
+  } else {
+    put_usertype(w, v.p_min);
+    put_usertype(w, v.p_max);
+  }
+}
+
+template <typename T>
+T get_usertype(ByteReader &r) {
+  T v;
+  if constexpr (requires { T::SIZE; }) {
+    for (size_t i = 0; i < T::SIZE; ++i)
+      v[i] = r.get<typename T::Scalar>();
+  } else {
+    v.p_min = get_usertype<decltype(v.p_min)>(r);
+    v.p_max = get_usertype<decltype(v.p_max)>(r);
+  }
+  return v;
+}
+
+bool encode_lua(ByteWriter &w, const sol::object &value, int depth = 0) {
+  if (depth > MAX_LUA_DEPTH) {
+    DAKKU_WARN("scene cache: lua tables nested too deep (cyclic?)");
+    return false;
+  }
+  switch (value.get_type()) {
+    case sol::type::lua_nil:
+    case sol::type::none:
+      w.put(LUA_TAG_NIL);
+      return true;
+    case sol::type::boolean:
+      w.put(value.as<bool>() ? LUA_TAG_TRUE : LUA_TAG_FALSE);
+      return true;
+    case sol::type::number:
+      if (value.is<int64_t>()) {
+        w.put(LUA_TAG_INTEGER);
+        w.put(value.as<int64_t>());
+      } else {
+        w.put(LUA_TAG_NUMBER);
+        w.put(value.as<double>());
+      }
+      return true;
+    case sol::type::string:
+      w.put(LUA_TAG_STRING);
+      w.put(value.as<std::string_view>());
+      return true;
+    case sol::type::table: {
+      auto table = value.as<sol::table>();
+      w.put(LUA_TAG_TABLE);
+      // the pair count is patched after the traversal
+      const size_t count_pos = w.bytes.size();
+      w.put(uint32_t{0});
+      uint32_t count = 0;
+      bool ok = true;
+      table.for_each([&](const sol::object &k, const sol::object &v) {
+        ok = ok && encode_lua(w, k, depth + 1) && encode_lua(w, v, depth + 1);
+        ++count;
+      });
+      std::memcpy(w.bytes.data() + count_pos, &count, sizeof(count));
+      return ok;
+    }
+    case sol::type::userdata: {
+      bool found = false;
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        ((!found && value.is<std::tuple_element_t<I, LuaUsertypes>>()
+              ? (w.put(static_cast<uint8_t>(LUA_TAG_USERTYPE + I)),
+                 put_usertype(w,
+                              value.as<std::tuple_element_t<I, LuaUsertypes>>()),
+                 found = true)
+              : false),
+         ...);
+      }
+      (std::make_index_sequence<std::tuple_size_v<LuaUsertypes>>{});
+      if (!found) DAKKU_WARN_ONCE("scene cache: unsupported lua usertype");
+      return found;
+    }
+    default:
+      DAKKU_WARN("scene cache: unsupported lua type {}",
+                 static_cast<int>(value.get_type()));
+      return false;
+  }
+}
+
+/**
+ * @brief check that `r` holds an encoded lua value that `decode_lua` can
+ * restore, without a lua state
+ *
+ */
+bool check_lua(ByteReader &r, int depth = 0) {
+  const auto tag = r.get<uint8_t>();
+  if (!r.ok || depth > MAX_LUA_DEPTH) return false;
+  switch (tag) {
+    case LUA_TAG_NIL:
+    case LUA_TAG_FALSE:
+    case LUA_TAG_TRUE:
+      return true;
+    case LUA_TAG_INTEGER:
+      static_cast<void>(r.get<int64_t>());
+      return r.ok;
+    case LUA_TAG_NUMBER:
+      static_cast<void>(r.get<double>());
+      return r.ok;
+    case LUA_TAG_STRING:
+      static_cast<void>(r.get_string());
+      return r.ok;
+    case LUA_TAG_TABLE: {
+      const auto count = r.get<uint32_t>();
+      for (uint32_t i = 0; i < count && r.ok; ++i) {
+        // lua tables have no nil or nan keys
+        ByteReader key = r;
+        const auto key_tag = key.get<uint8_t>();
+        if (key_tag == LUA_TAG_NIL ||
+            (key_tag == LUA_TAG_NUMBER && std::isnan(key.get<double>())))
+          return false;
+        if (!check_lua(r, depth + 1) || !check_lua(r, depth + 1))
+          return false;
+      }
+      return r.ok;
+    }
+    default: {
+      bool found = false;
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        ((tag == LUA_TAG_USERTYPE + I
+              ? (get_usertype<std::tuple_element_t<I, LuaUsertypes>>(r),
+                 found = true)
+              : false),
+         ...);
+      }
+      (std::make_index_sequence<std::tuple_size_v<LuaUsertypes>>{});
+      return found && r.ok;
+    }
+  }
+}
+
+sol::object decode_lua(ByteReader &r, sol::state &state) {
+  const auto tag = r.get<uint8_t>();
+  if (!r.ok) return sol::lua_nil;
+  switch (tag) {
+    case LUA_TAG_NIL:
+      return sol::lua_nil;
+    case LUA_TAG_FALSE:
+      return sol::make_object(state, false);
+    case LUA_TAG_TRUE:
+      return sol::make_object(state, true);
+    case LUA_TAG_INTEGER:
+      return sol::make_object(state, r.get<int64_t>());
+    case LUA_TAG_NUMBER:
+      return sol::make_object(state, r.get<double>());
+    case LUA_TAG_STRING:
+      return sol::make_object(state, r.get_string());
+    case LUA_TAG_TABLE: {
+      sol::table table = state.create_table();
+      const auto count = r.get<uint32_t>();
+      for (uint32_t i = 0; i < count && r.ok; ++i) {
+        sol::object k = decode_lua(r, state);
+        sol::object v = decode_lua(r, state);
+        table.set(k, v);
+      }
+      return table;
+    }
+    default: {
+      sol::object ret = sol::lua_nil;
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        ((tag == LUA_TAG_USERTYPE + I
+              ? (ret = sol::make_object(
+                     state,
+                     get_usertype<std::tuple_element_t<I, LuaUsertypes>>(r)),
+                 true)
+              : false),
+         ...);
+      }
+      (std::make_index_sequence<std::tuple_size_v<LuaUsertypes>>{});
+      return ret;
+    }
+  }
+}
+}  // namespace
+
+uint64_t hash_bytes(std::span<const std::byte> data, uint64_t seed) {
+  uint64_t h = seed;
+  for (std::byte b : data) {
+    h ^= static_cast<uint64_t>(b);
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
+std::optional<uint64_t> hash_file(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return {};
+  uint64_t h = hash_bytes({});
+  std::vector<char> buffer(1 << 16);
+  while (file) {
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    h = hash_bytes(std::as_bytes(std::span{buffer.data(),
+                                           static_cast<size_t>(file.gcount())}),
+                   h);
+  }
+  return h;
+}
+
+void SceneCacheWriter::add_input(const std::string &path) {
+  inputs.push_back(path);
+}
+
+void SceneCacheWriter::add_side_effect(std::string_view what) {
+  side_effects.emplace_back(what);
+}
+
+void SceneCacheWriter::watch(sol::state &state) {
+  state.set_function("_scene_input",
+                     [this](const std::string &path) { add_input(path); });
+  state.set_function("_scene_side_effect", [this](const std::string &what) {
+    add_side_effect(what);
+  });
+  state.script(R"(
+    _scene_natives = {}
+    for name, f in pairs(_G) do
+      if type(f) == "function" and name:sub(1, 1) == "_" and
+          name:sub(1, 7) ~= "_scene_" then
+        _scene_natives[name] = f
+      end
+    end
+    for name, f in pairs(_scene_natives) do
+      _G[name] = function(...)
+        _scene_side_effect(name)
+        return f(...)
+      end
+    end
+  )");
+}
+
+void SceneCacheWriter::unwatch(sol::state &state) {
+  state.script(R"(
+    for name, f in pairs(_scene_natives or {}) do _G[name] = f end
+    _scene_natives, _scene_input, _scene_side_effect = nil, nil, nil
+  )");
+}
+
+void SceneCacheWriter::add(std::string_view name,
+                           std::span<const std::byte> data) {
+  sections.push_back(Section{std::string(name), false,
+                             std::vector<std::byte>(data.begin(), data.end())});
+}
+
+bool SceneCacheWriter::add_lua(std::string_view name,
+                               const sol::object &value) {
+  ByteWriter w;
+  if (!encode_lua(w, value)) return false;
+  sections.push_back(Section{std::string(name), true, std::move(w.bytes)});
+  return true;
+}
+
+bool SceneCacheWriter::write(const std::string &path,
+                             const std::string &script) const {
+  if (!cacheable()) {
+    DAKKU_INFO("scene cache: not written, the script calls {}",
+               side_effects.front());
+    return false;
+  }
+  auto key = script_key(script);
+  if (!key) {
+    DAKKU_ERR("scene cache: can't read script {}", script);
+    return false;
+  }
+  ByteWriter input_section;
+  for (const auto &input : inputs) {
+    auto h = hash_file(input);
+    if (!h) {
+      DAKKU_ERR("scene cache: can't read input {}", input);
+      return false;
+    }
+    input_section.put(std::string_view{input});
+    input_section.put(*h);
+  }
+
+  std::vector<std::tuple<std::string_view, SectionKind,
+                         std::span<const std::byte>>>
+      all;
+  all.emplace_back(INPUTS_SECTION, SECTION_RAW, input_section.bytes);
+  for (const auto &[name, lua, bytes] : sections)
+    all.emplace_back(name, lua ? SECTION_LUA : SECTION_RAW, bytes);
+
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = SceneCache::VERSION;
+  header.n_sections = static_cast<uint32_t>(all.size());
+  header.key = *key;
+  std::vector<SectionEntry> table(all.size());
+  size_t offset = sizeof(Header) + sizeof(SectionEntry) * all.size();
+  for (size_t i = 0; i < all.size(); ++i) {
+    const auto &[name, kind, bytes] = all[i];
+    if (name.size() >= sizeof(table[i].name)) {
+      DAKKU_ERR("scene cache: section name too long: {}", name);
+      return false;
+    }
+    std::memcpy(table[i].name, name.data(), name.size());
+    table[i].kind = kind;
+    offset = align_up(offset);
+    table[i].offset = offset;
+    table[i].size = bytes.size();
+    offset += bytes.size();
+  }
+
+  // write to a temporary file first, so that a crash never leaves a
+  // truncated cache behind
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      DAKKU_ERR("scene cache: can't write {}", tmp);
+      return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(table.data()),
+               static_cast<std::streamsize>(sizeof(SectionEntry) * table.size()));
+    size_t pos = sizeof(Header) + sizeof(SectionEntry) * table.size();
+    const char zeros[ALIGNMENT]{};
+    for (size_t i = 0; i < all.size(); ++i) {
+      file.write(zeros, static_cast<std::streamsize>(table[i].offset - pos));
+      const auto bytes = std::get<2>(all[i]);
+      file.write(reinterpret_cast<const char *>(bytes.data()),
+                 static_cast<std::streamsize>(bytes.size()));
+      pos = table[i].offset + table[i].size;
+    }
+    if (!file) {
+      DAKKU_ERR("scene cache: can't write {}", tmp);
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    DAKKU_ERR("scene cache: can't rename {} to {}: {}", tmp, path,
+              ec.message());
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<SceneCache> SceneCache::open(const std::string &path,
+                                             const std::string &script) {
+  std::unique_ptr<SceneCache> cache{new SceneCache};
+#if defined(_WIN32) || defined(WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) return nullptr;
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    CloseHandle(file);
+    return nullptr;
+  }
+  cache->mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!cache->mapping) return nullptr;
+  cache->data = static_cast<const std::byte *>(
+      MapViewOfFile(cache->mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!cache->data) return nullptr;
+  cache->size = static_cast<size_t>(file_size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return nullptr;
+  }
+  void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                 MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) return nullptr;
+  cache->data = static_cast<const std::byte *>(p);
+  cache->size = static_cast<size_t>(st.st_size);
+#endif
+
+  Header header;
+  if (cache->size < sizeof(Header)) return nullptr;
+  std::memcpy(&header, cache->data, sizeof(Header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != VERSION)
+    return nullptr;
+  auto corrupted = [&path] {
+    DAKKU_WARN("scene cache: {} is corrupted", path);
+    return nullptr;
+  };
+  // the sections follow the table, aligned, inside the file
+  const size_t table_end =
+      sizeof(Header) + sizeof(SectionEntry) * header.n_sections;
+  if (cache->size < table_end) return corrupted();
+  for (uint32_t i = 0; i < header.n_sections; ++i) {
+    SectionEntry entry;
+    std::memcpy(&entry, cache->data + sizeof(Header) + sizeof(entry) * i,
+                sizeof(entry));
+    if (strnlen(entry.name, sizeof(entry.name)) == sizeof(entry.name) ||
+        entry.offset < table_end || entry.offset % ALIGNMENT != 0 ||
+        entry.offset > cache->size || entry.size > cache->size - entry.offset)
+      return corrupted();
+    if (entry.kind == SECTION_LUA) {
+      ByteReader r{{cache->data + entry.offset, entry.size}};
+      if (!check_lua(r) || !r.done()) return corrupted();
+    } else if (entry.kind != SECTION_RAW) {
+      return corrupted();
+    }
+  }
+  if (header.key != script_key(script)) return nullptr;
+  ByteReader inputs{cache->get(INPUTS_SECTION)};
+  while (!inputs.done()) {
+    std::string input{inputs.get_string()};
+    auto h = inputs.get<uint64_t>();
+    if (!inputs.ok || hash_file(input) != h) return nullptr;
+  }
+  return cache;
+}
+
+SceneCache::~SceneCache() {
+#if defined(_WIN32) || defined(WIN32)
+  if (data) UnmapViewOfFile(data);
+  if (mapping) CloseHandle(mapping);
+#else
+  if (data) munmap(const_cast<std::byte *>(data), size);
+#endif
+}
+
+bool SceneCache::contains(std::string_view name) const {
+  return get(name).data() != nullptr;
+}
+
+std::span<const std::byte> SceneCache::get(std::string_view name) const {
+  Header header;
+  std::memcpy(&header, data, sizeof(Header));
+  for (uint32_t i = 0; i < header.n_sections; ++i) {
+    SectionEntry entry;
+    std::memcpy(&entry, data + sizeof(Header) + sizeof(entry) * i,
+                sizeof(entry));
+    if (name == std::string_view(entry.name,
+                                 strnlen(entry.name, sizeof(entry.name))))
+      return {data + entry.offset, entry.size};
+  }
+  return {};
+}
+
+sol::object SceneCache::get_lua(std::string_view name,
+                                sol::state &state) const {
+  ByteReader r{get(name)};
+  if (r.done()) return sol::lua_nil;
+  sol::object ret = decode_lua(r, state);
+  // `open` has checked the lua sections
+  DAKKU_CHECK(r.ok && r.done(), "scene cache: corrupted lua section {}",
+              name);
+  return ret;
+}
+}  // namespace dakku
@@ -0,0 +1,201 @@
+#ifndef DAKKU_CORE_SCENE_CACHE_H_
+#define DAKKU_CORE_SCENE_CACHE_H_
+#include <core/logger.h>
+#include <core/lua.h>
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief 64 bit fnv-1a hash of `data`
+ *
+ * @param seed the initial hash (chain the calls to hash several buffers)
+ */
+DAKKU_EXPORT_CORE uint64_t hash_bytes(std::span<const std::byte> data,
+                                      uint64_t seed = 0xcbf29ce484222325ull);
+
+/**
+ * @brief hash the content of a file
+ *
+ * @return the hash, or `std::nullopt` if the file can't be read
+ */
+DAKKU_EXPORT_CORE std::optional<uint64_t> hash_file(const std::string &path);
+
+/**
+ * @brief collects the resolved scene after the lua evaluation and writes the
+ * scene cache
+ *
+ * the file is a header, a section table and named sections, each aligned to
+ * 64 bytes so that arrays (meshes, ...) can be used in place after mapping,
+ * the cache is keyed by the hash of the script and of every declared input
+ *
+ * a cache hit skips the script, thus only plain data scenes are cached: the
+ * cache is not written once the script calls a native `_` function (object
+ * creation, mesh loads, ...), see `watch`
+ *
+ */
+class DAKKU_EXPORT_CORE SceneCacheWriter {
+ public:
+  /**
+   * @brief declare a file the scene depends on (meshes, textures, included
+   * scripts), the cache is invalid once any of them changes
+   *
+   */
+  void add_input(const std::string &path);
+
+  /**
+   * @brief record a side effect of the script (e.g. the name of a native
+   * call), the cache is not written if there is any
+   *
+   */
+  void add_side_effect(std::string_view what);
+
+  /**
+   * @brief check whether the scene can be cached (no side effects)
+   *
+   */
+  [[nodiscard]] bool cacheable() const { return side_effects.empty(); }
+
+  /**
+   * @brief prepare `state` to run the scene script: `_scene_input(path)`
+   * declares an input and every native `_` function records a side effect
+   * when called, call `unwatch` once the script returns
+   *
+   */
+  void watch(sol::state &state);
+
+  /**
+   * @brief restore the native functions wrapped by `watch`
+   *
+   */
+  static void unwatch(sol::state &state);
+
+  /**
+   * @brief add a raw section
+   *
+   */
+  void add(std::string_view name, std::span<const std::byte> data);
+
+  /**
+   * @brief add an array section
+   *
+   */
+  template <typename T>
+  requires std::is_trivially_copyable_v<T>
+  void add(std::string_view name, std::span<const T> data) {
+    add(name, std::as_bytes(data));
+  }
+
+  /**
+   * @brief add a lua value (nil, booleans, numbers, strings, tables and the
+   * vector, point, normal and bounds usertypes)
+   *
+   * @return whether the value can be cached
+   */
+  bool add_lua(std::string_view name, const sol::object &value);
+
+  /**
+   * @brief write the cache file for `script`
+   *
+   * @return whether the file is written
+   */
+  bool write(const std::string &path, const std::string &script) const;
+
+ private:
+  /**
+   * @brief a named section
+   *
+   */
+  struct Section {
+    std::string name;
+    /// whether `bytes` is an encoded lua value
+    bool lua;
+    std::vector<std::byte> bytes;
+  };
+
+  /// named sections
+  std::vector<Section> sections;
+  /// input files
+  std::vector<std::string> inputs;
+  /// side effects of the script
+  std::vector<std::string> side_effects;
+};
+
+/**
+ * @brief memory mapped scene cache, see `SceneCacheWriter`
+ *
+ */
+class DAKKU_EXPORT_CORE SceneCache {
+ public:
+  /// file format version, bump it whenever the layout or an encoding changes
+  static constexpr uint32_t VERSION = 2;
+
+  /**
+   * @brief map the cache of `script`, the section table and the lua sections
+   * are validated, so that a corrupted or truncated file is never used
+   *
+   * @return the cache, or `nullptr` if it is missing, from another version,
+   * corrupted or out of date
+   */
+  static std::unique_ptr<SceneCache> open(const std::string &path,
+                                          const std::string &script);
+
+  ~SceneCache();
+  SceneCache(const SceneCache &) = delete;
+  SceneCache &operator=(const SceneCache &) = delete;
+
+  /**
+   * @brief check whether the section exists
+   *
+   */
+  [[nodiscard]] bool contains(std::string_view name) const;
+
+  /**
+   * @brief get a raw section (empty if absent)
+   *
+   */
+  [[nodiscard]] std::span<const std::byte> get(std::string_view name) const;
+
+  /**
+   * @brief get an array section (empty if absent or not an array of `T`)
+   *
+   */
+  template <typename T>
+  requires std::is_trivially_copyable_v<T>
+  std::span<const T> get(std::string_view name) const {
+    auto bytes = get(name);
+    if (bytes.size() % sizeof(T) != 0) {
+      DAKKU_ERR("scene cache: section {} is not an array of {} bytes", name,
+                sizeof(T));
+      return {};
+    }
+    return {reinterpret_cast<const T *>(bytes.data()),
+            bytes.size() / sizeof(T)};
+  }
+
+  /**
+   * @brief decode a lua section into `state` (nil if absent)
+   *
+   */
+  sol::object get_lua(std::string_view name, sol::state &state) const;
+
+ private:
+  SceneCache() = default;
+
+  /// mapped file
+  const std::byte *data{nullptr};
+  /// file size
+  size_t size{0};
+#if defined(_WIN32) || defined(WIN32)
+  /// file mapping handle
+  void *mapping{nullptr};
+#endif
+};
+}  // namespace dakku
+#endif
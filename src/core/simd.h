@@ -0,0 +1,181 @@
+#ifndef DAKKU_CORE_SIMD_H_
+#define DAKKU_CORE_SIMD_H_
+#include <core/fwd.h>
+
+// sse is the baseline for the simd code paths, define `DAKKU_DISABLE_SIMD`
+// (xmake option `simd`) to fall back to the plain scalar implementations
+#if !defined(DAKKU_DISABLE_SIMD) &&                          \
+    (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+/// sse (4-wide) code paths are available
+#define DAKKU_ENABLE_SSE
+#endif
+
+#if defined(DAKKU_ENABLE_SSE) && defined(__AVX__)
+/// avx (8-wide) code paths are available
+#define DAKKU_ENABLE_AVX
+#endif
+
+#if defined(DAKKU_ENABLE_AVX) && defined(__AVX2__)
+/// avx2 (8-wide integer) code paths are available
+#define DAKKU_ENABLE_AVX2
+#endif
+
+#ifdef DAKKU_ENABLE_SSE
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace dakku {
+
+/// widest native float simd width (in lanes)
+#if defined(DAKKU_ENABLE_AVX)
+static constexpr size_t SIMD_WIDTH = 8;
+#elif defined(DAKKU_ENABLE_SSE)
+static constexpr size_t SIMD_WIDTH = 4;
+#else
+static constexpr size_t SIMD_WIDTH = 1;
+#endif
+
+/**
+ * @brief `W` float lanes, used by the SoA (packet) kernels
+ * `load`/`store` require the pointer to be aligned to `W * sizeof(float)`
+ * `min`/`max` follow the sse semantics: the second operand is returned if
+ * either operand is nan
+ *
+ * @tparam W lane count (1, 4 or 8)
+ */
+template <size_t W>
+struct SimdFloat;
+
+/**
+ * @brief scalar fallback (one lane)
+ *
+ */
+template <>
+struct SimdFloat<1> {
+  static SimdFloat load(const float *p) { return {*p}; }
+  static SimdFloat set1(float x) { return {x}; }
+  void store(float *p) const { *p = v; }
+
+  friend SimdFloat operator+(SimdFloat a, SimdFloat b) { return {a.v + b.v}; }
+  friend SimdFloat operator-(SimdFloat a, SimdFloat b) { return {a.v - b.v}; }
+  friend SimdFloat operator*(SimdFloat a, SimdFloat b) { return {a.v * b.v}; }
+  friend SimdFloat operator/(SimdFloat a, SimdFloat b) { return {a.v / b.v}; }
+  friend SimdFloat min(SimdFloat a, SimdFloat b) {
+    return {a.v < b.v ? a.v : b.v};
+  }
+  friend SimdFloat max(SimdFloat a, SimdFloat b) {
+    return {a.v > b.v ? a.v : b.v};
+  }
+  friend SimdFloat abs(SimdFloat a) { return {std::abs(a.v)}; }
+  /// bit i is set if lane i of `a` is nan
+  friend uint32_t nan_mask(SimdFloat a) { return std::isnan(a.v) ? 1 : 0; }
+  /// bit i is set if `a[i] <= b[i]`
+  friend uint32_t le_mask(SimdFloat a, SimdFloat b) {
+    return a.v <= b.v ? 1 : 0;
+  }
+
+  /// lane value
+  float v;
+};
+
+#ifdef DAKKU_ENABLE_SSE
+/**
+ * @brief sse lanes
+ *
+ */
+template <>
+struct SimdFloat<4> {
+  static SimdFloat load(const float *p) { return {_mm_load_ps(p)}; }
+  static SimdFloat set1(float x) { return {_mm_set1_ps(x)}; }
+  void store(float *p) const { _mm_store_ps(p, v); }
+
+  friend SimdFloat operator+(SimdFloat a, SimdFloat b) {
+    return {_mm_add_ps(a.v, b.v)};
+  }
+  friend SimdFloat operator-(SimdFloat a, SimdFloat b) {
+    return {_mm_sub_ps(a.v, b.v)};
+  }
+  friend SimdFloat operator*(SimdFloat a, SimdFloat b) {
+    return {_mm_mul_ps(a.v, b.v)};
+  }
+  friend SimdFloat operator/(SimdFloat a, SimdFloat b) {
+    return {_mm_div_ps(a.v, b.v)};
+  }
+  friend SimdFloat min(SimdFloat a, SimdFloat b) {
+    return {_mm_min_ps(a.v, b.v)};
+  }
+  friend SimdFloat max(SimdFloat a, SimdFloat b) {
+    return {_mm_max_ps(a.v, b.v)};
+  }
+  friend SimdFloat abs(SimdFloat a) {
+    return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)};
+  }
+  friend uint32_t nan_mask(SimdFloat a) {
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpunord_ps(a.v, a.v)));
+  }
+  friend uint32_t le_mask(SimdFloat a, SimdFloat b) {
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(a.v, b.v)));
+  }
+
+  /// lane values
+  __m128 v;
+};
+#endif
+
+#ifdef DAKKU_ENABLE_AVX
+/**
+ * @brief avx lanes
+ *
+ */
+template <>
+struct SimdFloat<8> {
+  static SimdFloat load(const float *p) { return {_mm256_load_ps(p)}; }
+  static SimdFloat set1(float x) { return {_mm256_set1_ps(x)}; }
+  void store(float *p) const { _mm256_store_ps(p, v); }
+
+  friend SimdFloat operator+(SimdFloat a, SimdFloat b) {
+    return {_mm256_add_ps(a.v, b.v)};
+  }
+  friend SimdFloat operator-(SimdFloat a, SimdFloat b) {
+    return {_mm256_sub_ps(a.v, b.v)};
+  }
+  friend SimdFloat operator*(SimdFloat a, SimdFloat b) {
+    return {_mm256_mul_ps(a.v, b.v)};
+  }
+  friend SimdFloat operator/(SimdFloat a, SimdFloat b) {
+    return {_mm256_div_ps(a.v, b.v)};
+  }
+  friend SimdFloat min(SimdFloat a, SimdFloat b) {
+    return {_mm256_min_ps(a.v, b.v)};
+  }
+  friend SimdFloat max(SimdFloat a, SimdFloat b) {
+    return {_mm256_max_ps(a.v, b.v)};
+  }
+  friend SimdFloat abs(SimdFloat a) {
+    return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)};
+  }
+  friend uint32_t nan_mask(SimdFloat a) {
+    return static_cast<uint32_t>(
+        _mm256_movemask_ps(_mm256_cmp_ps(a.v, a.v, _CMP_UNORD_Q)));
+  }
+  friend uint32_t le_mask(SimdFloat a, SimdFloat b) {
+    return static_cast<uint32_t>(
+        _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)));
+  }
+
+  /// lane values
+  __m256 v;
+};
+#endif
+
+/// the widest simd float type for kernels over `N` lanes
+template <size_t N>
+using SimdFloatFor = SimdFloat<std::min(N, SIMD_WIDTH)>;
+
+}  // namespace dakku
+#endif
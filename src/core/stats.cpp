@@ -0,0 +1,167 @@
+#include <core/stats.h>
+#include <core/json.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace dakku {
+
+namespace {
+/// split "category/name"
+std::pair<std::string_view, std::string_view> split_title(
+    std::string_view title) {
+  const size_t slash = title.find('/');
+  if (slash == std::string_view::npos) return {"", title};
+  return {title.substr(0, slash), title.substr(slash + 1)};
+}
+
+/// sort entries by title
+template <typename T>
+void sort_by_title(std::vector<std::pair<std::string, T>> &entries) {
+  std::ranges::sort(entries, {}, &std::pair<std::string, T>::first);
+}
+}  // namespace
+
+StatRegistry &StatRegistry::instance() {
+  static StatRegistry _instance;
+  return _instance;
+}
+
+void StatRegistry::add(StatBase *stat) {
+  std::lock_guard lock(mutex);
+  stats.push_back(stat);
+}
+
+void StatRegistry::remove(StatBase *stat) {
+  std::lock_guard lock(mutex);
+  std::erase(stats, stat);
+}
+
+StatReport StatRegistry::collect() const {
+  StatReport report;
+  {
+    std::lock_guard lock(mutex);
+    for (const StatBase *stat : stats) stat->collect(report);
+  }
+  sort_by_title(report.counters);
+  sort_by_title(report.distributions);
+  sort_by_title(report.ratios);
+  return report;
+}
+
+void StatRegistry::report() const {
+  const StatReport report = collect();
+  // one line per statistic, the category is printed when it changes
+  std::vector<std::pair<std::string, std::string>> lines;
+  for (const auto &[title, value] : report.counters)
+    lines.emplace_back(title, fmt::format("{}", value));
+  for (const auto &[title, d] : report.distributions) {
+    if (d.count == 0) continue;
+    lines.emplace_back(title, fmt::format("{:.3f} avg [{} - {}] over {}",
+                                          d.sum / d.count, d.min, d.max,
+                                          d.count));
+  }
+  for (const auto &[title, r] : report.ratios) {
+    const auto [num, denom] = r;
+    lines.emplace_back(
+        title, fmt::format("{} / {} ({:.2f}x)", num, denom,
+                           denom != 0 ? static_cast<double>(num) / denom : 0));
+  }
+  std::ranges::stable_sort(lines, {}, [](const auto &line) {
+    return split_title(line.first).first;
+  });
+  DAKKU_INFO("statistics:");
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const auto [category, name] = split_title(lines[i].first);
+    if (i == 0 || category != split_title(lines[i - 1].first).first)
+      DAKKU_INFO("  {}", category);
+    DAKKU_INFO("    {:<42} {}", name, lines[i].second);
+  }
+}
+
+bool StatRegistry::write_json(const std::string &path) const {
+  const StatReport report = collect();
+  std::ofstream out(path);
+  if (!out) {
+    DAKKU_ERR("cannot create {}", path);
+    return false;
+  }
+  auto write_section = [&](const char *name, const auto &entries, auto &&f,
+                           bool last) {
+    out << "  " << json_string(name) << ": {";
+    for (size_t i = 0; i < entries.size(); ++i) {
+      out << (i == 0 ? "\n" : ",\n") << "    "
+          << json_string(entries[i].first) << ": " << f(entries[i].second);
+    }
+    out << (entries.empty() ? "}" : "\n  }") << (last ? "\n" : ",\n");
+  };
+  out << "{\n";
+  write_section(
+      "counters", report.counters,
+      [](int64_t v) { return fmt::format("{}", v); }, false);
+  write_section(
+      "distributions", report.distributions,
+      [](const StatReport::Distribution &d) {
+        const bool empty = d.count == 0;
+        return fmt::format(
+            R"({{"count": {}, "sum": {}, "min": {}, "max": {}, "avg": {}}})",
+            d.count, d.sum, empty ? 0 : d.min, empty ? 0 : d.max,
+            empty ? 0 : d.sum / d.count);
+      },
+      false);
+  write_section(
+      "ratios", report.ratios,
+      [](const std::pair<int64_t, int64_t> &r) {
+        return fmt::format(R"({{"numerator": {}, "denominator": {}}})",
+                           r.first, r.second);
+      },
+      true);
+  out << "}\n";
+  return static_cast<bool>(out);
+}
+
+void StatRegistry::clear() {
+  std::lock_guard lock(mutex);
+  for (StatBase *stat : stats) stat->clear();
+}
+
+StatBase::StatBase(const char *title) : title(title) {
+  StatRegistry::instance().add(this);
+}
+
+StatBase::~StatBase() { StatRegistry::instance().remove(this); }
+
+int64_t StatCounter::sum() const {
+  int64_t sum = 0;
+  for (int64_t v : values) sum += v;
+  return sum;
+}
+
+void StatCounter::collect(StatReport &report) const {
+  if (title) report.counters.emplace_back(title, sum());
+}
+
+void StatCounter::clear() {
+  for (int64_t &v : values) v = 0;
+}
+
+void StatDistribution::collect(StatReport &report) const {
+  StatReport::Distribution sum;
+  for (const StatReport::Distribution &d : values) {
+    sum.count += d.count;
+    sum.sum += d.sum;
+    sum.min = std::min(sum.min, d.min);
+    sum.max = std::max(sum.max, d.max);
+  }
+  report.distributions.emplace_back(title, sum);
+}
+
+void StatDistribution::clear() {
+  for (StatReport::Distribution &d : values) d = {};
+}
+
+void StatRatio::collect(StatReport &report) const {
+  report.ratios.emplace_back(
+      title, std::pair{numerator.sum(), denominator.sum()});
+}
+}  // namespace dakku
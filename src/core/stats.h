@@ -0,0 +1,239 @@
+#ifndef DAKKU_CORE_STATS_H_
+#define DAKKU_CORE_STATS_H_
+#include <core/logger.h>
+
+#include <oneapi/tbb/cache_aligned_allocator.h>
+#include <oneapi/tbb/enumerable_thread_specific.h>
+
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief per thread storage of a statistic, updates only touch the calling
+ * thread's (cache aligned) copy, the copies are combined when reporting
+ *
+ */
+template <typename T>
+using StatStorage = oneapi::tbb::enumerable_thread_specific<
+    T, oneapi::tbb::cache_aligned_allocator<T>,
+    oneapi::tbb::ets_key_per_instance>;
+
+class StatBase;
+
+/**
+ * @brief aggregated statistics, keyed by "category/name" titles
+ *
+ */
+struct StatReport {
+  /**
+   * @brief aggregated distribution
+   *
+   */
+  struct Distribution {
+    /// number of values
+    int64_t count{0};
+    /// sum of the values
+    double sum{0};
+    /// minimum value
+    double min{std::numeric_limits<double>::infinity()};
+    /// maximum value
+    double max{-std::numeric_limits<double>::infinity()};
+  };
+
+  /// counters
+  std::vector<std::pair<std::string, int64_t>> counters;
+  /// distributions
+  std::vector<std::pair<std::string, Distribution>> distributions;
+  /// ratios (numerator, denominator)
+  std::vector<std::pair<std::string, std::pair<int64_t, int64_t>>> ratios;
+};
+
+/**
+ * @brief registry of all statistics, every `DAKKU_STAT_*` registers itself on
+ * construction
+ *
+ */
+class DAKKU_EXPORT_CORE StatRegistry {
+ public:
+  /**
+   * @brief get stat registry instance
+   *
+   */
+  static StatRegistry &instance();
+
+  /**
+   * @brief register a statistic
+   *
+   */
+  void add(StatBase *stat);
+
+  /**
+   * @brief unregister a statistic
+   *
+   */
+  void remove(StatBase *stat);
+
+  /**
+   * @brief combine the per thread values of all statistics (call it when the
+   * workers are idle for exact values)
+   *
+   */
+  [[nodiscard]] StatReport collect() const;
+
+  /**
+   * @brief log the statistics grouped by category
+   *
+   */
+  void report() const;
+
+  /**
+   * @brief write the statistics as json
+   *
+   * @return whether the file has been written
+   */
+  [[nodiscard]] bool write_json(const std::string &path) const;
+
+  /**
+   * @brief reset all statistics (unsynchronized)
+   *
+   */
+  void clear();
+
+ private:
+  StatRegistry() = default;
+
+  /// guards `stats`
+  mutable std::mutex mutex;
+  /// registered statistics
+  std::vector<StatBase *> stats;
+};
+
+/**
+ * @brief a statistic, registered for its lifetime
+ *
+ */
+class DAKKU_EXPORT_CORE StatBase {
+ public:
+  /**
+   * @brief Construct a new Stat Base object
+   *
+   * @param title "category/name", nullptr for statistics that are only
+   * reported through another one (ratio operands)
+   */
+  explicit StatBase(const char *title);
+  virtual ~StatBase();
+  StatBase(const StatBase &) = delete;
+  StatBase &operator=(const StatBase &) = delete;
+
+  /**
+   * @brief add the combined value to `report`
+   *
+   */
+  virtual void collect(StatReport &report) const = 0;
+
+  /**
+   * @brief reset the value of all threads
+   *
+   */
+  virtual void clear() = 0;
+
+ protected:
+  /// "category/name"
+  const char *title;
+};
+
+/**
+ * @brief counter
+ *
+ */
+class DAKKU_EXPORT_CORE StatCounter : public StatBase {
+ public:
+  using StatBase::StatBase;
+
+  void add(int64_t n) { values.local() += n; }
+  [[nodiscard]] int64_t sum() const;
+  void collect(StatReport &report) const override;
+  void clear() override;
+
+ private:
+  /// per thread counts
+  StatStorage<int64_t> values;
+};
+
+/**
+ * @brief distribution of reported values (count, sum, min, max)
+ *
+ */
+class DAKKU_EXPORT_CORE StatDistribution : public StatBase {
+ public:
+  using StatBase::StatBase;
+
+  void add(double v) {
+    StatReport::Distribution &d = values.local();
+    ++d.count;
+    d.sum += v;
+    d.min = std::min(d.min, v);
+    d.max = std::max(d.max, v);
+  }
+  void collect(StatReport &report) const override;
+  void clear() override;
+
+ private:
+  /// per thread distributions
+  StatStorage<StatReport::Distribution> values;
+};
+
+/**
+ * @brief ratio of two counters
+ *
+ */
+class DAKKU_EXPORT_CORE StatRatio : public StatBase {
+ public:
+  StatRatio(const char *title, const StatCounter &numerator,
+            const StatCounter &denominator)
+      : StatBase(title), numerator(numerator), denominator(denominator) {}
+
+  void collect(StatReport &report) const override;
+  void clear() override {}
+
+ private:
+  /// numerator
+  const StatCounter &numerator;
+  /// denominator
+  const StatCounter &denominator;
+};
+
+// statistics are compiled out with `DAKKU_DISABLE_STATS` (xmake option
+// `stats`), the arguments of the update macros are then not evaluated
+#ifndef DAKKU_DISABLE_STATS
+/// define counter `var` titled "category/name"
+#define DAKKU_STAT_COUNTER(title, var) static ::dakku::StatCounter var{title}
+/// define distribution `var` titled "category/name"
+#define DAKKU_STAT_DISTRIBUTION(title, var) \
+  static ::dakku::StatDistribution var{title}
+/// define counters `num` and `denom` reported as the ratio "category/name"
+#define DAKKU_STAT_RATIO(title, num, denom)        \
+  static ::dakku::StatCounter num{nullptr};        \
+  static ::dakku::StatCounter denom{nullptr};      \
+  static ::dakku::StatRatio num##_##denom##_ratio{ \
+      title, num, denom}
+/// add `n` to counter `var`
+#define DAKKU_STAT_ADD(var, n) (var).add(static_cast<int64_t>(n))
+/// increment counter `var`
+#define DAKKU_STAT_INC(var) (var).add(1)
+/// report value `v` to distribution `var`
+#define DAKKU_STAT_VALUE(var, v) (var).add(static_cast<double>(v))
+#else
+#define DAKKU_STAT_COUNTER(title, var) static_assert(true)
+#define DAKKU_STAT_DISTRIBUTION(title, var) static_assert(true)
+#define DAKKU_STAT_RATIO(title, num, denom) static_assert(true)
+#define DAKKU_STAT_ADD(var, n) static_cast<void>(0)
+#define DAKKU_STAT_INC(var) static_cast<void>(0)
+#define DAKKU_STAT_VALUE(var, v) static_cast<void>(0)
+#endif
+}  // namespace dakku
+#endif
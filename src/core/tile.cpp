@@ -0,0 +1,123 @@
+#include <core/tile.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace dakku {
+
+namespace {
+/**
+ * @brief interleave the bits of `x` and `y` (x in the even bits)
+ *
+ */
+uint64_t morton_index(uint32_t x, uint32_t y) {
+  auto spread = [](uint64_t v) {
+    v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+    v = (v | (v << 8)) & 0x00ff00ff00ff00ffull;
+    v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1);
+}
+
+/**
+ * @brief the distance of $(x, y)$ along the hilbert curve filling a $n^2$
+ * grid ($n$ is a power of 2)
+ *
+ */
+uint64_t hilbert_index(uint32_t n, uint32_t x, uint32_t y) {
+  uint64_t d = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    uint32_t rx = (x & s) > 0;
+    uint32_t ry = (y & s) > 0;
+    d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+    // rotate the quadrant
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+/**
+ * @brief the tile coordinates of a `nx * ny` grid in spiral order, starting
+ * at the centre tile
+ *
+ */
+std::vector<Point2i> spiral_order(int nx, int ny) {
+  const size_t count = static_cast<size_t>(nx) * ny;
+  std::vector<Point2i> ret;
+  ret.reserve(count);
+  constexpr int dx[] = {1, 0, -1, 0};
+  constexpr int dy[] = {0, 1, 0, -1};
+  int x = (nx - 1) / 2, y = (ny - 1) / 2;
+  auto visit = [&] {
+    if (x >= 0 && x < nx && y >= 0 && y < ny) ret.emplace_back(x, y);
+  };
+  visit();
+  // legs of length 1, 1, 2, 2, 3, 3, ... turning after each leg
+  for (int len = 1, dir = 0; ret.size() < count; ++len) {
+    for (int leg = 0; leg < 2; ++leg, dir = (dir + 1) % 4) {
+      for (int i = 0; i < len; ++i) {
+        x += dx[dir];
+        y += dy[dir];
+        visit();
+      }
+    }
+  }
+  return ret;
+}
+}  // namespace
+
+TileScheduler::TileScheduler(const Bounds2i &bounds, int tile_size,
+                             TileOrder order) {
+  DAKKU_CHECK(tile_size > 0, "invalid tile size: {}", tile_size);
+  // degenerate bounds have no tiles (also avoids overflowing the diagonal of
+  // the default, empty bounds)
+  if (bounds.p_min.x() >= bounds.p_max.x() ||
+      bounds.p_min.y() >= bounds.p_max.y())
+    return;
+  Vector2i extent = bounds.diagonal();
+  count = Point2i((extent.x() + tile_size - 1) / tile_size,
+                  (extent.y() + tile_size - 1) / tile_size);
+  const int nx = count.x(), ny = count.y();
+
+  std::vector<Point2i> coords;
+  if (order == TileOrder::SPIRAL) {
+    coords = spiral_order(nx, ny);
+  } else {
+    coords.reserve(static_cast<size_t>(nx) * ny);
+    for (int y = 0; y < ny; ++y)
+      for (int x = 0; x < nx; ++x) coords.emplace_back(x, y);
+    if (order != TileOrder::SCANLINE) {
+      // the curves are defined over a power of 2 square, the tiles outside
+      // the grid are simply skipped
+      const auto n = std::bit_ceil(static_cast<uint32_t>(std::max(nx, ny)));
+      auto key = [&](const Point2i &c) {
+        auto x = static_cast<uint32_t>(c.x());
+        auto y = static_cast<uint32_t>(c.y());
+        return order == TileOrder::MORTON ? morton_index(x, y)
+                                          : hilbert_index(n, x, y);
+      };
+      std::sort(coords.begin(), coords.end(),
+                [&](const Point2i &a, const Point2i &b) {
+                  return key(a) < key(b);
+                });
+    }
+  }
+
+  tiles.reserve(coords.size());
+  for (const Point2i &c : coords) {
+    Point2i p_min(bounds.p_min.x() + c.x() * tile_size,
+                  bounds.p_min.y() + c.y() * tile_size);
+    Point2i p_max = min(p_min + Vector2i(tile_size, tile_size), bounds.p_max);
+    tiles.emplace_back(p_min, p_max);
+  }
+}
+}  // namespace dakku
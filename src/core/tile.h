@@ -0,0 +1,107 @@
+#ifndef DAKKU_CORE_TILE_H_
+#define DAKKU_CORE_TILE_H_
+#include <core/trace.h>
+
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief the order in which the tiles are visited
+ *
+ */
+enum class TileOrder {
+  /// row major
+  SCANLINE,
+  /// morton (z-order) curve
+  MORTON,
+  /// hilbert curve
+  HILBERT,
+  /// spiral from the centre tile outwards
+  SPIRAL
+};
+
+/**
+ * @brief splits a `Bounds2i` (usually the film) into tiles, orders them by a
+ * space filling curve and runs them in parallel through tbb's work stealing
+ * scheduler, neighbouring tasks cover neighbouring tiles so that the scene
+ * data stay hot in the shared caches
+ *
+ */
+class DAKKU_EXPORT_CORE TileScheduler {
+ public:
+  /// tile iterator, dereferences to the sub `Bounds2i` of a tile
+  using iterator = std::vector<Bounds2i>::const_iterator;
+
+  /**
+   * @brief Construct a new Tile Scheduler object
+   *
+   * @param bounds the bounds to split
+   * @param tile_size edge length of the tiles (the last row/column may be
+   * smaller)
+   * @param order the order of the tiles
+   */
+  explicit TileScheduler(const Bounds2i &bounds, int tile_size = 16,
+                         TileOrder order = TileOrder::HILBERT);
+
+  /**
+   * @brief the number of tiles
+   *
+   */
+  [[nodiscard]] size_t size() const { return tiles.size(); }
+
+  /**
+   * @brief the number of tiles in x and y
+   *
+   */
+  [[nodiscard]] Point2i tile_count() const { return count; }
+
+  /**
+   * @brief get the `i`-th tile in curve order
+   *
+   */
+  [[nodiscard]] const Bounds2i &operator[](size_t i) const {
+    return tiles[i];
+  }
+
+  /**
+   * @brief begin of the tile iteration (in curve order)
+   *
+   */
+  [[nodiscard]] iterator begin() const { return tiles.begin(); }
+
+  /**
+   * @brief end of the tile iteration
+   *
+   */
+  [[nodiscard]] iterator end() const { return tiles.end(); }
+
+  /**
+   * @brief run `f(tile)` for all tiles in parallel, idle workers steal
+   * consecutive runs of tiles
+   *
+   * @param f callable with a `const Bounds2i &` parameter
+   */
+  template <typename F>
+  void parallel_for(F &&f) const {
+    oneapi::tbb::parallel_for(
+        oneapi::tbb::blocked_range<size_t>(0, tiles.size()),
+        [&](const oneapi::tbb::blocked_range<size_t> &r) {
+          for (size_t i = r.begin(); i != r.end(); ++i) {
+            TraceScope trace("Tile", tiles[i]);
+            f(tiles[i]);
+          }
+        });
+  }
+
+ private:
+  /// tiles in curve order
+  std::vector<Bounds2i> tiles;
+  /// the number of tiles in x and y
+  Point2i count;
+};
+}  // namespace dakku
+#endif
@@ -0,0 +1,104 @@
+#include <core/trace.h>
+#include <core/json.h>
+
+#include <fstream>
+
+namespace dakku {
+
+Tracer &Tracer::instance() {
+  static Tracer _instance;
+  return _instance;
+}
+
+Tracer::Tracer() : epoch(std::chrono::steady_clock::now()) {}
+
+uint64_t Tracer::now() const {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - epoch)
+          .count());
+}
+
+Tracer::Buffer &Tracer::local() {
+  // the tracer is a singleton, so the cached buffer never dangles
+  thread_local Buffer *buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard lock(mutex);
+    buffers.push_back(
+        std::make_unique<Buffer>(static_cast<uint32_t>(buffers.size())));
+    buffer = buffers.back().get();
+  }
+  return *buffer;
+}
+
+void Tracer::record(const TraceEvent &event) {
+  Buffer &buffer = local();
+  const uint64_t i = buffer.head.load(std::memory_order_relaxed);
+  buffer.events[i & (CAPACITY - 1)] = event;
+  buffer.head.store(i + 1, std::memory_order_release);
+}
+
+size_t Tracer::size() const {
+  std::lock_guard lock(mutex);
+  size_t ret = 0;
+  for (const auto &buffer : buffers)
+    ret += std::min<uint64_t>(buffer->head.load(std::memory_order_acquire),
+                              CAPACITY);
+  return ret;
+}
+
+bool Tracer::write_json(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out) {
+    DAKKU_ERR("cannot create {}", path);
+    return false;
+  }
+  std::lock_guard lock(mutex);
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  auto separator = [&] {
+    out << (first ? "\n" : ",\n");
+    first = false;
+  };
+  for (const auto &buffer : buffers) {
+    separator();
+    out << fmt::format(
+        R"({{"name": "thread_name", "ph": "M", "pid": 1, "tid": {}, )"
+        R"("args": {{"name": "thread {}"}}}})",
+        buffer->tid, buffer->tid);
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    for (uint64_t i = head > CAPACITY ? head - CAPACITY : 0; i < head; ++i) {
+      const TraceEvent &e = buffer->events[i & (CAPACITY - 1)];
+      separator();
+      // chrome traces are in microseconds
+      out << fmt::format(
+          R"({{"name": {}, "ph": "X", "pid": 1, "tid": {}, "ts": {:.3f}, )"
+          R"("dur": {:.3f})",
+          json_string(e.name), buffer->tid, e.begin * 1e-3,
+          (e.end - e.begin) * 1e-3);
+      if (e.has_tile)
+        out << fmt::format(R"(, "args": {{"tile": [{}, {}, {}, {}]}})",
+                           e.tile[0], e.tile[1], e.tile[2], e.tile[3]);
+      out << '}';
+    }
+  }
+  out << "\n]}\n";
+  return static_cast<bool>(out);
+}
+
+void Tracer::clear() {
+  std::lock_guard lock(mutex);
+  for (const auto &buffer : buffers)
+    buffer->head.store(0, std::memory_order_relaxed);
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(Tracer, [] {
+  DAKKU_INFO("register Tracer");
+  auto &state = Lua::instance().get_state();
+  state.set_function(
+      "_enable_tracing",
+      sol::overload([] { Tracer::instance().enable(); },
+                    [](bool on) { Tracer::instance().enable(on); }));
+  return 0;
+});
+}  // namespace dakku
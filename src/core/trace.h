@@ -0,0 +1,164 @@
+#ifndef DAKKU_CORE_TRACE_H_
+#define DAKKU_CORE_TRACE_H_
+#include <core/bounds.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief a recorded span (chrome "complete" event)
+ *
+ */
+struct TraceEvent {
+  /// phase name (static string)
+  const char *name;
+  /// begin time in nanoseconds since the tracer was created
+  uint64_t begin;
+  /// end time in nanoseconds since the tracer was created
+  uint64_t end;
+  /// tile of the span
+  std::array<int, 4> tile;
+  /// whether `tile` is set
+  bool has_tile;
+};
+
+/**
+ * @brief timeline tracer, every thread records into its own lock free ring
+ * buffer (the oldest events are overwritten when it is full), the buffers
+ * are dumped as chrome `trace_event` json (viewable in perfetto)
+ * disabled by default, a disabled tracer costs one relaxed load per span
+ *
+ */
+class DAKKU_EXPORT_CORE Tracer {
+ public:
+  /// events per thread buffer (power of 2)
+  static constexpr size_t CAPACITY = size_t{1} << 16;
+
+  /**
+   * @brief get tracer instance
+   *
+   */
+  static Tracer &instance();
+
+  /**
+   * @brief enable or disable recording
+   *
+   */
+  void enable(bool on = true) { enabled.store(on, std::memory_order_relaxed); }
+
+  /**
+   * @brief check whether recording is enabled
+   *
+   */
+  [[nodiscard]] bool is_enabled() const {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief nanoseconds since the tracer was created
+   *
+   */
+  [[nodiscard]] uint64_t now() const;
+
+  /**
+   * @brief record a span on the calling thread's buffer
+   *
+   */
+  void record(const TraceEvent &event);
+
+  /**
+   * @brief the number of events that are held in the buffers
+   *
+   */
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * @brief write the events as chrome trace json, call it when no thread
+   * records
+   *
+   * @return whether the file has been written
+   */
+  [[nodiscard]] bool write_json(const std::string &path) const;
+
+  /**
+   * @brief drop all events (unsynchronized)
+   *
+   */
+  void clear();
+
+ private:
+  /**
+   * @brief single producer ring buffer of a thread
+   *
+   */
+  struct Buffer {
+    explicit Buffer(uint32_t tid)
+        : tid(tid), events(std::make_unique<TraceEvent[]>(CAPACITY)) {}
+
+    /// thread index (in order of the first recorded event)
+    uint32_t tid;
+    /// the number of events ever written
+    std::atomic<uint64_t> head{0};
+    /// events, slot `i % CAPACITY` holds the `i`-th event
+    std::unique_ptr<TraceEvent[]> events;
+  };
+
+  Tracer();
+
+  /// get the calling thread's buffer (created on first use)
+  Buffer &local();
+
+  /// whether recording is enabled
+  std::atomic<bool> enabled{false};
+  /// creation time
+  std::chrono::steady_clock::time_point epoch;
+  /// guards `buffers`
+  mutable std::mutex mutex;
+  /// buffers of all threads
+  std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+/**
+ * @brief records the span of its scope when tracing is enabled
+ *
+ */
+class TraceScope {
+ public:
+  explicit TraceScope(const char *name) : name(name) {
+    if (Tracer::instance().is_enabled()) begin = Tracer::instance().now();
+  }
+  TraceScope(const char *name, const Bounds2i &tile) : TraceScope(name) {
+    this->tile = {tile.p_min.x(), tile.p_min.y(), tile.p_max.x(),
+                  tile.p_max.y()};
+    has_tile = true;
+  }
+  ~TraceScope() {
+    if (begin == NOT_RECORDED) return;
+    Tracer &tracer = Tracer::instance();
+    tracer.record(TraceEvent{name, begin, tracer.now(), tile, has_tile});
+  }
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+ private:
+  /// `begin` of a span that started while tracing was disabled
+  static constexpr uint64_t NOT_RECORDED = ~uint64_t{0};
+
+  /// span name
+  const char *name;
+  /// begin time
+  uint64_t begin{NOT_RECORDED};
+  /// tile of the span
+  std::array<int, 4> tile{};
+  /// whether `tile` is set
+  bool has_tile{false};
+};
+
+DAKKU_DECLARE_LUA_OBJECT(Tracer, DAKKU_EXPORT_CORE);
+}  // namespace dakku
+#endif
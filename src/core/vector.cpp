@@ -2,19 +2,28 @@
 
 namespace dakku {
 
+// arithmetic operators build lazy expressions, the bindings evaluate them
 #define DAKKU_IMPLEMENT_VECTOR_TYPE(name, T)                                   \
   DAKKU_IMPLEMENT_LUA_OBJECT(name, []() {                                      \
     DAKKU_INFO("register " #name);                                             \
     auto &lua = Lua::instance().get_state();                                   \
-    name (name::*negate)() const = &name::operator-;                           \
-    name (name::*add_vector)(const name &) const = &name::operator+;           \
-    name (name::*add_scalar)(T) const = &name::operator+<T>;                   \
-    name (name::*sub_vector)(const name &) const = &name::operator-;           \
-    name (name::*sub_scalar)(T) const = &name::operator-<T>;                   \
-    name (name::*mul_vector)(const name &) const = &name::operator*;           \
-    name (name::*mul_scalar)(T) const = &name::operator*<T>;                   \
-    name (name::*div_vector)(const name &) const = &name::operator/;           \
-    name (name::*div_scalar)(T) const = &name::operator/<T>;                   \
+    auto negate = [](const name &a) -> name { return -a; };                    \
+    auto add_vector = [](const name &a, const name &b) -> name {               \
+      return a + b;                                                            \
+    };                                                                         \
+    auto add_scalar = [](const name &a, T b) -> name { return a + b; };        \
+    auto sub_vector = [](const name &a, const name &b) -> name {               \
+      return a - b;                                                            \
+    };                                                                         \
+    auto sub_scalar = [](const name &a, T b) -> name { return a - b; };        \
+    auto mul_vector = [](const name &a, const name &b) -> name {               \
+      return a * b;                                                            \
+    };                                                                         \
+    auto mul_scalar = [](const name &a, T b) -> name { return a * b; };        \
+    auto div_vector = [](const name &a, const name &b) -> name {               \
+      return a / b;                                                            \
+    };                                                                         \
+    auto div_scalar = [](const name &a, T b) -> name { return a / b; };        \
     lua.new_usertype<name>(                                                    \
         #name, sol::constructors<name(), name(T), name(const sol::table &)>(), \
         sol::meta_function::new_index, &name::set_by_index<T>, "clone",        \
@@ -29,6 +38,7 @@ namespace dakku {
     return 0;                                                                  \
   })
 
+DAKKU_IMPLEMENT_VECTOR_TYPE(Vector4f, float);
 DAKKU_IMPLEMENT_VECTOR_TYPE(Vector3f, float);
 DAKKU_IMPLEMENT_VECTOR_TYPE(Vector3i, int);
 DAKKU_IMPLEMENT_VECTOR_TYPE(Vector2f, float);
@@ -38,16 +48,26 @@ DAKKU_IMPLEMENT_VECTOR_TYPE(Vector2i, int);
   DAKKU_IMPLEMENT_LUA_OBJECT(name, []() {                                      \
     DAKKU_INFO("register " #name);                                             \
     auto &lua = Lua::instance().get_state();                                   \
-    name (name::*negate)() const = &name::operator-;                           \
-    name (name::*add_vector)(const name &) const = &name::operator+;           \
-    name (name::*add_scalar)(T) const = &name::operator+<T>;                   \
-    name (name::*sub_vector)(const vector_type &) const = &name::operator-;    \
-    vector_type (name::*sub_point)(const name &) const = &name::operator-;     \
-    name (name::*sub_scalar)(T) const = &name::operator-<T>;                   \
-    name (name::*mul_vector)(const name &) const = &name::operator*;           \
-    name (name::*mul_scalar)(T) const = &name::operator*<T>;                   \
-    name (name::*div_vector)(const name &) const = &name::operator/;           \
-    name (name::*div_scalar)(T) const = &name::operator/<T>;                   \
+    auto negate = [](const name &a) -> name { return -a; };                    \
+    auto add_vector = [](const name &a, const name &b) -> name {               \
+      return a + b;                                                            \
+    };                                                                         \
+    auto add_scalar = [](const name &a, T b) -> name { return a + b; };        \
+    auto sub_vector = [](const name &a, const vector_type &b) -> name {        \
+      return a - b;                                                            \
+    };                                                                         \
+    auto sub_point = [](const name &a, const name &b) -> vector_type {         \
+      return a - b;                                                            \
+    };                                                                         \
+    auto sub_scalar = [](const name &a, T b) -> name { return a - b; };        \
+    auto mul_vector = [](const name &a, const name &b) -> name {               \
+      return a * b;                                                            \
+    };                                                                         \
+    auto mul_scalar = [](const name &a, T b) -> name { return a * b; };        \
+    auto div_vector = [](const name &a, const name &b) -> name {               \
+      return a / b;                                                            \
+    };                                                                         \
+    auto div_scalar = [](const name &a, T b) -> name { return a / b; };        \
     lua.new_usertype<name>(                                                    \
         #name, sol::constructors<name(), name(T), name(const sol::table &)>(), \
         sol::meta_function::new_index, &name::set_by_index<T>, "clone",        \
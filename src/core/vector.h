@@ -15,38 +15,7 @@ template <typename T, size_t S>
 class Vector : public VectorBase<T, S, Vector<T, S>> {
  public:
   using VectorBase<T, S, Vector<T, S>>::VectorBase;
-
-  /**
-   * @brief negation of the vector
-   *
-   * @return $-\vec v$
-   */
-  Vector operator-() const {
-    Vector ret = *this;
-    for (size_t i = 0; i < S; ++i) ret[i] = -ret[i];
-    return ret;
-  }
-
-  /**
-   * @brief subtraction
-   *
-   */
-  Vector operator-(const Vector &rhs) const {
-    Vector ret = *this;
-    ret -= rhs;
-    return ret;
-  }
-
-  /**
-   * @brief subtraction
-   *
-   */
-  template <ArithmeticType V>
-  Vector operator-(V rhs) const {
-    Vector ret = *this;
-    ret -= rhs;
-    return ret;
-  }
+  using VectorBase<T, S, Vector<T, S>>::operator=;
 };
 
 /// 2d int vector
@@ -57,11 +26,14 @@ using Vector2f = Vector<float, 2>;
 using Vector3i = Vector<int, 3>;
 /// 3d float vector
 using Vector3f = Vector<float, 3>;
+/// 4d float vector
+using Vector4f = Vector<float, 4>;
 
 DAKKU_DECLARE_LUA_OBJECT(Vector2i, DAKKU_EXPORT_CORE);
 DAKKU_DECLARE_LUA_OBJECT(Vector2f, DAKKU_EXPORT_CORE);
 DAKKU_DECLARE_LUA_OBJECT(Vector3i, DAKKU_EXPORT_CORE);
 DAKKU_DECLARE_LUA_OBJECT(Vector3f, DAKKU_EXPORT_CORE);
+DAKKU_DECLARE_LUA_OBJECT(Vector4f, DAKKU_EXPORT_CORE);
 
 /**
  * @brief point
@@ -73,56 +45,34 @@ template <typename T, size_t S>
 class Point : public VectorBase<T, S, Point<T, S>> {
  public:
   using VectorBase<T, S, Point<T, S>>::VectorBase;
+  using VectorBase<T, S, Point<T, S>>::operator=;
+};
 
-  /**
-   * @brief negation of the point
-   *
-   * @return $-v$
-   */
-  Point operator-() const {
-    Point ret = *this;
-    for (size_t i = 0; i < S; ++i) ret[i] = -ret[i];
-    return ret;
-  }
-
-  /**
-   * @brief subtraction
-   *
-   */
-  template <ArithmeticType V>
-  Point operator-(V rhs) const {
-    Point ret = *this;
-    ret -= rhs;
-    return ret;
-  }
-
-  /**
-   * @brief subtraction
-   *
-   */
-  Vector<T, S> operator-(const Point &rhs) const {
-    Point ret = *this;
-    ret -= rhs;
-    return Vector<T, S>{ret};
-  }
+/**
+ * @brief point - point => vector
+ *
+ */
+template <typename T, size_t S>
+struct VectorOpResult<VectorSubOp, Point<T, S>, Point<T, S>> {
+  using type = Vector<T, S>;
+};
 
-  /**
-   * @brief subtraction
-   *
-   */
-  Point operator-(const Vector<T, S> &rhs) const {
-    Point ret = *this;
-    ret -= Point(rhs);
-    return ret;
-  }
+/**
+ * @brief point + vector => point
+ *
+ */
+template <typename T, size_t S>
+struct VectorOpResult<VectorAddOp, Point<T, S>, Vector<T, S>> {
+  using type = Point<T, S>;
+};
 
-  /**
-   * @brief point + vector => point
-   *
-   */
-  friend Point operator+(const Point &a, const Vector<T, S> &b) {
-    return Point(Vector<T, S>(a) + b);
-  }
+/**
+ * @brief point - vector => point
+ *
+ */
+template <typename T, size_t S>
+struct VectorOpResult<VectorSubOp, Point<T, S>, Vector<T, S>> {
+  using type = Point<T, S>;
 };
 
 /// 3d float point
@@ -148,38 +98,7 @@ template <typename T, size_t S>
 class Normal : public VectorBase<T, S, Normal<T, S>> {
  public:
   using VectorBase<T, S, Normal<T, S>>::VectorBase;
-
-  /**
-   * @brief negation of the vector
-   *
-   * @return $-\vec v$
-   */
-  Normal operator-() const {
-    Normal ret = *this;
-    for (size_t i = 0; i < S; ++i) ret[i] = -ret[i];
-    return ret;
-  }
-
-  /**
-   * @brief subtraction
-   *
-   */
-  Normal operator-(const Normal &rhs) const {
-    Normal ret = *this;
-    ret -= rhs;
-    return ret;
-  }
-
-  /**
-   * @brief subtraction
-   *
-   */
-  template <ArithmeticType V>
-  Normal operator-(V rhs) const {
-    Normal ret = *this;
-    ret -= rhs;
-    return ret;
-  }
+  using VectorBase<T, S, Normal<T, S>>::operator=;
 };
 
 /// 3d float normal
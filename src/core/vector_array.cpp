@@ -0,0 +1,82 @@
+#include <core/vector_array.h>
+
+namespace dakku {
+
+namespace {
+/**
+ * @brief register the shared bindings of `VectorArray<V>`, elements are
+ * indexed from 1 like lua arrays, bulk operations run in c++
+ *
+ */
+template <typename V>
+auto register_vector_array(const char *name) {
+  using A = VectorArray<V>;
+  using Offset = Vector<float, A::SIZE>;
+  auto &lua = Lua::instance().get_state();
+  auto check_index = [](const A &a, int64_t i) {
+    if (i < 1 || static_cast<size_t>(i) > a.size())
+      lua_error("index out of range: {} not in [1, {}]", i, a.size());
+  };
+  auto index = [=](const A &a, int64_t i) -> V {
+    check_index(a, i);
+    return a.get(static_cast<size_t>(i - 1));
+  };
+  auto new_index = [=](A &a, int64_t i, const V &v) {
+    check_index(a, i);
+    a.set(static_cast<size_t>(i - 1), v);
+  };
+  auto check_size = [](const A &a, const A &b) {
+    if (a.size() != b.size())
+      lua_error("size mismatch: {} != {}", b.size(), a.size());
+  };
+  auto add_vector = [](A &a, const Offset &v) -> A & { return a += v; };
+  auto add_array = [=](A &a, const A &b) -> A & {
+    check_size(a, b);
+    return a += b;
+  };
+  auto sub_vector = [](A &a, const Offset &v) -> A & { return a -= v; };
+  auto sub_array = [=](A &a, const A &b) -> A & {
+    check_size(a, b);
+    return a -= b;
+  };
+  auto scale_scalar = [](A &a, float s) -> A & { return a *= s; };
+  auto scale_vector = [](A &a, const Offset &s) -> A & { return a *= s; };
+  auto transform = [](A &a, const sol::table &m) -> A & {
+    std::array<float, A::SIZE *(A::SIZE + 1)> matrix{};
+    if (m.size() != matrix.size())
+      lua_error("expect {} matrix entries, got {}", matrix.size(), m.size());
+    for (size_t i = 0; i < matrix.size(); ++i) matrix[i] = m[i + 1];
+    return a.transform(matrix);
+  };
+  return lua.new_usertype<A>(
+      name,
+      sol::constructors<A(), A(size_t), A(const sol::table &)>(),
+      "from_string", &A::from_string, sol::meta_function::index, index,
+      sol::meta_function::new_index, new_index, sol::meta_function::length,
+      &A::size, "push_back", &A::push_back, "resize", &A::resize, "add",
+      sol::overload(add_vector, add_array), "sub",
+      sol::overload(sub_vector, sub_array), "scale",
+      sol::overload(scale_scalar, scale_vector), "transform", transform,
+      "bounds", &A::bounds);
+}
+}  // namespace
+
+DAKKU_IMPLEMENT_LUA_OBJECT(Vector3fArray, [] {
+  DAKKU_INFO("register Vector3fArray");
+  auto type = register_vector_array<Vector3f>("Vector3fArray");
+  type["normalize"] = &Vector3fArray::normalize;
+  return 0;
+});
+
+DAKKU_IMPLEMENT_LUA_OBJECT(Point3fArray, [] {
+  DAKKU_INFO("register Point3fArray");
+  register_vector_array<Point3f>("Point3fArray");
+  return 0;
+});
+
+DAKKU_IMPLEMENT_LUA_OBJECT(Point2fArray, [] {
+  DAKKU_INFO("register Point2fArray");
+  register_vector_array<Point2f>("Point2fArray");
+  return 0;
+});
+}  // namespace dakku
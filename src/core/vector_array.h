@@ -0,0 +1,307 @@
+#ifndef DAKKU_CORE_VECTOR_ARRAY_H_
+#define DAKKU_CORE_VECTOR_ARRAY_H_
+#include <core/bounds.h>
+
+#include <charconv>
+#include <string_view>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief contiguous array of float vectors (or points), stored packed
+ * (x0, y0, z0, x1, ...) without per element padding, so that it can be
+ * handed to meshes, the scene cache or lua without per element userdata
+ * all bulk operations run in c++
+ *
+ * @tparam V element type (`Vector3f`, `Point3f`, `Point2f`, ...)
+ */
+template <typename V>
+requires std::is_same_v<typename V::Scalar, float> class VectorArray {
+ public:
+  /// component count
+  static constexpr size_t SIZE = V::SIZE;
+  /// bounds of the elements
+  using Bounds = std::conditional_t<SIZE == 2, Bounds2f, Bounds3f>;
+
+  VectorArray() = default;
+
+  /**
+   * @brief Construct a new Vector Array object with `n` zero elements
+   *
+   */
+  explicit VectorArray(size_t n) : values(n * SIZE) {}
+
+  /**
+   * @brief Construct a new Vector Array object from a lua array, either flat
+   * numbers (`{x0, y0, z0, x1, ...}`), nested arrays (`{{x0, y0, z0}, ...}`)
+   * or elements (`{Point3f.new(...), ...}`), raises a lua error on anything
+   * else or on an incomplete element
+   *
+   */
+  explicit VectorArray(const sol::table &table) {
+    values.reserve(table.size() * SIZE);
+    for (size_t i = 1; i <= table.size(); ++i) {
+      sol::object o = table[i];
+      if (o.get_type() == sol::type::number) {
+        values.push_back(o.as<float>());
+        continue;
+      }
+      if (values.size() % SIZE != 0)
+        lua_error("element {} follows {} trailing numbers", i,
+                  values.size() % SIZE);
+      if (o.get_type() == sol::type::table) {
+        auto t = o.as<sol::table>();
+        if (t.size() != SIZE)
+          lua_error("element {} has {} components, expect {}", i, t.size(),
+                    SIZE);
+        for (size_t j = 1; j <= SIZE; ++j) {
+          sol::object c = t[j];
+          if (c.get_type() != sol::type::number)
+            lua_error("component {} of element {} is not a number", j, i);
+          values.push_back(c.as<float>());
+        }
+      } else if (o.is<V>()) {
+        push_back(o.as<V>());
+      } else {
+        lua_error("invalid element {} of {} array", i, SIZE);
+      }
+    }
+    if (values.size() % SIZE != 0)
+      lua_error("{} trailing numbers don't make an element",
+                values.size() % SIZE);
+  }
+
+  /**
+   * @brief parse numbers separated by spaces, commas or semicolons
+   * (`"x0 y0 z0, x1 y1 z1"`), parsing stops at the first invalid number
+   *
+   */
+  static VectorArray from_string(std::string_view s) {
+    VectorArray ret;
+    const char *p = s.data(), *end = s.data() + s.size();
+    while (true) {
+      while (p != end && (std::isspace(static_cast<unsigned char>(*p)) ||
+                          *p == ',' || *p == ';'))
+        ++p;
+      if (p == end) break;
+      float v;
+      auto [next, ec] = std::from_chars(p, end, v);
+      if (ec != std::errc{}) {
+        DAKKU_ERR("invalid number at {} of \"{}\"", p - s.data(), s);
+        break;
+      }
+      ret.values.push_back(v);
+      p = next;
+    }
+    ret.truncate();
+    return ret;
+  }
+
+  /**
+   * @brief the number of elements
+   *
+   */
+  [[nodiscard]] size_t size() const { return values.size() / SIZE; }
+
+  /**
+   * @brief resize to `n` elements (new elements are zero)
+   *
+   */
+  void resize(size_t n) { values.resize(n * SIZE); }
+
+  /**
+   * @brief reserve space for `n` elements
+   *
+   */
+  void reserve(size_t n) { values.reserve(n * SIZE); }
+
+  /**
+   * @brief append an element
+   *
+   */
+  void push_back(const V &v) {
+    for (size_t j = 0; j < SIZE; ++j) values.push_back(v[j]);
+  }
+
+  /**
+   * @brief get element `i`
+   *
+   */
+  [[nodiscard]] V get(size_t i) const {
+    DAKKU_CHECK(i < size(), "index out of range: {} >= {}", i, size());
+    V ret;
+    for (size_t j = 0; j < SIZE; ++j) ret[j] = values[i * SIZE + j];
+    return ret;
+  }
+
+  /**
+   * @brief set element `i`
+   *
+   */
+  void set(size_t i, const V &v) {
+    DAKKU_CHECK(i < size(), "index out of range: {} >= {}", i, size());
+    for (size_t j = 0; j < SIZE; ++j) values[i * SIZE + j] = v[j];
+  }
+
+  /**
+   * @brief get the packed components
+   *
+   */
+  [[nodiscard]] std::span<const float> data() const { return values; }
+
+  /**
+   * @brief get the packed components
+   *
+   */
+  std::span<float> data() { return values; }
+
+  /**
+   * @brief get the components as structure of arrays (`ret[j][i]` is
+   * component `j` of element `i`)
+   *
+   */
+  [[nodiscard]] std::array<std::vector<float>, SIZE> to_soa() const {
+    std::array<std::vector<float>, SIZE> ret;
+    for (auto &c : ret) c.resize(size());
+    for (size_t i = 0; i < size(); ++i)
+      for (size_t j = 0; j < SIZE; ++j) ret[j][i] = values[i * SIZE + j];
+    return ret;
+  }
+
+  /**
+   * @brief add `v` to all elements
+   *
+   */
+  VectorArray &operator+=(const Vector<float, SIZE> &v) {
+    return apply([&](float x, size_t j) { return x + v[j]; });
+  }
+
+  /**
+   * @brief subtract `v` from all elements
+   *
+   */
+  VectorArray &operator-=(const Vector<float, SIZE> &v) {
+    return apply([&](float x, size_t j) { return x - v[j]; });
+  }
+
+  /**
+   * @brief scale all elements
+   *
+   */
+  VectorArray &operator*=(float s) {
+    return apply([&](float x, size_t) { return x * s; });
+  }
+
+  /**
+   * @brief scale all elements component wise
+   *
+   */
+  VectorArray &operator*=(const Vector<float, SIZE> &s) {
+    return apply([&](float x, size_t j) { return x * s[j]; });
+  }
+
+  /**
+   * @brief add the elements of `rhs` element wise
+   *
+   */
+  VectorArray &operator+=(const VectorArray &rhs) {
+    DAKKU_CHECK(rhs.size() == size(), "size mismatch: {} != {}", rhs.size(),
+                size());
+    for (size_t k = 0; k < values.size(); ++k) values[k] += rhs.values[k];
+    return *this;
+  }
+
+  /**
+   * @brief subtract the elements of `rhs` element wise
+   *
+   */
+  VectorArray &operator-=(const VectorArray &rhs) {
+    DAKKU_CHECK(rhs.size() == size(), "size mismatch: {} != {}", rhs.size(),
+                size());
+    for (size_t k = 0; k < values.size(); ++k) values[k] -= rhs.values[k];
+    return *this;
+  }
+
+  /**
+   * @brief apply an affine transform given as a row major
+   * $SIZE \times (SIZE + 1)$ matrix, the last column (translation) only
+   * applies to points
+   *
+   */
+  VectorArray &transform(std::span<const float, SIZE *(SIZE + 1)> m) {
+    constexpr bool is_point = std::is_same_v<V, Point<float, SIZE>>;
+    for (size_t i = 0; i < values.size(); i += SIZE) {
+      std::array<float, SIZE> r;
+      for (size_t row = 0; row < SIZE; ++row) {
+        float sum = is_point ? m[row * (SIZE + 1) + SIZE] : 0.0f;
+        for (size_t col = 0; col < SIZE; ++col)
+          sum += m[row * (SIZE + 1) + col] * values[i + col];
+        r[row] = sum;
+      }
+      std::copy(r.begin(), r.end(), values.begin() + i);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief normalize all elements (vectors only)
+   *
+   */
+  VectorArray &normalize() requires std::is_same_v<V, Vector<float, SIZE>> {
+    for (size_t i = 0; i < values.size(); i += SIZE) {
+      float sum = 0;
+      for (size_t j = 0; j < SIZE; ++j) sum += values[i + j] * values[i + j];
+      const float inv = sum > 0 ? 1 / std::sqrt(sum) : 0;
+      for (size_t j = 0; j < SIZE; ++j) values[i + j] *= inv;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief get the bounds of all elements
+   *
+   */
+  [[nodiscard]] Bounds bounds() const {
+    Bounds ret;
+    for (size_t i = 0; i < values.size(); i += SIZE) {
+      Point<float, SIZE> p;
+      for (size_t j = 0; j < SIZE; ++j) p[j] = values[i + j];
+      ret = ret | p;
+    }
+    return ret;
+  }
+
+ private:
+  /// `values[k] = f(values[k], component of k)`
+  template <typename F>
+  VectorArray &apply(F &&f) {
+    for (size_t i = 0; i < values.size(); i += SIZE)
+      for (size_t j = 0; j < SIZE; ++j) values[i + j] = f(values[i + j], j);
+    return *this;
+  }
+
+  /// drop trailing components of an incomplete element
+  void truncate() {
+    if (values.size() % SIZE != 0) {
+      DAKKU_ERR("{} trailing components are dropped", values.size() % SIZE);
+      values.resize(values.size() / SIZE * SIZE);
+    }
+  }
+
+  /// packed components
+  std::vector<float> values;
+};
+
+/// contiguous 3d float vectors
+using Vector3fArray = VectorArray<Vector3f>;
+/// contiguous 3d float points
+using Point3fArray = VectorArray<Point3f>;
+/// contiguous 2d float points
+using Point2fArray = VectorArray<Point2f>;
+
+DAKKU_DECLARE_LUA_OBJECT(Vector3fArray, DAKKU_EXPORT_CORE);
+DAKKU_DECLARE_LUA_OBJECT(Point3fArray, DAKKU_EXPORT_CORE);
+DAKKU_DECLARE_LUA_OBJECT(Point2fArray, DAKKU_EXPORT_CORE);
+}  // namespace dakku
+#endif
@@ -2,13 +2,65 @@
 #define DAKKU_CORE_VECTOR_BASE_H_
 #include <core/logger.h>
 #include <core/lua.h>
+#include <core/math_func.h>
+#include <core/simd.h>
+#include <core/vector_expr.h>
 
 #include <array>
+#include <bit>
 #include <numeric>
 #include <span>
 
 namespace dakku {
 
+/**
+ * @brief vector storage, a plain array of `S` components
+ *
+ * @tparam T type
+ * @tparam S size
+ */
+template <ArithmeticType T, size_t S>
+struct VectorStorage : std::array<T, S> {
+  /// whether the storage is held in a simd register
+  static constexpr bool SIMD = false;
+};
+
+#ifdef DAKKU_ENABLE_SSE
+/**
+ * @brief 3d/4d float vector storage, held in a (padded) `__m128`
+ * the padding lane of 3d vectors is unspecified and never observed
+ *
+ * @tparam S size
+ */
+template <size_t S>
+requires(S == 3 || S == 4) struct VectorStorage<float, S> {
+  /// whether the storage is held in a simd register
+  static constexpr bool SIMD = true;
+  /// mask of the lanes in use (movemask layout)
+  static constexpr int LANES = (1 << S) - 1;
+
+  float *data() { return reinterpret_cast<float *>(&m); }
+  [[nodiscard]] const float *data() const {
+    return reinterpret_cast<const float *>(&m);
+  }
+  float &operator[](size_t i) { return data()[i]; }
+  const float &operator[](size_t i) const { return data()[i]; }
+  float *begin() { return data(); }
+  float *end() { return data() + S; }
+  [[nodiscard]] const float *begin() const { return data(); }
+  [[nodiscard]] const float *end() const { return data() + S; }
+  [[nodiscard]] size_t size() const { return S; }
+  void fill(float value) { m = _mm_set1_ps(value); }
+
+  bool operator==(const VectorStorage &rhs) const {
+    return (_mm_movemask_ps(_mm_cmpeq_ps(m, rhs.m)) & LANES) == LANES;
+  }
+
+  /// packed components
+  __m128 m{_mm_setzero_ps()};
+};
+#endif
+
 /**
  * @brief vector base
  *
@@ -18,7 +70,22 @@ namespace dakku {
  */
 template <ArithmeticType T, size_t S, typename D>
 class VectorBase {
+  template <ArithmeticType, size_t, typename>
+  friend class VectorBase;
+  template <typename>
+  friend class VectorLeaf;
+
+  /// storage type
+  using Storage = VectorStorage<T, S>;
+  /// whether the vector is backed by simd registers
+  static constexpr bool SIMD = Storage::SIMD;
+
  public:
+  /// component type
+  using Scalar = T;
+  /// number of components
+  static constexpr size_t SIZE = S;
+
   /**
    * @brief Construct a new Vector Base object
    * all components initialized to zero
@@ -74,6 +141,24 @@ class VectorBase {
     DAKKU_CHECK(!has_nans(), "has nan");
   }
 
+  /**
+   * @brief Construct a new Vector Base object by evaluating a vector
+   * expression
+   *
+   * @tparam E expression type
+   * @tparam R the type the expression evaluates to
+   * @param expr the given expression
+   */
+  template <typename E, typename R>
+  explicit VectorBase(const VectorExpr<E, R> &expr) {
+    if constexpr (std::is_same_v<R, D>) {
+      assign(expr.expr());
+    } else {
+      set(expr.eval());
+      DAKKU_CHECK(!has_nans(), "has nan");
+    }
+  }
+
   VectorBase(const VectorBase &other) : _data(other._data) {
     DAKKU_CHECK(!has_nans(), "has nan");
   }
@@ -93,6 +178,18 @@ class VectorBase {
     return *this;
   }
 
+  /**
+   * @brief evaluate a vector expression into this vector
+   *
+   * @tparam E expression type
+   * @param expr the given expression
+   */
+  template <typename E>
+  D &operator=(const VectorExpr<E, D> &expr) {
+    assign(expr.expr());
+    return derived();
+  }
+
   /**
    * @brief convert to derived type
    *
@@ -165,7 +262,11 @@ class VectorBase {
    */
   template <ArithmeticType Other, typename OtherDerived>
   void set(const VectorBase<Other, S, OtherDerived> &rhs) {
-    for (size_t i = 0; i < S; ++i) _data[i] = static_cast<T>(rhs[i]);
+    if constexpr (SIMD && std::is_same_v<T, Other>) {
+      _data.m = rhs._data.m;
+    } else {
+      for (size_t i = 0; i < S; ++i) _data[i] = static_cast<T>(rhs[i]);
+    }
   }
 
   /**
@@ -207,8 +308,13 @@ class VectorBase {
    * @return false vector does not contain nans
    */
   [[nodiscard]] bool has_nans() const {
-    return std::any_of(std::begin(_data), std::end(_data),
-                       [](T x) { return isnan(x); });
+    if constexpr (SIMD) {
+      return (_mm_movemask_ps(_mm_cmpunord_ps(_data.m, _data.m)) &
+              Storage::LANES) != 0;
+    } else {
+      return std::any_of(std::begin(_data), std::end(_data),
+                         [](T x) { return isnan(x); });
+    }
   }
 
   /**
@@ -241,9 +347,9 @@ class VectorBase {
    * @param rhs another vector
    * @return this
    */
-  D &operator+=(const D &rhs) {
-    for (size_t i = 0; i < S; ++i) _data[i] += rhs[i];
-    return derived();
+  template <VectorOperand E>
+  requires std::is_same_v<VectorResult<E>, D> D &operator+=(const E &rhs) {
+    return update<VectorAddOp>(rhs);
   }
 
   /**
@@ -254,56 +360,25 @@ class VectorBase {
    */
   template <ArithmeticType V>
   D &operator+=(V rhs) {
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD && SimdScalarType<V>) {
+      _data.m = _mm_add_ps(_data.m, _mm_set1_ps(static_cast<float>(rhs)));
+      return derived();
+    }
+#endif
     for (size_t i = 0; i < S; ++i) _data[i] += rhs;
     return derived();
   }
 
-  /**
-   * @brief addition
-   *
-   * @param rhs another vector
-   * @return result
-   */
-  D operator+(const D &rhs) const {
-    D ret = derived();
-    ret += rhs;
-    return ret;
-  }
-
-  /**
-   * @brief addition
-   *
-   * @param rhs another vector
-   * @return result
-   */
-  template <ArithmeticType V>
-  D operator+(V rhs) const {
-    D ret = derived();
-    ret += rhs;
-    return ret;
-  }
-
-  /**
-   * @brief addition
-   *
-   * @param a $a$
-   * @param b $\vec b$
-   * @return elementwise add a
-   */
-  template <ArithmeticType U>
-  friend D operator+(U a, const D &b) {
-    return b + a;
-  }
-
   /**
    * @brief subtraction
    *
    * @param rhs another vector
    * @return this
    */
-  D &operator-=(const D &rhs) {
-    for (size_t i = 0; i < S; ++i) _data[i] -= rhs[i];
-    return derived();
+  template <VectorOperand E>
+  requires std::is_same_v<VectorResult<E>, D> D &operator-=(const E &rhs) {
+    return update<VectorSubOp>(rhs);
   }
 
   /**
@@ -314,33 +389,25 @@ class VectorBase {
    */
   template <ArithmeticType V>
   D &operator-=(V rhs) {
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD && SimdScalarType<V>) {
+      _data.m = _mm_sub_ps(_data.m, _mm_set1_ps(static_cast<float>(rhs)));
+      return derived();
+    }
+#endif
     for (size_t i = 0; i < S; ++i) _data[i] -= rhs;
     return derived();
   }
 
-  /**
-   * @brief subtraction
-   *
-   * @param a $a$
-   * @param b $\vec b$
-   * @return elementwise sub
-   */
-  template <ArithmeticType U>
-  friend D operator-(U a, const D &b) {
-    D ret = -b;
-    ret += a;
-    return ret;
-  }
-
   /**
    * @brief multiplication
    *
    * @param rhs another vector
    * @return this
    */
-  D &operator*=(const D &rhs) {
-    for (size_t i = 0; i < S; ++i) _data[i] *= rhs[i];
-    return derived();
+  template <VectorOperand E>
+  requires std::is_same_v<VectorResult<E>, D> D &operator*=(const E &rhs) {
+    return update<VectorMulOp>(rhs);
   }
 
   /**
@@ -351,56 +418,25 @@ class VectorBase {
    */
   template <ArithmeticType V>
   D &operator*=(V rhs) {
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD && SimdScalarType<V>) {
+      _data.m = _mm_mul_ps(_data.m, _mm_set1_ps(static_cast<float>(rhs)));
+      return derived();
+    }
+#endif
     for (size_t i = 0; i < S; ++i) _data[i] *= rhs;
     return derived();
   }
 
-  /**
-   * @brief multiplication
-   *
-   * @param rhs another vector
-   * @return result
-   */
-  D operator*(const D &rhs) const {
-    D ret = derived();
-    ret *= rhs;
-    return ret;
-  }
-
-  /**
-   * @brief multiplication
-   *
-   * @param rhs scalar
-   * @return result
-   */
-  template <ArithmeticType V>
-  D operator*(V rhs) const {
-    D ret = derived();
-    ret *= rhs;
-    return ret;
-  }
-
-  /**
-   * @brief multiplication
-   *
-   * @param a $a$
-   * @param b $\vec b$
-   * @return elementwise mul
-   */
-  template <ArithmeticType U>
-  friend D operator*(U a, const D &b) {
-    return b * a;
-  }
-
   /**
    * @brief division
    *
    * @param rhs another vector
    * @return this
    */
-  D &operator/=(const D &rhs) {
-    for (size_t i = 0; i < S; ++i) _data[i] /= rhs[i];
-    return derived();
+  template <VectorOperand E>
+  requires std::is_same_v<VectorResult<E>, D> D &operator/=(const E &rhs) {
+    return update<VectorDivOp>(rhs);
   }
 
   /**
@@ -414,43 +450,6 @@ class VectorBase {
     return derived() *= static_cast<T>(T{1} / rhs);
   }
 
-  /**
-   * @brief division
-   *
-   * @param rhs another vector
-   * @return result
-   */
-  D operator/(const D &rhs) const {
-    D ret = derived();
-    ret /= rhs;
-    return ret;
-  }
-
-  /**
-   * @brief division
-   *
-   * @param rhs scalar
-   * @return result
-   */
-  template <ArithmeticType U>
-  D operator/(U rhs) const {
-    D ret = derived();
-    ret /= rhs;
-    return ret;
-  }
-
-  /**
-   * @brief division
-   *
-   * @param a $a$
-   * @param b $\vec b$
-   * @return elementwise div (broad cast $a$)
-   */
-  template <ArithmeticType U>
-  friend D operator/(U a, const D &b) {
-    return D(a) / b;
-  }
-
   /**
    * @brief output the vector
    *
@@ -544,6 +543,18 @@ class VectorBase {
    * @return the index
    */
   [[nodiscard]] size_t max_element_index() const {
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD) {
+      __m128 v = _data.m;
+      // replicate x into the padding lane so it never wins
+      if constexpr (S == 3) v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 2, 1, 0));
+      __m128 m = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+      m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+      // the first lane equals to the max, same as `std::max_element`
+      int mask = _mm_movemask_ps(_mm_cmpeq_ps(v, m));
+      return mask ? std::countr_zero(static_cast<unsigned>(mask)) : 0;
+    }
+#endif
     return std::distance(_data.begin(),
                          std::max_element(_data.begin(), _data.end()));
   }
@@ -561,7 +572,12 @@ class VectorBase {
    */
   friend D max(const D &v1, const D &v2) {
     D ret = v1;
-    for (size_t i = 0; i < S; ++i) ret[i] = std::max(ret[i], v2[i]);
+    if constexpr (SIMD) {
+      // operands swapped: `std::max(a, b)` is `(b > a) ? b : a`
+      ret._data.m = _mm_max_ps(v2._data.m, v1._data.m);
+    } else {
+      for (size_t i = 0; i < S; ++i) ret[i] = std::max(ret[i], v2[i]);
+    }
     return ret;
   }
 
@@ -577,7 +593,12 @@ class VectorBase {
    */
   friend D min(const D &v1, const D &v2) {
     D ret = v1;
-    for (size_t i = 0; i < S; ++i) ret[i] = std::min(ret[i], v2[i]);
+    if constexpr (SIMD) {
+      // operands swapped: `std::min(a, b)` is `(b < a) ? b : a`
+      ret._data.m = _mm_min_ps(v2._data.m, v1._data.m);
+    } else {
+      for (size_t i = 0; i < S; ++i) ret[i] = std::min(ret[i], v2[i]);
+    }
     return ret;
   }
 
@@ -593,9 +614,21 @@ class VectorBase {
    * @return $\vec a \cdot \vec b$
    */
   template <typename OtherDerived>
-  decltype(auto) dot(const VectorBase<T, S, OtherDerived> &rhs) const {
-    return std::inner_product(_data.begin(), _data.end(), rhs._data.begin(),
-                              T{});
+  T dot(const VectorBase<T, S, OtherDerived> &rhs) const {
+    // sum in component order: ((x + y) + z) + w
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD) {
+      __m128 p = _mm_mul_ps(_data.m, rhs._data.m);
+      __m128 s = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+      s = _mm_add_ss(s, _mm_movehl_ps(p, p));
+      if constexpr (S == 4)
+        s = _mm_add_ss(s, _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3)));
+      return _mm_cvtss_f32(s);
+    }
+#endif
+    T ret = _data[0] * rhs._data[0];
+    for (size_t i = 1; i < S; ++i) ret += _data[i] * rhs._data[i];
+    return ret;
   }
 
   /**
@@ -641,6 +674,12 @@ class VectorBase {
    */
   friend D abs(const D &v) {
     D ret = v;
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD) {
+      ret._data.m = _mm_andnot_ps(_mm_set1_ps(-0.0f), v._data.m);
+      return ret;
+    }
+#endif
     for (size_t i = 0; i < S; ++i) ret[i] = std::abs(ret[i]);
     return ret;
   }
@@ -657,6 +696,19 @@ class VectorBase {
    */
   D cross(const D &rhs) const {
     static_assert(S == 3, "only 3d vector support cross product");
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD) {
+      const __m128 a = _data.m;
+      const __m128 b = rhs._data.m;
+      D ret;
+      ret._data.m = _mm_sub_ps(
+          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)),
+                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2))),
+          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)),
+                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))));
+      return ret;
+    }
+#endif
     return D{(y() * rhs.z()) - (z() * rhs.y()),
              (z() * rhs.x()) - (x() * rhs.z()),
              (x() * rhs.y()) - (y() * rhs.x())};
@@ -667,6 +719,12 @@ class VectorBase {
    *
    */
   [[nodiscard]] bool is_zero() const {
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD) {
+      return (_mm_movemask_ps(_mm_cmpeq_ps(_data.m, _mm_setzero_ps())) &
+              Storage::LANES) == Storage::LANES;
+    }
+#endif
     return std::all_of(_data.begin(), _data.end(),
                        [](const T &v) { return v == 0; });
   }
@@ -677,7 +735,12 @@ class VectorBase {
    */
   friend D sqrt(const D &v) {
     D ret = v;
-    for (size_t i = 0; i < S; ++i) ret[i] = static_cast<T>(std::sqrt(ret[i]));
+    if constexpr (SIMD) {
+      ret._data.m = _mm_sqrt_ps(v._data.m);
+    } else {
+      for (size_t i = 0; i < S; ++i)
+        ret[i] = static_cast<T>(std::sqrt(ret[i]));
+    }
     return ret;
   }
 
@@ -771,12 +834,65 @@ class VectorBase {
    */
   D lerp(const D &b, T t) const { return lerp(derived(), b, t); }
 
-  operator std::span<T, S>() { return std::span{_data}; }
-  operator std::span<const T, S>() const { return std::span{_data}; }
+  /**
+   * @brief element-wise negation
+   *
+   */
+  D negate() const {
+    D ret = derived();
+#ifdef DAKKU_ENABLE_SSE
+    if constexpr (SIMD) {
+      ret._data.m = _mm_xor_ps(_data.m, _mm_set1_ps(-0.0f));
+      return ret;
+    }
+#endif
+    for (size_t i = 0; i < S; ++i) ret[i] = -ret[i];
+    return ret;
+  }
+
+  operator std::span<T, S>() { return std::span<T, S>{_data.data(), S}; }
+  operator std::span<const T, S>() const {
+    return std::span<const T, S>{_data.data(), S};
+  }
 
  private:
+  /**
+   * @brief evaluate an expression into the storage (single pass)
+   *
+   * @tparam E expression type
+   * @param expr the given expression
+   */
+  template <typename E>
+  void assign(const E &expr) {
+    if constexpr (SIMD && E::PACKET) {
+      _data.m = expr.packet();
+    } else {
+      for (size_t i = 0; i < S; ++i) _data[i] = expr.at(i);
+    }
+    DAKKU_CHECK(!has_nans(), "has nan");
+  }
+
+  /**
+   * @brief `this = this op rhs` (single pass)
+   *
+   * @tparam Op operation
+   * @tparam E rhs type
+   * @param rhs vector or expression
+   */
+  template <typename Op, typename E>
+  D &update(const E &rhs) {
+    const VectorOperandNode<const E &> node(rhs);
+    if constexpr (SIMD && VectorOperandNode<const E &>::PACKET) {
+      _data.m = Op::packet(_data.m, node.packet());
+    } else {
+      for (size_t i = 0; i < S; ++i)
+        _data[i] = static_cast<T>(Op::apply(_data[i], node.at(i)));
+    }
+    return derived();
+  }
+
   /// vector base data
-  std::array<T, S> _data;
+  Storage _data;
 };
 }  // namespace dakku
 
@@ -0,0 +1,570 @@
+#ifndef DAKKU_CORE_VECTOR_EXPR_H_
+#define DAKKU_CORE_VECTOR_EXPR_H_
+#include <core/simd.h>
+
+#include <concepts>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace dakku {
+
+template <ArithmeticType T, size_t S, typename D>
+class VectorBase;
+
+template <typename E, typename D>
+class VectorExpr;
+
+/**
+ * @brief concept: scalar `V` combines with float lanes exactly like the
+ * scalar code (i.e. it is not promoted to a wider floating point type)
+ *
+ * @tparam V typename
+ */
+template <typename V>
+concept SimdScalarType =
+    std::is_integral_v<V> || std::is_same_v<std::decay_t<V>, float>;
+
+/**
+ * @brief the type a vector (or vector expression) evaluates to, only used in
+ * unevaluated context
+ *
+ */
+template <ArithmeticType T, size_t S, typename D>
+D vector_result_of(const VectorBase<T, S, D> &);
+
+/**
+ * @brief the type a vector (or vector expression) evaluates to, only used in
+ * unevaluated context
+ *
+ */
+template <typename E, typename D>
+D vector_result_of(const VectorExpr<E, D> &);
+
+/// the type a vector operand evaluates to
+template <typename X>
+using VectorResult = decltype(vector_result_of(
+    std::declval<const std::remove_cvref_t<X> &>()));
+
+/**
+ * @brief concept: `X` is a vector or a vector expression
+ *
+ * @tparam X typename
+ */
+template <typename X>
+concept VectorOperand = requires {
+  typename VectorResult<X>;
+};
+
+/**
+ * @brief concept: `X` is a (lazy) vector expression
+ *
+ * @tparam X typename
+ */
+template <typename X>
+concept VectorExpression = VectorOperand<X> &&
+    std::derived_from<std::remove_cvref_t<X>,
+                      VectorExpr<std::remove_cvref_t<X>, VectorResult<X>>>;
+
+/// $a + b$
+struct VectorAddOp {
+  template <typename A, typename B>
+  static auto apply(A a, B b) {
+    return a + b;
+  }
+#ifdef DAKKU_ENABLE_SSE
+  static __m128 packet(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+#endif
+};
+
+/// $a - b$
+struct VectorSubOp {
+  template <typename A, typename B>
+  static auto apply(A a, B b) {
+    return a - b;
+  }
+#ifdef DAKKU_ENABLE_SSE
+  static __m128 packet(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+#endif
+};
+
+/// $a \times b$
+struct VectorMulOp {
+  template <typename A, typename B>
+  static auto apply(A a, B b) {
+    return a * b;
+  }
+#ifdef DAKKU_ENABLE_SSE
+  static __m128 packet(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+#endif
+};
+
+/// $a / b$
+struct VectorDivOp {
+  template <typename A, typename B>
+  static auto apply(A a, B b) {
+    return a / b;
+  }
+#ifdef DAKKU_ENABLE_SSE
+  static __m128 packet(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+#endif
+};
+
+/**
+ * @brief result type of `L op R` between two vector types,
+ * undefined if the combination is not allowed
+ * (by default only vectors of the same type can be combined)
+ *
+ * @tparam Op operation
+ * @tparam L lhs vector type
+ * @tparam R rhs vector type
+ */
+template <typename Op, typename L, typename R>
+struct VectorOpResult {};
+
+template <typename Op, typename D>
+struct VectorOpResult<Op, D, D> {
+  using type = D;
+};
+
+/**
+ * @brief concept: `L op R` is allowed
+ *
+ */
+template <typename Op, typename L, typename R>
+concept VectorOpAllowed = requires {
+  typename VectorOpResult<Op, VectorResult<L>, VectorResult<R>>::type;
+};
+
+/**
+ * @brief lazy vector expression base
+ * an expression is evaluated (in a single pass) only when it is stored into a
+ * vector, thus a chain of operations creates no temporary vectors
+ *
+ * every leaf holds a copy of the components of its vector (at most 16 bytes,
+ * the copies are folded away once the expression is inlined), so
+ * `auto v = a + b;` is a snapshot: it neither follows later changes of `a`
+ * and `b` nor dangles when it outlives them, and it converts to the vector
+ * type wherever one is expected
+ * building and moving expressions never checks for nans, only the vector the
+ * expression is finally stored into does
+ *
+ * @tparam E derived expression
+ * @tparam D the vector type the expression evaluates to
+ */
+template <typename E, typename D>
+class [[nodiscard]] VectorExpr {
+ public:
+  /**
+   * @brief convert to derived expression
+   *
+   */
+  const E &expr() const { return static_cast<const E &>(*this); }
+
+  /**
+   * @brief evaluate the expression
+   *
+   */
+  D eval() const { return D(*this); }
+
+  /**
+   * @brief evaluate the expression
+   *
+   */
+  operator D() const { return eval(); }
+
+  /**
+   * @brief evaluate the i'th component only
+   *
+   */
+  auto operator[](size_t i) const { return expr().at(i); }
+
+  /**
+   * @brief size of the result vector
+   *
+   */
+  [[nodiscard]] size_t size() const { return D::SIZE; }
+
+  /**
+   * @brief evaluate the first component
+   *
+   */
+  auto x() const { return expr().at(0); }
+
+  /**
+   * @brief evaluate the second component
+   *
+   */
+  auto y() const { return expr().at(1); }
+
+  /**
+   * @brief evaluate the third component
+   *
+   */
+  auto z() const { return expr().at(2); }
+
+  /**
+   * @brief evaluate the fourth component
+   *
+   */
+  auto w() const { return expr().at(3); }
+
+  /**
+   * @brief get a copy (evaluate)
+   *
+   */
+  D clone() const { return eval(); }
+
+  [[nodiscard]] std::string to_string() const { return eval().to_string(); }
+
+  [[nodiscard]] bool has_nans() const { return eval().has_nans(); }
+
+  [[nodiscard]] bool is_zero() const { return eval().is_zero(); }
+
+  template <VectorOperand R>
+  auto dot(const R &rhs) const {
+    if constexpr (VectorExpression<R>) {
+      return eval().dot(rhs.eval());
+    } else {
+      return eval().dot(rhs);
+    }
+  }
+
+  auto squared_norm() const { return eval().squared_norm(); }
+
+  auto norm() const { return eval().norm(); }
+
+  auto length() const { return eval().length(); }
+
+  [[nodiscard]] size_t max_element_index() const {
+    return eval().max_element_index();
+  }
+
+  auto max_element() const { return eval().max_element(); }
+
+  D cross(const D &rhs) const { return eval().cross(rhs); }
+
+  D abs() const { return eval().abs(); }
+
+  D sqrt() const { return eval().sqrt(); }
+
+  D floor() const { return eval().floor(); }
+
+  D ceil() const { return eval().ceil(); }
+
+  D min(const D &rhs) const { return eval().min(rhs); }
+
+  D max(const D &rhs) const { return eval().max(rhs); }
+
+  friend std::ostream &operator<<(std::ostream &os, const VectorExpr &e) {
+    return os << e.to_string();
+  }
+};
+
+/**
+ * @brief expression leaf, holds a copy of the components of a vector (the raw
+ * storage, so that no checked vector copy is made)
+ *
+ * @tparam D the vector type
+ */
+template <typename D>
+class VectorLeaf {
+ public:
+  /// the vector type
+  using Result = D;
+  /// component type
+  using Scalar = typename Result::Scalar;
+  /// whether the leaf can be loaded as a simd packet
+  static constexpr bool PACKET = Result::SIMD;
+
+  explicit VectorLeaf(const D &v) : v(v._data) {}
+
+  Scalar at(size_t i) const { return v[i]; }
+
+#ifdef DAKKU_ENABLE_SSE
+  __m128 packet() const { return v.m; }
+#endif
+
+ private:
+  typename D::Storage v;
+};
+
+/// expression node of an operand: expressions by value, vectors as leaves
+template <typename X>
+using VectorOperandNode =
+    std::conditional_t<VectorExpression<X>, std::remove_cvref_t<X>,
+                       VectorLeaf<std::remove_cvref_t<X>>>;
+
+/**
+ * @brief vector op vector
+ *
+ */
+template <typename Op, typename L, typename R, typename D>
+class [[nodiscard]] VectorBinaryExpr
+    : public VectorExpr<VectorBinaryExpr<Op, L, R, D>, D> {
+ public:
+  /// component type
+  using Scalar = typename D::Scalar;
+  /// whether the expression can be evaluated as simd packets
+  static constexpr bool PACKET = L::PACKET && R::PACKET;
+
+  VectorBinaryExpr(L l, R r) : l(std::move(l)), r(std::move(r)) {}
+
+  Scalar at(size_t i) const {
+    return static_cast<Scalar>(Op::apply(l.at(i), r.at(i)));
+  }
+
+#ifdef DAKKU_ENABLE_SSE
+  __m128 packet() const { return Op::packet(l.packet(), r.packet()); }
+#endif
+
+ private:
+  L l;
+  R r;
+};
+
+/**
+ * @brief vector op scalar
+ *
+ */
+template <typename Op, typename L, ArithmeticType V, typename D>
+class [[nodiscard]] VectorScalarExpr
+    : public VectorExpr<VectorScalarExpr<Op, L, V, D>, D> {
+ public:
+  /// component type
+  using Scalar = typename D::Scalar;
+  /// whether the expression can be evaluated as simd packets
+  static constexpr bool PACKET = L::PACKET && SimdScalarType<V>;
+
+  VectorScalarExpr(L l, V s) : l(std::move(l)), s(s) {}
+
+  Scalar at(size_t i) const {
+    return static_cast<Scalar>(Op::apply(l.at(i), s));
+  }
+
+#ifdef DAKKU_ENABLE_SSE
+  __m128 packet() const {
+    return Op::packet(l.packet(), _mm_set1_ps(static_cast<float>(s)));
+  }
+#endif
+
+ private:
+  L l;
+  V s;
+};
+
+/**
+ * @brief scalar op vector
+ *
+ */
+template <typename Op, ArithmeticType V, typename R, typename D>
+class [[nodiscard]] ScalarVectorExpr
+    : public VectorExpr<ScalarVectorExpr<Op, V, R, D>, D> {
+ public:
+  /// component type
+  using Scalar = typename D::Scalar;
+  /// whether the expression can be evaluated as simd packets
+  static constexpr bool PACKET = R::PACKET && SimdScalarType<V>;
+
+  ScalarVectorExpr(V s, R r) : s(s), r(std::move(r)) {}
+
+  Scalar at(size_t i) const {
+    return static_cast<Scalar>(Op::apply(s, r.at(i)));
+  }
+
+#ifdef DAKKU_ENABLE_SSE
+  __m128 packet() const {
+    return Op::packet(_mm_set1_ps(static_cast<float>(s)), r.packet());
+  }
+#endif
+
+ private:
+  V s;
+  R r;
+};
+
+/**
+ * @brief negation
+ *
+ */
+template <typename E, typename D>
+class [[nodiscard]] VectorNegateExpr
+    : public VectorExpr<VectorNegateExpr<E, D>, D> {
+ public:
+  /// component type
+  using Scalar = typename D::Scalar;
+  /// whether the expression can be evaluated as simd packets
+  static constexpr bool PACKET = E::PACKET;
+
+  explicit VectorNegateExpr(E e) : e(std::move(e)) {}
+
+  Scalar at(size_t i) const { return static_cast<Scalar>(-e.at(i)); }
+
+#ifdef DAKKU_ENABLE_SSE
+  __m128 packet() const { return _mm_xor_ps(e.packet(), _mm_set1_ps(-0.0f)); }
+#endif
+
+ private:
+  E e;
+};
+
+/**
+ * @brief build `l op r`
+ *
+ */
+template <typename Op, VectorOperand L, VectorOperand R>
+auto make_vector_expr(L &&l, R &&r) {
+  using Result =
+      typename VectorOpResult<Op, VectorResult<L>, VectorResult<R>>::type;
+  return VectorBinaryExpr<Op, VectorOperandNode<L>, VectorOperandNode<R>,
+                          Result>(VectorOperandNode<L>(std::forward<L>(l)),
+                                  VectorOperandNode<R>(std::forward<R>(r)));
+}
+
+/**
+ * @brief build `l op s`
+ *
+ */
+template <typename Op, VectorOperand L, ArithmeticType V>
+auto make_vector_expr(L &&l, V s) {
+  return VectorScalarExpr<Op, VectorOperandNode<L>, V, VectorResult<L>>(
+      VectorOperandNode<L>(std::forward<L>(l)), s);
+}
+
+/**
+ * @brief build `s op r`
+ *
+ */
+template <typename Op, ArithmeticType V, VectorOperand R>
+auto make_vector_expr(V s, R &&r) {
+  return ScalarVectorExpr<Op, V, VectorOperandNode<R>, VectorResult<R>>(
+      s, VectorOperandNode<R>(std::forward<R>(r)));
+}
+
+/**
+ * @brief addition
+ *
+ */
+template <VectorOperand L, VectorOperand R>
+requires VectorOpAllowed<VectorAddOp, L, R>
+auto operator+(L &&l, R &&r) {
+  return make_vector_expr<VectorAddOp>(std::forward<L>(l), std::forward<R>(r));
+}
+
+/**
+ * @brief addition
+ *
+ */
+template <VectorOperand L, ArithmeticType V>
+auto operator+(L &&l, V s) {
+  return make_vector_expr<VectorAddOp>(std::forward<L>(l), s);
+}
+
+/**
+ * @brief addition
+ *
+ */
+template <ArithmeticType V, VectorOperand R>
+auto operator+(V s, R &&r) {
+  return make_vector_expr<VectorAddOp>(s, std::forward<R>(r));
+}
+
+/**
+ * @brief subtraction
+ *
+ */
+template <VectorOperand L, VectorOperand R>
+requires VectorOpAllowed<VectorSubOp, L, R>
+auto operator-(L &&l, R &&r) {
+  return make_vector_expr<VectorSubOp>(std::forward<L>(l), std::forward<R>(r));
+}
+
+/**
+ * @brief subtraction
+ *
+ */
+template <VectorOperand L, ArithmeticType V>
+auto operator-(L &&l, V s) {
+  return make_vector_expr<VectorSubOp>(std::forward<L>(l), s);
+}
+
+/**
+ * @brief subtraction
+ *
+ */
+template <ArithmeticType V, VectorOperand R>
+auto operator-(V s, R &&r) {
+  return make_vector_expr<VectorSubOp>(s, std::forward<R>(r));
+}
+
+/**
+ * @brief multiplication
+ *
+ */
+template <VectorOperand L, VectorOperand R>
+requires VectorOpAllowed<VectorMulOp, L, R>
+auto operator*(L &&l, R &&r) {
+  return make_vector_expr<VectorMulOp>(std::forward<L>(l), std::forward<R>(r));
+}
+
+/**
+ * @brief multiplication
+ *
+ */
+template <VectorOperand L, ArithmeticType V>
+auto operator*(L &&l, V s) {
+  return make_vector_expr<VectorMulOp>(std::forward<L>(l), s);
+}
+
+/**
+ * @brief multiplication
+ *
+ */
+template <ArithmeticType V, VectorOperand R>
+auto operator*(V s, R &&r) {
+  return make_vector_expr<VectorMulOp>(s, std::forward<R>(r));
+}
+
+/**
+ * @brief division
+ *
+ */
+template <VectorOperand L, VectorOperand R>
+requires VectorOpAllowed<VectorDivOp, L, R>
+auto operator/(L &&l, R &&r) {
+  return make_vector_expr<VectorDivOp>(std::forward<L>(l), std::forward<R>(r));
+}
+
+/**
+ * @brief division, multiplies by the reciprocal of `s`
+ *
+ */
+template <VectorOperand L, ArithmeticType V>
+auto operator/(L &&l, V s) {
+  using Scalar = typename VectorResult<L>::Scalar;
+  return make_vector_expr<VectorMulOp>(std::forward<L>(l),
+                                       static_cast<Scalar>(Scalar{1} / s));
+}
+
+/**
+ * @brief division (broad cast `s`)
+ *
+ */
+template <ArithmeticType V, VectorOperand R>
+auto operator/(V s, R &&r) {
+  using Scalar = typename VectorResult<R>::Scalar;
+  return make_vector_expr<VectorDivOp>(static_cast<Scalar>(s),
+                                       std::forward<R>(r));
+}
+
+/**
+ * @brief negation
+ *
+ */
+template <VectorOperand E>
+auto operator-(E &&e) {
+  return VectorNegateExpr<VectorOperandNode<E>, VectorResult<E>>(
+      VectorOperandNode<E>(std::forward<E>(e)));
+}
+}  // namespace dakku
+#endif
@@ -0,0 +1,153 @@
+#include <imageio/exr.h>
+
+#include <zlib.h>
+
+#include <cstring>
+
+namespace dakku {
+
+namespace {
+/// append the little endian bytes of `value`
+template <typename T>
+void put(std::string &buf, T value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  buf.append(bytes, sizeof(T));
+}
+
+/// append a header attribute
+void put_attribute(std::string &buf, const char *name, const char *type,
+                   const std::string &value) {
+  buf.append(name, std::strlen(name) + 1);
+  buf.append(type, std::strlen(type) + 1);
+  put(buf, static_cast<int32_t>(value.size()));
+  buf += value;
+}
+
+/// openexr zip compression: byte interleaving, delta predictor, deflate
+/// returns the raw data if compression does not make it smaller
+std::vector<uint8_t> zip_compress(const std::vector<uint8_t> &raw) {
+  const size_t n = raw.size();
+  std::vector<uint8_t> tmp(n);
+  // even bytes to the first half, odd bytes to the second
+  for (size_t i = 0, h = (n + 1) / 2; i < n; ++i)
+    tmp[(i & 1) ? h + i / 2 : i / 2] = raw[i];
+  for (size_t i = n - 1; i > 0; --i)
+    tmp[i] = static_cast<uint8_t>(tmp[i] - tmp[i - 1] + 128);
+  uLongf size = compressBound(static_cast<uLong>(n));
+  std::vector<uint8_t> ret(size);
+  if (compress2(ret.data(), &size, tmp.data(), static_cast<uLong>(n), 4) !=
+          Z_OK ||
+      size >= n)
+    return raw;
+  ret.resize(size);
+  return ret;
+}
+}  // namespace
+
+ExrWriter::ExrWriter(const std::string &path, const Point2i &resolution,
+                     int tile_size)
+    : ImageWriter(resolution, tile_size),
+      out(path, std::ios::binary),
+      offsets(static_cast<size_t>(tile_count.x()) * tile_count.y()) {
+  if (!out) {
+    DAKKU_ERR("cannot create {}", path);
+    good = false;
+    return;
+  }
+  std::string header;
+  put(header, uint32_t{20000630});
+  // version 2, single part tiled
+  put(header, uint32_t{2 | 0x200});
+  std::string channels;
+  for (const char *name : {"B", "G", "R"}) {
+    channels.append(name, 2);
+    // float, not linear, 3 reserved bytes, x/y sampling 1
+    put(channels, int32_t{2});
+    put(channels, uint32_t{0});
+    put(channels, int32_t{1});
+    put(channels, int32_t{1});
+  }
+  channels.push_back('\0');
+  put_attribute(header, "channels", "chlist", channels);
+  // zip (16 lines, the whole tile for tiled files)
+  put_attribute(header, "compression", "compression", std::string(1, '\3'));
+  std::string window;
+  for (int32_t v : {0, 0, resolution.x() - 1, resolution.y() - 1})
+    put(window, v);
+  put_attribute(header, "dataWindow", "box2i", window);
+  put_attribute(header, "displayWindow", "box2i", window);
+  // random y, tiles are stored in completion order
+  put_attribute(header, "lineOrder", "lineOrder", std::string(1, '\2'));
+  std::string value;
+  put(value, 1.0f);
+  put_attribute(header, "pixelAspectRatio", "float", value);
+  put_attribute(header, "screenWindowWidth", "float", value);
+  value.clear();
+  put(value, 0.0f);
+  put(value, 0.0f);
+  put_attribute(header, "screenWindowCenter", "v2f", value);
+  value.clear();
+  put(value, static_cast<uint32_t>(tile_size));
+  put(value, static_cast<uint32_t>(tile_size));
+  // one level, round down
+  value.push_back('\0');
+  put_attribute(header, "tiles", "tiledesc", value);
+  header.push_back('\0');
+  out.write(header.data(), static_cast<std::streamsize>(header.size()));
+  table_offset = static_cast<std::streamoff>(header.size());
+  // placeholder offset table
+  out.write(reinterpret_cast<const char *>(offsets.data()),
+            static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+  good = static_cast<bool>(out);
+}
+
+ExrWriter::~ExrWriter() { close(); }
+
+void ExrWriter::encode_tile(const Bounds2i &tile, std::span<const float> rgb) {
+  write_chunk(tile, rgb);
+}
+
+void ExrWriter::write_chunk(const Bounds2i &tile, std::span<const float> rgb) {
+  const Vector2i size = tile.diagonal();
+  // each line stores the channels one after another in name order (b, g, r)
+  std::vector<uint8_t> raw(rgb.size() * sizeof(float));
+  uint8_t *p = raw.data();
+  for (int y = 0; y < size.y(); ++y) {
+    for (int c = CHANNELS - 1; c >= 0; --c) {
+      for (int x = 0; x < size.x(); ++x, p += sizeof(float))
+        std::memcpy(p, &rgb[(y * size.x() + x) * CHANNELS + c], sizeof(float));
+    }
+  }
+  const std::vector<uint8_t> data = zip_compress(raw);
+  const Point2i index = tile_index(tile);
+  std::string chunk;
+  put(chunk, int32_t{index.x()});
+  put(chunk, int32_t{index.y()});
+  put(chunk, int32_t{0});
+  put(chunk, int32_t{0});
+  put(chunk, static_cast<int32_t>(data.size()));
+  std::lock_guard lock(mutex);
+  offsets[index.y() * tile_count.x() + index.x()] =
+      static_cast<uint64_t>(out.tellp());
+  out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+  out.write(reinterpret_cast<const char *>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+}
+
+bool ExrWriter::finish() {
+  // readers need every tile, fill the missing ones with black
+  for (int y = 0; y < tile_count.y(); ++y) {
+    for (int x = 0; x < tile_count.x(); ++x) {
+      if (offsets[y * tile_count.x() + x] != 0) continue;
+      const Bounds2i tile = tile_bounds(Point2i{x, y});
+      write_chunk(tile, std::vector<float>(tile.area() * CHANNELS));
+    }
+  }
+  out.seekp(table_offset);
+  out.write(reinterpret_cast<const char *>(offsets.data()),
+            static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+  out.close();
+  return !out.fail();
+}
+}  // namespace dakku
@@ -0,0 +1,40 @@
+#ifndef DAKKU_IMAGEIO_EXR_H_
+#define DAKKU_IMAGEIO_EXR_H_
+#include <imageio/image_writer.h>
+
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace dakku {
+
+/**
+ * @brief tiled openexr writer (float rgb, zip compression, one level,
+ * random line order), tiles are compressed in parallel and appended in
+ * completion order, the offset table is filled in by `finish`
+ *
+ */
+class DAKKU_EXPORT_IMAGEIO ExrWriter : public ImageWriter {
+ public:
+  ExrWriter(const std::string &path, const Point2i &resolution, int tile_size);
+  ~ExrWriter() override;
+
+ protected:
+  void encode_tile(const Bounds2i &tile, std::span<const float> rgb) override;
+  bool finish() override;
+
+ private:
+  /// compress a tile and append it to the file
+  void write_chunk(const Bounds2i &tile, std::span<const float> rgb);
+
+  /// output file
+  std::ofstream out;
+  /// guards `out` and `offsets`
+  std::mutex mutex;
+  /// file offset of the tile table
+  std::streamoff table_offset{0};
+  /// file offsets of the tiles (row major, 0 if not written)
+  std::vector<uint64_t> offsets;
+};
+}  // namespace dakku
+#endif
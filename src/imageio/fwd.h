@@ -0,0 +1,12 @@
+#ifndef DAKKU_IMAGEIO_FWD_H_
+#define DAKKU_IMAGEIO_FWD_H_
+#include <core/bounds.h>
+
+namespace dakku {
+#if DAKKU_BUILD_MODULE != DAKKU_IMAGEIO_MODULE
+#define DAKKU_EXPORT_IMAGEIO DAKKU_IMPORT
+#else
+#define DAKKU_EXPORT_IMAGEIO DAKKU_EXPORT
+#endif
+}  // namespace dakku
+#endif
@@ -0,0 +1,86 @@
+#include <core/profiler.h>
+#include <imageio/exr.h>
+#include <imageio/image_writer.h>
+#include <imageio/pfm.h>
+#include <imageio/png.h>
+
+#include <oneapi/tbb/info.h>
+
+#include <filesystem>
+#include <vector>
+
+namespace dakku {
+
+ImageWriter::ImageWriter(const Point2i &resolution, int tile_size)
+    : resolution(resolution),
+      tile_size(tile_size),
+      tile_count((resolution.x() + tile_size - 1) / tile_size,
+                 (resolution.y() + tile_size - 1) / tile_size),
+      arena(std::max(2, oneapi::tbb::info::default_concurrency() / 4)) {
+  DAKKU_CHECK(tile_size > 0, "invalid tile size: {}", tile_size);
+}
+
+ImageWriter::~ImageWriter() {
+  // the writers close in their destructors, this only guards against leaking
+  // tasks if a writer has not
+  if (!closed) arena.execute([this] { group.wait(); });
+}
+
+void ImageWriter::write_tile(const Bounds2i &tile,
+                             std::span<const float> rgb) {
+  DAKKU_CHECK(!closed, "write to a closed image writer");
+  DAKKU_CHECK(rgb.size() == static_cast<size_t>(tile.area()) * CHANNELS,
+              "tile size mismatch: {} != {}", rgb.size(),
+              tile.area() * CHANNELS);
+  DAKKU_CHECK(tile == tile_bounds(tile_index(tile)),
+              "tile is not aligned to the {} grid", tile_size);
+  if (!good) return;
+  arena.execute([&] {
+    group.run([this, tile, pixels = std::vector<float>(rgb.begin(),
+                                                       rgb.end())] {
+      ProfilePhase _(Prof::IMAGE_WRITE);
+      encode_tile(tile, pixels);
+    });
+  });
+}
+
+bool ImageWriter::close() {
+  if (closed) return good;
+  arena.execute([this] { group.wait(); });
+  closed = true;
+  if (good) good = finish();
+  return good;
+}
+
+Point2i ImageWriter::tile_index(const Bounds2i &tile) const {
+  return Point2i{tile.p_min.x() / tile_size, tile.p_min.y() / tile_size};
+}
+
+Bounds2i ImageWriter::tile_bounds(const Point2i &index) const {
+  Point2i p_min{index.x() * tile_size, index.y() * tile_size};
+  Point2i p_max{std::min(p_min.x() + tile_size, resolution.x()),
+                std::min(p_min.y() + tile_size, resolution.y())};
+  return Bounds2i{p_min, p_max};
+}
+
+std::unique_ptr<ImageWriter> create_image_writer(const std::string &path,
+                                                 const Point2i &resolution,
+                                                 int tile_size) {
+  std::string ext = std::filesystem::path(path).extension().string();
+  std::ranges::transform(ext, ext.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  std::unique_ptr<ImageWriter> writer;
+  if (ext == ".exr") {
+    writer = std::make_unique<ExrWriter>(path, resolution, tile_size);
+  } else if (ext == ".pfm") {
+    writer = std::make_unique<PfmWriter>(path, resolution, tile_size);
+  } else if (ext == ".png") {
+    writer = std::make_unique<PngWriter>(path, resolution, tile_size);
+  } else {
+    DAKKU_ERR("unsupported image format: {}", path);
+    return nullptr;
+  }
+  return writer->is_good() ? std::move(writer) : nullptr;
+}
+}  // namespace dakku
@@ -0,0 +1,121 @@
+#ifndef DAKKU_IMAGEIO_IMAGE_WRITER_H_
+#define DAKKU_IMAGEIO_IMAGE_WRITER_H_
+#include <imageio/fwd.h>
+
+#include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_group.h>
+
+#include <memory>
+#include <span>
+#include <string>
+
+namespace dakku {
+
+/**
+ * @brief streaming image writer, tiles are handed over as soon as they are
+ * rendered and encoded/compressed by tasks of a separate io arena, so the
+ * full resolution float image is never held in memory and the render
+ * threads never compress
+ * tiles must be aligned to the `tile_size` grid of the image (like the tiles
+ * of `TileScheduler` over `[0, resolution)`), missing tiles are written black
+ *
+ */
+class DAKKU_EXPORT_IMAGEIO ImageWriter {
+ public:
+  /// channels per pixel (rgb)
+  static constexpr int CHANNELS = 3;
+
+  /**
+   * @brief Construct a new Image Writer object
+   *
+   * @param resolution image resolution
+   * @param tile_size edge length of the tiles
+   */
+  ImageWriter(const Point2i &resolution, int tile_size);
+  virtual ~ImageWriter();
+  ImageWriter(const ImageWriter &) = delete;
+  ImageWriter &operator=(const ImageWriter &) = delete;
+
+  /**
+   * @brief schedule a tile for writing (thread safe), `rgb` is copied
+   *
+   * @param tile pixel bounds of the tile
+   * @param rgb row major rgb values of the tile pixels
+   */
+  void write_tile(const Bounds2i &tile, std::span<const float> rgb);
+
+  /**
+   * @brief wait for the scheduled tiles and finish the file, called by the
+   * destructors of the writers
+   *
+   * @return whether the file has been written successfully
+   */
+  bool close();
+
+  /**
+   * @brief image resolution
+   *
+   */
+  [[nodiscard]] const Point2i &get_resolution() const { return resolution; }
+
+  /**
+   * @brief check whether the file is usable
+   *
+   */
+  [[nodiscard]] bool is_good() const { return good; }
+
+ protected:
+  /**
+   * @brief encode and write a tile, runs on the io arena and may run
+   * concurrently for different tiles
+   *
+   */
+  virtual void encode_tile(const Bounds2i &tile,
+                           std::span<const float> rgb) = 0;
+
+  /**
+   * @brief finish the file after all tiles have been encoded
+   *
+   */
+  virtual bool finish() = 0;
+
+  /**
+   * @brief the index of `tile` in the tile grid
+   *
+   */
+  [[nodiscard]] Point2i tile_index(const Bounds2i &tile) const;
+
+  /**
+   * @brief the bounds of the tile at `index` of the tile grid
+   *
+   */
+  [[nodiscard]] Bounds2i tile_bounds(const Point2i &index) const;
+
+  /// image resolution
+  Point2i resolution;
+  /// edge length of the tiles
+  int tile_size;
+  /// number of tiles in x and y
+  Point2i tile_count;
+  /// whether the file is usable (set by the writers)
+  bool good{true};
+
+ private:
+  /// arena of the encoding tasks, separate from the render arena
+  oneapi::tbb::task_arena arena;
+  /// encoding tasks
+  oneapi::tbb::task_group group;
+  /// whether `close` has been called
+  bool closed{false};
+};
+
+/**
+ * @brief create an image writer from the extension of `path` (`.exr`,
+ * `.pfm` or `.png`)
+ *
+ * @return nullptr if the format is unknown or the file cannot be created
+ */
+DAKKU_EXPORT_IMAGEIO std::unique_ptr<ImageWriter> create_image_writer(
+    const std::string &path, const Point2i &resolution, int tile_size = 16);
+}  // namespace dakku
+#endif
@@ -0,0 +1,55 @@
+#include <imageio/pfm.h>
+
+#include <filesystem>
+
+namespace dakku {
+
+PfmWriter::PfmWriter(const std::string &path, const Point2i &resolution,
+                     int tile_size)
+    : ImageWriter(resolution, tile_size),
+      path(path),
+      out(path, std::ios::binary) {
+  if (!out) {
+    DAKKU_ERR("cannot create {}", path);
+    good = false;
+    return;
+  }
+  // negative scale: little endian
+  const std::string header =
+      fmt::format("PF\n{} {}\n-1\n", resolution.x(), resolution.y());
+  out.write(header.data(), static_cast<std::streamsize>(header.size()));
+  header_size = static_cast<std::streamoff>(header.size());
+  good = static_cast<bool>(out);
+}
+
+PfmWriter::~PfmWriter() { close(); }
+
+void PfmWriter::encode_tile(const Bounds2i &tile, std::span<const float> rgb) {
+  const Vector2i size = tile.diagonal();
+  const auto row_bytes =
+      static_cast<std::streamsize>(size.x() * CHANNELS * sizeof(float));
+  std::lock_guard lock(mutex);
+  for (int y = 0; y < size.y(); ++y) {
+    // rows are stored bottom to top
+    const int64_t row = resolution.y() - 1 - (tile.p_min.y() + y);
+    out.seekp(header_size + static_cast<std::streamoff>(
+                                (row * resolution.x() + tile.p_min.x()) *
+                                CHANNELS * sizeof(float)));
+    out.write(reinterpret_cast<const char *>(&rgb[y * size.x() * CHANNELS]),
+              row_bytes);
+  }
+}
+
+bool PfmWriter::finish() {
+  out.close();
+  if (out.fail()) return false;
+  // missing tiles at the end of the file are left as holes (zeros)
+  const auto size = static_cast<uintmax_t>(header_size) +
+                    static_cast<uintmax_t>(resolution.x()) * resolution.y() *
+                        CHANNELS * sizeof(float);
+  std::error_code ec;
+  if (std::filesystem::file_size(path, ec) < size)
+    std::filesystem::resize_file(path, size, ec);
+  return !ec;
+}
+}  // namespace dakku
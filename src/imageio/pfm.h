@@ -0,0 +1,35 @@
+#ifndef DAKKU_IMAGEIO_PFM_H_
+#define DAKKU_IMAGEIO_PFM_H_
+#include <imageio/image_writer.h>
+
+#include <fstream>
+#include <mutex>
+
+namespace dakku {
+
+/**
+ * @brief pfm writer (float rgb, uncompressed), the tile rows are written
+ * straight to their final offsets
+ *
+ */
+class DAKKU_EXPORT_IMAGEIO PfmWriter : public ImageWriter {
+ public:
+  PfmWriter(const std::string &path, const Point2i &resolution, int tile_size);
+  ~PfmWriter() override;
+
+ protected:
+  void encode_tile(const Bounds2i &tile, std::span<const float> rgb) override;
+  bool finish() override;
+
+ private:
+  /// output path
+  std::string path;
+  /// output file
+  std::ofstream out;
+  /// guards `out`
+  std::mutex mutex;
+  /// size of the header
+  std::streamoff header_size{0};
+};
+}  // namespace dakku
+#endif
@@ -0,0 +1,154 @@
+#include <imageio/png.h>
+
+#include <array>
+#include <cmath>
+
+namespace dakku {
+
+namespace {
+/// append a big endian 32 bit value
+void put_be32(std::vector<uint8_t> &buf, uint32_t v) {
+  for (int shift = 24; shift >= 0; shift -= 8)
+    buf.push_back(static_cast<uint8_t>(v >> shift));
+}
+
+/// encode a linear value as an 8 bit srgb value
+uint8_t to_srgb8(float v) {
+  if (!(v > 0)) return 0;
+  if (v >= 1) return 255;
+  v = v <= 0.0031308f ? 12.92f * v : 1.055f * std::pow(v, 1 / 2.4f) - 0.055f;
+  return static_cast<uint8_t>(v * 255 + 0.5f);
+}
+}  // namespace
+
+PngWriter::PngWriter(const std::string &path, const Point2i &resolution,
+                     int tile_size)
+    : ImageWriter(resolution, tile_size),
+      out(path, std::ios::binary),
+      bands(tile_count.y()) {
+  if (!out || deflateInit(&stream, 6) != Z_OK) {
+    DAKKU_ERR("cannot create {}", path);
+    good = false;
+    return;
+  }
+  static constexpr std::array<uint8_t, 8> SIGNATURE{0x89, 'P',  'N',  'G',
+                                                    '\r', '\n', 0x1a, '\n'};
+  out.write(reinterpret_cast<const char *>(SIGNATURE.data()), SIGNATURE.size());
+  std::vector<uint8_t> header;
+  put_be32(header, static_cast<uint32_t>(resolution.x()));
+  put_be32(header, static_cast<uint32_t>(resolution.y()));
+  // 8 bit truecolor, deflate, adaptive filtering, no interlacing
+  header.insert(header.end(), {8, 2, 0, 0, 0});
+  write_chunk("IHDR", header.data(), header.size());
+  // srgb, perceptual intent
+  const uint8_t intent = 0;
+  write_chunk("sRGB", &intent, 1);
+  good = static_cast<bool>(out);
+}
+
+PngWriter::~PngWriter() {
+  close();
+  deflateEnd(&stream);
+}
+
+PngWriter::Band &PngWriter::band(int i) {
+  Band &b = bands[i];
+  DAKKU_CHECK(!b.deflated, "band {} has already been written", i);
+  if (b.pixels.empty()) {
+    const int rows = tile_bounds(Point2i{0, i}).diagonal().y();
+    b.pixels.resize(static_cast<size_t>(rows) * resolution.x() * CHANNELS);
+    b.remaining = tile_count.x();
+  }
+  return b;
+}
+
+void PngWriter::encode_tile(const Bounds2i &tile, std::span<const float> rgb) {
+  const int i = tile_index(tile).y();
+  const Vector2i size = tile.diagonal();
+  uint8_t *pixels;
+  {
+    std::lock_guard lock(band_mutex);
+    pixels = band(i).pixels.data();
+  }
+  // tiles of a band cover disjoint pixels
+  for (int y = 0; y < size.y(); ++y) {
+    uint8_t *row = pixels + (static_cast<size_t>(y) * resolution.x() +
+                             tile.p_min.x()) *
+                                CHANNELS;
+    for (int k = 0; k < size.x() * CHANNELS; ++k)
+      row[k] = to_srgb8(rgb[y * size.x() * CHANNELS + k]);
+  }
+  bool complete;
+  {
+    std::lock_guard lock(band_mutex);
+    complete = --bands[i].remaining == 0;
+  }
+  if (complete) {
+    std::lock_guard lock(mutex);
+    flush_bands(false);
+  }
+}
+
+void PngWriter::flush_bands(bool finish) {
+  const size_t row_bytes = static_cast<size_t>(resolution.x()) * CHANNELS;
+  std::vector<uint8_t> filtered;
+  while (next_band < tile_count.y()) {
+    std::vector<uint8_t> pixels;
+    {
+      std::lock_guard lock(band_mutex);
+      Band &b = band(next_band);
+      if (b.remaining != 0 && !finish) break;
+      pixels = std::move(b.pixels);
+      b.pixels = {};
+      b.deflated = true;
+    }
+    // sub filter: every byte minus the same channel of the previous pixel
+    const size_t rows = pixels.size() / row_bytes;
+    filtered.resize(rows * (row_bytes + 1));
+    for (size_t y = 0; y < rows; ++y) {
+      const uint8_t *src = &pixels[y * row_bytes];
+      uint8_t *dst = &filtered[y * (row_bytes + 1)];
+      dst[0] = 1;
+      for (size_t k = 0; k < row_bytes; ++k)
+        dst[k + 1] = static_cast<uint8_t>(
+            src[k] - (k >= CHANNELS ? src[k - CHANNELS] : 0));
+    }
+    ++next_band;
+    deflate_rows(filtered.data(), filtered.size(),
+                 next_band == tile_count.y() ? Z_FINISH : Z_NO_FLUSH);
+  }
+}
+
+void PngWriter::deflate_rows(const uint8_t *data, size_t size, int flush) {
+  std::array<uint8_t, 1 << 16> buffer;
+  stream.next_in = const_cast<uint8_t *>(data);
+  stream.avail_in = static_cast<uInt>(size);
+  do {
+    stream.next_out = buffer.data();
+    stream.avail_out = static_cast<uInt>(buffer.size());
+    deflate(&stream, flush);
+    const size_t n = buffer.size() - stream.avail_out;
+    if (n > 0) write_chunk("IDAT", buffer.data(), n);
+  } while (stream.avail_out == 0 || stream.avail_in != 0);
+}
+
+void PngWriter::write_chunk(const char *type, const uint8_t *data,
+                            size_t size) {
+  std::vector<uint8_t> buf;
+  put_be32(buf, static_cast<uint32_t>(size));
+  buf.insert(buf.end(), type, type + 4);
+  buf.insert(buf.end(), data, data + size);
+  put_be32(buf, static_cast<uint32_t>(
+                    crc32(0, buf.data() + 4, static_cast<uInt>(size + 4))));
+  out.write(reinterpret_cast<const char *>(buf.data()),
+            static_cast<std::streamsize>(buf.size()));
+}
+
+bool PngWriter::finish() {
+  // bands with missing tiles are written with black holes
+  flush_bands(true);
+  write_chunk("IEND", nullptr, 0);
+  out.close();
+  return !out.fail();
+}
+}  // namespace dakku
@@ -0,0 +1,62 @@
+#ifndef DAKKU_IMAGEIO_PNG_H_
+#define DAKKU_IMAGEIO_PNG_H_
+#include <imageio/image_writer.h>
+
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include <zlib.h>
+
+namespace dakku {
+
+/**
+ * @brief png writer (8 bit srgb), tiles are quantized into their row band,
+ * completed bands are filtered and deflated in order into one idat stream,
+ * so only the 8 bit bands that wait for an earlier band stay in memory
+ *
+ */
+class DAKKU_EXPORT_IMAGEIO PngWriter : public ImageWriter {
+ public:
+  PngWriter(const std::string &path, const Point2i &resolution, int tile_size);
+  ~PngWriter() override;
+
+ protected:
+  void encode_tile(const Bounds2i &tile, std::span<const float> rgb) override;
+  bool finish() override;
+
+ private:
+  /// the 8 bit rows of a band of tiles
+  struct Band {
+    /// rgb bytes
+    std::vector<uint8_t> pixels;
+    /// tiles that have not been quantized yet
+    int remaining{0};
+    /// whether the band has been deflated
+    bool deflated{false};
+  };
+
+  /// get band `i`, allocating it if needed (requires `band_mutex`)
+  Band &band(int i);
+  /// deflate the completed bands from `next_band` on (requires `mutex`)
+  void flush_bands(bool finish);
+  /// deflate `size` bytes, flushing the output as idat chunks
+  void deflate_rows(const uint8_t *data, size_t size, int flush);
+  /// write a png chunk
+  void write_chunk(const char *type, const uint8_t *data, size_t size);
+
+  /// output file
+  std::ofstream out;
+  /// guards `out`, `stream` and `next_band`
+  std::mutex mutex;
+  /// guards `bands`
+  std::mutex band_mutex;
+  /// row bands (empty until their first tile arrives or once deflated)
+  std::vector<Band> bands;
+  /// the first band that has not been deflated
+  int next_band{0};
+  /// idat deflate stream
+  z_stream stream{};
+};
+}  // namespace dakku
+#endif
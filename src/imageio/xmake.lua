@@ -0,0 +1,9 @@
+add_requires("zlib")
+
+target("dakku.imageio")
+  set_kind("shared")
+  add_defines("DAKKU_BUILD_MODULE=DAKKU_IMAGEIO_MODULE")
+  add_includedirs(os.projectdir() .. "/src", {public = true})
+  add_files("*.cpp")
+  add_packages("zlib")
+  add_deps("dakku.core")
@@ -0,0 +1,12 @@
+#ifndef DAKKU_INTEGRATORS_FWD_H_
+#define DAKKU_INTEGRATORS_FWD_H_
+#include <core/integrator.h>
+
+namespace dakku {
+#if DAKKU_BUILD_MODULE != DAKKU_INTEGRATORS_MODULE
+#define DAKKU_EXPORT_INTEGRATORS DAKKU_IMPORT
+#else
+#define DAKKU_EXPORT_INTEGRATORS DAKKU_EXPORT
+#endif
+}  // namespace dakku
+#endif
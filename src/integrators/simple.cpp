@@ -0,0 +1,105 @@
+#include <integrators/simple.h>
+#include <core/memory.h>
+#include <core/profiler.h>
+#include <core/tile.h>
+
+#include <atomic>
+#include <chrono>
+
+namespace dakku {
+
+namespace {
+/// `adaptive` is a settings table such as `scene.adaptive`
+Integrator *lua_create_simple_integrator(
+    int max_depth, sol::optional<int> tile_size,
+    sol::optional<sol::table> adaptive) {
+  std::optional<AdaptiveSettings> settings;
+  if (adaptive) settings = AdaptiveSettings::from_lua(*adaptive);
+  return create_simple_integrator(max_depth, tile_size.value_or(16), settings);
+}
+}  // namespace
+
+RenderStats SimpleIntegrator::render(const Scene &scene, const Camera &camera,
+                                     const Sampler &sampler,
+                                     Film &film) const {
+  const auto start = std::chrono::steady_clock::now();
+  std::atomic<uint64_t> camera_rays{0}, extension_rays{0}, shadow_rays{0};
+  TileScheduler scheduler{film.get_sample_bounds(), tile_size};
+  // samples `[first, first + n)` of every pixel in `tile`
+  auto render_tile = [&](const Bounds2i &tile, uint32_t first, uint32_t n) {
+    ProfilePhase _(Prof::INTEGRATOR);
+    FilmTile film_tile = film.get_film_tile(tile);
+    uint64_t n_camera = 0, n_extension = 0, n_shadow = 0;
+    for (const Point2i &pixel : tile) {
+      for (uint32_t index = first; index < first + n; ++index) {
+        const Point2f u = sampler.sample_2d(pixel, index, 0);
+        const Point2f p_film{static_cast<float>(pixel.x()) + u.x(),
+                             static_cast<float>(pixel.y()) + u.y()};
+        Ray ray = camera.generate_ray_differential(p_film);
+        ++n_camera;
+        Vector3f L{0, 0, 0}, beta{1, 1, 1};
+        for (int depth = 0;; ++depth) {
+          if (depth > 0) ++n_extension;
+          const std::optional<RayHit> hit = scene.accelerator->intersect(ray);
+          if (!hit) {
+            L += beta * scene.background;
+            break;
+          }
+          ProfilePhase shading(Prof::SHADING);
+          const SurfaceHit surface = surface_hit(scene, ray, *hit);
+          const Material &material =
+              scene.materials[scene.material_id(hit->prim_id)];
+          L += beta * material.emission;
+          if (depth == max_depth) break;
+          if (auto shadow = sample_light(scene, material, surface)) {
+            ++n_shadow;
+            if (!scene.accelerator->occluded(shadow->ray))
+              L += beta * shadow->weight;
+          }
+          const auto scattered = sample_material(
+              material, surface,
+              sampler.sample_2d(pixel, index, bounce_dimension(depth)));
+          if (!scattered) break;
+          beta *= scattered->weight;
+          ray = scattered->ray;
+        }
+        film_tile.add_sample(p_film, L);
+      }
+    }
+    film.merge_film_tile(film_tile);
+    camera_rays += n_camera;
+    extension_rays += n_extension;
+    shadow_rays += n_shadow;
+  };
+  if (adaptive) {
+    AdaptiveScheduler{film, scheduler, *adaptive}.render(render_tile);
+  } else {
+    scheduler.parallel_for([&](const Bounds2i &tile) {
+      render_tile(tile, 0, sampler.samples_per_pixel);
+    });
+  }
+  RenderStats stats{camera_rays, extension_rays, shadow_rays,
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count()};
+  report("simple integrator", stats);
+  return stats;
+}
+
+Integrator *create_simple_integrator(
+    int max_depth, int tile_size, std::optional<AdaptiveSettings> adaptive) {
+  return GlobalMemoryArena::instance().allocObject<SimpleIntegrator>(
+      max_depth, tile_size, adaptive);
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(SimpleIntegrator, [] {
+  DAKKU_INFO("register SimpleIntegrator");
+  auto &state = Lua::instance().get_state();
+  state.new_usertype<SimpleIntegrator>(
+      "SimpleIntegrator", sol::no_constructor, "max_depth",
+      sol::readonly(&SimpleIntegrator::max_depth));
+  state.set_function("_create_simple_integrator",
+                     &lua_create_simple_integrator);
+  return 0;
+});
+}  // namespace dakku
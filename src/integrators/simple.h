@@ -0,0 +1,51 @@
+#ifndef DAKKU_INTEGRATORS_SIMPLE_H_
+#define DAKKU_INTEGRATORS_SIMPLE_H_
+#include <integrators/fwd.h>
+#include <core/adaptive.h>
+
+#include <optional>
+
+namespace dakku {
+
+/**
+ * @brief megakernel path tracer: every tbb task renders a tile and traces
+ * its paths one at a time from the camera to the end
+ * with adaptive settings the tiles are sampled by an `AdaptiveScheduler`
+ * (up to `max_spp` samples per pixel) instead of taking the sampler's
+ * `samples_per_pixel` everywhere
+ *
+ */
+class DAKKU_EXPORT_INTEGRATORS SimpleIntegrator : public Integrator {
+ public:
+  /**
+   * @brief Construct a new Simple Integrator object
+   *
+   * @param max_depth the maximum number of bounces
+   * @param tile_size edge length of the film tiles
+   * @param adaptive adaptive sampling settings (none samples uniformly)
+   */
+  explicit SimpleIntegrator(
+      int max_depth, int tile_size = 16,
+      std::optional<AdaptiveSettings> adaptive = std::nullopt)
+      : Integrator(max_depth), tile_size(tile_size), adaptive(adaptive) {}
+
+  RenderStats render(const Scene &scene, const Camera &camera,
+                     const Sampler &sampler, Film &film) const override;
+
+  /// edge length of the film tiles
+  const int tile_size;
+  /// adaptive sampling settings
+  const std::optional<AdaptiveSettings> adaptive;
+};
+
+/**
+ * @brief Create a simple integrator object
+ *
+ */
+DAKKU_EXPORT_INTEGRATORS Integrator *create_simple_integrator(
+    int max_depth, int tile_size,
+    std::optional<AdaptiveSettings> adaptive = std::nullopt);
+
+DAKKU_DECLARE_LUA_OBJECT(SimpleIntegrator, DAKKU_EXPORT_INTEGRATORS);
+}  // namespace dakku
+#endif
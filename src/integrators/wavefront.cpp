@@ -0,0 +1,432 @@
+#include <integrators/wavefront.h>
+#include <core/memory.h>
+#include <core/profiler.h>
+#include <core/ray_sort.h>
+#include <core/stats.h>
+#include <core/tile.h>
+
+#include <atomic>
+#include <chrono>
+
+namespace dakku {
+
+DAKKU_STAT_COUNTER("Integrator/Rays reordered", rays_reordered);
+
+namespace {
+/// queue entries per task of the counting sort
+constexpr size_t SORT_CHUNK_SIZE = 4096;
+/// packet width of the traversal stages
+constexpr size_t PACKET_SIZE = 8;
+
+/// 3d float vectors as structure of arrays
+struct Vector3fSoA {
+  void resize(size_t n) {
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+  }
+  [[nodiscard]] Vector3f get(size_t i) const {
+    return Vector3f{x[i], y[i], z[i]};
+  }
+  void set(size_t i, const Vector3f &v) {
+    x[i] = v.x();
+    y[i] = v.y();
+    z[i] = v.z();
+  }
+
+  std::vector<float> x, y, z;
+};
+
+/// rays as structure of arrays, each tagged with the path it extends, rays
+/// are appended concurrently
+struct RayQueue {
+  void resize(size_t capacity) {
+    o.resize(capacity);
+    d.resize(capacity);
+    t_max.resize(capacity);
+    path.resize(capacity);
+  }
+  [[nodiscard]] size_t size() const {
+    return n.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] Ray get(size_t i) const {
+    return Ray{Point3f{o.x[i], o.y[i], o.z[i]}, d.get(i), t_max[i]};
+  }
+  void set(size_t i, const Ray &ray, uint32_t path_index) {
+    o.x[i] = ray.o.x();
+    o.y[i] = ray.o.y();
+    o.z[i] = ray.o.z();
+    d.set(i, ray.d);
+    t_max[i] = ray.tMax;
+    path[i] = path_index;
+  }
+  /// append a ray, return its slot
+  size_t push(const Ray &ray, uint32_t path_index) {
+    const size_t i = n.fetch_add(1, std::memory_order_relaxed);
+    set(i, ray, path_index);
+    return i;
+  }
+
+  /// ray origins
+  Vector3fSoA o;
+  /// ray directions
+  Vector3fSoA d;
+  /// ray max times
+  std::vector<float> t_max;
+  /// the path of each ray
+  std::vector<uint32_t> path;
+  /// the number of rays
+  std::atomic<size_t> n{0};
+};
+
+/// the state of all stages of a wave, allocated once per render
+struct Wavefront {
+  explicit Wavefront(size_t capacity) {
+    film_x.resize(capacity);
+    film_y.resize(capacity);
+    pixel_x.resize(capacity);
+    pixel_y.resize(capacity);
+    sample_index.resize(capacity);
+    beta.resize(capacity);
+    L.resize(capacity);
+    for (RayQueue &queue : rays) queue.resize(capacity);
+    shadows.resize(capacity);
+    shadow_weight.resize(capacity);
+    hits.resize(capacity);
+    keys.resize(capacity);
+    order.resize(capacity);
+    sort_keys.resize(capacity);
+    ray_order.resize(capacity);
+    sort_scratch.reserve(capacity);
+  }
+
+  /// film position of each path
+  std::vector<float> film_x, film_y;
+  /// pixel of each path
+  std::vector<int> pixel_x, pixel_y;
+  /// sample index of each path
+  std::vector<uint32_t> sample_index;
+  /// path throughput
+  Vector3fSoA beta;
+  /// radiance gathered by each path
+  Vector3fSoA L;
+  /// rays of the current and the next bounce
+  std::array<RayQueue, 2> rays;
+  /// shadow rays of the current bounce
+  RayQueue shadows;
+  /// radiance carried by the unoccluded shadow rays
+  Vector3fSoA shadow_weight;
+  /// hit of each ray of the current bounce
+  std::vector<RayHit> hits;
+  /// material id of each ray's hit, the number of materials on miss
+  std::vector<uint32_t> keys;
+  /// the rays of the current bounce bucketed by `keys`
+  std::vector<uint32_t> order;
+  /// `ray_sort_key` of each ray of the queue being reordered
+  std::vector<uint32_t> sort_keys;
+  /// the slots of the queue being traced in traversal order
+  std::vector<uint32_t> ray_order;
+  /// scratch memory of the radix sort of `sort_keys`
+  RadixSortScratch sort_scratch;
+};
+
+/// run `f(first, count)` over the queue in packets of `PACKET_SIZE`
+template <typename F>
+void for_each_packet(size_t n, F &&f) {
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<size_t>(0, (n + PACKET_SIZE - 1) /
+                                                PACKET_SIZE),
+      [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        for (size_t p = r.begin(); p != r.end(); ++p) {
+          const size_t first = p * PACKET_SIZE;
+          f(first, std::min(PACKET_SIZE, n - first));
+        }
+      });
+}
+
+/// generate the camera rays of the paths of `tiles`, the paths of tile `k`
+/// are `[offsets[k], offsets[k + 1])`
+void generate(const Camera &camera, const Sampler &sampler,
+              std::span<const Bounds2i> tiles,
+              std::span<const size_t> offsets, Wavefront &wave) {
+  RayQueue &queue = wave.rays[0];
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<size_t>(0, tiles.size()),
+      [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        ProfilePhase _(Prof::CAMERA_RAY);
+        for (size_t k = r.begin(); k != r.end(); ++k) {
+          auto i = static_cast<uint32_t>(offsets[k]);
+          for (const Point2i &pixel : tiles[k]) {
+            for (uint32_t index = 0; index < sampler.samples_per_pixel;
+                 ++index, ++i) {
+              const Point2f u = sampler.sample_2d(pixel, index, 0);
+              const Point2f p_film{static_cast<float>(pixel.x()) + u.x(),
+                                   static_cast<float>(pixel.y()) + u.y()};
+              wave.film_x[i] = p_film.x();
+              wave.film_y[i] = p_film.y();
+              wave.pixel_x[i] = pixel.x();
+              wave.pixel_y[i] = pixel.y();
+              wave.sample_index[i] = index;
+              wave.beta.set(i, Vector3f{1, 1, 1});
+              wave.L.set(i, Vector3f{0, 0, 0});
+              queue.set(i, camera.generate_ray_differential(p_film), i);
+            }
+          }
+        }
+      });
+  queue.n = offsets.back();
+}
+
+/// group the rays of `queue` by direction octant and origin into
+/// `wave.ray_order` (a parallel radix sort of `ray_sort_key`)
+void reorder(const RayQueue &queue, const Bounds3f &bounds, Wavefront &wave) {
+  const size_t n = queue.size();
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<size_t>(0, n, 4096),
+      [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          wave.sort_keys[i] = ray_sort_key(
+              Point3f{queue.o.x[i], queue.o.y[i], queue.o.z[i]},
+              queue.d.get(i), bounds);
+          wave.ray_order[i] = static_cast<uint32_t>(i);
+        }
+      });
+  radix_sort(std::span(wave.sort_keys).first(n),
+             std::span(wave.ray_order).first(n), wave.sort_scratch,
+             RAY_SORT_KEY_BITS);
+  DAKKU_STAT_ADD(rays_reordered, n);
+}
+
+/// find the closest hits of `queue` and their material keys, traced in
+/// `wave.ray_order` if `reordered`, the results stay in the rays' slots
+void intersect(const Scene &scene, const RayQueue &queue, bool reordered,
+               Wavefront &wave) {
+  const auto miss = static_cast<uint32_t>(scene.materials.size());
+  for_each_packet(queue.size(), [&](size_t first, size_t count) {
+    std::array<uint32_t, PACKET_SIZE> slots;
+    std::array<Ray, PACKET_SIZE> rays;
+    for (size_t j = 0; j < count; ++j) {
+      slots[j] = reordered ? wave.ray_order[first + j]
+                           : static_cast<uint32_t>(first + j);
+      rays[j] = queue.get(slots[j]);
+    }
+    RayPacket8 packet;
+    packet.gather(std::span<const Ray>(rays.data(), count));
+    std::array<RayHit, PACKET_SIZE> hits;
+    const uint32_t mask = scene.accelerator->intersect(packet, hits);
+    for (size_t j = 0; j < count; ++j) {
+      wave.hits[slots[j]] = hits[j];
+      wave.keys[slots[j]] =
+          mask & (1u << j) ? scene.material_id(hits[j].prim_id) : miss;
+    }
+  });
+}
+
+/// bucket the `n` rays of the current bounce by key into `wave.order`: a
+/// stable counting sort over chunks (chunk histograms, an exclusive prefix
+/// sum in bucket-major order, then a scatter per chunk)
+void sort_by_material(size_t n, size_t n_buckets, Wavefront &wave) {
+  const size_t n_chunks = (n + SORT_CHUNK_SIZE - 1) / SORT_CHUNK_SIZE;
+  std::vector<size_t> offsets(n_chunks * n_buckets);
+  const auto chunks = oneapi::tbb::blocked_range<size_t>(0, n_chunks);
+  oneapi::tbb::parallel_for(
+      chunks, [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        for (size_t c = r.begin(); c != r.end(); ++c) {
+          const size_t end = std::min(n, (c + 1) * SORT_CHUNK_SIZE);
+          for (size_t i = c * SORT_CHUNK_SIZE; i < end; ++i)
+            ++offsets[c * n_buckets + wave.keys[i]];
+        }
+      });
+  size_t sum = 0;
+  for (size_t b = 0; b < n_buckets; ++b) {
+    for (size_t c = 0; c < n_chunks; ++c) {
+      const size_t count = offsets[c * n_buckets + b];
+      offsets[c * n_buckets + b] = sum;
+      sum += count;
+    }
+  }
+  oneapi::tbb::parallel_for(
+      chunks, [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        for (size_t c = r.begin(); c != r.end(); ++c) {
+          const size_t end = std::min(n, (c + 1) * SORT_CHUNK_SIZE);
+          size_t *offset = &offsets[c * n_buckets];
+          for (size_t i = c * SORT_CHUNK_SIZE; i < end; ++i)
+            wave.order[offset[wave.keys[i]]++] = static_cast<uint32_t>(i);
+        }
+      });
+}
+
+/// shade the hits of `queue` in material order, push the shadow rays and
+/// the rays of the next bounce
+void shade(const Scene &scene, const Sampler &sampler, int depth,
+           int max_depth, const RayQueue &queue, RayQueue &next,
+           Wavefront &wave) {
+  const auto miss = static_cast<uint32_t>(scene.materials.size());
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<size_t>(0, queue.size()),
+      [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        ProfilePhase _(Prof::SHADING);
+        for (size_t k = r.begin(); k != r.end(); ++k) {
+          const uint32_t i = wave.order[k];
+          const uint32_t path = queue.path[i];
+          const Vector3f beta = wave.beta.get(path);
+          if (wave.keys[i] == miss) {
+            wave.L.set(path,
+                       Vector3f{wave.L.get(path) + beta * scene.background});
+            continue;
+          }
+          const Ray ray = queue.get(i);
+          const SurfaceHit surface = surface_hit(scene, ray, wave.hits[i]);
+          const Material &material = scene.materials[wave.keys[i]];
+          wave.L.set(path,
+                     Vector3f{wave.L.get(path) + beta * material.emission});
+          if (depth == max_depth) continue;
+          if (auto shadow = sample_light(scene, material, surface)) {
+            const size_t s = wave.shadows.push(shadow->ray, path);
+            wave.shadow_weight.set(s, Vector3f{beta * shadow->weight});
+          }
+          const Point2i pixel{wave.pixel_x[path], wave.pixel_y[path]};
+          const auto scattered = sample_material(
+              material, surface,
+              sampler.sample_2d(pixel, wave.sample_index[path],
+                                Integrator::bounce_dimension(depth)));
+          if (!scattered) continue;
+          wave.beta.set(path, Vector3f{beta * scattered->weight});
+          next.push(scattered->ray, path);
+        }
+      });
+}
+
+/// add the radiance of the unoccluded shadow rays to their paths (a path
+/// has at most one shadow ray per bounce), traced in `wave.ray_order` if
+/// `reordered`
+void trace_shadows(const Scene &scene, bool reordered, Wavefront &wave) {
+  const RayQueue &queue = wave.shadows;
+  for_each_packet(queue.size(), [&](size_t first, size_t count) {
+    std::array<uint32_t, PACKET_SIZE> slots;
+    std::array<Ray, PACKET_SIZE> rays;
+    for (size_t j = 0; j < count; ++j) {
+      slots[j] = reordered ? wave.ray_order[first + j]
+                           : static_cast<uint32_t>(first + j);
+      rays[j] = queue.get(slots[j]);
+    }
+    RayPacket8 packet;
+    packet.gather(std::span<const Ray>(rays.data(), count));
+    const uint32_t occluded = scene.accelerator->occluded(packet);
+    for (size_t j = 0; j < count; ++j) {
+      if (occluded & (1u << j)) continue;
+      const uint32_t path = queue.path[slots[j]];
+      wave.L.set(path, Vector3f{wave.L.get(path) +
+                                wave.shadow_weight.get(slots[j])});
+    }
+  });
+}
+
+/// add the finished paths of `tiles` to the film
+void accumulate(std::span<const Bounds2i> tiles,
+                std::span<const size_t> offsets, const Wavefront &wave,
+                Film &film) {
+  oneapi::tbb::parallel_for(
+      oneapi::tbb::blocked_range<size_t>(0, tiles.size()),
+      [&](const oneapi::tbb::blocked_range<size_t> &r) {
+        for (size_t k = r.begin(); k != r.end(); ++k) {
+          FilmTile tile = film.get_film_tile(tiles[k]);
+          for (size_t i = offsets[k]; i < offsets[k + 1]; ++i)
+            tile.add_sample(Point2f{wave.film_x[i], wave.film_y[i]},
+                            wave.L.get(i));
+          film.merge_film_tile(tile);
+        }
+      });
+}
+
+Integrator *lua_create_wavefront_integrator(int max_depth,
+                                            sol::optional<size_t> queue_size,
+                                            sol::optional<int> tile_size,
+                                            sol::optional<bool> reorder_rays) {
+  return create_wavefront_integrator(
+      max_depth, queue_size.value_or(WavefrontIntegrator::DEFAULT_QUEUE_SIZE),
+      tile_size.value_or(16), reorder_rays.value_or(false));
+}
+}  // namespace
+
+RenderStats WavefrontIntegrator::render(const Scene &scene,
+                                        const Camera &camera,
+                                        const Sampler &sampler,
+                                        Film &film) const {
+  const auto start = std::chrono::steady_clock::now();
+  RenderStats stats;
+  const TileScheduler scheduler{film.get_sample_bounds(), tile_size};
+  const std::vector<Bounds2i> tiles(scheduler.begin(), scheduler.end());
+  const size_t spp = sampler.samples_per_pixel;
+  // no larger than the film, but at least a tile
+  size_t n_paths = 0, max_tile_paths = 0;
+  for (const Bounds2i &tile : tiles) {
+    n_paths += static_cast<size_t>(tile.area()) * spp;
+    max_tile_paths =
+        std::max(max_tile_paths, static_cast<size_t>(tile.area()) * spp);
+  }
+  const size_t capacity =
+      std::max(std::min(queue_size, n_paths), max_tile_paths);
+  Wavefront wave{capacity};
+  const size_t n_buckets = scene.materials.size() + 1;
+  const Bounds3f scene_bounds = scene.accelerator->world_bound();
+
+  std::vector<size_t> offsets;
+  for (size_t first = 0, last; first < tiles.size(); first = last) {
+    // a wave is a run of consecutive tiles (in curve order) that fits
+    offsets.assign(1, 0);
+    for (last = first; last < tiles.size(); ++last) {
+      const size_t n = static_cast<size_t>(tiles[last].area()) * spp;
+      if (last > first && offsets.back() + n > capacity) break;
+      offsets.push_back(offsets.back() + n);
+    }
+    TraceScope trace("Wavefront wave");
+    const std::span<const Bounds2i> wave_tiles(tiles.data() + first,
+                                               last - first);
+    generate(camera, sampler, wave_tiles, offsets, wave);
+    stats.camera_rays += offsets.back();
+    for (int depth = 0; wave.rays[depth & 1].size() > 0; ++depth) {
+      RayQueue &queue = wave.rays[depth & 1];
+      RayQueue &next = wave.rays[(depth + 1) & 1];
+      next.n = 0;
+      wave.shadows.n = 0;
+      if (depth > 0) stats.extension_rays += queue.size();
+      // camera rays leave the tiles in order and are coherent already
+      const bool reordered = reorder_rays && depth > 0;
+      if (reordered) reorder(queue, scene_bounds, wave);
+      intersect(scene, queue, reordered, wave);
+      sort_by_material(queue.size(), n_buckets, wave);
+      shade(scene, sampler, depth, max_depth, queue, next, wave);
+      stats.shadow_rays += wave.shadows.size();
+      if (reorder_rays) reorder(wave.shadows, scene_bounds, wave);
+      trace_shadows(scene, reorder_rays, wave);
+      queue.n = 0;
+    }
+    accumulate(wave_tiles, offsets, wave, film);
+  }
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  report("wavefront integrator", stats);
+  return stats;
+}
+
+Integrator *create_wavefront_integrator(int max_depth, size_t queue_size,
+                                        int tile_size, bool reorder_rays) {
+  return GlobalMemoryArena::instance().allocObject<WavefrontIntegrator>(
+      max_depth, queue_size, tile_size, reorder_rays);
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(WavefrontIntegrator, [] {
+  DAKKU_INFO("register WavefrontIntegrator");
+  auto &state = Lua::instance().get_state();
+  state.new_usertype<WavefrontIntegrator>(
+      "WavefrontIntegrator", sol::no_constructor, "max_depth",
+      sol::readonly(&WavefrontIntegrator::max_depth), "queue_size",
+      sol::readonly(&WavefrontIntegrator::queue_size), "reorder_rays",
+      sol::readonly(&WavefrontIntegrator::reorder_rays));
+  state.set_function("_create_wavefront_integrator",
+                     &lua_create_wavefront_integrator);
+  return 0;
+});
+}  // namespace dakku
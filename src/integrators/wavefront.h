@@ -0,0 +1,64 @@
+#ifndef DAKKU_INTEGRATORS_WAVEFRONT_H_
+#define DAKKU_INTEGRATORS_WAVEFRONT_H_
+#include <integrators/fwd.h>
+
+namespace dakku {
+
+/**
+ * @brief wavefront path tracer: the film is rendered in waves of up to
+ * `queue_size` paths, kept as structure of arrays, and every bounce of a
+ * wave runs as stages over the whole queue (each a tbb parallel_for):
+ * generate camera rays, intersect in packets of 8, bucket the hits by
+ * material (a stable counting sort, misses last), shade the buckets and push
+ * shadow and continuation rays, then trace the shadow rays in packets
+ * with `reorder_rays` the continuation and shadow rays are traced grouped by
+ * direction octant and origin (see `sort_rays`) and the results scattered
+ * back to the rays' slots, so that neighbouring packets visit the same nodes
+ * it renders the same estimate as `SimpleIntegrator`, shading runs over
+ * runs of one material and traversal over whole queues instead of one
+ * path at a time
+ *
+ */
+class DAKKU_EXPORT_INTEGRATORS WavefrontIntegrator : public Integrator {
+ public:
+  /// default maximum number of paths in flight
+  static constexpr size_t DEFAULT_QUEUE_SIZE = size_t{1} << 20;
+
+  /**
+   * @brief Construct a new Wavefront Integrator object
+   *
+   * @param max_depth the maximum number of bounces
+   * @param queue_size the maximum number of paths in flight (a wave holds
+   * whole tiles, at least one)
+   * @param tile_size edge length of the film tiles
+   * @param reorder_rays sort the incoherent rays before traversal
+   */
+  explicit WavefrontIntegrator(int max_depth,
+                               size_t queue_size = DEFAULT_QUEUE_SIZE,
+                               int tile_size = 16, bool reorder_rays = false)
+      : Integrator(max_depth),
+        queue_size(queue_size),
+        tile_size(tile_size),
+        reorder_rays(reorder_rays) {}
+
+  RenderStats render(const Scene &scene, const Camera &camera,
+                     const Sampler &sampler, Film &film) const override;
+
+  /// the maximum number of paths in flight
+  const size_t queue_size;
+  /// edge length of the film tiles
+  const int tile_size;
+  /// whether the continuation and shadow rays are sorted before traversal
+  const bool reorder_rays;
+};
+
+/**
+ * @brief Create a wavefront integrator object
+ *
+ */
+DAKKU_EXPORT_INTEGRATORS Integrator *create_wavefront_integrator(
+    int max_depth, size_t queue_size, int tile_size, bool reorder_rays);
+
+DAKKU_DECLARE_LUA_OBJECT(WavefrontIntegrator, DAKKU_EXPORT_INTEGRATORS);
+}  // namespace dakku
+#endif
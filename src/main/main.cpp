@@ -1,7 +1,13 @@
+#include <core/asset_loader.h>
 #include <core/logger.h>
 #include <core/lua.h>
+#include <core/profiler.h>
+#include <core/scene_cache.h>
+#include <core/stats.h>
+#include <core/trace.h>
 
 #include <iostream>
+#include <string_view>
 
 using namespace dakku;
 
@@ -9,8 +15,69 @@ int main(int argc, const char *argv[]) {
 #if defined(_WIN32) || defined(WIN32)
   LoadLibrary("dakku.core.dll");
   LoadLibrary("dakku.filters.dll");
+  LoadLibrary("dakku.accelerators.dll");
+  LoadLibrary("dakku.samplers.dll");
+  LoadLibrary("dakku.integrators.dll");
 #endif
-  Lua::instance().get_state().open_libraries(sol::lib::base);
-  Lua::instance().get_state().script_file("../../../../scenes/test.lua");
+  // `--trace` records the timeline from the start, so that it covers the
+  // scene script and the asset loads it starts, `--profile` samples the
+  // phases into `profile.folded` and `--stats` writes the counters to
+  // `stats.json`
+  bool profile = false, stats = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg == "--trace") Tracer::instance().enable();
+    if (arg == "--profile") profile = true;
+    if (arg == "--stats") stats = true;
+  }
+  // log from a background thread while rendering
+  Logger::set_async(true);
+  if (profile) Profiler::instance().start();
+  auto &state = Lua::instance().get_state();
+  state.open_libraries(sol::lib::base);
+  const std::string script = "../../../../scenes/test.lua";
+  const std::string cache_path = script + ".cache";
+  // a plain data `scene` table is cached, later runs skip the evaluation
+  // until the script or one of its declared inputs changes, scripts that
+  // create objects or load assets are always evaluated
+  std::unique_ptr<SceneCache> cache = SceneCache::open(cache_path, script);
+  if (cache) {
+    DAKKU_INFO("load scene cache {}", cache_path);
+    state["scene"] = cache->get_lua("scene", state);
+  } else {
+    SceneCacheWriter writer;
+    writer.watch(state);
+    bool valid;
+    {
+      ProfilePhase _(Prof::SCENE_LOAD);
+      Tracer &tracer = Tracer::instance();
+      const uint64_t begin = tracer.now();
+      valid =
+          state.safe_script_file(script, sol::script_pass_on_error).valid();
+      // recorded after the fact, the script may turn tracing on itself
+      if (tracer.is_enabled())
+        tracer.record(
+            TraceEvent{"Scene script", begin, tracer.now(), {}, false});
+    }
+    // join the asset loads the script started before finalizing the scene
+    AssetLoader::instance().wait();
+    SceneCacheWriter::unwatch(state);
+    if (valid && writer.cacheable() &&
+        writer.add_lua("scene", state["scene"].get<sol::object>()))
+      writer.write(cache_path, script);
+  }
+  if (profile) {
+    Profiler::instance().stop();
+    Profiler::instance().report();
+    static_cast<void>(Profiler::instance().write_collapsed("profile.folded"));
+  }
+  StatRegistry::instance().report();
+  if (stats)
+    static_cast<void>(StatRegistry::instance().write_json("stats.json"));
+  // tracing is turned on by `--trace` or by the script (`_enable_tracing()`)
+  if (Tracer::instance().size() > 0)
+    static_cast<void>(Tracer::instance().write_json("trace.json"));
+  Logger::report_suppressed();
+  Logger::set_async(false);
   return 0;
 }
\ No newline at end of file
@@ -25,6 +25,14 @@ namespace dakku {
 #define DAKKU_CORE_MODULE 1
 /// dakku filters module
 #define DAKKU_FILTERS_MODULE 2
+/// dakku accelerators module
+#define DAKKU_ACCELERATORS_MODULE 3
+/// dakku imageio module
+#define DAKKU_IMAGEIO_MODULE 4
+/// dakku samplers module
+#define DAKKU_SAMPLERS_MODULE 5
+/// dakku integrators module
+#define DAKKU_INTEGRATORS_MODULE 6
 /// dakku main module
 #define DAKKU_MAIN_MODULE 10
 
@@ -0,0 +1,12 @@
+#ifndef DAKKU_SAMPLERS_FWD_H_
+#define DAKKU_SAMPLERS_FWD_H_
+#include <core/sampler.h>
+
+namespace dakku {
+#if DAKKU_BUILD_MODULE != DAKKU_SAMPLERS_MODULE
+#define DAKKU_EXPORT_SAMPLERS DAKKU_IMPORT
+#else
+#define DAKKU_EXPORT_SAMPLERS DAKKU_EXPORT
+#endif
+}  // namespace dakku
+#endif
@@ -0,0 +1,259 @@
+#include <samplers/halton.h>
+#include <core/memory.h>
+
+#include <numeric>
+
+namespace dakku {
+
+namespace {
+/// the first `HALTON_DIMENSIONS` primes
+constexpr auto PRIMES = [] {
+  std::array<uint32_t, HALTON_DIMENSIONS> ret{};
+  for (uint32_t n = 2, count = 0; count < HALTON_DIMENSIONS; ++n) {
+    bool is_prime = true;
+    for (uint32_t i = 0; i < count && ret[i] * ret[i] <= n; ++i)
+      if (n % ret[i] == 0) is_prime = false;
+    if (is_prime) ret[count++] = n;
+  }
+  return ret;
+}();
+
+/// the largest resolution the pixel grid of the first two dimensions covers,
+/// larger films repeat the grid
+constexpr uint64_t MAX_RESOLUTION = 128;
+
+/// radical inverse of `a` in `base` (no permutation)
+double radical_inverse(uint32_t base, uint64_t a) {
+  const double inv_base = 1.0 / base;
+  uint64_t reversed = 0;
+  double inv_base_n = 1;
+  while (a) {
+    const uint64_t next = a / base;
+    reversed = reversed * base + (a - next * base);
+    inv_base_n *= inv_base;
+    a = next;
+  }
+  return static_cast<double>(reversed) * inv_base_n;
+}
+
+/**
+ * @brief radical inverse of `a` in `base` with the digits permuted by `perm`,
+ * the infinitely many leading zero digits are permuted as well, they add a
+ * geometric series of `perm[0]`
+ *
+ */
+float scrambled_radical_inverse(uint32_t base, const uint16_t *perm,
+                                uint64_t a) {
+  const double inv_base = 1.0 / base;
+  uint64_t reversed = 0;
+  double inv_base_n = 1;
+  while (a) {
+    const uint64_t next = a / base;
+    reversed = reversed * base + perm[a - next * base];
+    inv_base_n *= inv_base;
+    a = next;
+  }
+  const double v = inv_base_n * (static_cast<double>(reversed) +
+                                 inv_base * perm[0] / (1 - inv_base));
+  return std::min(static_cast<float>(v), ONE_MINUS_EPSILON);
+}
+
+/// the index whose low `n_digits` digits in `base` reversed are `inverse`
+uint64_t inverse_radical_inverse(uint32_t base, uint64_t inverse,
+                                 uint32_t n_digits) {
+  uint64_t index = 0;
+  for (uint32_t i = 0; i < n_digits; ++i) {
+    index = index * base + inverse % base;
+    inverse /= base;
+  }
+  return index;
+}
+
+/// inverse of `a` modulo `n` (`a` and `n` are coprime)
+uint64_t multiplicative_inverse(int64_t a, int64_t n) {
+  // extended euclid, `x` tracks the coefficient of `a`
+  int64_t x = 1, last_x = 0, r = a, last_r = n;
+  while (r != 0) {
+    const int64_t q = last_r / r;
+    last_r = std::exchange(r, last_r - q * r);
+    last_x = std::exchange(x, last_x - q * x);
+  }
+  return static_cast<uint64_t>((last_x % n + n) % n);
+}
+
+#ifdef DAKKU_ENABLE_AVX2
+/**
+ * @brief 4 lanes of `scrambled_radical_inverse` of the same `a`, in doubles
+ * so that indices beyond 32 bits stay exact
+ *
+ * @param bases the base of each lane
+ * @param offsets the permutation offset of each lane
+ */
+__m128 scrambled_radical_inverse(__m256d bases, __m128i offsets,
+                                 const uint16_t *permutations, uint64_t a) {
+  const auto *table = reinterpret_cast<const int *>(permutations);
+  const __m128i low16 = _mm_set1_epi32(0xffff);
+  // permutations are uint16, the gathers load 32 bits and mask the low half
+  auto lookup = [&](__m128i digits) {
+    return _mm256_cvtepi32_pd(_mm_and_si128(
+        _mm_i32gather_epi32(table, _mm_add_epi32(offsets, digits), 2),
+        low16));
+  };
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1);
+  const __m256d inv_bases = _mm256_div_pd(one, bases);
+  __m256d v = _mm256_set1_pd(static_cast<double>(a));
+  __m256d reversed = zero, inv_base_n = one;
+  while (true) {
+    const __m256d active = _mm256_cmp_pd(v, zero, _CMP_NEQ_OQ);
+    if (_mm256_movemask_pd(active) == 0) break;
+    // floor(v / base) through the reciprocal, corrected by one step
+    __m256d next = _mm256_floor_pd(_mm256_mul_pd(v, inv_bases));
+    __m256d digit = _mm256_sub_pd(v, _mm256_mul_pd(next, bases));
+    const __m256d under = _mm256_cmp_pd(digit, zero, _CMP_LT_OQ);
+    next = _mm256_sub_pd(next, _mm256_and_pd(under, one));
+    digit = _mm256_add_pd(digit, _mm256_and_pd(under, bases));
+    const __m256d over = _mm256_cmp_pd(digit, bases, _CMP_GE_OQ);
+    next = _mm256_add_pd(next, _mm256_and_pd(over, one));
+    digit = _mm256_sub_pd(digit, _mm256_and_pd(over, bases));
+    const __m256d perm = lookup(_mm256_cvttpd_epi32(digit));
+    reversed = _mm256_blendv_pd(
+        reversed, _mm256_add_pd(_mm256_mul_pd(reversed, bases), perm), active);
+    inv_base_n = _mm256_blendv_pd(
+        inv_base_n, _mm256_mul_pd(inv_base_n, inv_bases), active);
+    v = next;
+  }
+  const __m256d tail = _mm256_div_pd(
+      _mm256_mul_pd(inv_bases, lookup(_mm_setzero_si128())),
+      _mm256_sub_pd(one, inv_bases));
+  const __m256d r = _mm256_mul_pd(inv_base_n, _mm256_add_pd(reversed, tail));
+  return _mm_min_ps(_mm256_cvtpd_ps(r), _mm_set1_ps(ONE_MINUS_EPSILON));
+}
+#endif
+
+Sampler *lua_create_halton_sampler(uint32_t samples_per_pixel,
+                                   const Bounds2i &sample_bounds,
+                                   sol::optional<uint64_t> seed) {
+  return create_halton_sampler(samples_per_pixel, sample_bounds,
+                               seed.value_or(0));
+}
+}  // namespace
+
+HaltonSampler::HaltonSampler(uint32_t samples_per_pixel,
+                             const Bounds2i &sample_bounds, uint64_t seed)
+    : Sampler(samples_per_pixel) {
+  const Vector2i res = sample_bounds.diagonal();
+  for (size_t i = 0; i < 2; ++i) {
+    const uint64_t base = i == 0 ? 2 : 3;
+    const auto target = std::min<uint64_t>(std::max(res[i], 1), MAX_RESOLUTION);
+    base_scales[i] = 1;
+    while (base_scales[i] < target) {
+      base_scales[i] *= base;
+      ++base_exponents[i];
+    }
+  }
+  sample_stride = base_scales[0] * base_scales[1];
+  const auto scale_x = static_cast<int64_t>(base_scales[0]);
+  const auto scale_y = static_cast<int64_t>(base_scales[1]);
+  mult_inverses[0] = multiplicative_inverse(scale_y, scale_x);
+  mult_inverses[1] = multiplicative_inverse(scale_x, scale_y);
+
+  // a random permutation of the digits of each base, one extra entry pads
+  // the 32 bit gathers
+  permutations.resize(
+      std::accumulate(PRIMES.begin(), PRIMES.end(), size_t{1}));
+  uint32_t offset = 0;
+  for (uint32_t d = 0; d < HALTON_DIMENSIONS; ++d) {
+    permutation_offsets[d] = offset;
+    uint16_t *perm = permutations.data() + offset;
+    std::iota(perm, perm + PRIMES[d], uint16_t{0});
+    for (uint32_t i = PRIMES[d] - 1; i > 0; --i) {
+      const uint64_t r = mix_bits(seed ^ mix_bits((uint64_t{d} << 32) | i));
+      std::swap(perm[i], perm[r % (i + 1)]);
+    }
+    offset += PRIMES[d];
+  }
+}
+
+uint64_t HaltonSampler::global_index(const Point2i &pixel,
+                                     uint32_t index) const {
+  uint64_t offset = 0;
+  if (sample_stride > 1) {
+    for (size_t i = 0; i < 2; ++i) {
+      const auto scale = static_cast<int64_t>(base_scales[i]);
+      const auto p = static_cast<uint64_t>((pixel[i] % scale + scale) % scale);
+      offset += inverse_radical_inverse(i == 0 ? 2 : 3, p, base_exponents[i]) *
+                (sample_stride / base_scales[i]) * mult_inverses[i];
+    }
+    offset %= sample_stride;
+  }
+  return offset + index * sample_stride;
+}
+
+float HaltonSampler::sample_dimension(uint64_t index, uint32_t dim) const {
+  // the low digits of the index select the pixel, the rest is the offset
+  if (dim == 0)
+    return std::min(
+        static_cast<float>(radical_inverse(2, index >> base_exponents[0])),
+        ONE_MINUS_EPSILON);
+  if (dim == 1)
+    return std::min(
+        static_cast<float>(radical_inverse(3, index / base_scales[1])),
+        ONE_MINUS_EPSILON);
+  dim %= HALTON_DIMENSIONS;
+  return scrambled_radical_inverse(
+      PRIMES[dim], permutations.data() + permutation_offsets[dim], index);
+}
+
+float HaltonSampler::sample(const Point2i &pixel, uint32_t index,
+                            uint32_t dim) const {
+  return sample_dimension(global_index(pixel, index), dim);
+}
+
+void HaltonSampler::sample_batch(const Point2i &pixel, uint32_t index,
+                                 uint32_t first_dim,
+                                 std::span<float> out) const {
+  const uint64_t i = global_index(pixel, index);
+  size_t k = 0;
+#ifdef DAKKU_ENABLE_AVX2
+  // the pixel dimensions are special
+  for (; k < out.size() && first_dim + k < 2; ++k)
+    out[k] = sample_dimension(i, first_dim + static_cast<uint32_t>(k));
+  for (; k + 4 <= out.size(); k += 4) {
+    alignas(32) std::array<double, 4> bases;
+    alignas(16) std::array<uint32_t, 4> offsets;
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+      const uint32_t dim =
+          (first_dim + static_cast<uint32_t>(k) + lane) % HALTON_DIMENSIONS;
+      bases[lane] = PRIMES[dim];
+      offsets[lane] = permutation_offsets[dim];
+    }
+    _mm_storeu_ps(
+        out.data() + k,
+        scrambled_radical_inverse(
+            _mm256_load_pd(bases.data()),
+            _mm_load_si128(reinterpret_cast<const __m128i *>(offsets.data())),
+            permutations.data(), i));
+  }
+#endif
+  for (; k < out.size(); ++k)
+    out[k] = sample_dimension(i, first_dim + static_cast<uint32_t>(k));
+}
+
+Sampler *create_halton_sampler(uint32_t samples_per_pixel,
+                               const Bounds2i &sample_bounds, uint64_t seed) {
+  return GlobalMemoryArena::instance().allocObject<HaltonSampler>(
+      samples_per_pixel, sample_bounds, seed);
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(HaltonSampler, [] {
+  DAKKU_INFO("register HaltonSampler");
+  auto &state = Lua::instance().get_state();
+  state.new_usertype<HaltonSampler>(
+      "HaltonSampler", sol::no_constructor, "samples_per_pixel",
+      sol::readonly(&HaltonSampler::samples_per_pixel), "sample",
+      &HaltonSampler::sample);
+  state.set_function("_create_halton_sampler", &lua_create_halton_sampler);
+  return 0;
+});
+}  // namespace dakku
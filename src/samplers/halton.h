@@ -0,0 +1,73 @@
+#ifndef DAKKU_SAMPLERS_HALTON_H_
+#define DAKKU_SAMPLERS_HALTON_H_
+#include <samplers/fwd.h>
+#include <core/bounds.h>
+
+#include <vector>
+
+namespace dakku {
+
+/// the number of halton dimensions (prime bases), higher dimensions wrap
+static constexpr uint32_t HALTON_DIMENSIONS = 128;
+
+/**
+ * @brief halton sampler with random digit permutations
+ * the film is covered by the first two dimensions (bases 2 and 3), each pixel
+ * gets the subsequence of halton points that fall into it, so dimensions 0
+ * and 1 are the offsets in the pixel, the other dimensions use the scrambled
+ * radical inverse with a permutation table of each base
+ *
+ */
+class DAKKU_EXPORT_SAMPLERS HaltonSampler : public Sampler {
+ public:
+  /**
+   * @brief Construct a new Halton Sampler object
+   *
+   * @param sample_bounds the pixels that are sampled
+   * @param seed seeds the permutation tables
+   */
+  HaltonSampler(uint32_t samples_per_pixel, const Bounds2i &sample_bounds,
+                uint64_t seed = 0);
+
+  [[nodiscard]] float sample(const Point2i &pixel, uint32_t index,
+                             uint32_t dim) const override;
+
+  void sample_batch(const Point2i &pixel, uint32_t index, uint32_t first_dim,
+                    std::span<float> out) const override;
+
+  /**
+   * @brief get the index of sample `index` of `pixel` in the halton sequence
+   *
+   */
+  [[nodiscard]] uint64_t global_index(const Point2i &pixel,
+                                      uint32_t index) const;
+
+ private:
+  /// sample a dimension of the halton point `index`
+  [[nodiscard]] float sample_dimension(uint64_t index, uint32_t dim) const;
+
+  /// $2^j$ and $3^k$, the pixel grid repeats with this period
+  std::array<uint64_t, 2> base_scales{};
+  /// $j$ and $k$
+  std::array<uint32_t, 2> base_exponents{};
+  /// `base_scales[0] * base_scales[1]`, the distance between two samples of
+  /// a pixel in the sequence
+  uint64_t sample_stride{1};
+  /// inverses of `base_scales[1]` modulo `base_scales[0]` and the other way
+  std::array<uint64_t, 2> mult_inverses{};
+  /// digit permutations of all bases, concatenated
+  std::vector<uint16_t> permutations;
+  /// offset of the permutation of each dimension
+  std::array<uint32_t, HALTON_DIMENSIONS> permutation_offsets{};
+};
+
+/**
+ * @brief Create a halton sampler object
+ *
+ */
+DAKKU_EXPORT_SAMPLERS Sampler *create_halton_sampler(
+    uint32_t samples_per_pixel, const Bounds2i &sample_bounds, uint64_t seed);
+
+DAKKU_DECLARE_LUA_OBJECT(HaltonSampler, DAKKU_EXPORT_SAMPLERS);
+}  // namespace dakku
+#endif
@@ -0,0 +1,213 @@
+#include <samplers/sobol.h>
+#include <core/memory.h>
+
+namespace dakku {
+
+namespace {
+/**
+ * @brief primitive polynomial and initial direction numbers of a sobol
+ * dimension (Joe and Kuo, new-joe-kuo-6.21201)
+ *
+ */
+struct SobolInit {
+  /// degree of the polynomial
+  uint32_t s;
+  /// inner coefficients of the polynomial
+  uint32_t a;
+  /// initial direction numbers $m_1, \dots, m_s$
+  std::array<uint32_t, 6> m;
+};
+
+/// dimensions 1 to `SOBOL_DIMENSIONS - 1` (dimension 0 is van der corput)
+constexpr std::array<SobolInit, SOBOL_DIMENSIONS - 1> SOBOL_INIT = {{
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+}};
+
+/// generator matrices, `[dim][bit]` is the column of index bit `bit`
+using SobolMatrices =
+    std::array<std::array<uint32_t, 32>, SOBOL_DIMENSIONS>;
+
+constexpr SobolMatrices SOBOL_MATRICES = [] {
+  SobolMatrices ret{};
+  for (uint32_t k = 0; k < 32; ++k) ret[0][k] = 1u << (31 - k);
+  for (uint32_t d = 1; d < SOBOL_DIMENSIONS; ++d) {
+    const auto &[s, a, m] = SOBOL_INIT[d - 1];
+    auto &v = ret[d];
+    for (uint32_t k = 0; k < s; ++k) v[k] = m[k] << (31 - k);
+    for (uint32_t k = s; k < 32; ++k) {
+      v[k] = v[k - s] ^ (v[k - s] >> s);
+      for (uint32_t j = 1; j < s; ++j)
+        if ((a >> (s - 1 - j)) & 1) v[k] ^= v[k - j];
+    }
+  }
+  return ret;
+}();
+
+#ifdef DAKKU_ENABLE_AVX2
+/// `SOBOL_MATRICES` transposed (`[bit][dim]`), so that the columns of
+/// consecutive dimensions are contiguous
+alignas(32) constexpr auto SOBOL_MATRICES_T = [] {
+  std::array<std::array<uint32_t, SOBOL_DIMENSIONS>, 32> ret{};
+  for (uint32_t d = 0; d < SOBOL_DIMENSIONS; ++d)
+    for (uint32_t k = 0; k < 32; ++k) ret[k][d] = SOBOL_MATRICES[d][k];
+  return ret;
+}();
+#endif
+
+/// random permutation of the bits above each bit (Laine and Karras)
+constexpr uint32_t laine_karras_permutation(uint32_t x, uint32_t seed) {
+  x += seed;
+  x ^= x * 0x6c50b47cu;
+  x ^= x * 0xb82f1e52u;
+  x ^= x * 0xc7afe638u;
+  x ^= x * 0x8d22f6e6u;
+  return x;
+}
+
+/// nested uniform (owen) scramble of a fixed point fraction (Burley)
+constexpr uint32_t nested_uniform_scramble(uint32_t x, uint32_t seed) {
+  return reverse_bits_32(
+      laine_karras_permutation(reverse_bits_32(x), seed));
+}
+
+/// fixed point fraction to a float in $[0, 1)$
+float to_unit_float(uint32_t x) {
+  return static_cast<float>(x >> 8) * 0x1p-24f;
+}
+
+#ifdef DAKKU_ENABLE_AVX2
+/// reverse the bits of every lane
+__m256i reverse_bits_32(__m256i x) {
+  const __m256i bswap =
+      _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                       3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  // reversed nibbles
+  const __m256i lut =
+      _mm256_setr_epi8(0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe, 0x1, 0x9, 0x5,
+                       0xd, 0x3, 0xb, 0x7, 0xf, 0x0, 0x8, 0x4, 0xc, 0x2, 0xa,
+                       0x6, 0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  x = _mm256_shuffle_epi8(x, bswap);
+  const __m256i lo = _mm256_and_si256(x, nibble);
+  const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+  return _mm256_or_si256(_mm256_slli_epi16(_mm256_shuffle_epi8(lut, lo), 4),
+                         _mm256_shuffle_epi8(lut, hi));
+}
+
+/// `x ^= x * c` for every lane
+__m256i xor_mul(__m256i x, uint32_t c) {
+  return _mm256_xor_si256(
+      x, _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(c))));
+}
+
+/// 8 lanes of `nested_uniform_scramble`
+__m256i nested_uniform_scramble(__m256i x, __m256i seed) {
+  x = _mm256_add_epi32(reverse_bits_32(x), seed);
+  x = xor_mul(x, 0x6c50b47cu);
+  x = xor_mul(x, 0xb82f1e52u);
+  x = xor_mul(x, 0xc7afe638u);
+  x = xor_mul(x, 0x8d22f6e6u);
+  return reverse_bits_32(x);
+}
+#endif
+
+Sampler *lua_create_sobol_sampler(uint32_t samples_per_pixel,
+                                  sol::optional<uint64_t> seed) {
+  return create_sobol_sampler(samples_per_pixel, seed.value_or(0));
+}
+}  // namespace
+
+uint32_t sobol_sample(uint32_t index, uint32_t dim) {
+  DAKKU_CHECK(dim < SOBOL_DIMENSIONS, "sobol dimension out of range: {}", dim);
+  uint32_t v = 0;
+  for (const uint32_t *m = SOBOL_MATRICES[dim].data(); index; index >>= 1, ++m)
+    if (index & 1) v ^= *m;
+  return v;
+}
+
+uint32_t SobolSampler::hash(const Point2i &pixel, uint64_t key) const {
+  const uint64_t p = static_cast<uint64_t>(static_cast<uint32_t>(pixel.x()))
+                         << 32 |
+                     static_cast<uint32_t>(pixel.y());
+  return static_cast<uint32_t>(mix_bits(mix_bits(p ^ seed) ^ key));
+}
+
+float SobolSampler::sample(const Point2i &pixel, uint32_t index,
+                           uint32_t dim) const {
+  const uint32_t group = dim / SOBOL_DIMENSIONS;
+  // even keys shuffle the index of a group, odd keys scramble a dimension
+  const uint32_t shuffled =
+      nested_uniform_scramble(index, hash(pixel, 2ull * group));
+  const uint32_t v = sobol_sample(shuffled, dim % SOBOL_DIMENSIONS);
+  return to_unit_float(nested_uniform_scramble(v, hash(pixel, 2ull * dim + 1)));
+}
+
+void SobolSampler::sample_batch(const Point2i &pixel, uint32_t index,
+                                uint32_t first_dim,
+                                std::span<float> out) const {
+  size_t k = 0;
+#ifdef DAKKU_ENABLE_AVX2
+  while (k + 8 <= out.size()) {
+    const uint32_t dim = first_dim + static_cast<uint32_t>(k);
+    const uint32_t d = dim % SOBOL_DIMENSIONS;
+    // the 8 lanes must share a group to share the shuffled index
+    if (d + 8 > SOBOL_DIMENSIONS) {
+      out[k] = sample(pixel, index, dim);
+      ++k;
+      continue;
+    }
+    uint32_t shuffled = nested_uniform_scramble(
+        index, hash(pixel, 2ull * (dim / SOBOL_DIMENSIONS)));
+    __m256i v = _mm256_setzero_si256();
+    for (const auto *m = SOBOL_MATRICES_T.data(); shuffled;
+         shuffled >>= 1, ++m)
+      if (shuffled & 1)
+        v = _mm256_xor_si256(
+            v, _mm256_loadu_si256(
+                   reinterpret_cast<const __m256i *>(m->data() + d)));
+    alignas(32) std::array<uint32_t, 8> seeds;
+    for (uint32_t lane = 0; lane < 8; ++lane)
+      seeds[lane] = hash(pixel, 2ull * (dim + lane) + 1);
+    v = nested_uniform_scramble(
+        v, _mm256_load_si256(reinterpret_cast<const __m256i *>(seeds.data())));
+    // shift right by 8 keeps the values positive for the signed conversion
+    const __m256 f = _mm256_mul_ps(
+        _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 8)), _mm256_set1_ps(0x1p-24f));
+    _mm256_storeu_ps(out.data() + k, f);
+    k += 8;
+  }
+#endif
+  for (; k < out.size(); ++k)
+    out[k] = sample(pixel, index, first_dim + static_cast<uint32_t>(k));
+}
+
+Sampler *create_sobol_sampler(uint32_t samples_per_pixel, uint64_t seed) {
+  return GlobalMemoryArena::instance().allocObject<SobolSampler>(
+      samples_per_pixel, seed);
+}
+
+DAKKU_IMPLEMENT_LUA_OBJECT(SobolSampler, [] {
+  DAKKU_INFO("register SobolSampler");
+  auto &state = Lua::instance().get_state();
+  state.new_usertype<SobolSampler>(
+      "SobolSampler", sol::no_constructor, "samples_per_pixel",
+      sol::readonly(&SobolSampler::samples_per_pixel), "sample",
+      &SobolSampler::sample);
+  state.set_function("_create_sobol_sampler", &lua_create_sobol_sampler);
+  return 0;
+});
+}  // namespace dakku
@@ -0,0 +1,61 @@
+#ifndef DAKKU_SAMPLERS_SOBOL_H_
+#define DAKKU_SAMPLERS_SOBOL_H_
+#include <samplers/fwd.h>
+
+namespace dakku {
+
+/// the number of sobol dimensions with their own generator matrix
+static constexpr uint32_t SOBOL_DIMENSIONS = 16;
+
+/**
+ * @brief get dimension `dim` (< `SOBOL_DIMENSIONS`) of point `index` of the
+ * (unscrambled) sobol sequence as a 32 bit fixed point fraction
+ *
+ */
+DAKKU_EXPORT_SAMPLERS uint32_t sobol_sample(uint32_t index, uint32_t dim);
+
+/**
+ * @brief owen scrambled sobol sampler
+ * the dimensions are grouped by `SOBOL_DIMENSIONS`, each group is a padded
+ * sobol point: the sample index is shuffled with a seed of (pixel, group) and
+ * every dimension is nested uniform scrambled with a seed of (pixel,
+ * dimension), so the dimensions of a group stay stratified together and the
+ * pixels and groups are decorrelated
+ * the shuffle keeps each power of two prefix of the samples of a pixel a
+ * complete (scrambled) net
+ *
+ */
+class DAKKU_EXPORT_SAMPLERS SobolSampler : public Sampler {
+ public:
+  /**
+   * @brief Construct a new Sobol Sampler object
+   *
+   * @param seed decorrelates different renders of the same scene
+   */
+  explicit SobolSampler(uint32_t samples_per_pixel, uint64_t seed = 0)
+      : Sampler(samples_per_pixel), seed(seed) {}
+
+  [[nodiscard]] float sample(const Point2i &pixel, uint32_t index,
+                             uint32_t dim) const override;
+
+  void sample_batch(const Point2i &pixel, uint32_t index, uint32_t first_dim,
+                    std::span<float> out) const override;
+
+  /// the scramble seed
+  const uint64_t seed;
+
+ private:
+  /// hash `pixel` and `key` into a 32 bit seed
+  [[nodiscard]] uint32_t hash(const Point2i &pixel, uint64_t key) const;
+};
+
+/**
+ * @brief Create a sobol sampler object
+ *
+ */
+DAKKU_EXPORT_SAMPLERS Sampler *create_sobol_sampler(uint32_t samples_per_pixel,
+                                                    uint64_t seed);
+
+DAKKU_DECLARE_LUA_OBJECT(SobolSampler, DAKKU_EXPORT_SAMPLERS);
+}  // namespace dakku
+#endif
@@ -1,9 +1,12 @@
--- includes("imageio")
+includes("imageio")
 -- includes("stream")
 -- includes("textures")
 -- includes("cameras")
 -- includes("math")
 includes("core")
 includes("filters")
+includes("samplers")
+includes("accelerators")
+includes("integrators")
 includes("main")
 -- includes("gui")
\ No newline at end of file
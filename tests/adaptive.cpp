@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <core/adaptive.h>
+
+#include <random>
+
+using namespace dakku;
+
+namespace {
+class BoxFilter : public Filter {
+ public:
+  BoxFilter() : Filter(Vector2f{0.5f, 0.5f}) {}
+  [[nodiscard]] float evaluate(const Point2f &) const override { return 1; }
+};
+}  // namespace
+
+TEST(Adaptive, VarianceEstimator) {
+  std::mt19937 rng{3};
+  std::normal_distribution<float> dist{2, 0.5f};
+  std::vector<float> xs(1000);
+  for (float &x : xs) x = dist(rng);
+  VarianceEstimator all, a, b;
+  for (size_t i = 0; i < xs.size(); ++i) {
+    all.add(xs[i]);
+    (i < 300 ? a : b).add(xs[i]);
+  }
+  double mean = 0, m2 = 0;
+  for (float x : xs) mean += x;
+  mean /= static_cast<double>(xs.size());
+  for (float x : xs) m2 += (x - mean) * (x - mean);
+  EXPECT_NEAR(all.mean, mean, 1e-4);
+  EXPECT_NEAR(all.variance(), m2 / (xs.size() - 1), 1e-3);
+  // merging disjoint sets gives the same statistics
+  a.merge(b);
+  EXPECT_EQ(a.n, all.n);
+  EXPECT_NEAR(a.mean, all.mean, 1e-4);
+  EXPECT_NEAR(a.variance(), all.variance(), 1e-3);
+  EXPECT_EQ(VarianceEstimator{}.relative_error(), INF);
+}
+
+TEST(Adaptive, Render) {
+  // the left half is constant, the right half is noisy
+  BoxFilter filter;
+  Film film{Point2i{32, 16}, filter};
+  TileScheduler scheduler{film.get_sample_bounds(), 8};
+  AdaptiveSettings settings;
+  settings.base_spp = 8;
+  settings.pass_spp = 8;
+  settings.max_spp = 64;
+  settings.threshold = 0.01f;
+  AdaptiveScheduler adaptive{film, scheduler, settings};
+
+  std::atomic<uint64_t> taken{0};
+  auto reports = adaptive.render([&](const Bounds2i &bounds,
+                                     uint32_t first_sample,
+                                     uint32_t n_samples) {
+    FilmTile tile = film.get_film_tile(bounds);
+    for (const Point2i &p : bounds) {
+      for (uint32_t s = first_sample; s < first_sample + n_samples; ++s) {
+        std::mt19937 rng(p.x() * 7919 + p.y() * 104729 + s);
+        const float v = p.x() < 16
+                            ? 1.0f
+                            : std::uniform_real_distribution<float>(0, 2)(rng);
+        tile.add_sample(Point2f{p.x() + 0.5f, p.y() + 0.5f},
+                        Vector3f{v, v, v});
+      }
+    }
+    taken += static_cast<uint64_t>(bounds.area()) * n_samples;
+    film.merge_film_tile(tile);
+  });
+
+  ASSERT_GE(reports.size(), 2);
+  uint64_t reported = 0;
+  for (const auto &r : reports) reported += r.samples;
+  EXPECT_EQ(reported, taken);
+  // after the base pass only the noisy half is revisited
+  EXPECT_EQ(reports[0].converged, 16 * 16);
+  EXPECT_EQ(reports[1].regions, adaptive.get_regions().size() / 2);
+  for (size_t i = 0; i < adaptive.get_regions().size(); ++i) {
+    const Bounds2i &region = adaptive.get_regions()[i];
+    EXPECT_EQ(adaptive.get_region_spp(i),
+              region.p_min.x() < 16 ? 8u : 64u);
+  }
+  // the noisy pixels can't reach the threshold within 64 samples
+  EXPECT_EQ(reports.back().converged, 16 * 16);
+  EXPECT_FLOAT_EQ(reports.back().mean_spp, (8 + 64) / 2.0f);
+  EXPECT_EQ(film.get_variance(Point2i{20, 3}).n, 64);
+  EXPECT_TRUE(adaptive.unconverged_regions().empty());
+}
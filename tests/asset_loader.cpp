@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <core/asset_loader.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace dakku;
+
+TEST(AssetLoader, Submit) {
+  auto &loader = AssetLoader::instance();
+  std::vector<AssetHandle<int>> handles;
+  for (int i = 0; i < 64; ++i)
+    handles.push_back(loader.submit([i] { return i * i; }));
+  for (int i = 0; i < 64; ++i) EXPECT_EQ(handles[i].get(), i * i);
+  loader.wait();
+  EXPECT_EQ(loader.pending(), 0);
+  for (const auto &h : handles) EXPECT_TRUE(h.ready());
+}
+
+TEST(AssetLoader, Wait) {
+  // `wait` joins every scheduled load
+  auto &loader = AssetLoader::instance();
+  std::atomic<int> started{0};
+  std::vector<AssetHandle<bool>> handles;
+  for (int i = 0; i < 4; ++i)
+    handles.push_back(loader.submit([&started] {
+      ++started;
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      return true;
+    }));
+  loader.wait();
+  EXPECT_EQ(started, 4);
+  for (const auto &h : handles) EXPECT_TRUE(h.get());
+}
+
+TEST(AssetLoader, ReadFile) {
+  auto path = std::filesystem::temp_directory_path() / "dakku_asset_test.txt";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "hello\nasset";
+  }
+  FileAsset handle = AssetLoader::instance().submit(
+      [p = path.string()] { return read_file(p); });
+  EXPECT_EQ(handle.get(), "hello\nasset");
+  std::filesystem::remove(path);
+}
+
+TEST(AssetLoader, Throw) {
+  // a failed load is rethrown by `get` and still counts as finished
+  auto &loader = AssetLoader::instance();
+  auto handle = loader.submit([]() -> int {
+    throw std::runtime_error("broken asset");
+  });
+  EXPECT_THROW(handle.get(), std::runtime_error);
+  loader.wait();
+  EXPECT_EQ(loader.pending(), 0);
+  EXPECT_TRUE(handle.ready());
+}
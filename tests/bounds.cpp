@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <core/bounds.h>
 
+#include <random>
+
 using namespace dakku;
 
 // some test are adopted from pbrt-v3
@@ -103,3 +105,81 @@ TEST(Bounds, PointDistance) {
     EXPECT_EQ(2 * 2 + 6 * 6 + 4 * 4, distance_squared(Point3f(-3, -9, 22), b));
   }
 }
+
+TEST(Bounds, RayIntersect) {
+  Bounds3f b(Point3f(0, 0, 0), Point3f(1, 2, 3));
+  float t0, t1;
+  EXPECT_TRUE(b.intersect_p(Ray{Point3f(-1, 1, 1), Vector3f(1, 0, 0)}, &t0,
+                            &t1));
+  EXPECT_EQ(t0, 1);
+  EXPECT_GE(t1, 2);
+  EXPECT_FALSE(b.intersect_p(Ray{Point3f(-1, 1, 1), Vector3f(-1, 0, 0)}));
+  EXPECT_FALSE(b.intersect_p(Ray{Point3f(-1, 1, 1), Vector3f(1, 0, 0), 0.5f}));
+  // inside
+  EXPECT_TRUE(b.intersect_p(Ray{Point3f(0.5, 1, 1), Vector3f(0, 0, -1)}, &t0,
+                            &t1));
+  EXPECT_EQ(t0, 0);
+  // axis parallel ray lying in a slab plane ($0 \cdot \infty$)
+  EXPECT_TRUE(b.intersect_p(Ray{Point3f(0, 1, -1), Vector3f(0, 0, 1)}));
+  // empty bounds
+  EXPECT_FALSE(
+      Bounds3f{}.intersect_p(Ray{Point3f(0, 0, 0), Vector3f(1, 1, 1)}));
+  // the traversal overload agrees, including axis parallel and on-plane rays
+  for (const Ray &ray :
+       {Ray{Point3f(0, 1, -1), Vector3f(0, 0, 1)},
+        Ray{Point3f(1, 2, -1), Vector3f(0, 0, 1)},
+        Ray{Point3f(0, 0, 4), Vector3f(0, 0, -1)},
+        Ray{Point3f(-1, 1, 1), Vector3f(1, 0, 0)},
+        Ray{Point3f(-1, 1, 1), Vector3f(-1, 0, 0)},
+        Ray{Point3f(-1, 1, 1), Vector3f(1, 0, 0), 0.5f},
+        Ray{Point3f(0.5, 1, 1), Vector3f(0, 0, -1)},
+        Ray{Point3f(0.5, 3, 1), Vector3f(1, 0, 0)},
+        Ray{Point3f(-1, -1, -1), Vector3f(1, 2, 3)}}) {
+    const Vector3f inv_dir(1 / ray.d.x(), 1 / ray.d.y(), 1 / ray.d.z());
+    const int dir_is_neg[3] = {inv_dir.x() < 0, inv_dir.y() < 0,
+                               inv_dir.z() < 0};
+    EXPECT_EQ(b.intersect_p(ray, inv_dir, dir_is_neg), b.intersect_p(ray));
+    EXPECT_FALSE(Bounds3f{}.intersect_p(ray, inv_dir, dir_is_neg));
+  }
+  const Ray on_plane{Point3f(0, 1, -1), Vector3f(0, 0, 1)};
+  const Vector3f inv_dir(INF, 1, 1);
+  const int dir_is_neg[3] = {0, 0, 0};
+  EXPECT_TRUE(b.intersect_p(on_plane, inv_dir, dir_is_neg));
+}
+
+template <size_t N>
+void check_box_packet() {
+  std::mt19937 rng{N};
+  std::uniform_real_distribution<float> u(-10, 10);
+  for (int k = 0; k < 1000; ++k) {
+    Bounds3fPacket<N> packet;
+    std::array<Bounds3f, N> boxes;
+    // keep the last lane empty
+    for (size_t i = 0; i + 1 < N; ++i) {
+      boxes[i] = Bounds3f{Point3f(u(rng), u(rng), u(rng)),
+                          Point3f(u(rng), u(rng), u(rng))};
+      packet.set(i, boxes[i]);
+    }
+    Vector3f d(u(rng), u(rng), u(rng));
+    if (k % 4 == 0) d[k % 3] = 0;
+    Ray ray{Point3f(u(rng), u(rng), u(rng)), d, k % 2 ? INF : 5.0f};
+    Vector3f inv_dir(1 / d.x(), 1 / d.y(), 1 / d.z());
+    int dir_is_neg[3] = {inv_dir.x() < 0, inv_dir.y() < 0, inv_dir.z() < 0};
+    std::array<float, N> t_near;
+    uint32_t mask = packet.intersect_p(ray, inv_dir, dir_is_neg, &t_near);
+    for (size_t i = 0; i < N; ++i) {
+      float t0;
+      bool hit = boxes[i].intersect_p(ray, &t0);
+      ASSERT_EQ(hit, ((mask >> i) & 1) != 0) << k << " " << i;
+      if (hit) {
+        EXPECT_EQ(t0, t_near[i]);
+      }
+      EXPECT_EQ(boxes[i].intersect_p(ray, inv_dir, dir_is_neg), hit)
+          << k << " " << i;
+    }
+  }
+}
+
+TEST(Bounds, RayIntersectPacket4) { check_box_packet<4>(); }
+
+TEST(Bounds, RayIntersectPacket8) { check_box_packet<8>(); }
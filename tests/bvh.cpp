@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <accelerators/bvh.h>
+#include <accelerators/embree.h>
+
+#include <memory>
+#include <random>
+
+using namespace dakku;
+
+namespace {
+/// test sphere
+class Sphere : public Primitive {
+ public:
+  Sphere(const Point3f &center, float radius)
+      : center(center), radius(radius) {}
+
+  [[nodiscard]] Bounds3f world_bound() const override {
+    Vector3f r(radius, radius, radius);
+    return Bounds3f{center - r, center + r};
+  }
+
+  std::optional<RayHit> intersect(const Ray &ray) const override {
+    auto t = hit(ray);
+    if (!t) return {};
+    ray.tMax = *t;
+    return RayHit{*t};
+  }
+
+  [[nodiscard]] bool occluded(const Ray &ray) const override {
+    return hit(ray).has_value();
+  }
+
+  [[nodiscard]] Normal3f normal(const Point3f &p,
+                                const RayHit &) const override {
+    const Vector3f n = (p - center) / radius;
+    return Normal3f{n.x(), n.y(), n.z()};
+  }
+
+ private:
+  [[nodiscard]] std::optional<float> hit(const Ray &ray) const {
+    Vector3f oc = ray.o - center;
+    float a = ray.d.dot(ray.d);
+    float b = oc.dot(ray.d);
+    float c = oc.dot(oc) - radius * radius;
+    float disc = b * b - a * c;
+    if (disc < 0) return {};
+    float s = std::sqrt(disc);
+    for (float t : {(-b - s) / a, (-b + s) / a})
+      if (t > 0 && t < ray.tMax) return t;
+    return {};
+  }
+
+  Point3f center;
+  float radius;
+};
+
+/// random spheres in $[0, 100]^3$
+std::vector<std::unique_ptr<Sphere>> random_spheres(size_t n,
+                                                    std::mt19937 &rng) {
+  std::uniform_real_distribution<float> pos(0, 100), rad(0.05f, 1.0f);
+  std::vector<std::unique_ptr<Sphere>> ret;
+  for (size_t i = 0; i < n; ++i)
+    ret.push_back(std::make_unique<Sphere>(
+        Point3f(pos(rng), pos(rng), pos(rng)), rad(rng)));
+  return ret;
+}
+
+void check_against_brute_force(size_t n_spheres, int max_prims_in_node) {
+  std::mt19937 rng{static_cast<uint32_t>(n_spheres)};
+  auto spheres = random_spheres(n_spheres, rng);
+  std::vector<const Primitive *> prims;
+  for (auto &s : spheres) prims.push_back(s.get());
+  BVH bvh{prims, max_prims_in_node};
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(bvh.get_nodes().data()) % 64, 0);
+
+  std::uniform_real_distribution<float> pos(-10, 110), dir(-1, 1);
+  for (int k = 0; k < 2000; ++k) {
+    Ray ray{Point3f(pos(rng), pos(rng), pos(rng)),
+            Vector3f(dir(rng), dir(rng), k % 7 == 0 ? 0 : dir(rng))};
+    if (k % 3 == 0) ray.tMax = 20;
+    const float t_max = ray.tMax;
+    std::optional<RayHit> expected;
+    Ray r = ray;
+    for (uint32_t i = 0; i < prims.size(); ++i) {
+      if (auto h = prims[i]->intersect(r)) {
+        expected = h;
+        expected->prim_id = i;
+      }
+    }
+    EXPECT_EQ(bvh.occluded(ray), expected.has_value());
+    auto hit = bvh.intersect(ray);
+    ASSERT_EQ(hit.has_value(), expected.has_value());
+    if (hit) {
+      EXPECT_EQ(hit->prim_id, expected->prim_id);
+      EXPECT_EQ(hit->t, expected->t);
+      EXPECT_EQ(ray.tMax, hit->t);
+    } else {
+      EXPECT_EQ(ray.tMax, t_max);
+    }
+  }
+}
+}  // namespace
+
+TEST(BVH, Small) {
+  check_against_brute_force(1, 4);
+  check_against_brute_force(100, 1);
+  check_against_brute_force(500, 4);
+}
+
+TEST(BVH, ParallelBuild) { check_against_brute_force(20000, 4); }
+
+TEST(BVH, Degenerate) {
+  // coincident centroids can't be separated by sah
+  std::vector<std::unique_ptr<Sphere>> spheres;
+  for (int i = 0; i < 100; ++i)
+    spheres.push_back(std::make_unique<Sphere>(Point3f(1, 2, 3), 1 + i * 0.01f));
+  std::vector<const Primitive *> prims;
+  for (auto &s : spheres) prims.push_back(s.get());
+  BVH bvh{prims};
+  for (const BVHNode &node : bvh.get_nodes())
+    EXPECT_LE(node.n_primitives, 4);
+  auto hit = bvh.intersect(Ray{Point3f(1, 2, -10), Vector3f(0, 0, 1)});
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(hit->prim_id, 99);
+  EXPECT_FALSE(BVH(std::span<const Primitive *const>{})
+                   .intersect(Ray{Point3f(), Vector3f(1, 0, 0)}));
+}
+
+TEST(BVH, DeepTree) {
+  // geometrically spaced spheres: sah peels a few spheres off per level, the
+  // tree still has to fit the traversal stack
+  std::vector<std::unique_ptr<Sphere>> spheres;
+  for (int i = 0; i < 400; ++i) {
+    const float x = 1e-6f * std::pow(1.07f, static_cast<float>(i));
+    spheres.push_back(std::make_unique<Sphere>(Point3f(x, 0, 0), x / 50));
+  }
+  std::vector<const Primitive *> prims;
+  for (auto &s : spheres) prims.push_back(s.get());
+  BVH bvh{prims, 1};
+  const auto nodes = bvh.get_nodes();
+  auto depth = [&](auto &&self, size_t i) -> size_t {
+    if (nodes[i].n_primitives > 0) return 0;
+    return 1 + std::max(self(self, i + 1),
+                        self(self, nodes[i].second_child_offset));
+  };
+  EXPECT_LE(depth(depth, 0), BVH::MAX_DEPTH);
+  // every sphere from above
+  for (uint32_t i = 0; i < spheres.size(); ++i) {
+    const float x = spheres[i]->world_bound().centroid().x();
+    auto hit = bvh.intersect(Ray{Point3f(x, 0, x), Vector3f(0, 0, -1)});
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->prim_id, i);
+  }
+}
+
+TEST(Accelerator, Packet) {
+  std::mt19937 rng{7};
+  auto spheres = random_spheres(1000, rng);
+  std::vector<const Primitive *> prims;
+  for (auto &s : spheres) prims.push_back(s.get());
+  // without embree this falls back to the bvh
+  for (const Accelerator *accel :
+       {create_bvh_accelerator(prims), create_embree_accelerator(prims)}) {
+    std::uniform_real_distribution<float> pos(0, 100), dir(-1, 1);
+    std::array<Ray, 8> rays;
+    for (auto &ray : rays)
+      ray = Ray{Point3f(pos(rng), pos(rng), pos(rng)),
+                Vector3f(dir(rng), dir(rng), dir(rng))};
+    RayPacket8 packet;
+    packet.gather(std::span<const Ray>{rays}.first(7));
+    EXPECT_EQ(packet.active, 0x7f);
+    EXPECT_EQ(accel->occluded(packet) & ~packet.active, 0);
+    std::array<RayHit, 8> hits;
+    uint32_t mask = accel->intersect(packet, hits);
+    for (size_t i = 0; i < 7; ++i) {
+      auto hit = accel->intersect(rays[i]);
+      ASSERT_EQ(hit.has_value(), ((mask >> i) & 1) != 0);
+      if (hit) {
+        EXPECT_EQ(hit->prim_id, hits[i].prim_id);
+        EXPECT_EQ(packet.tMax[i], rays[i].tMax);
+      }
+    }
+  }
+}
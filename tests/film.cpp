@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <core/film.h>
+#include <core/tile.h>
+
+#include <numeric>
+#include <random>
+
+using namespace dakku;
+
+namespace {
+class TentFilter : public Filter {
+ public:
+  explicit TentFilter(float radius) : Filter(Vector2f{radius, radius}) {}
+  [[nodiscard]] float evaluate(const Point2f &p) const override {
+    return std::max(0.0f, radius.x() - std::abs(p.x())) *
+           std::max(0.0f, radius.y() - std::abs(p.y()));
+  }
+};
+
+std::vector<float> resolve(const Film &film) {
+  const Point2i &res = film.get_resolution();
+  std::vector<float> rgb(static_cast<size_t>(res.x()) * res.y() * 3);
+  film.get_pixels(film.get_pixel_bounds(), rgb);
+  return rgb;
+}
+}  // namespace
+
+TEST(Film, SampleBounds) {
+  TentFilter filter{1.5f};
+  Film film{Point2i{8, 4}, filter};
+  Bounds2i b = film.get_sample_bounds();
+  EXPECT_EQ(b.p_min, (Point2i{-1, -1}));
+  EXPECT_EQ(b.p_max, (Point2i{9, 5}));
+  // the tile grows by the filter radius and is clipped to the film
+  FilmTile tile = film.get_film_tile(Bounds2i{{2, 0}, {4, 2}});
+  EXPECT_EQ(tile.get_pixel_bounds().p_min, (Point2i{0, 0}));
+  EXPECT_EQ(tile.get_pixel_bounds().p_max, (Point2i{6, 4}));
+}
+
+TEST(Film, ConstantRadiance) {
+  // a constant signal is reconstructed exactly whatever the tiling
+  TentFilter filter{2.0f};
+  Film film{Point2i{37, 21}, filter};
+  TileScheduler scheduler{film.get_sample_bounds(), 8};
+  scheduler.parallel_for([&](const Bounds2i &bounds) {
+    FilmTile tile = film.get_film_tile(bounds);
+    std::mt19937 rng(bounds.p_min.x() * 131 + bounds.p_min.y());
+    std::uniform_real_distribution<float> u(0, 1);
+    for (const Point2i &p : bounds)
+      for (int s = 0; s < 4; ++s)
+        tile.add_sample(Point2f{p.x() + u(rng), p.y() + u(rng)},
+                        Vector3f{0.25f, 0.5f, 1.0f});
+    film.merge_film_tile(tile);
+  });
+  std::vector<float> rgb = resolve(film);
+  for (size_t i = 0; i < rgb.size(); i += 3) {
+    EXPECT_NEAR(rgb[i], 0.25f, 1e-5f);
+    EXPECT_NEAR(rgb[i + 1], 0.5f, 1e-5f);
+    EXPECT_NEAR(rgb[i + 2], 1.0f, 1e-5f);
+  }
+}
+
+TEST(Film, Splat) {
+  TentFilter filter{1.0f};
+  Film film{Point2i{4, 4}, filter};
+  oneapi::tbb::parallel_for(0, 1000, [&](int) {
+    film.add_splat(Point2f{1.5f, 2.25f}, Vector3f{1, 2, 3});
+    // outside of the film
+    film.add_splat(Point2f{-0.5f, 1.0f}, Vector3f{1, 1, 1});
+    film.add_splat(Point2f{4.0f, 1.0f}, Vector3f{1, 1, 1});
+  });
+  std::vector<float> rgb(3);
+  film.get_pixels(Bounds2i{{1, 2}, {2, 3}}, rgb, 0.5f);
+  EXPECT_EQ(rgb, (std::vector<float>{500, 1000, 1500}));
+  std::vector<float> all = resolve(film);
+  EXPECT_FLOAT_EQ(std::accumulate(all.begin(), all.end(), 0.0f), 6000);
+  film.clear();
+  all = resolve(film);
+  EXPECT_FLOAT_EQ(std::accumulate(all.begin(), all.end(), 0.0f), 0);
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <core/filter.h>
+
+#include <random>
+
+using namespace dakku;
+
+namespace {
+/// a non-separable, non-constant filter for testing
+class ConeFilter : public Filter {
+ public:
+  using Filter::Filter;
+
+  [[nodiscard]] float evaluate(const Point2f &p) const override {
+    return std::max(0.0f, 1.0f - std::sqrt(p.x() * p.x() * inv_radius.x() *
+                                               inv_radius.x() +
+                                           p.y() * p.y() * inv_radius.y() *
+                                               inv_radius.y()));
+  }
+};
+}  // namespace
+
+TEST(Filter, TableApproximatesFilter) {
+  ConeFilter filter{Vector2f(2.0f, 1.5f)};
+  const FilterTable &table = filter.table();
+  EXPECT_EQ(&table, &filter.table());
+  // cell centers are exact
+  for (int y = 0; y < FilterTable::WIDTH; ++y) {
+    for (int x = 0; x < FilterTable::WIDTH; ++x) {
+      Point2f p((x + 0.5f) * 2.0f / FilterTable::WIDTH,
+                (y + 0.5f) * 1.5f / FilterTable::WIDTH);
+      EXPECT_FLOAT_EQ(table.evaluate(p), filter.evaluate(p));
+      // symmetric
+      EXPECT_EQ(table.evaluate(-p), table.evaluate(p));
+    }
+  }
+  EXPECT_EQ(table.evaluate(Point2f(2.5f, 0.0f)), 0.0f);
+  EXPECT_EQ(table.evaluate(Point2f(0.0f, -1.6f)), 0.0f);
+}
+
+TEST(Filter, BatchMatchesTable) {
+  ConeFilter filter{Vector2f(1.5f, 2.5f)};
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<float> dist{-3.0f, 3.0f};
+  std::vector<Point2f> p;
+  for (int i = 0; i < 1003; ++i) p.emplace_back(dist(rng), dist(rng));
+  p[5] = Point2f(1.5f, -2.5f);
+  p[6] = Point2f(-0.0f, 0.0f);
+  std::vector<float> out(p.size());
+  filter.evaluate_batch(p, out);
+  for (size_t i = 0; i < p.size(); ++i)
+    EXPECT_EQ(out[i], filter.table().evaluate(p[i])) << "i = " << i;
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <core/tile.h>
+#include <imageio/image_writer.h>
+#include <zlib.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace dakku;
+
+namespace {
+constexpr int TILE_SIZE = 16;
+const Point2i RESOLUTION{37, 21};
+
+float pixel(int x, int y, int c) { return x * 0.25f + y * 0.5f + c; }
+
+std::string temp_path(const char *name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::string read_all(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), {}};
+}
+
+template <typename T>
+T read(const std::string &s, size_t offset) {
+  T v;
+  std::memcpy(&v, s.data() + offset, sizeof(T));
+  return v;
+}
+
+uint32_t read_be32(const std::string &s, size_t offset) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i)
+    v = (v << 8) | static_cast<uint8_t>(s[offset + i]);
+  return v;
+}
+
+// write the tiles in reverse scheduler order, `skip` is never written
+void write_image(ImageWriter &writer, float (*f)(int, int, int),
+                 int skip = -1) {
+  TileScheduler scheduler{Bounds2i{{0, 0}, RESOLUTION}, TILE_SIZE};
+  for (int i = static_cast<int>(scheduler.size()) - 1; i >= 0; --i) {
+    if (i == skip) continue;
+    const Bounds2i &tile = scheduler[i];
+    std::vector<float> rgb;
+    for (int y = tile.p_min.y(); y < tile.p_max.y(); ++y)
+      for (int x = tile.p_min.x(); x < tile.p_max.x(); ++x)
+        for (int c = 0; c < ImageWriter::CHANNELS; ++c)
+          rgb.push_back(f(x, y, c));
+    writer.write_tile(tile, rgb);
+  }
+  EXPECT_TRUE(writer.close());
+}
+}  // namespace
+
+TEST(ImageWriter, UnknownFormat) {
+  EXPECT_EQ(create_image_writer(temp_path("dakku_test.bmp"), RESOLUTION),
+            nullptr);
+}
+
+TEST(ImageWriter, Pfm) {
+  const std::string path = temp_path("dakku_test.pfm");
+  write_image(*create_image_writer(path, RESOLUTION, TILE_SIZE), pixel);
+  const std::string data = read_all(path);
+  const std::string header = "PF\n37 21\n-1\n";
+  ASSERT_EQ(data.size(), header.size() + 37 * 21 * 3 * sizeof(float));
+  EXPECT_EQ(data.substr(0, header.size()), header);
+  for (int y = 0; y < RESOLUTION.y(); ++y)
+    for (int x = 0; x < RESOLUTION.x(); ++x)
+      for (int c = 0; c < 3; ++c) {
+        const size_t offset =
+            header.size() +
+            (((RESOLUTION.y() - 1 - y) * RESOLUTION.x() + x) * 3 + c) * 4;
+        EXPECT_EQ(read<float>(data, offset), pixel(x, y, c));
+      }
+  std::filesystem::remove(path);
+}
+
+TEST(ImageWriter, Exr) {
+  const std::string path = temp_path("dakku_test.exr");
+  // the skipped tile has to be written black
+  write_image(*create_image_writer(path, RESOLUTION, TILE_SIZE), pixel, 2);
+  const std::string data = read_all(path);
+  ASSERT_GT(data.size(), 8);
+  EXPECT_EQ(read<uint32_t>(data, 0), 20000630);
+  EXPECT_EQ(read<uint32_t>(data, 4), 0x202);
+  // skip the attributes
+  size_t p = 8;
+  while (data[p] != '\0') {
+    p += std::strlen(&data[p]) + 1;
+    p += std::strlen(&data[p]) + 1;
+    p += 4 + read<int32_t>(data, p);
+  }
+  ++p;
+  const Bounds2i skipped =
+      TileScheduler{Bounds2i{{0, 0}, RESOLUTION}, TILE_SIZE}[2];
+  const int nx = 3, ny = 2;
+  std::vector<float> image(37 * 21 * 3, -1);
+  for (int i = 0; i < nx * ny; ++i) {
+    size_t offset = read<uint64_t>(data, p + i * 8);
+    ASSERT_GT(offset, 0);
+    const int tx = read<int32_t>(data, offset);
+    const int ty = read<int32_t>(data, offset + 4);
+    EXPECT_EQ(ty * nx + tx, i);
+    const int size = read<int32_t>(data, offset + 16);
+    const int w = std::min(TILE_SIZE, RESOLUTION.x() - tx * TILE_SIZE);
+    const int h = std::min(TILE_SIZE, RESOLUTION.y() - ty * TILE_SIZE);
+    std::string raw(w * h * 3 * 4, '\0');
+    if (size == static_cast<int>(raw.size())) {
+      raw = data.substr(offset + 20, size);
+    } else {
+      std::string tmp(raw.size(), '\0');
+      uLongf n = tmp.size();
+      ASSERT_EQ(uncompress(reinterpret_cast<Bytef *>(tmp.data()), &n,
+                           reinterpret_cast<const Bytef *>(&data[offset + 20]),
+                           size),
+                Z_OK);
+      ASSERT_EQ(n, tmp.size());
+      for (size_t k = 1; k < tmp.size(); ++k)
+        tmp[k] = static_cast<char>(tmp[k] + tmp[k - 1] - 128);
+      for (size_t k = 0, half = (tmp.size() + 1) / 2; k < raw.size(); ++k)
+        raw[k] = tmp[(k & 1) ? half + k / 2 : k / 2];
+    }
+    for (int y = 0; y < h; ++y)
+      for (int c = 0; c < 3; ++c)
+        for (int x = 0; x < w; ++x) {
+          const int px = tx * TILE_SIZE + x, py = ty * TILE_SIZE + y;
+          // channels are stored as b, g, r
+          image[(py * 37 + px) * 3 + 2 - c] =
+              read<float>(raw, ((y * 3 + c) * w + x) * 4);
+        }
+  }
+  for (int y = 0; y < RESOLUTION.y(); ++y)
+    for (int x = 0; x < RESOLUTION.x(); ++x)
+      for (int c = 0; c < 3; ++c) {
+        const bool black = x >= skipped.p_min.x() && x < skipped.p_max.x() &&
+                           y >= skipped.p_min.y() && y < skipped.p_max.y();
+        EXPECT_EQ(image[(y * 37 + x) * 3 + c], black ? 0 : pixel(x, y, c));
+      }
+  std::filesystem::remove(path);
+}
+
+TEST(ImageWriter, Png) {
+  const std::string path = temp_path("dakku_test.png");
+  write_image(*create_image_writer(path, RESOLUTION, TILE_SIZE),
+              [](int x, int y, int c) {
+                return (x + y + c) % 2 ? 1.0f : 0.0f;
+              });
+  const std::string data = read_all(path);
+  ASSERT_GT(data.size(), 8);
+  EXPECT_EQ(data.substr(1, 3), "PNG");
+  std::string idat;
+  bool end = false;
+  for (size_t p = 8; p < data.size();) {
+    const uint32_t size = read_be32(data, p);
+    const std::string type = data.substr(p + 4, 4);
+    EXPECT_EQ(crc32(0, reinterpret_cast<const Bytef *>(&data[p + 4]),
+                    size + 4),
+              read_be32(data, p + 8 + size));
+    if (type == "IHDR") {
+      EXPECT_EQ(read_be32(data, p + 8), 37);
+      EXPECT_EQ(read_be32(data, p + 12), 21);
+    } else if (type == "IDAT") {
+      idat += data.substr(p + 8, size);
+    } else if (type == "IEND") {
+      end = true;
+    }
+    p += 12 + size;
+  }
+  EXPECT_TRUE(end);
+  const size_t row_bytes = 37 * 3 + 1;
+  std::string rows(row_bytes * 21, '\0');
+  uLongf n = rows.size();
+  ASSERT_EQ(uncompress(reinterpret_cast<Bytef *>(rows.data()), &n,
+                       reinterpret_cast<const Bytef *>(idat.data()),
+                       idat.size()),
+            Z_OK);
+  ASSERT_EQ(n, rows.size());
+  for (int y = 0; y < 21; ++y) {
+    uint8_t *row = reinterpret_cast<uint8_t *>(&rows[y * row_bytes]);
+    ASSERT_EQ(row[0], 1);
+    for (size_t k = 4; k < row_bytes; ++k) row[k] += row[k - 3];
+    for (int x = 0; x < 37; ++x)
+      for (int c = 0; c < 3; ++c)
+        EXPECT_EQ(row[1 + x * 3 + c], (x + y + c) % 2 ? 255 : 0);
+  }
+  std::filesystem::remove(path);
+}
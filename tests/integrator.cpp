@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <accelerators/bvh.h>
+#include <core/mesh.h>
+#include <integrators/simple.h>
+#include <integrators/wavefront.h>
+#include <samplers/sobol.h>
+
+using namespace dakku;
+
+namespace {
+class BoxFilter : public Filter {
+ public:
+  BoxFilter() : Filter(Vector2f{0.5f, 0.5f}) {}
+  [[nodiscard]] float evaluate(const Point2f &) const override { return 1; }
+};
+
+/// a floor, a mirror wall and an emissive panel
+struct TestScene {
+  TestScene() {
+    const float v[] = {-4, 0, -4, 4, 0, -4, 4, 0, 4, -4, 0, 4,  // floor
+                       -4, 0, -2, 4, 0, -2, 4, 4, -2, -4, 4, -2,  // mirror
+                       -1, 3, 0, 1, 3, 0, 1, 3, 1, -1, 3, 1};     // panel
+    Point3fArray positions;
+    for (size_t i = 0; i < std::size(v); i += 3)
+      positions.push_back(Point3f{v[i], v[i + 1], v[i + 2]});
+    std::vector<uint32_t> indices;
+    for (uint32_t q = 0; q < 3; ++q)
+      for (uint32_t i : {0u, 1u, 2u, 0u, 2u, 3u}) indices.push_back(4 * q + i);
+    mesh = TriangleMesh{std::move(positions), std::move(indices)};
+    triangles = create_triangles(mesh);
+    bvh = std::make_unique<BVH>(triangles);
+    scene.accelerator = bvh.get();
+    scene.primitives = triangles;
+    scene.materials = {
+        Material{MaterialType::DIFFUSE, Vector3f{0.7f, 0.6f, 0.5f}},
+        Material{MaterialType::MIRROR, Vector3f{0.9f, 0.9f, 0.9f}},
+        Material{MaterialType::DIFFUSE, Vector3f{0, 0, 0},
+                 Vector3f{4, 4, 4}}};
+    scene.material_ids = {0, 0, 1, 1, 2, 2};
+    Vector3f l{1, 3, 2};
+    scene.light = DirectionalLight{l / l.length(), Vector3f{2, 2, 2}};
+    scene.background = Vector3f{0.1f, 0.2f, 0.3f};
+  }
+
+  TriangleMesh mesh;
+  std::vector<const Primitive *> triangles;
+  std::unique_ptr<BVH> bvh;
+  Scene scene;
+};
+
+std::vector<float> pixels(const Film &film) {
+  const Bounds2i &bounds = film.get_pixel_bounds();
+  std::vector<float> ret(static_cast<size_t>(bounds.area()) * 3);
+  film.get_pixels(bounds, ret);
+  return ret;
+}
+}  // namespace
+
+TEST(Integrator, DirectLighting) {
+  // a diffuse plane facing the camera and the light: every pixel is
+  // $\frac {albedo} \pi E$
+  Point3fArray positions;
+  for (auto [x, y] : {std::pair{-9, -9}, {9, -9}, {9, 9}, {-9, 9}})
+    positions.push_back(
+        Point3f(static_cast<float>(x), static_cast<float>(y), 0));
+  TriangleMesh mesh{std::move(positions), {0, 1, 2, 0, 2, 3}};
+  auto triangles = create_triangles(mesh);
+  BVH bvh{triangles};
+  Scene scene;
+  scene.accelerator = &bvh;
+  scene.primitives = triangles;
+  scene.materials = {
+      Material{MaterialType::DIFFUSE, Vector3f{0.5f, 0.5f, 0.5f}}};
+  scene.light = DirectionalLight{Vector3f{0, 0, 1}, Vector3f{PI, 2 * PI, 0}};
+  const Camera camera{Point3f{0, 0, 5}, Point3f{0, 0, 0}, Vector3f{0, 1, 0},
+                      60, Point2i{16, 16}};
+  BoxFilter filter;
+  SobolSampler sampler{4};
+  for (int integrator = 0; integrator < 2; ++integrator) {
+    Film film{Point2i{16, 16}, filter};
+    if (integrator == 0)
+      SimpleIntegrator{1}.render(scene, camera, sampler, film);
+    else
+      WavefrontIntegrator{1}.render(scene, camera, sampler, film);
+    const std::vector<float> rgb = pixels(film);
+    for (size_t i = 0; i < rgb.size(); i += 3) {
+      EXPECT_NEAR(rgb[i], 0.5f, 1e-4f);
+      EXPECT_NEAR(rgb[i + 1], 1.0f, 1e-4f);
+      EXPECT_NEAR(rgb[i + 2], 0.0f, 1e-4f);
+    }
+  }
+}
+
+TEST(Integrator, WavefrontMatchesSimple) {
+  TestScene test;
+  const Point2i resolution{40, 30};
+  const Camera camera{Point3f{0, 2, 6}, Point3f{0, 1, 0}, Vector3f{0, 1, 0},
+                      70, resolution};
+  BoxFilter filter;
+  SobolSampler sampler{4, 5};
+
+  Film reference{resolution, filter};
+  const RenderStats simple =
+      SimpleIntegrator{4, 8}.render(test.scene, camera, sampler, reference);
+  EXPECT_EQ(simple.camera_rays, resolution.x() * resolution.y() * 4);
+  EXPECT_GT(simple.extension_rays, 0);
+  EXPECT_GT(simple.shadow_rays, 0);
+  const std::vector<float> expected = pixels(reference);
+
+  // a small queue splits the film into many waves
+  for (size_t queue_size :
+       {size_t{1000}, WavefrontIntegrator::DEFAULT_QUEUE_SIZE}) {
+    Film film{resolution, filter};
+    const RenderStats stats = WavefrontIntegrator{4, queue_size, 8}.render(
+        test.scene, camera, sampler, film);
+    EXPECT_EQ(stats.camera_rays, simple.camera_rays);
+    EXPECT_EQ(stats.extension_rays, simple.extension_rays);
+    EXPECT_EQ(stats.shadow_rays, simple.shadow_rays);
+    const std::vector<float> rgb = pixels(film);
+    for (size_t i = 0; i < rgb.size(); ++i)
+      EXPECT_NEAR(rgb[i], expected[i], 1e-4f * std::max(1.0f, expected[i]));
+  }
+
+  // reordering only changes the traversal order
+  Film film{resolution, filter};
+  const RenderStats stats = WavefrontIntegrator{4, 1000, 8, true}.render(
+      test.scene, camera, sampler, film);
+  EXPECT_EQ(stats.rays(), simple.rays());
+  const std::vector<float> rgb = pixels(film);
+  for (size_t i = 0; i < rgb.size(); ++i)
+    EXPECT_NEAR(rgb[i], expected[i], 1e-4f * std::max(1.0f, expected[i]));
+}
+
+TEST(Integrator, Adaptive) {
+  TestScene test;
+  const Point2i resolution{16, 12};
+  const Camera camera{Point3f{0, 2, 6}, Point3f{0, 1, 0}, Vector3f{0, 1, 0},
+                      70, resolution};
+  BoxFilter filter;
+  SobolSampler sampler{4, 5};
+  const uint64_t n_pixels = resolution.x() * resolution.y();
+
+  // without later passes the base pass is the uniform render
+  AdaptiveSettings settings;
+  settings.base_spp = 4;
+  settings.max_spp = 4;
+  Film reference{resolution, filter}, film{resolution, filter};
+  SimpleIntegrator{4, 8}.render(test.scene, camera, sampler, reference);
+  const RenderStats base = SimpleIntegrator{4, 8, settings}.render(
+      test.scene, camera, sampler, film);
+  EXPECT_EQ(base.camera_rays, n_pixels * 4);
+  EXPECT_EQ(pixels(film), pixels(reference));
+
+  // later passes only add samples
+  settings.pass_spp = 4;
+  settings.max_spp = 32;
+  settings.threshold = 0.01f;
+  Film adaptive{resolution, filter};
+  const RenderStats stats = SimpleIntegrator{4, 8, settings}.render(
+      test.scene, camera, sampler, adaptive);
+  EXPECT_GT(stats.camera_rays, n_pixels * 4);
+  EXPECT_LE(stats.camera_rays, n_pixels * 32);
+}
+
+TEST(Integrator, LuaScene) {
+  // the test scene assembled and rendered by a script
+  TestScene test;
+  const Point2i resolution{40, 30};
+  const Camera camera{Point3f{0, 2, 6}, Point3f{0, 1, 0}, Vector3f{0, 1, 0},
+                      70, resolution};
+  BoxFilter filter;
+  Film reference{resolution, filter};
+  SimpleIntegrator{4, 8}.render(test.scene, camera, SobolSampler{4, 5},
+                                reference);
+
+  auto &state = Lua::instance().get_state();
+  state["filter"] = static_cast<const Filter *>(&filter);
+  state.script(R"(
+    positions = Point3fArray.new({
+      {-4, 0, -4}, {4, 0, -4}, {4, 0, 4}, {-4, 0, 4},
+      {-4, 0, -2}, {4, 0, -2}, {4, 4, -2}, {-4, 4, -2},
+      {-1, 3, 0}, {1, 3, 0}, {1, 3, 1}, {-1, 3, 1}})
+    mesh = _create_triangle_mesh(positions, {1, 2, 3, 1, 3, 4, 5, 6, 7, 5, 7,
+                                             8, 9, 10, 11, 9, 11, 12})
+    triangles = _create_triangles(mesh)
+    scene = {
+      accelerator = _create_bvh_accelerator(triangles),
+      primitives = triangles,
+      materials = {
+        {albedo = Vector3f.new({0.7, 0.6, 0.5})},
+        {type = "mirror", albedo = Vector3f.new(0.9)},
+        {albedo = Vector3f.new(0), emission = Vector3f.new(4)}},
+      material_ids = {1, 1, 2, 2, 3, 3},
+      light = {direction = Vector3f.new({1, 3, 2}),
+               radiance = Vector3f.new(2)},
+      background = Vector3f.new({0.1, 0.2, 0.3})}
+    resolution = Point2i.new({40, 30})
+    film = _create_film(resolution, filter)
+    stats = _render(_create_simple_integrator(4, 8), _create_scene(scene),
+                    _create_camera(Point3f.new({0, 2, 6}),
+                                   Point3f.new({0, 1, 0}),
+                                   Vector3f.new({0, 1, 0}), 70, resolution),
+                    _create_sobol_sampler(4, 5), film)
+  )");
+  EXPECT_EQ(pixels(*state["film"].get<Film *>()), pixels(reference));
+  EXPECT_EQ(state["stats"].get<RenderStats>().camera_rays,
+            resolution.x() * resolution.y() * 4);
+
+  auto run = [&](const char *code) {
+    return state.safe_script(code, sol::script_pass_on_error).valid();
+  };
+  EXPECT_FALSE(run("_create_scene({primitives = triangles})"));
+  EXPECT_FALSE(run("_create_scene({accelerator = scene.accelerator, "
+                   "primitives = {triangles[1]}})"));
+  EXPECT_FALSE(run("scene.material_ids = {1, 4}; _create_scene(scene)"));
+  EXPECT_FALSE(run("scene.material_ids = {1}; scene.materials[1].type = "
+                   "'glass'; _create_scene(scene)"));
+  for (const char *name : {"filter", "positions", "mesh", "triangles", "scene",
+                           "resolution", "film", "stats"})
+    state[name] = sol::lua_nil;
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <core/logger.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <condition_variable>
+#include <future>
+
+using namespace dakku;
+
+namespace {
+/// holds the asynchronous worker until opened, keeps the last message
+class GateSink final : public spdlog::sinks::base_sink<std::mutex> {
+ public:
+  void open() {
+    {
+      std::lock_guard lock(gate_mutex);
+      opened = true;
+    }
+    cv.notify_all();
+  }
+
+  std::string last() {
+    std::lock_guard lock(gate_mutex);
+    return last_message;
+  }
+
+ protected:
+  void sink_it_(const spdlog::details::log_msg &msg) override {
+    std::unique_lock lock(gate_mutex);
+    cv.wait(lock, [&] { return opened; });
+    last_message.assign(msg.payload.data(), msg.payload.size());
+  }
+
+  void flush_() override {}
+
+ private:
+  std::mutex gate_mutex;
+  std::condition_variable cv;
+  bool opened{false};
+  std::string last_message;
+};
+}  // namespace
+
+TEST(Logger, RateLimit) {
+  LogSite site{__FILE__, __LINE__};
+  int logged = 0;
+  for (int i = 0; i < 10; ++i) logged += site.every(4);
+  // hits 0, 4, 8
+  EXPECT_EQ(logged, 3);
+  EXPECT_EQ(site.suppressed(), 7);
+
+  LogSite once{__FILE__, __LINE__};
+  logged = 0;
+  for (int i = 0; i < 5; ++i) logged += once.once();
+  EXPECT_EQ(logged, 1);
+  EXPECT_EQ(once.suppressed(), 4);
+}
+
+TEST(Logger, Async) {
+  spdlog::logger *sync = Logger::get().handle();
+  Logger::set_async(true, 16);
+  spdlog::logger *async = Logger::get().handle();
+  EXPECT_NE(sync, async);
+  // the worker is held on the first message, the queue fills up behind it
+  auto gate = std::make_shared<GateSink>();
+  async->sinks().push_back(gate);
+  const size_t dropped = Logger::dropped();
+  auto producer = std::async(std::launch::async, [] {
+    for (int i = 0; i < 100; ++i) DAKKU_INFO("async message {}", i);
+  });
+  // a full queue drops the oldest messages instead of blocking
+  EXPECT_EQ(producer.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+  EXPECT_GT(Logger::dropped(), dropped);
+  gate->open();
+  producer.wait();
+  DAKKU_INFO("last async message");
+  Logger::set_async(false);
+  EXPECT_EQ(Logger::get().handle(), sync);
+  // switching back returns once the worker has written the queued messages
+  EXPECT_EQ(gate->last(), "last async message");
+  async->sinks().pop_back();
+  // switching again reuses the same asynchronous logger
+  Logger::set_async(true);
+  EXPECT_EQ(Logger::get().handle(), async);
+  Logger::set_async(false);
+  Logger::report_suppressed();
+}
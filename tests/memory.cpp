@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <core/memory.h>
+
+#include <set>
+
+using namespace dakku;
+
+TEST(Memory, ThreadLocalArenasReset) {
+  ThreadLocalArenas arenas{4096};
+  auto *a = arenas.local().allocObject<std::array<int, 16>>();
+  a->fill(1);
+  arenas.reset();
+  // the arena rewinds, so the same sequence reuses the same memory
+  auto *b = arenas.local().allocObject<std::array<int, 16>>();
+  EXPECT_EQ(a, b);
+  // overflow the initial block, then rewind again
+  for (int i = 0; i < 1024; ++i) arenas.local().allocObject<double>(i);
+  arenas.reset();
+  auto *c = arenas.local().allocObject<std::array<int, 16>>();
+  EXPECT_EQ(c, a);
+  EXPECT_EQ(arenas.size(), 1);
+}
+
+TEST(Memory, ThreadLocalArenasParallel) {
+  ThreadLocalArenas arenas;
+  constexpr int n = 1 << 14;
+  std::vector<int *> p(n);
+  oneapi::tbb::parallel_for(0, n, [&](int i) {
+    p[i] = arenas.local().allocObject<int>(i);
+  });
+  std::set<int *> unique(p.begin(), p.end());
+  EXPECT_EQ(unique.size(), static_cast<size_t>(n));
+  for (int i = 0; i < n; ++i) EXPECT_EQ(*p[i], i);
+  EXPECT_GE(arenas.size(), 1);
+  arenas.reset_all();
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <accelerators/bvh.h>
+#include <core/mesh.h>
+
+#include <random>
+
+using namespace dakku;
+
+namespace {
+/// unit quad in the z = 0 plane as two triangles
+TriangleMesh unit_quad() {
+  TriangleMesh mesh{4, 2, true, true};
+  const float corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  for (uint32_t i = 0; i < 4; ++i) {
+    mesh.set_position(i, Point3f{corners[i][0], corners[i][1], 0});
+    mesh.set_normal(i, Normal3f{0, 0, 1});
+    mesh.set_uv(i, Point2f{corners[i][0], corners[i][1]});
+  }
+  mesh.set_triangle(0, 0, 1, 2);
+  mesh.set_triangle(1, 0, 2, 3);
+  return mesh;
+}
+}  // namespace
+
+TEST(Mesh, Half) {
+  for (float f : {0.0f, -0.0f, 1.0f, -2.5f, 0.5f, 65504.0f, 6.103515625e-05f,
+                  5.9604645e-08f})
+    EXPECT_EQ(half_to_float(float_to_half(f)), f);
+  EXPECT_EQ(float_to_half(65520.0f), 0x7c00);
+  EXPECT_EQ(float_to_half(1e-9f), 0);
+  // ties round to even
+  EXPECT_EQ(half_to_float(float_to_half(1 + 1.0f / 2048)), 1.0f);
+  EXPECT_TRUE(std::isnan(half_to_float(float_to_half(NAN))));
+  EXPECT_TRUE(std::isinf(half_to_float(float_to_half(INF))));
+  // every finite half round trips
+  for (uint32_t h = 0; h < 0x7c00; ++h)
+    EXPECT_EQ(float_to_half(half_to_float(static_cast<uint16_t>(h))), h);
+}
+
+TEST(Mesh, Octahedral) {
+  std::mt19937 rng{7};
+  std::normal_distribution<float> dist;
+  for (int i = 0; i < 1000; ++i) {
+    Normal3f n{dist(rng), dist(rng), dist(rng)};
+    n = n / n.length();
+    const Normal3f d = decode_octahedral(encode_octahedral(n));
+    EXPECT_GT(n.dot(d), 0.99999f);
+  }
+  for (const Normal3f &n : {Normal3f{0, 0, 1}, Normal3f{0, 0, -1},
+                            Normal3f{1, 0, 0}, Normal3f{0, -1, 0}})
+    EXPECT_GT(n.dot(decode_octahedral(encode_octahedral(n))), 0.99999f);
+}
+
+TEST(Mesh, Attributes) {
+  TriangleMesh mesh = unit_quad();
+  EXPECT_TRUE(mesh.is_valid());
+  EXPECT_EQ(mesh.n_triangles(), 2);
+  // 12 bytes of position, 4 of normal and 4 of uv per vertex
+  EXPECT_EQ(mesh.memory_bytes(), 4 * 20 + 6 * 4);
+  EXPECT_EQ(mesh.uv(2), Point2f(1, 1));
+  const Bounds3f bounds{Point3f(0, 0, 0), Point3f(1, 1, 0)};
+  EXPECT_EQ(mesh.triangle_bound(1), bounds);
+  EXPECT_EQ(mesh.world_bound(), bounds);
+
+  // scale x by 2, swap y and z and translate, the normal becomes +y
+  const std::array<float, 12> m = {2, 0, 0, 1,  //
+                                   0, 0, 1, 0,  //
+                                   0, 1, 0, 3};
+  mesh.transform(m);
+  EXPECT_EQ(mesh.position(2), Point3f(3, 0, 4));
+  EXPECT_GT(mesh.normal(0).dot(Normal3f{0, 1, 0}), 0.99999f);
+}
+
+TEST(Mesh, Intersect) {
+  TriangleMesh mesh = unit_quad();
+  Ray ray{Point3f{0.25f, 0.5f, 1}, Vector3f{0, 0, -1}};
+  EXPECT_FALSE(mesh.intersect(0, ray));
+  auto hit = mesh.intersect(1, ray);
+  ASSERT_TRUE(hit);
+  EXPECT_FLOAT_EQ(hit->t, 1);
+  EXPECT_FLOAT_EQ(ray.tMax, 1);
+  EXPECT_FALSE(mesh.occluded(1, Ray{Point3f{0.25f, 0.5f, 1},
+                                    Vector3f{0, 0, -1}, 0.5f}));
+
+  // accelerators are built over the triangle primitives
+  auto triangles = create_triangles(mesh);
+  BVH bvh{triangles};
+  EXPECT_EQ(bvh.world_bound(), mesh.world_bound());
+  Ray r{Point3f{0.75f, 0.5f, -2}, Vector3f{0, 0, 1}};
+  hit = bvh.intersect(r);
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->prim_id, 0);
+  EXPECT_FLOAT_EQ(hit->t, 2);
+  EXPECT_EQ(triangles[0]->normal(r(hit->t), *hit), Normal3f(0, 0, 1));
+  // one contiguous block per mesh
+  EXPECT_EQ(static_cast<const Triangle *>(triangles[1]),
+            static_cast<const Triangle *>(triangles[0]) + 1);
+
+  // degenerate triangles still get a unit normal
+  TriangleMesh line{3, 1};
+  line.set_triangle(0, 0, 1, 2);
+  line.set_position(1, Point3f{1, 0, 0});
+  line.set_position(2, Point3f{2, 0, 0});
+  EXPECT_EQ(line.surface_normal(0, Point2f{0.5f, 0.25f}).length(), 1);
+}
+
+TEST(Mesh, LuaRejectsBadInput) {
+  auto &state = Lua::instance().get_state();
+  state.script(R"(
+    quad = Point3fArray.new({{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}})
+  )");
+  auto run = [&](const char *code) {
+    return state.safe_script(code, sol::script_pass_on_error).valid();
+  };
+  EXPECT_TRUE(run("mesh = _create_triangle_mesh(quad, {1, 2, 3, 1, 3, 4})"));
+  EXPECT_TRUE(run("mesh:transform({1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0})"));
+  EXPECT_FALSE(run("_create_triangle_mesh(quad, {1, 2, 5})"));
+  EXPECT_FALSE(run("_create_triangle_mesh(quad, {0, 1, 2})"));
+  EXPECT_FALSE(run("_create_triangle_mesh(quad, {1, 2, 3, 4})"));
+  EXPECT_FALSE(run("mesh:transform({1, 0, 0})"));
+  state["quad"] = sol::lua_nil;
+  state["mesh"] = sol::lua_nil;
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <core/mesh_loader.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace dakku;
+
+namespace {
+/// binary ply of a unit quad, as two triangles or as one polygon
+std::string binary_quad(bool big_endian, bool polygon) {
+  std::string s = "ply\nformat binary_";
+  s += big_endian ? "big" : "little";
+  s += "_endian 1.0\ncomment quad\nelement vertex 4\n"
+       "property float x\nproperty float y\nproperty float z\n";
+  s += "element face " + std::to_string(polygon ? 1 : 2) +
+       "\nproperty list uchar int vertex_indices\nend_header\n";
+  const bool swap = big_endian != (std::endian::native == std::endian::big);
+  auto put = [&](auto v) {
+    char bytes[sizeof(v)];
+    std::memcpy(bytes, &v, sizeof(v));
+    if (swap) std::reverse(bytes, bytes + sizeof(v));
+    s.append(bytes, sizeof(v));
+  };
+  const float corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  for (const auto &c : corners) {
+    put(c[0]);
+    put(c[1]);
+    put(0.0f);
+  }
+  if (polygon) {
+    put(uint8_t{4});
+    for (int32_t i : {0, 1, 2, 3}) put(i);
+  } else {
+    for (int32_t t : {0, 1}) {
+      put(uint8_t{3});
+      for (int32_t i : {0, t + 1, t + 2}) put(i);
+    }
+  }
+  return s;
+}
+
+void expect_quad(const TriangleMesh &mesh) {
+  ASSERT_EQ(mesh.n_vertices(), 4);
+  ASSERT_EQ(mesh.n_triangles(), 2);
+  EXPECT_EQ(mesh.position(2), Point3f(1, 1, 0));
+  EXPECT_EQ(mesh.triangle(0), (std::array<uint32_t, 3>{0, 1, 2}));
+  EXPECT_EQ(mesh.triangle(1), (std::array<uint32_t, 3>{0, 2, 3}));
+}
+}  // namespace
+
+TEST(MeshLoader, BinaryPly) {
+  for (bool big_endian : {false, true}) {
+    for (bool polygon : {false, true}) {
+      TriangleMesh mesh;
+      EXPECT_TRUE(parse_ply(binary_quad(big_endian, polygon), mesh));
+      expect_quad(mesh);
+    }
+  }
+  // truncated data
+  TriangleMesh mesh;
+  const std::string ply = binary_quad(false, false);
+  EXPECT_FALSE(parse_ply(ply.substr(0, ply.size() - 4), mesh));
+  // negative and out of range indices, in both face paths
+  for (bool polygon : {false, true}) {
+    for (int32_t index : {-1, 4}) {
+      std::string bad = binary_quad(false, polygon);
+      std::memcpy(bad.data() + bad.size() - 4, &index, sizeof(index));
+      EXPECT_FALSE(parse_ply(bad, mesh));
+    }
+  }
+  // list properties in the vertex element
+  EXPECT_FALSE(parse_ply("ply\nformat binary_little_endian 1.0\n"
+                         "element vertex 1\nproperty float x\n"
+                         "property float y\nproperty float z\n"
+                         "property list uchar float weights\nend_header\n",
+                         mesh));
+}
+
+TEST(MeshLoader, AsciiPly) {
+  const std::string ply =
+      "ply\r\nformat ascii 1.0\r\n"
+      "element vertex 4\r\n"
+      "property float x\r\nproperty float y\r\nproperty float z\r\n"
+      "property float nx\r\nproperty float ny\r\nproperty float nz\r\n"
+      "property float u\r\nproperty float v\r\n"
+      "element face 2\r\n"
+      "property uchar flags\r\n"
+      "property list uchar uint vertex_index\r\n"
+      "end_header\r\n"
+      "0 0 0 0 0 1 0 0\r\n1 0 0 0 0 1 1 0\r\n"
+      "1 1 0 0 0 1 1 1\r\n0 1 0 0 0 1 0 1\r\n"
+      "\r\n"
+      "7 3 0 1 2\r\n7 3 0 2 3\r\n";
+  // every chunk size splits the body differently
+  for (size_t chunk_size : {1, 7, 16, 1 << 20}) {
+    TriangleMesh mesh;
+    EXPECT_TRUE(parse_ply(ply, mesh, chunk_size));
+    expect_quad(mesh);
+    EXPECT_TRUE(mesh.has_normals());
+    EXPECT_GT(mesh.normal(3).dot(Normal3f{0, 0, 1}), 0.99999f);
+    EXPECT_EQ(mesh.uv(1), Point2f(1, 0));
+  }
+  TriangleMesh mesh;
+  EXPECT_FALSE(parse_ply("ply\nformat ascii 1.0\nelement vertex 1\n"
+                         "property float x\nend_header\n0\n",
+                         mesh));
+  EXPECT_FALSE(parse_ply("plyx\nend_header\n", mesh));
+}
+
+TEST(MeshLoader, Obj) {
+  const std::string obj =
+      "# quad\n"
+      "v 0 0 0\nv 1 0 0\nvt 0 0\nvn 0 0 1\n"
+      "v 1 1 0\nv 0 1 0\n"
+      "f 1/1/1 2//1 3\n"
+      "f -4 -2 -1\n"
+      "f 1 2 3 4\n";
+  for (size_t chunk_size : {1, 10, 1 << 20}) {
+    TriangleMesh mesh;
+    EXPECT_TRUE(parse_obj(obj, mesh, chunk_size));
+    ASSERT_EQ(mesh.n_triangles(), 4);
+    EXPECT_EQ(mesh.position(3), Point3f(0, 1, 0));
+    EXPECT_EQ(mesh.triangle(1), (std::array<uint32_t, 3>{0, 2, 3}));
+    EXPECT_EQ(mesh.triangle(3), (std::array<uint32_t, 3>{0, 2, 3}));
+  }
+  TriangleMesh mesh;
+  EXPECT_FALSE(parse_obj("v 0 0 0\nf 1 2 3\n", mesh));
+}
+
+TEST(MeshLoader, LoadMesh) {
+  const auto path =
+      std::filesystem::temp_directory_path() / "dakku_mesh_loader_test.ply";
+  std::ofstream(path, std::ios::binary) << binary_quad(false, false);
+  {
+    MappedFile file{path.string()};
+    ASSERT_TRUE(file.is_good());
+    EXPECT_EQ(file.view(), binary_quad(false, false));
+  }
+  auto mesh = load_mesh(path.string());
+  ASSERT_TRUE(mesh);
+  expect_quad(*mesh);
+  MeshAsset handle = AssetLoader::instance().submit(
+      [p = path.string()] { return load_mesh(p); });
+  ASSERT_TRUE(handle.get());
+  EXPECT_EQ(handle.get()->n_triangles(), 2);
+  std::filesystem::remove(path);
+  EXPECT_FALSE(load_mesh(path.string()));
+}
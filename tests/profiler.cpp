@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <core/profiler.h>
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+using namespace dakku;
+
+namespace {
+constexpr uint32_t bit(Prof p) { return 1u << static_cast<uint32_t>(p); }
+}  // namespace
+
+TEST(Profiler, Phase) {
+  EXPECT_EQ(profiler_state, 0);
+  {
+    ProfilePhase outer(Prof::INTEGRATOR);
+    EXPECT_EQ(profiler_state, bit(Prof::INTEGRATOR));
+    {
+      ProfilePhase inner(Prof::SHADING);
+      // nested phases of the same kind keep the bit set
+      ProfilePhase again(Prof::INTEGRATOR);
+      EXPECT_EQ(profiler_state, bit(Prof::INTEGRATOR) | bit(Prof::SHADING));
+    }
+    EXPECT_EQ(profiler_state, bit(Prof::INTEGRATOR));
+  }
+  EXPECT_EQ(profiler_state, 0);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(Profiler, Sampling) {
+  auto &profiler = Profiler::instance();
+  profiler.clear();
+  profiler.start(1000);
+  const uint32_t state = bit(Prof::INTEGRATOR) | bit(Prof::SHADING);
+  {
+    ProfilePhase integrator(Prof::INTEGRATOR);
+    ProfilePhase shading(Prof::SHADING);
+    // burn cpu time until some samples have been taken
+    volatile double sink = 0;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (profiler.samples(state) < 5 &&
+           std::chrono::steady_clock::now() < deadline)
+      for (int i = 0; i < 10000; ++i) sink = sink + std::sqrt(i);
+  }
+  profiler.stop();
+  EXPECT_GE(profiler.samples(state), 5);
+  profiler.report();
+
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "dakku_profile.folded")
+          .string();
+  ASSERT_TRUE(profiler.write_collapsed(path));
+  std::ifstream in(path);
+  std::string folded{std::istreambuf_iterator<char>(in), {}};
+  EXPECT_NE(folded.find("dakku;Integrator;Shading "), std::string::npos);
+  std::filesystem::remove(path);
+  profiler.clear();
+  EXPECT_EQ(profiler.samples(state), 0);
+}
+#endif
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <core/ray_packet.h>
+
+#include <random>
+
+using namespace dakku;
+
+namespace {
+
+template <size_t N>
+std::vector<RayDifferential> random_rays(size_t n) {
+  std::mt19937 rng{static_cast<unsigned>(N)};
+  std::uniform_real_distribution<float> dist{-10.0f, 10.0f};
+  auto v = [&] { return Vector3f(dist(rng), dist(rng), dist(rng)); };
+  auto p = [&] { return Point3f(dist(rng), dist(rng), dist(rng)); };
+  std::vector<RayDifferential> rays;
+  for (size_t i = 0; i < n; ++i) {
+    RayDifferential r{p(), v(), std::abs(dist(rng))};
+    r.has_differentials = i % 2 == 0;
+    r.rx_origin = p();
+    r.ry_origin = p();
+    r.rx_direction = v();
+    r.ry_direction = v();
+    rays.push_back(r);
+  }
+  return rays;
+}
+
+template <size_t N>
+void check_packet() {
+  auto rays = random_rays<N>(N - 1);
+  RayDifferentialPacket<N> packet;
+  packet.gather(rays);
+  EXPECT_EQ(packet.active, (1u << (N - 1)) - 1);
+  EXPECT_FALSE(packet.has_nans());
+
+  // evaluation matches the single ray code exactly
+  Float3Packet<N> p = packet(0.75f);
+  for (size_t i = 0; i < N - 1; ++i)
+    EXPECT_EQ(p.template get<Point3f>(i), rays[i](0.75f)) << "lane " << i;
+
+  packet.scale_differentials(0.3f);
+  for (auto &r : rays) r.scale_differentials(0.3f);
+  std::vector<RayDifferential> out(N - 1);
+  packet.scatter(out);
+  for (size_t i = 0; i < N - 1; ++i) {
+    EXPECT_EQ(out[i].o, rays[i].o);
+    EXPECT_EQ(out[i].d, rays[i].d);
+    EXPECT_EQ(out[i].tMax, rays[i].tMax);
+    EXPECT_EQ(out[i].has_differentials, rays[i].has_differentials);
+    EXPECT_EQ(out[i].rx_origin, rays[i].rx_origin);
+    EXPECT_EQ(out[i].ry_origin, rays[i].ry_origin);
+    EXPECT_EQ(out[i].rx_direction, rays[i].rx_direction);
+    EXPECT_EQ(out[i].ry_direction, rays[i].ry_direction);
+  }
+
+  // nans in inactive lanes are ignored
+  packet.tMax[N - 1] = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_FALSE(packet.has_nans());
+  packet.tMax[1] = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_EQ(packet.nan_lanes(), 1u << 1);
+}
+}  // namespace
+
+TEST(RayPacket, Differential4) { check_packet<4>(); }
+
+TEST(RayPacket, Differential8) { check_packet<8>(); }
+
+TEST(RayPacket, Differential16) { check_packet<16>(); }
+
+TEST(RayPacket, GatherScatterIndices) {
+  std::vector<Ray> rays;
+  for (int i = 0; i < 10; ++i)
+    rays.emplace_back(Point3f(i, 0, 0), Vector3f(0, 1, 0), 100.0f);
+  std::vector<uint32_t> indices{9, 2, 5, 7};
+  RayPacket8 packet;
+  packet.gather(rays, indices);
+  EXPECT_EQ(packet.active, 0xfu);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    EXPECT_EQ(packet.o.x[i], static_cast<float>(indices[i]));
+    packet.tMax[i] = static_cast<float>(i);
+  }
+  packet.active &= ~(1u << 2);
+  packet.scatter(rays, indices);
+  EXPECT_EQ(rays[9].tMax, 0.0f);
+  EXPECT_EQ(rays[2].tMax, 1.0f);
+  EXPECT_EQ(rays[5].tMax, 100.0f);
+  EXPECT_EQ(rays[7].tMax, 3.0f);
+  EXPECT_EQ(rays[0].tMax, 100.0f);
+}
+
+TEST(RayPacket, GatherScatterDifferentialIndices) {
+  auto rays = random_rays<8>(10);
+  std::vector<uint32_t> indices{9, 2, 5, 7};
+  RayDifferentialPacket<8> packet;
+  packet.gather(rays, indices);
+  EXPECT_EQ(packet.active, 0xfu);
+  EXPECT_EQ(packet.has_differentials, 0x2u);
+
+  std::vector<RayDifferential> out(rays.size());
+  packet.scatter(out, indices);
+  for (uint32_t i : indices) {
+    EXPECT_EQ(out[i].o, rays[i].o);
+    EXPECT_EQ(out[i].has_differentials, rays[i].has_differentials);
+    EXPECT_EQ(out[i].rx_origin, rays[i].rx_origin);
+    EXPECT_EQ(out[i].ry_direction, rays[i].ry_direction);
+  }
+}
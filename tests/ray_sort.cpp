@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <core/math_func.h>
+#include <core/ray_sort.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace dakku;
+
+TEST(RaySort, Morton) {
+  EXPECT_EQ(encode_morton_3(1, 0, 0), 1);
+  EXPECT_EQ(encode_morton_3(0, 1, 0), 2);
+  EXPECT_EQ(encode_morton_3(0, 0, 1), 4);
+  EXPECT_EQ(encode_morton_3(3, 0, 0), 9);
+  EXPECT_EQ(encode_morton_3(1023, 1023, 1023), (1u << 30) - 1);
+}
+
+TEST(RaySort, Key) {
+  const Bounds3f bounds{Point3f{-1, -1, -1}, Point3f{1, 1, 1}};
+  constexpr int SHIFT = 3 * RAY_SORT_MORTON_BITS;
+  // the octant is in the top bits
+  EXPECT_EQ(ray_sort_key(Point3f{0, 0, 0}, Vector3f{1, 1, 1}, bounds) >> SHIFT,
+            0);
+  EXPECT_EQ(
+      ray_sort_key(Point3f{0, 0, 0}, Vector3f{-1, 1, -1}, bounds) >> SHIFT, 5);
+  // the origin is clamped to the bounds
+  EXPECT_EQ(ray_sort_key(Point3f{-5, -5, -5}, Vector3f{1, 1, 1}, bounds), 0);
+  EXPECT_EQ(ray_sort_key(Point3f{5, 5, 5}, Vector3f{1, 1, 1}, bounds),
+            (1u << SHIFT) - 1);
+  EXPECT_LT(ray_sort_key(Point3f{5, 5, 5}, Vector3f{1, 1, 1}, bounds),
+            1u << RAY_SORT_KEY_BITS);
+}
+
+TEST(RaySort, RadixSort) {
+  std::mt19937 rng{7};
+  // one scratch for all sorts, as a render keeps it
+  RadixSortScratch scratch;
+  for (size_t n : {size_t{0}, size_t{1}, size_t{1000}, size_t{100000}}) {
+    for (int key_bits : {8, RAY_SORT_KEY_BITS, 32}) {
+      std::vector<uint32_t> keys(n), values(n);
+      for (uint32_t &k : keys)
+        k = key_bits == 32 ? rng() : rng() & ((1u << key_bits) - 1);
+      std::iota(values.begin(), values.end(), 0);
+      // stable: equal keys keep their order
+      std::vector<std::pair<uint32_t, uint32_t>> expected(n);
+      for (size_t i = 0; i < n; ++i) expected[i] = {keys[i], values[i]};
+      std::stable_sort(
+          expected.begin(), expected.end(),
+          [](const auto &a, const auto &b) { return a.first < b.first; });
+      const uint32_t *buffer = scratch.keys.data();
+      radix_sort(keys, values, scratch, key_bits);
+      // the first sort of each size grows the scratch, the others reuse it
+      if (key_bits != 8) {
+        EXPECT_EQ(scratch.keys.data(), buffer);
+      }
+      for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(keys[i], expected[i].first);
+        EXPECT_EQ(values[i], expected[i].second);
+      }
+    }
+  }
+}
+
+TEST(RaySort, SortRays) {
+  std::mt19937 rng{11};
+  std::uniform_real_distribution<float> u(-10, 10);
+  std::vector<Ray> rays(5000);
+  for (Ray &ray : rays)
+    ray = Ray{Point3f{u(rng), u(rng), u(rng)},
+              Vector3f{u(rng), u(rng), u(rng)}};
+  const Bounds3f bounds{Point3f{-10, -10, -10}, Point3f{10, 10, 10}};
+  std::vector<uint32_t> order(rays.size());
+  sort_rays(rays, bounds, order);
+  // a permutation with nondecreasing keys
+  std::vector<uint32_t> sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); ++i) EXPECT_EQ(sorted[i], i);
+  for (size_t k = 1; k < order.size(); ++k)
+    EXPECT_LE(ray_sort_key(rays[order[k - 1]].o, rays[order[k - 1]].d, bounds),
+              ray_sort_key(rays[order[k]].o, rays[order[k]].d, bounds));
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <samplers/halton.h>
+#include <samplers/sobol.h>
+
+#include <set>
+
+using namespace dakku;
+
+namespace {
+/// check that `values` hit every interval of width $\frac 1 n$ once
+void expect_stratified(const std::vector<float> &values) {
+  const auto n = static_cast<float>(values.size());
+  std::set<int> strata;
+  for (float v : values) {
+    EXPECT_GE(v, 0);
+    EXPECT_LT(v, 1);
+    strata.insert(static_cast<int>(v * n));
+  }
+  EXPECT_EQ(strata.size(), values.size());
+}
+}  // namespace
+
+TEST(Sampler, SobolSequence) {
+  // every dimension is a (0, 1)-sequence: the first 2^m points stratify
+  for (uint32_t dim = 0; dim < SOBOL_DIMENSIONS; ++dim) {
+    std::set<uint32_t> strata;
+    for (uint32_t i = 0; i < 256; ++i)
+      strata.insert(sobol_sample(i, dim) >> 24);
+    EXPECT_EQ(strata.size(), 256) << "dimension " << dim;
+  }
+  // dimensions 0 and 1 are a (0, 2)-sequence: one point per elementary
+  // interval of area 2^-8
+  for (uint32_t a = 0; a <= 8; ++a) {
+    std::set<std::pair<uint32_t, uint32_t>> cells;
+    for (uint32_t i = 0; i < 256; ++i)
+      cells.emplace(sobol_sample(i, 0) >> (32 - a),
+                    sobol_sample(i, 1) >> (24 + a));
+    EXPECT_EQ(cells.size(), 256);
+  }
+}
+
+TEST(Sampler, Sobol) {
+  SobolSampler sampler{64, 7};
+  const Point2i pixel{3, 5};
+  // owen scrambling and the index shuffle keep the stratification
+  for (uint32_t dim : {0u, 1u, 7u, 16u, 33u}) {
+    std::vector<float> values;
+    for (uint32_t i = 0; i < 64; ++i)
+      values.push_back(sampler.sample(pixel, i, dim));
+    expect_stratified(values);
+  }
+  // stateless and decorrelated between pixels
+  EXPECT_EQ(sampler.sample(pixel, 3, 2), sampler.sample(pixel, 3, 2));
+  EXPECT_NE(sampler.sample(pixel, 3, 2),
+            sampler.sample(Point2i{4, 5}, 3, 2));
+  EXPECT_NE(sampler.sample(pixel, 3, 2),
+            SobolSampler(64, 8).sample(pixel, 3, 2));
+}
+
+TEST(Sampler, SobolBatch) {
+  SobolSampler sampler{16};
+  const Point2i pixel{-2, 9};
+  for (uint32_t first_dim : {0u, 5u, 12u, 16u}) {
+    std::array<float, 19> out;
+    sampler.sample_batch(pixel, 11, first_dim, out);
+    for (uint32_t k = 0; k < out.size(); ++k)
+      EXPECT_EQ(out[k], sampler.sample(pixel, 11, first_dim + k));
+  }
+}
+
+TEST(Sampler, Halton) {
+  const Bounds2i bounds{Point2i{0, 0}, Point2i{100, 50}};
+  HaltonSampler sampler{16, bounds, 3};
+  // the samples of a pixel are the halton points that fall into it: the
+  // low digits of the index reversed are the pixel (modulo 128 and 81)
+  for (const Point2i &pixel : {Point2i{0, 0}, Point2i{37, 11}, Point2i{99, 49}})
+    for (uint32_t i = 0; i < 4; ++i) {
+      uint64_t index = sampler.global_index(pixel, i);
+      int x = 0, y = 0;
+      for (int k = 0; k < 7; ++k, index /= 2) x = 2 * x + index % 2;
+      index = sampler.global_index(pixel, i);
+      for (int k = 0; k < 4; ++k, index /= 3) y = 3 * y + index % 3;
+      EXPECT_EQ(x, pixel.x());
+      EXPECT_EQ(y, pixel.y());
+    }
+
+  // with a single pixel the samples are the sequence itself, the scrambled
+  // radical inverse stratifies the first b^m points
+  HaltonSampler single{125, Bounds2i{Point2i{0, 0}, Point2i{1, 1}}, 3};
+  for (uint32_t dim : {0u, 2u}) {
+    std::vector<float> values;
+    const uint32_t n = dim == 0 ? 128 : 125;
+    for (uint32_t i = 0; i < n; ++i)
+      values.push_back(single.sample(Point2i{0, 0}, i, dim));
+    expect_stratified(values);
+  }
+}
+
+TEST(Sampler, HaltonBatch) {
+  HaltonSampler sampler{16, Bounds2i{Point2i{0, 0}, Point2i{64, 64}}};
+  const Point2i pixel{5, 60};
+  for (uint32_t first_dim : {0u, 1u, 2u, 120u}) {
+    std::array<float, 16> out;
+    sampler.sample_batch(pixel, 9, first_dim, out);
+    for (uint32_t k = 0; k < out.size(); ++k)
+      EXPECT_FLOAT_EQ(out[k], sampler.sample(pixel, 9, first_dim + k));
+  }
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <core/bounds.h>
+#include <core/scene_cache.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace dakku;
+
+namespace {
+/// temporary files of a test
+class SceneCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = std::filesystem::temp_directory_path() /
+          ("dakku_scene_cache_" + std::to_string(::testing::UnitTest::GetInstance()
+                                                     ->random_seed()));
+    std::filesystem::create_directories(dir);
+    script = (dir / "scene.lua").string();
+    input = (dir / "mesh.bin").string();
+    cache = (dir / "scene.lua.cache").string();
+    write_file(script, "scene = {}");
+    write_file(input, "0123");
+  }
+
+  void TearDown() override { std::filesystem::remove_all(dir); }
+
+  static void write_file(const std::string &path, const std::string &content) {
+    std::ofstream(path, std::ios::binary) << content;
+  }
+
+  /// apply `f` to byte `pos` of a file
+  template <typename F>
+  static void patch_file(const std::string &path, size_t pos, F &&f) {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekg(static_cast<std::streamoff>(pos));
+    char c;
+    file.read(&c, 1);
+    auto b = static_cast<std::byte>(c);
+    f(b);
+    c = static_cast<char>(b);
+    file.seekp(static_cast<std::streamoff>(pos));
+    file.write(&c, 1);
+  }
+
+  std::filesystem::path dir;
+  std::string script, input, cache;
+};
+}  // namespace
+
+TEST_F(SceneCacheTest, Sections) {
+  std::vector<float> vertices{1, 2, 3, 4, 5, 6};
+  std::vector<uint32_t> indices{0, 1, 2};
+  SceneCacheWriter writer;
+  writer.add_input(input);
+  writer.add<float>("vertices", vertices);
+  writer.add<uint32_t>("indices", indices);
+  ASSERT_TRUE(writer.write(cache, script));
+
+  auto loaded = SceneCache::open(cache, script);
+  ASSERT_TRUE(loaded);
+  auto v = loaded->get<float>("vertices");
+  EXPECT_EQ(std::vector<float>(v.begin(), v.end()), vertices);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(v.data()) % 64, 0);
+  auto i = loaded->get<uint32_t>("indices");
+  EXPECT_EQ(std::vector<uint32_t>(i.begin(), i.end()), indices);
+  EXPECT_FALSE(loaded->contains("normals"));
+  EXPECT_TRUE(loaded->get<float>("normals").empty());
+}
+
+TEST_F(SceneCacheTest, Invalidation) {
+  SceneCacheWriter writer;
+  writer.add_input(input);
+  ASSERT_TRUE(writer.write(cache, script));
+  EXPECT_TRUE(SceneCache::open(cache, script));
+  EXPECT_FALSE(SceneCache::open(cache + ".missing", script));
+
+  // input changed
+  write_file(input, "01234");
+  EXPECT_FALSE(SceneCache::open(cache, script));
+  ASSERT_TRUE(writer.write(cache, script));
+  EXPECT_TRUE(SceneCache::open(cache, script));
+
+  // script changed
+  write_file(script, "scene = { spp = 16 }");
+  EXPECT_FALSE(SceneCache::open(cache, script));
+
+  // corrupted
+  write_file(cache, "DAKKUSC");
+  EXPECT_FALSE(SceneCache::open(cache, script));
+
+  // truncated
+  const std::vector<float> vertices(100, 1.0f);
+  writer.add<float>("vertices", vertices);
+  ASSERT_TRUE(writer.write(cache, script));
+  ASSERT_TRUE(SceneCache::open(cache, script));
+  std::filesystem::resize_file(cache, std::filesystem::file_size(cache) - 4);
+  EXPECT_FALSE(SceneCache::open(cache, script));
+
+  // misaligned section, the offset of the second section table entry
+  ASSERT_TRUE(writer.write(cache, script));
+  patch_file(cache, 64 + 64 + 48, [](std::byte &b) { b |= std::byte{1}; });
+  EXPECT_FALSE(SceneCache::open(cache, script));
+}
+
+TEST_F(SceneCacheTest, Lua) {
+  auto &state = Lua::instance().get_state();
+  state.script(R"(
+    scene = {
+      name = "box", spp = 16, scale = 0.5, visible = true,
+      eye = Point3f.new({0, 1, 2}), up = Vector3f.new({0, 1, 0}),
+      crop = Bounds2i.new({{0, 0}, {4, 8}}),
+      lights = {{1, 2}, {3}},
+    }
+  )");
+  SceneCacheWriter writer;
+  ASSERT_TRUE(writer.add_lua("scene", state["scene"].get<sol::object>()));
+  ASSERT_TRUE(writer.write(cache, script));
+  state["scene"] = sol::lua_nil;
+
+  auto loaded = SceneCache::open(cache, script);
+  ASSERT_TRUE(loaded);
+  state["scene"] = loaded->get_lua("scene", state);
+  sol::table scene = state["scene"];
+  EXPECT_EQ(scene.get<std::string>("name"), "box");
+  EXPECT_TRUE(state.script("return math.type(scene.spp) == 'integer'")
+                  .get<bool>());
+  EXPECT_EQ(scene.get<float>("scale"), 0.5f);
+  EXPECT_TRUE(scene.get<bool>("visible"));
+  EXPECT_EQ(scene.get<Point3f>("eye"), Point3f(0, 1, 2));
+  EXPECT_EQ(scene.get<Vector3f>("up"), Vector3f(0, 1, 0));
+  EXPECT_EQ(scene.get<Bounds2i>("crop"),
+            Bounds2i(Point2i(0, 0), Point2i(4, 8)));
+  EXPECT_EQ(state.script("return #scene.lights[1] + scene.lights[2][1]")
+                .get<int>(),
+            5);
+
+  // an unknown tag at the start of the lua section, right after the table
+  // and the empty inputs section
+  loaded.reset();
+  patch_file(cache, 64 + 2 * 64, [](std::byte &b) { b = std::byte{0xff}; });
+  EXPECT_FALSE(SceneCache::open(cache, script));
+}
+
+TEST_F(SceneCacheTest, SideEffects) {
+  auto &state = Lua::instance().get_state();
+  int calls = 0;
+  state.set_function("_test_native", [&calls] { return ++calls; });
+  SceneCacheWriter writer;
+  writer.watch(state);
+  state.script("scene = { spp = 4 }");
+  EXPECT_TRUE(writer.cacheable());
+  state.script("scene.n = _test_native()");
+  SceneCacheWriter::unwatch(state);
+  // the wrapped native is still called and returns its value
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(state.script("return scene.n").get<int>(), 1);
+  EXPECT_FALSE(writer.cacheable());
+  EXPECT_FALSE(writer.write(cache, script));
+  EXPECT_FALSE(SceneCache::open(cache, script));
+
+  // the original native is restored
+  state.script("_test_native()");
+  EXPECT_EQ(calls, 2);
+  EXPECT_TRUE(state.script("return _scene_input == nil").get<bool>());
+  state["_test_native"] = sol::lua_nil;
+  state["scene"] = sol::lua_nil;
+}
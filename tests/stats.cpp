@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <core/stats.h>
+#include <oneapi/tbb/parallel_for.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace dakku;
+
+namespace {
+template <typename T>
+const T *find(const std::vector<std::pair<std::string, T>> &entries,
+              const std::string &title) {
+  for (const auto &[t, v] : entries)
+    if (t == title) return &v;
+  return nullptr;
+}
+}  // namespace
+
+TEST(Stats, Aggregate) {
+  StatCounter counter{"Test/Counter"};
+  StatDistribution distribution{"Test/Distribution"};
+  StatCounter num{nullptr}, denom{nullptr};
+  StatRatio ratio{"Test/Ratio", num, denom};
+  oneapi::tbb::parallel_for(1, 1001, [&](int i) {
+    counter.add(2);
+    distribution.add(i);
+    num.add(i % 2);
+    denom.add(1);
+  });
+  EXPECT_EQ(counter.sum(), 2000);
+  StatReport report = StatRegistry::instance().collect();
+  ASSERT_NE(find(report.counters, "Test/Counter"), nullptr);
+  EXPECT_EQ(*find(report.counters, "Test/Counter"), 2000);
+  // ratio operands are not reported on their own
+  for (const auto &[title, v] : report.counters) EXPECT_FALSE(title.empty());
+  const auto *d = find(report.distributions, "Test/Distribution");
+  ASSERT_NE(d, nullptr);
+  EXPECT_EQ(d->count, 1000);
+  EXPECT_EQ(d->sum, 500500);
+  EXPECT_EQ(d->min, 1);
+  EXPECT_EQ(d->max, 1000);
+  const auto *r = find(report.ratios, "Test/Ratio");
+  ASSERT_NE(r, nullptr);
+  EXPECT_EQ(r->first, 500);
+  EXPECT_EQ(r->second, 1000);
+
+  StatRegistry::instance().report();
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "dakku_stats.json").string();
+  ASSERT_TRUE(StatRegistry::instance().write_json(path));
+  std::ifstream in(path);
+  std::string json{std::istreambuf_iterator<char>(in), {}};
+  EXPECT_NE(json.find(R"("Test/Counter": 2000)"), std::string::npos);
+  EXPECT_NE(json.find(R"("numerator": 500, "denominator": 1000)"),
+            std::string::npos);
+  std::filesystem::remove(path);
+
+  StatRegistry::instance().clear();
+  EXPECT_EQ(counter.sum(), 0);
+  EXPECT_EQ(num.sum(), 0);
+}
+
+TEST(Stats, Unregister) {
+  {
+    StatCounter counter{"Test/Scoped"};
+    counter.add(1);
+    EXPECT_NE(find(StatRegistry::instance().collect().counters, "Test/Scoped"),
+              nullptr);
+  }
+  EXPECT_EQ(find(StatRegistry::instance().collect().counters, "Test/Scoped"),
+            nullptr);
+}
+
+TEST(Stats, Macros) {
+  DAKKU_STAT_COUNTER("Test/Macro counter", macro_counter);
+  DAKKU_STAT_DISTRIBUTION("Test/Macro distribution", macro_distribution);
+  DAKKU_STAT_RATIO("Test/Macro ratio", macro_num, macro_denom);
+  DAKKU_STAT_INC(macro_counter);
+  DAKKU_STAT_ADD(macro_counter, 2);
+  DAKKU_STAT_VALUE(macro_distribution, 1.5);
+  DAKKU_STAT_INC(macro_num);
+  DAKKU_STAT_ADD(macro_denom, 4);
+#ifndef DAKKU_DISABLE_STATS
+  EXPECT_EQ(macro_counter.sum(), 3);
+  EXPECT_EQ(macro_num.sum(), 1);
+#endif
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <core/tile.h>
+
+#include <atomic>
+#include <map>
+
+using namespace dakku;
+
+namespace {
+/// every pixel is covered by exactly one tile
+void check_cover(const Bounds2i &bounds, const TileScheduler &scheduler) {
+  std::map<std::pair<int, int>, int> covered;
+  for (const Bounds2i &tile : scheduler) {
+    EXPECT_EQ(tile.intersect(bounds), tile);
+    for (Point2i p : tile) ++covered[{p.x(), p.y()}];
+  }
+  EXPECT_EQ(covered.size(), static_cast<size_t>(bounds.area()));
+  for (auto [p, n] : covered) EXPECT_EQ(n, 1);
+}
+
+/// consecutive tiles share an edge
+void check_adjacent(const TileScheduler &scheduler) {
+  for (size_t i = 1; i < scheduler.size(); ++i) {
+    Vector2i d = scheduler[i].p_min - scheduler[i - 1].p_min;
+    EXPECT_EQ(std::abs(d.x()) + std::abs(d.y()), 16) << i;
+  }
+}
+}  // namespace
+
+TEST(Tile, Cover) {
+  Bounds2i bounds{Point2i{-3, 5}, Point2i{97, 60}};
+  for (auto order : {TileOrder::SCANLINE, TileOrder::MORTON,
+                     TileOrder::HILBERT, TileOrder::SPIRAL}) {
+    TileScheduler scheduler{bounds, 16, order};
+    EXPECT_EQ(scheduler.tile_count(), Point2i(7, 4));
+    EXPECT_EQ(scheduler.size(), 28);
+    check_cover(bounds, scheduler);
+  }
+  EXPECT_EQ(TileScheduler(Bounds2i{}).size(), 0);
+}
+
+TEST(Tile, Order) {
+  Bounds2i square{Point2i{0, 0}, Point2i{128, 128}};
+  check_adjacent(TileScheduler{square, 16, TileOrder::HILBERT});
+  check_adjacent(TileScheduler{square, 16, TileOrder::SPIRAL});
+  TileScheduler morton{square, 16, TileOrder::MORTON};
+  EXPECT_EQ(morton[1].p_min, Point2i(16, 0));
+  EXPECT_EQ(morton[2].p_min, Point2i(0, 16));
+  TileScheduler spiral{Bounds2i{Point2i{0, 0}, Point2i{80, 48}}, 16,
+                       TileOrder::SPIRAL};
+  EXPECT_EQ(spiral[0].p_min, Point2i(32, 16));
+}
+
+TEST(Tile, ParallelFor) {
+  Bounds2i bounds{Point2i{0, 0}, Point2i{333, 211}};
+  TileScheduler scheduler{bounds, 32};
+  std::atomic<int> pixels{0}, tiles{0};
+  scheduler.parallel_for([&](const Bounds2i &tile) {
+    ++tiles;
+    pixels += tile.area();
+  });
+  EXPECT_EQ(tiles, static_cast<int>(scheduler.size()));
+  EXPECT_EQ(pixels, bounds.area());
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <core/tile.h>
+#include <core/trace.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace dakku;
+
+TEST(Trace, Tiles) {
+  Tracer &tracer = Tracer::instance();
+  tracer.clear();
+  // disabled tracers record nothing
+  { TraceScope trace("Disabled"); }
+  EXPECT_EQ(tracer.size(), 0);
+
+  tracer.enable();
+  TileScheduler scheduler{Bounds2i{{0, 0}, {40, 20}}, 16};
+  scheduler.parallel_for([](const Bounds2i &) {});
+  tracer.enable(false);
+  EXPECT_EQ(tracer.size(), scheduler.size());
+
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "dakku_trace.json").string();
+  ASSERT_TRUE(tracer.write_json(path));
+  std::ifstream in(path);
+  std::string json{std::istreambuf_iterator<char>(in), {}};
+  EXPECT_EQ(json.find("{\"displayTimeUnit\""), 0);
+  EXPECT_NE(json.find(R"("name": "thread_name")"), std::string::npos);
+  EXPECT_NE(json.find(R"("name": "Tile", "ph": "X")"), std::string::npos);
+  EXPECT_NE(json.find(R"("tile": [32, 16, 40, 20])"), std::string::npos);
+  EXPECT_EQ(json.find("Disabled"), std::string::npos);
+  std::filesystem::remove(path);
+  tracer.clear();
+  EXPECT_EQ(tracer.size(), 0);
+}
+
+TEST(Trace, RingBuffer) {
+  Tracer &tracer = Tracer::instance();
+  tracer.clear();
+  tracer.enable();
+  // a full buffer keeps the latest events
+  for (size_t i = 0; i < Tracer::CAPACITY + 10; ++i) {
+    TraceScope trace("Event");
+  }
+  tracer.enable(false);
+  EXPECT_EQ(tracer.size(), Tracer::CAPACITY);
+  tracer.clear();
+}
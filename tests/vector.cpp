@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <core/vector.h>
 
+#include <bit>
+#include <random>
+
 using namespace dakku;
 
 TEST(Vector, Basic) {
@@ -11,4 +14,208 @@ TEST(Vector, Basic) {
   a = 1 / -((9 * (4 - (1 + a + 2) * 3 - 1)) / 4);
   for (float &i : b) i = 1 / -(9 * (4 - (1 + i + 2) * 3 - 1) / 4);
   EXPECT_TRUE(eq());
-}
\ No newline at end of file
+}
+
+namespace {
+
+/// bitwise equality, so that `-0.0f` and `0.0f` are told apart
+bool bit_equal(float a, float b) {
+  return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+}
+
+template <typename V>
+void expect_bit_equal(const V &v, const std::array<float, 4> &e) {
+  for (size_t i = 0; i < v.size(); ++i)
+    EXPECT_TRUE(bit_equal(v[i], e[i]))
+        << "i = " << i << ", " << v[i] << " vs " << e[i];
+}
+
+/// random components mixed with signed zeros and ties
+std::vector<std::array<float, 4>> sample_components() {
+  std::mt19937 rng{7};
+  std::uniform_real_distribution<float> dist{-100.0f, 100.0f};
+  std::vector<std::array<float, 4>> ret{{0.0f, -0.0f, 0.0f, -0.0f},
+                                        {-0.0f, 0.0f, -0.0f, 0.0f},
+                                        {1.0f, 1.0f, 1.0f, 1.0f},
+                                        {-3.0f, 2.0f, 2.0f, -3.0f}};
+  for (int i = 0; i < 64; ++i)
+    ret.push_back({dist(rng), dist(rng), dist(rng), dist(rng)});
+  return ret;
+}
+
+template <typename V>
+V make(const std::array<float, 4> &c) {
+  V ret;
+  for (size_t i = 0; i < ret.size(); ++i) ret[i] = c[i];
+  return ret;
+}
+
+/// compare every simd-backed op with its scalar definition
+template <typename V, size_t n>
+void check_against_scalar() {
+  auto samples = sample_components();
+  for (size_t k = 0; k + 1 < samples.size(); ++k) {
+    const auto &ca = samples[k];
+    const auto &cb = samples[k + 1];
+    V a = make<V>(ca), b = make<V>(cb);
+    std::array<float, 4> e{};
+
+    for (size_t i = 0; i < n; ++i) e[i] = ca[i] + cb[i];
+    expect_bit_equal(V{a} += b, e);
+    for (size_t i = 0; i < n; ++i) e[i] = ca[i] - cb[i];
+    expect_bit_equal(V{a} -= b, e);
+    for (size_t i = 0; i < n; ++i) e[i] = ca[i] * cb[i];
+    expect_bit_equal(a * b, e);
+    for (size_t i = 0; i < n; ++i) e[i] = ca[i] * 2.5f;
+    expect_bit_equal(a * 2.5f, e);
+    for (size_t i = 0; i < n; ++i) e[i] = ca[i] + 3;
+    expect_bit_equal(a + 3, e);
+    if (!b.is_zero() && std::all_of(cb.begin(), cb.begin() + n,
+                                    [](float x) { return x != 0; })) {
+      for (size_t i = 0; i < n; ++i) e[i] = ca[i] / cb[i];
+      expect_bit_equal(a / b, e);
+    }
+    for (size_t i = 0; i < n; ++i) e[i] = std::min(ca[i], cb[i]);
+    expect_bit_equal(min(a, b), e);
+    for (size_t i = 0; i < n; ++i) e[i] = std::max(ca[i], cb[i]);
+    expect_bit_equal(max(a, b), e);
+    for (size_t i = 0; i < n; ++i) e[i] = std::abs(ca[i]);
+    expect_bit_equal(abs(a), e);
+    for (size_t i = 0; i < n; ++i) e[i] = std::sqrt(std::abs(ca[i]));
+    expect_bit_equal(sqrt(abs(a)), e);
+    for (size_t i = 0; i < n; ++i) e[i] = -ca[i];
+    expect_bit_equal(-a, e);
+
+    float d = ca[0] * cb[0];
+    for (size_t i = 1; i < n; ++i) d += ca[i] * cb[i];
+    EXPECT_TRUE(bit_equal(a.dot(b), d));
+
+    size_t m = 0;
+    for (size_t i = 1; i < n; ++i)
+      if (ca[m] < ca[i]) m = i;
+    EXPECT_EQ(a.max_element_index(), m);
+
+    if constexpr (n == 3) {
+      e = {ca[1] * cb[2] - ca[2] * cb[1], ca[2] * cb[0] - ca[0] * cb[2],
+           ca[0] * cb[1] - ca[1] * cb[0], 0.0f};
+      expect_bit_equal(a.cross(b), e);
+    }
+
+    EXPECT_TRUE(a == make<V>(ca));
+    EXPECT_FALSE(a != make<V>(ca));
+    EXPECT_FALSE(a.has_nans());
+  }
+}
+}  // namespace
+
+TEST(Vector, SimdVector3f) { check_against_scalar<Vector3f, 3>(); }
+
+TEST(Vector, SimdPoint3f) { check_against_scalar<Point3f, 3>(); }
+
+TEST(Vector, SimdNormal3f) { check_against_scalar<Normal3f, 3>(); }
+
+TEST(Vector, SimdVector4f) { check_against_scalar<Vector4f, 4>(); }
+
+TEST(Vector, SimdHasNans) {
+  Vector3f a;
+  EXPECT_TRUE(a.is_zero());
+  // a nan in the padding lane (3d) must not be reported
+  a = Vector3f(1.0f, 2.0f, 3.0f) / Vector3f(1.0f, 1.0f, 1.0f);
+  EXPECT_FALSE(a.has_nans());
+  EXPECT_FALSE(a.is_zero());
+  Point3f p = Point3f(1.0f, 2.0f, 3.0f) + Vector3f(1.0f, 1.0f, 1.0f);
+  EXPECT_EQ(p, Point3f(2.0f, 3.0f, 4.0f));
+  EXPECT_EQ(Point3f(2.0f, 3.0f, 4.0f) - Point3f(1.0f, 1.0f, 1.0f),
+            Vector3f(1.0f, 2.0f, 3.0f));
+}
+
+TEST(Vector, ExprResultType) {
+  static_assert(
+      std::is_same_v<VectorResult<decltype(Point3f{} - Point3f{})>, Vector3f>);
+  static_assert(
+      std::is_same_v<VectorResult<decltype(Point3f{} + Vector3f{})>, Point3f>);
+  static_assert(
+      std::is_same_v<VectorResult<decltype(Point3f{} - Vector3f{})>, Point3f>);
+  static_assert(std::is_same_v<VectorResult<decltype(2 * -Normal3f{})>,
+                               Normal3f>);
+  static_assert(!VectorOpAllowed<VectorAddOp, Vector3f, Point3f>);
+  static_assert(!VectorOpAllowed<VectorAddOp, Vector3f, Normal3f>);
+#ifdef DAKKU_ENABLE_SSE
+  Point3f o;
+  Vector3f d;
+  static_assert(decltype(o + (o - o) * 2.0f + d)::PACKET);
+  // double scalars are applied per component like the scalar code
+  static_assert(!decltype(d * 0.5)::PACKET);
+#endif
+}
+
+TEST(Vector, ExprFused) {
+  Point3f o(1.5f, -2.25f, 0.1f), rx(0.3f, 7.0f, -3.3f);
+  float s = 0.37f;
+  // o + (rx - o) * s, one operation at a time
+  Vector3f t = rx - o;
+  t *= s;
+  Point3f e = o;
+  e += Point3f(t);
+  Point3f r = o + (rx - o) * s;
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(bit_equal(r[i], e[i]));
+    // lazy component access evaluates the same operations
+    EXPECT_TRUE(bit_equal((o + (rx - o) * s)[i], e[i]));
+  }
+
+  // the destination may appear in the expression
+  Vector3f a(1.0f, 2.0f, 3.0f), b(4.0f, 5.0f, 6.0f);
+  a = b - a * 2;
+  EXPECT_EQ(a, Vector3f(2.0f, 1.0f, 0.0f));
+  a += a * a;
+  EXPECT_EQ(a, Vector3f(6.0f, 2.0f, 0.0f));
+
+  Vector3f c = a * 0.1;
+  for (size_t i = 0; i < 3; ++i)
+    EXPECT_TRUE(bit_equal(c[i], static_cast<float>(a[i] * 0.1)));
+
+  Vector3i v(1, 2, 3);
+  Vector3i w = (v + 1) * 3 - v / 1;
+  EXPECT_EQ(w, Vector3i(5, 7, 9));
+  EXPECT_EQ(10 - w, Vector3i(5, 3, 1));
+
+  EXPECT_FLOAT_EQ(distance(Point3f(0.0f, 0.0f, 0.0f),
+                           Point3f(3.0f, 4.0f, 0.0f)),
+                  5.0f);
+  EXPECT_FLOAT_EQ((Vector3f(1.0f, 2.0f, 2.0f) * 2).length(), 6.0f);
+}
+
+namespace {
+
+/// `auto` return built from locals
+auto offset_point(const Point3f &p, float s) {
+  Vector3f d(1.0f, 2.0f, 3.0f);
+  return p + d * s;
+}
+
+}  // namespace
+
+TEST(Vector, ExprAuto) {
+  Vector3f a(1.0f, 2.0f, 3.0f), b(4.0f, 5.0f, 6.0f);
+  auto v = a + b;
+  a = Vector3f(100.0f, 100.0f, 100.0f);
+  b = a;
+  // `v` is a snapshot of the operands, not an alias
+  EXPECT_EQ(Vector3f(v), Vector3f(5.0f, 7.0f, 9.0f));
+  auto w = v * 2;
+  EXPECT_EQ(Vector3f(w), Vector3f(10.0f, 14.0f, 18.0f));
+
+  // the locals of `offset_point` are gone, the expression still holds them
+  auto p = offset_point(Point3f(1.0f, 1.0f, 1.0f), 2.0f);
+  EXPECT_EQ(Point3f(p), Point3f(3.0f, 5.0f, 7.0f));
+
+  // building and moving expressions copies no checked vectors, only the
+  // stored result is checked
+  static_assert(std::is_trivially_copyable_v<decltype(a + b * 2.0f - a)>);
+  static_assert(std::is_trivially_copyable_v<decltype(-(p + 1.0f))>);
+  // an auto result passes wherever the vector type is expected
+  auto length = [](const Vector3f &u) { return u.length(); };
+  EXPECT_EQ(length(w), Vector3f(10.0f, 14.0f, 18.0f).length());
+  EXPECT_EQ(v.dot(w), Vector3f(5.0f, 7.0f, 9.0f).dot(Vector3f(w)));
+}
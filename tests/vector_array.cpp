@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <core/vector_array.h>
+
+using namespace dakku;
+
+TEST(VectorArray, Basic) {
+  Point3fArray a;
+  EXPECT_EQ(a.size(), 0);
+  a.push_back(Point3f{1, 2, 3});
+  a.push_back(Point3f{4, 5, 6});
+  EXPECT_EQ(a.size(), 2);
+  EXPECT_EQ(a.get(1), (Point3f{4, 5, 6}));
+  a.set(0, Point3f{-1, -2, -3});
+  std::vector<float> expected{-1, -2, -3, 4, 5, 6};
+  EXPECT_TRUE(std::ranges::equal(a.data(), expected));
+
+  auto soa = a.to_soa();
+  EXPECT_EQ(soa[0], (std::vector<float>{-1, 4}));
+  EXPECT_EQ(soa[2], (std::vector<float>{-3, 6}));
+
+  a.resize(3);
+  EXPECT_EQ(a.get(2), (Point3f{0, 0, 0}));
+}
+
+TEST(VectorArray, FromString) {
+  auto a = Point2fArray::from_string(" 0 1, 2.5 -3;\n4e1\t5 ");
+  ASSERT_EQ(a.size(), 3);
+  EXPECT_EQ(a.get(0), (Point2f{0, 1}));
+  EXPECT_EQ(a.get(1), (Point2f{2.5f, -3}));
+  EXPECT_EQ(a.get(2), (Point2f{40, 5}));
+  EXPECT_EQ(Point2fArray::from_string("").size(), 0);
+}
+
+TEST(VectorArray, Arithmetic) {
+  Point3fArray a;
+  a.push_back(Point3f{1, 2, 3});
+  a.push_back(Point3f{-1, 0, 1});
+  a += Vector3f{1, 1, 1};
+  EXPECT_EQ(a.get(0), (Point3f{2, 3, 4}));
+  a *= 2.0f;
+  EXPECT_EQ(a.get(1), (Point3f{0, 2, 4}));
+  a *= Vector3f{1, 0.5f, 0.25f};
+  EXPECT_EQ(a.get(0), (Point3f{4, 3, 2}));
+  Point3fArray b = a;
+  a -= b;
+  EXPECT_EQ(a.get(0), (Point3f{0, 0, 0}));
+  EXPECT_EQ(a.get(1), (Point3f{0, 0, 0}));
+
+  Bounds3f bounds = b.bounds();
+  EXPECT_EQ(bounds.p_min, (Point3f{0, 1, 1}));
+  EXPECT_EQ(bounds.p_max, (Point3f{4, 3, 2}));
+}
+
+TEST(VectorArray, Transform) {
+  // rotate 90 degrees around z then translate by (1, 2, 3)
+  std::array<float, 12> m{0, -1, 0, 1, 1, 0, 0, 2, 0, 0, 1, 3};
+  Point3fArray p;
+  p.push_back(Point3f{1, 0, 0});
+  p.transform(m);
+  EXPECT_EQ(p.get(0), (Point3f{1, 3, 3}));
+
+  Vector3fArray v;
+  v.push_back(Vector3f{1, 0, 0});
+  v.push_back(Vector3f{0, 3, 4});
+  v.transform(m);
+  EXPECT_EQ(v.get(0), (Vector3f{0, 1, 0}));
+  v.normalize();
+  EXPECT_EQ(v.get(0), (Vector3f{0, 1, 0}));
+  EXPECT_FLOAT_EQ(v.get(1).x(), -0.6f);
+  EXPECT_FLOAT_EQ(v.get(1).z(), 0.8f);
+}
+
+TEST(VectorArray, LuaIndexOutOfRange) {
+  auto &state = Lua::instance().get_state();
+  state.script("points = Point3fArray.new(2)");
+  auto run = [&](const char *code) {
+    return state.safe_script(code, sol::script_pass_on_error).valid();
+  };
+  EXPECT_TRUE(run("points[2] = Point3f.new({1, 2, 3})"));
+  EXPECT_TRUE(run("return points[2]"));
+  EXPECT_FALSE(run("return points[0]"));
+  EXPECT_FALSE(run("return points[3]"));
+  EXPECT_FALSE(run("points[3] = Point3f.new({1, 2, 3})"));
+  EXPECT_FALSE(run("points:add(Point3fArray.new(3))"));
+  state["points"] = sol::lua_nil;
+}
+
+TEST(VectorArray, LuaInvalidTable) {
+  auto &state = Lua::instance().get_state();
+  auto run = [&](const char *code) {
+    return state.safe_script(code, sol::script_pass_on_error).valid();
+  };
+  EXPECT_TRUE(
+      run("return Point2fArray.new({0, 1, {2, 3}, Point2f.new({4, 5})})"));
+  EXPECT_FALSE(run("return Point2fArray.new({0, 1, 2})"));
+  EXPECT_FALSE(run("return Point2fArray.new({0, {1, 2}})"));
+  EXPECT_FALSE(run("return Point2fArray.new({{1}})"));
+  EXPECT_FALSE(run("return Point2fArray.new({{1, 'a'}})"));
+  EXPECT_FALSE(run("return Point2fArray.new({true})"));
+}
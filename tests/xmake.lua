@@ -3,4 +3,5 @@ target("test")
   set_kind("binary")
   add_files("*.cpp")
   add_packages("gtest")
-  add_deps("dakku.core")
\ No newline at end of file
+  add_deps("dakku.core", "dakku.accelerators", "dakku.imageio", "dakku.samplers",
+           "dakku.integrators")
\ No newline at end of file
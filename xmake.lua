@@ -12,6 +12,32 @@ if is_plat("windows") then
   add_defines("NOMINMAX")
 end
 
+option("simd")
+  set_default(true)
+  set_showmenu(true)
+  set_description("use sse/avx intrinsics in core math or not")
+option_end()
+
+if not has_config("simd") then
+  add_defines("DAKKU_DISABLE_SIMD")
+end
+
+option("stats")
+  set_default(true)
+  set_showmenu(true)
+  set_description("collect render statistics or not")
+option_end()
+
+if not has_config("stats") then
+  add_defines("DAKKU_DISABLE_STATS")
+end
+
+option("embree")
+  set_default(false)
+  set_showmenu(true)
+  set_description("build the embree accelerator or not")
+option_end()
+
 add_vectorexts("mmx", "sse", "sse2", "sse3", "ssse3", "avx", "avx2")
 includes("src")
 
@@ -22,4 +48,13 @@ option("build_test")
 
 if has_config("build_test") then
   includes("tests")
+end
+
+option("build_bench")
+  set_default(false)
+  set_showmenu(true)
+  set_description("build with benchmarks or not")
+
+if has_config("build_bench") then
+  includes("bench")
 end
\ No newline at end of file